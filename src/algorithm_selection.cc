@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the automatic algorithm selection.
+
+#include "algorithm_selection.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <boost/range/algorithm.hpp>
+
+#include "bdd.h"
+
+namespace scram::core {
+
+namespace {
+
+/// The size of the unique table
+/// beyond which the trial BDD is abandoned for ZBDD.
+const int kTrialVertexLimit = 1 << 20;
+
+}  // namespace
+
+PdagMetrics CollectMetrics(const Pdag& graph) noexcept {
+  PdagMetrics metrics;
+  metrics.coherent = graph.coherent();
+  std::unordered_set<int> visited;  // The indices of gates and variables.
+  std::vector<const Gate*> modules = {&graph.root()};
+  visited.insert(graph.root().index());
+  while (!modules.empty()) {
+    const Gate* module = modules.back();
+    modules.pop_back();
+    int num_variables = 0;
+    int num_shared_variables = 0;
+    auto gather = [&](auto& self, const Gate& gate) -> void {
+      ++metrics.num_gates;
+      if (gate.module())
+        ++metrics.num_modules;
+      if (gate.type() == kXor ||
+          boost::find_if(gate.args(), [](int arg) { return arg < 0; }) !=
+              gate.args().end()) {
+        ++metrics.num_noncoherent_gates;
+      }
+      for (Gate::ConstArg<Variable> arg : gate.args<Variable>()) {
+        if (!visited.insert(arg.second.index()).second)
+          continue;
+        ++num_variables;
+        if (arg.second.parents().size() > 1)
+          ++num_shared_variables;
+      }
+      for (Gate::ConstArg<Gate> arg : gate.args<Gate>()) {
+        if (!visited.insert(arg.second.index()).second)
+          continue;
+        if (arg.second.module()) {
+          modules.push_back(&arg.second);
+        } else {
+          self(self, arg.second);
+        }
+      }
+    };
+    gather(gather, *module);
+    metrics.num_variables += num_variables;
+    metrics.num_shared_variables += num_shared_variables;
+    metrics.max_module_variables =
+        std::max(metrics.max_module_variables, num_variables);
+    metrics.max_module_shared_variables =
+        std::max(metrics.max_module_shared_variables, num_shared_variables);
+  }
+  return metrics;
+}
+
+AlgorithmSelection SelectAlgorithm(const Pdag& graph, const Settings& settings,
+                                   std::unique_ptr<Bdd>* trial) noexcept {
+  AlgorithmSelection selection{Algorithm::kBdd, Approximation::kNone, "",
+                               CollectMetrics(graph)};
+  const PdagMetrics& metrics = selection.metrics;
+  if (settings.prime_implicants()) {
+    selection.reason = "prime implicants";
+  } else {
+    auto bdd = std::make_unique<Bdd>(&graph, settings, kTrialVertexLimit);
+    selection.trial_vertices = bdd->size();
+    if (bdd->complete()) {
+      selection.reason = metrics.coherent
+                             ? "BDD trial within the limit"
+                             : "non-coherent BDD trial within the limit";
+      if (trial)
+        *trial = std::move(bdd);
+    } else {
+      selection.algorithm = Algorithm::kZbdd;
+      selection.approximation = Approximation::kRareEvent;
+      selection.reason = metrics.coherent
+                             ? "BDD trial over the limit"
+                             : "non-coherent BDD trial over the limit";
+    }
+  }
+  if (settings.approximation() != Approximation::kNone)
+    selection.approximation = settings.approximation();
+  return selection;
+}
+
+}  // namespace scram::core
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Automatic selection of qualitative analysis algorithms
+/// from the structure of preprocessed PDAGs.
+
+#pragma once
+
+#include <memory>
+
+#include "pdag.h"
+#include "settings.h"
+
+namespace scram::core {
+
+class Bdd;
+
+/// Cheap structural metrics of a PDAG preprocessed for BDD.
+struct PdagMetrics {
+  int num_gates = 0;  ///< The number of unique gates.
+  int num_variables = 0;  ///< The number of unique variables.
+  int num_modules = 0;  ///< The number of module gates.
+  /// The number of gates with complement arguments or XOR logic.
+  int num_noncoherent_gates = 0;
+  /// The number of variables with more than one parent gate.
+  int num_shared_variables = 0;
+  /// The largest number of variables in a single module,
+  /// excluding the variables of its sub-modules.
+  int max_module_variables = 0;
+  /// The largest number of shared variables in a single module.
+  /// The shared variables of a module
+  /// are the main contributors to the width of its BDD.
+  int max_module_shared_variables = 0;
+  bool coherent = true;  ///< The coherence of the graph.
+};
+
+/// The qualitative analysis algorithm selected for an analysis target.
+struct AlgorithmSelection {
+  Algorithm algorithm;  ///< The selected algorithm.
+  Approximation approximation;  ///< The quantitative approximation.
+  const char* reason;  ///< The short description of the decision.
+  PdagMetrics metrics;  ///< The inputs of the decision.
+  int trial_vertices = 0;  ///< The size of the trial BDD if constructed.
+};
+
+/// Collects the structural metrics of a PDAG.
+///
+/// @param[in] graph  The PDAG preprocessed for BDD.
+///
+/// @returns The metrics of the graph.
+PdagMetrics CollectMetrics(const Pdag& graph) noexcept;
+
+/// Selects the qualitative analysis algorithm for a preprocessed PDAG.
+///
+/// BDD is always selected for prime implicants,
+/// which only BDD can calculate.
+/// Other graphs, coherent or not, get a trial BDD construction
+/// bounded by the number of vertices.
+/// BDD is selected if the trial completes within the bound
+/// since the exact quantification is affordable.
+/// Otherwise, ZBDD with the approximation is selected
+/// since the product order limit and cut-off prune the ZBDD
+/// where the BDD blows up.
+/// The ZBDD products of non-coherent graphs
+/// are minimal cut sets without complement literals.
+/// The structural metrics are not predictive enough
+/// to replace the trial construction.
+///
+/// @param[in] graph  The PDAG preprocessed for BDD.
+/// @param[in] settings  The analysis settings with the automatic selection.
+/// @param[out] trial  The complete trial BDD for reuse by the analysis.
+///
+/// @returns The selected algorithm and approximation with the metrics.
+AlgorithmSelection SelectAlgorithm(const Pdag& graph, const Settings& settings,
+                                   std::unique_ptr<Bdd>* trial = nullptr)
+    noexcept;
+
+}  // namespace scram::core
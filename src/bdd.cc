@@ -20,6 +20,9 @@
 
 #include "bdd.h"
 
+#include <functional>
+#include <map>
+
 #include <boost/multiprecision/miller_rabin.hpp>
 #include <boost/range/algorithm.hpp>
 
@@ -38,9 +41,12 @@ int GetPrimeNumber(int n) {
   return n;
 }
 
-Bdd::Bdd(const Pdag* graph, const Settings& settings)
+Bdd::Bdd(const Pdag* graph, const Settings& settings, int vertex_limit)
     : kSettings_(settings),
       coherent_(graph->coherent()),
+      reorder_threshold_(settings.reorder_threshold()),
+      vertex_limit_(vertex_limit),
+      complete_(true),
       kOne_(new Terminal<Ite>(true)),
       function_id_(2) {
   TIMER(DEBUG3, "Converting PDAG into BDD");
@@ -60,7 +66,7 @@ Bdd::Bdd(const Pdag* graph, const Settings& settings)
     }
   } else {
     std::unordered_map<int, std::pair<Function, int>> gates;
-    root_ = ConvertGraph(graph->root(), &gates);
+    root_ = ConvertGraph(graph->root(), graph->root().index(), &gates);
     root_.complement ^= graph->complement();
   }
   ClearMarks(false);
@@ -72,6 +78,12 @@ Bdd::Bdd(const Pdag* graph, const Settings& settings)
   ClearMarks(false);
   LOG(DEBUG4) << "# of ITE in BDD: " << CountIteNodes(root_.vertex);
   ClearMarks(false);
+  if (reordering_.count) {
+    LOG(DEBUG3) << "# of variable reorderings: " << reordering_.count;
+    LOG(DEBUG3) << "Reordering reduced # of BDD vertices from "
+                << reordering_.size_before << " to " << reordering_.size_after
+                << " in " << reordering_.time;
+  }
   if (coherent_) {  // Clear tables if no more calculations are expected.
     Freeze();
   } else {  // To be used by ZBDD for prime implicant calculations.
@@ -79,6 +91,15 @@ Bdd::Bdd(const Pdag* graph, const Settings& settings)
   }
 }
 
+Bdd::Bdd(const Settings& settings, bool coherent) noexcept
+    : kSettings_(settings),
+      coherent_(coherent),
+      reorder_threshold_(0),
+      vertex_limit_(0),
+      complete_(true),
+      kOne_(new Terminal<Ite>(true)),
+      function_id_(2) {}
+
 Bdd::~Bdd() noexcept = default;
 
 void Bdd::Analyze(const Pdag* graph) noexcept {
@@ -133,10 +154,12 @@ ItePtr Bdd::FindOrAddVertex(const Gate& gate, const VertexPtr& high,
 }
 
 Bdd::Function Bdd::ConvertGraph(
-    const Gate& gate,
+    const Gate& gate, int module,
     std::unordered_map<int, std::pair<Function, int>>* gates) noexcept {
   assert(!gate.constant() && "Unexpected constant gate!");
   Function result;  // For the NRVO, due to memoization.
+  if (!complete_)
+    return {false, kOne_};  // The trial is over.
   // Memoization check.
   if (auto it_entry = ext::find(*gates, gate.index())) {
     std::pair<Function, int>& entry = it_entry->second;
@@ -148,14 +171,18 @@ Bdd::Function Bdd::ConvertGraph(
   }
   std::vector<Function> args;
   for (const Gate::ConstArg<Variable>& arg : gate.args<Variable>()) {
-    args.push_back(
-        {arg.first < 0, FindOrAddVertex(arg.second.index(), kOne_, kOne_, true,
-                                        arg.second.order())});
-    index_to_order_.emplace(arg.second.index(), arg.second.order());
+    // The order may have changed with the reordering.
+    int order = index_to_order_.emplace(arg.second.index(), arg.second.order())
+                    .first->second;
+    args.push_back({arg.first < 0, FindOrAddVertex(arg.second.index(), kOne_,
+                                                   kOne_, true, order)});
+    index_to_module_.emplace(arg.second.index(), module);
   }
   for (const Gate::ConstArg<Gate>& arg : gate.args<Gate>()) {
-    Function res = ConvertGraph(arg.second, gates);
+    Function res = ConvertGraph(
+        arg.second, arg.second.module() ? arg.second.index() : module, gates);
     if (arg.second.module()) {
+      index_to_module_.emplace(arg.second.index(), module);
       args.push_back(
           {arg.first < 0, FindOrAddVertex(arg.second, kOne_, kOne_, true)});
     } else {
@@ -170,12 +197,24 @@ Bdd::Function Bdd::ConvertGraph(
       return false;
     return Ite::Ref(lhs.vertex).order() > Ite::Ref(rhs.vertex).order();
   });
-  auto it = args.cbegin();
-  for (result = *it++; it != args.cend(); ++it) {
-    result = Apply(gate.type(), result.vertex, it->vertex, result.complement,
-                   it->complement);
+  if (gate.type() == kAtleast) {
+    result = ApplyAtleast(args, gate.min_number());
+  } else {
+    auto it = args.cbegin();
+    for (result = *it++; it != args.cend() && complete_; ++it) {
+      result = Apply(gate.type(), result.vertex, it->vertex, result.complement,
+                     it->complement);
+      if (vertex_limit_ && unique_table_.size() > vertex_limit_)
+        complete_ = false;  // Wide gates blow up in the middle.
+    }
   }
+  if (vertex_limit_ && unique_table_.size() > vertex_limit_)
+    complete_ = false;
   ClearTables();
+  if (complete_ && reorder_threshold_ &&
+      unique_table_.size() > reorder_threshold_) {
+    ReorderVariables();
+  }
   assert(result.vertex);
   if (gate.module())
     modules_.emplace(gate.index(), result);
@@ -184,6 +223,174 @@ Bdd::Function Bdd::ConvertGraph(
   return result;
 }
 
+void Bdd::ReorderVariables() noexcept {
+  CLOCK(reorder_time);
+  std::vector<Level> levels;  // Top-down positions in the ordering.
+  {
+    std::map<int, Level> order_to_level;
+    unique_table_.ForEach([&order_to_level](Ite* ite) {
+      Level& level = order_to_level[ite->order()];
+      level.index = ite->index();
+      level.order = ite->order();
+      level.fixed = ite->module();
+      level.vertices.emplace_back(ite);
+    });
+    for (auto& entry : order_to_level)
+      levels.push_back(std::move(entry.second));
+  }
+  int size = 0;
+  for (Level& level : levels) {  // Top-down collection of dead vertices.
+    level.vertices.erase(
+        std::remove_if(level.vertices.begin(), level.vertices.end(),
+                       [](const ItePtr& ite) { return ite->unique(); }),
+        level.vertices.end());
+    size += level.vertices.size();
+  }
+  const int size_before = size;
+
+  std::map<int, std::vector<int>> module_to_levels;
+  for (int i = 0; i < levels.size(); ++i) {
+    auto it = index_to_module_.find(levels[i].index);
+    assert(it != index_to_module_.end() && "Unknown variable module.");
+    module_to_levels[it->second].push_back(i);
+  }
+  const double kMaxGrowth = 1.2;  // The limit for sifting in one direction.
+  for (auto& [module, chain] : module_to_levels) {
+    std::vector<std::pair<int, int>> variables;  // Sizes and indices.
+    for (int i : chain) {
+      if (!levels[i].fixed)
+        variables.emplace_back(levels[i].vertices.size(), levels[i].index);
+    }
+    boost::sort(variables, std::greater<>());  // Largest variables first.
+    for (const auto& variable : variables) {
+      auto get_level = [&levels, &chain](int slot) -> Level& {
+        return levels[chain[slot]];
+      };
+      int slot = 0;
+      while (get_level(slot).index != variable.second)
+        ++slot;
+      int top = slot;
+      while (top > 0 && !get_level(top - 1).fixed)
+        --top;
+      int bottom = slot;
+      while (bottom + 1 < chain.size() && !get_level(bottom + 1).fixed)
+        ++bottom;
+      int best_size = size;
+      int best_slot = slot;
+      auto move = [&](int target) {
+        for (; slot < target; ++slot)
+          size += SwapLevels(&get_level(slot), &get_level(slot + 1));
+        for (; slot > target; --slot)
+          size += SwapLevels(&get_level(slot - 1), &get_level(slot));
+      };
+      auto sift = [&](int end) {
+        while (slot != end && size <= kMaxGrowth * best_size) {
+          move(slot < end ? slot + 1 : slot - 1);
+          if (size < best_size) {
+            best_size = size;
+            best_slot = slot;
+          }
+        }
+      };
+      if (slot - top < bottom - slot) {  // The closest end first.
+        sift(top);
+        sift(bottom);
+      } else {
+        sift(bottom);
+        sift(top);
+      }
+      move(best_slot);
+      assert(size == best_size);
+    }
+  }
+  levels.clear();
+  unique_table_.Purge();
+  reorder_threshold_ = std::max(reorder_threshold_, 2 * size);
+  double time = DUR(reorder_time);
+  reordering_.count += 1;
+  reordering_.size_before += size_before;
+  reordering_.size_after += size;
+  reordering_.time += time;
+  LOG(DEBUG4) << "Reordered BDD variables from " << size_before << " to "
+              << size << " vertices in " << time;
+}
+
+int Bdd::SwapLevels(Level* upper, Level* lower) noexcept {
+  assert(upper->order < lower->order && "Invalid positions.");
+  assert(!upper->fixed && !lower->fixed && "Module proxies are not swapped.");
+  const int size_before = upper->vertices.size() + lower->vertices.size();
+  const int x = upper->index;
+  const int y = lower->index;
+  auto is_y = [y](const VertexPtr& vertex) {
+    return !vertex->terminal() && Ite::Ref(vertex).index() == y;
+  };
+  std::vector<ItePtr> x_vertices;  // Independent of y.
+  std::vector<ItePtr> y_vertices;  // Including x vertices dependent on y.
+  for (ItePtr& ite : upper->vertices) {
+    if (ite->unique())
+      continue;  // Dead vertex.
+    if (is_y(ite->high()) || is_y(ite->low())) {
+      y_vertices.push_back(std::move(ite));
+    } else {
+      ite->order(lower->order);
+      x_vertices.push_back(std::move(ite));
+    }
+  }
+  upper->vertices.clear();
+  for (const ItePtr& ite : lower->vertices)
+    ite->order(upper->order);
+
+  // Cofactors of the function with respect to the y variable.
+  auto get_cofactors = [&is_y](const Function& function) {
+    if (!is_y(function.vertex))
+      return std::pair(function, function);
+    const Ite& ite = Ite::Ref(function.vertex);
+    return std::pair(
+        Function{function.complement, ite.high()},
+        Function{function.complement != ite.complement_edge(), ite.low()});
+  };
+  // Reduced x vertex with the high edge free of the complement.
+  auto get_x_function = [&](const Function& high, const Function& low) {
+    if (high.complement == low.complement &&
+        high.vertex->id() == low.vertex->id()) {
+      return high;
+    }
+    ItePtr ite = FindOrAddVertex(x, high.vertex, low.vertex,
+                                 high.complement ^ low.complement,
+                                 lower->order);
+    if (ite->unique())  // New vertex.
+      x_vertices.push_back(ite);
+    return Function{high.complement, ite};
+  };
+  for (const ItePtr& ite : y_vertices) {
+    auto [f_11, f_10] = get_cofactors({false, ite->high()});
+    auto [f_01, f_00] = get_cofactors({ite->complement_edge(), ite->low()});
+    unique_table_.FindOrAdd(x, get_high_id(*ite), get_low_id(*ite)).reset();
+    Function high = get_x_function(f_11, f_01);
+    Function low = get_x_function(f_10, f_00);
+    assert(!high.complement && "Complement high edge.");
+    ite->Rewire(y, upper->order, high.vertex, low.vertex);
+    ite->complement_edge(low.complement);
+    IteWeakPtr& in_table =
+        unique_table_.FindOrAdd(y, get_high_id(*ite), get_low_id(*ite));
+    assert(in_table.expired() && "Non-canonical swap.");
+    in_table = ite;
+  }
+  for (ItePtr& ite : lower->vertices) {
+    if (!ite->unique())  // Dead if only referenced by the level.
+      y_vertices.push_back(std::move(ite));
+  }
+  lower->vertices.clear();
+
+  upper->index = y;
+  upper->vertices = std::move(y_vertices);
+  lower->index = x;
+  lower->vertices = std::move(x_vertices);
+  index_to_order_[y] = upper->order;
+  index_to_order_[x] = lower->order;
+  return upper->vertices.size() + lower->vertices.size() - size_before;
+}
+
 std::pair<int, int> Bdd::GetMinMaxId(const VertexPtr& arg_one,
                                      const VertexPtr& arg_two,
                                      bool complement_one,
@@ -306,6 +513,26 @@ Bdd::Function Bdd::Apply(Connective type, const VertexPtr& arg_one,
   return Apply<kOr>(arg_one, arg_two, complement_one, complement_two);
 }
 
+Bdd::Function Bdd::ApplyAtleast(const std::vector<Function>& args,
+                                int min_number) noexcept {
+  assert(min_number > 0 && min_number <= args.size());
+  // The K/N functions of the applied arguments by the remaining K.
+  std::vector<Function> row(min_number + 1, {true, kOne_});
+  row.front() = {false, kOne_};
+  int num_args = args.size();
+  for (int i = 0; i < num_args; ++i) {
+    const Function& arg = args[i];
+    int last = std::max(1, min_number - (num_args - i - 1));
+    for (int k = std::min(i + 1, min_number); k >= last; --k) {
+      Function with_arg = Apply(kAnd, arg.vertex, row[k - 1].vertex,
+                                arg.complement, row[k - 1].complement);
+      row[k] = Apply(kOr, with_arg.vertex, row[k].vertex, with_arg.complement,
+                     row[k].complement);
+    }
+  }
+  return row.back();
+}
+
 Bdd::Function Bdd::CalculateConsensus(const ItePtr& ite,
                                       bool complement) noexcept {
   ClearTables();
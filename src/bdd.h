@@ -114,6 +114,12 @@ class WeakIntrusivePtr final : private boost::noncopyable {
   /// @returns true if the managed vertex is deleted or not initialized.
   bool expired() const { return !vertex_; }
 
+  /// Detaches the vertex from this entry, so the entry expires.
+  void reset() noexcept {
+    this->~WeakIntrusivePtr();
+    vertex_ = nullptr;
+  }
+
   /// @returns The intrusive pointer of the vertex.
   ///          nullptr if the vertex is deleted or not initialized.
   IntrusivePtr<T> lock() const { return IntrusivePtr<T>(vertex_); }
@@ -272,6 +278,31 @@ class NonTerminal : public Vertex<T>, public IntrusivePtrCast<T> {
     return order_;
   }
 
+  /// Moves the vertex to another position in the variable ordering.
+  ///
+  /// @param[in] order  The new order of the vertex.
+  void order(int order) {
+    assert(order > 0);
+    order_ = order;
+  }
+
+  /// Replaces the decomposition variable and branches of this vertex
+  /// without changing its function for the parents.
+  ///
+  /// @param[in] index  The index of the new decomposition variable.
+  /// @param[in] order  The order of the new decomposition variable.
+  /// @param[in] high  The new vertex for the (1/True/then/left) branch.
+  /// @param[in] low  The new vertex for the (0/False/else/right) branch.
+  ///
+  /// @pre The vertex is detached from its unique table entry.
+  void Rewire(int index, int order, const VertexPtr& high,
+              const VertexPtr& low) {
+    index_ = index;
+    this->order(order);
+    high_ = high;
+    low_ = low;
+  }
+
   /// @returns true if this vertex represents a module gate.
   bool module() const { return module_; }
 
@@ -413,6 +444,22 @@ class UniqueTable {
   /// @returns The current number of entries.
   int size() const { return size_; }
 
+  /// Calls the visitor with every live vertex in the table.
+  ///
+  /// @param[in] visitor  The function taking T* argument.
+  template <class Visitor>
+  void ForEach(Visitor visitor) const {
+    for (const Bucket& chain : table_) {
+      for (const WeakIntrusivePtr<T>& entry : chain) {
+        if (!entry.expired())
+          visitor(entry.get());
+      }
+    }
+  }
+
+  /// Removes expired entries to make the size exact.
+  void Purge() { Rehash(capacity_); }
+
   /// Erases all entries.
   void clear() {
     for (Bucket& chain : table_)
@@ -680,6 +727,7 @@ class CacheTable {
 };
 
 class Zbdd;  // For analysis purposes.
+class DiagramCache;  // Snapshots of the analysis diagrams.
 
 /// Analysis of PDAGs with Binary Decision Diagrams.
 /// This binary decision diagram data structure
@@ -688,6 +736,8 @@ class Zbdd;  // For analysis purposes.
 /// @note The low/else edge is chosen to have the attribute for an ITE vertex.
 ///       There is only one terminal vertex of value 1/True.
 class Bdd : private boost::noncopyable {
+  friend class DiagramCache;  // Restores the diagram from snapshots.
+
  public:
   using VertexPtr = IntrusivePtr<Vertex<Ite>>;  ///< BDD vertex base.
   using TerminalPtr = IntrusivePtr<Terminal<Ite>>;  ///< Terminal vertices.
@@ -735,7 +785,20 @@ class Bdd : private boost::noncopyable {
   /// @pre The PDAG has variable ordering.
   ///
   /// @note BDD construction may take considerable time.
-  Bdd(const Pdag* graph, const Settings& settings);
+  Bdd(const Pdag* graph, const Settings& settings)
+      : Bdd(graph, settings, /*vertex_limit=*/0) {}
+
+  /// Constructs a trial BDD within the limit on the number of vertices.
+  /// The construction stops converting gates once the limit is exceeded,
+  /// and the resultant incomplete BDD is unfit for analysis.
+  ///
+  /// @param[in] graph  Preprocessed and partially normalized PDAG.
+  /// @param[in] settings  The analysis settings.
+  /// @param[in] vertex_limit  The limit on the size of the unique table.
+  ///                          0 for no limit.
+  ///
+  /// @pre The PDAG has variable ordering.
+  Bdd(const Pdag* graph, const Settings& settings, int vertex_limit);
 
   /// To handle incomplete ZBDD type with unique pointers.
   ~Bdd() noexcept;
@@ -754,6 +817,23 @@ class Bdd : private boost::noncopyable {
   /// @returns true if the BDD has been constructed from a coherent PDAG.
   bool coherent() const { return coherent_; }
 
+  /// @returns false if the construction has exceeded the vertex limit.
+  bool complete() const { return complete_; }
+
+  /// @returns The number of unique vertices in the BDD.
+  int size() const { return unique_table_.size(); }
+
+  /// Accumulated results of the dynamic variable reordering.
+  struct Reordering {
+    int count = 0;  ///< The number of reorderings.
+    int size_before = 0;  ///< The total # of vertices before reorderings.
+    int size_after = 0;  ///< The total # of vertices after reorderings.
+    double time = 0;  ///< The total reordering time in seconds.
+  };
+
+  /// @returns The results of the variable reordering during construction.
+  const Reordering& reordering() const { return reordering_; }
+
   /// Helper function to clear and set vertex marks.
   ///
   /// @param[in] mark  Desired mark for BDD vertices.
@@ -782,6 +862,12 @@ class Bdd : private boost::noncopyable {
   using IteWeakPtr = WeakIntrusivePtr<Ite>;  ///< Pointer in containers.
   using ComputeTable = CacheTable<Function>;  ///< Computation results.
 
+  /// Constructs an empty BDD to be restored from a snapshot.
+  ///
+  /// @param[in] settings  The analysis settings.
+  /// @param[in] coherent  The coherence of the source PDAG.
+  Bdd(const Settings& settings, bool coherent) noexcept;
+
   /// Finds or adds a unique if-then-else vertex in BDD.
   /// All vertices in the BDD must be created with this functions.
   /// Otherwise, the BDD may not be reduced.
@@ -833,15 +919,44 @@ class Bdd : private boost::noncopyable {
   /// Registers processed gates.
   ///
   /// @param[in] gate  The root or current parent gate of the graph.
+  /// @param[in] module  The index of the module gate containing the gate.
   /// @param[in,out] gates  Processed gates with use counts.
   ///
   /// @returns The BDD function representing the gate.
   ///
   /// @pre The memoization container is not used outside of this function.
   Function ConvertGraph(
-      const Gate& gate,
+      const Gate& gate, int module,
       std::unordered_map<int, std::pair<Function, int>>* gates) noexcept;
 
+  /// The vertices of a variable at a single position in the ordering.
+  struct Level {
+    int index;  ///< The index of the variable or module.
+    int order;  ///< The order of the position.
+    bool fixed;  ///< Module proxies keep their positions.
+    std::vector<ItePtr> vertices;  ///< The live vertices of the variable.
+  };
+
+  /// Reduces the number of vertices by sifting variables one at a time.
+  /// The variables are sifted only within their modules
+  /// between the positions of sub-module proxies.
+  /// The vertices are updated in place,
+  /// so all the functions referenced outside of the unique table
+  /// stay valid.
+  ///
+  /// @pre The computation tables are clear.
+  void ReorderVariables() noexcept;
+
+  /// Swaps the variables of two positions in the ordering.
+  /// The vertices of the other modules between the positions
+  /// must be independent of these variables.
+  ///
+  /// @param[in,out] upper  The position of the upper variable.
+  /// @param[in,out] lower  The position of the lower variable.
+  ///
+  /// @returns The change in the number of vertices.
+  int SwapLevels(Level* upper, Level* lower) noexcept;
+
   /// Computes minimum and maximum ids for keys in computation tables.
   ///
   /// @param[in] arg_one  First argument function graph.
@@ -910,6 +1025,22 @@ class Bdd : private boost::noncopyable {
                  const VertexPtr& arg_two, bool complement_one,
                  bool complement_two) noexcept;
 
+  /// Applies the K/N (ATLEAST) logic to the argument functions
+  /// without the expansion of the gate into AND/OR gates.
+  /// The threshold recursion
+  /// K/N(x, y_i) = OR(AND(x, K-1/N-1(y_i)), K/N-1(y_i))
+  /// is memoized on (remaining K, argument position)
+  /// with one row of K functions per position.
+  ///
+  /// @param[in] args  The argument functions in the order of application.
+  /// @param[in] min_number  The min number of true arguments.
+  ///
+  /// @returns The BDD function of the K/N logic.
+  ///
+  /// @pre 0 < min_number <= args.size()
+  Function ApplyAtleast(const std::vector<Function>& args,
+                        int min_number) noexcept;
+
   /// Calculates consensus of high and low of an if-then-else BDD vertex.
   ///
   /// @param[in] ite  The BDD vertex with the input.
@@ -982,6 +1113,12 @@ class Bdd : private boost::noncopyable {
 
   std::unordered_map<int, Function> modules_;  ///< Module graphs.
   std::unordered_map<int, int> index_to_order_;  ///< Indices and orders.
+  /// The modules of variables and module proxies for reordering.
+  std::unordered_map<int, int> index_to_module_;
+  int reorder_threshold_;  ///< The unique table size to trigger reordering.
+  int vertex_limit_;  ///< The unique table size to stop the construction.
+  bool complete_;  ///< Indication of the construction within the limit.
+  Reordering reordering_;  ///< The results of reordering.
   const TerminalPtr kOne_;  ///< Terminal True.
   int function_id_;  ///< Identification assignment for new function graphs.
   std::unique_ptr<Zbdd> zbdd_;  ///< ZBDD as a result of analysis.
@@ -0,0 +1,804 @@
+/*
+ * Copyright (C) 2014-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the binary columnar report writer, reader, and converter.
+
+#include "binary_report.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <unordered_map>
+
+#include <boost/exception/errinfo_errno.hpp>
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/exception/errinfo_file_open_mode.hpp>
+#include <boost/interprocess/exceptions.hpp>
+
+#include "ccf_group.h"
+#include "error.h"
+#include "logger.h"
+#include "version.h"
+#include "xml_stream.h"
+
+namespace scram::binary {
+
+namespace {  // The binary layout helpers.
+
+const char kSignature[8] = "SCRAMBR";  ///< The file type signature.
+const std::uint32_t kVersion = 1;  ///< The version of the file layout.
+const std::uint64_t kAlignment = 8;  ///< The alignment of column data.
+
+/// The fixed-size beginning of the report file.
+struct Header {
+  char signature[8];  ///< The file type signature.
+  std::uint32_t version;  ///< The version of the layout.
+  std::uint32_t num_results;  ///< The number of analysis results.
+  std::uint64_t directory;  ///< The offset of the column directory.
+  std::uint64_t num_columns;  ///< The number of directory entries.
+};
+
+/// The type tags of column elements.
+/// @{
+template <typename T>
+const Type kTypeOf = Type::kString;
+template <>
+const Type kTypeOf<std::int32_t> = Type::kInt32;
+template <>
+const Type kTypeOf<std::uint64_t> = Type::kUInt64;
+template <>
+const Type kTypeOf<double> = Type::kFloat64;
+/// @}
+
+/// @returns The size of the column element type.
+std::uint64_t SizeOf(Type type) {
+  switch (type) {
+    case Type::kInt32:
+      return sizeof(std::int32_t);
+    case Type::kUInt64:
+    case Type::kString:  // The string boundaries.
+      return sizeof(std::uint64_t);
+    case Type::kFloat64:
+      return sizeof(double);
+  }
+  return 0;
+}
+
+/// @param[in] offsets  The boundaries of sub-ranges in another column.
+/// @param[in] size  The number of elements in the other column.
+///
+/// @returns true if the offsets are non-decreasing boundaries
+///          that start at 0 and end at the size.
+bool IsBoundaries(const boost::iterator_range<const std::uint64_t*>& offsets,
+                  std::uint64_t size) {
+  return !offsets.empty() && offsets.front() == 0 && offsets.back() == size &&
+         std::is_sorted(offsets.begin(), offsets.end());
+}
+
+/// Sequential writer of columns into the report file.
+class FileWriter {
+ public:
+  /// @param[in] file  The destination file.
+  ///
+  /// @throws IOError  The file cannot be opened for writing.
+  explicit FileWriter(const std::string& file)
+      : fp_(std::fopen(file.c_str(), "wb"), &std::fclose) {
+    if (!fp_) {
+      SCRAM_THROW(IOError("Cannot open the output file for binary report."))
+          << boost::errinfo_errno(errno)
+          << boost::errinfo_file_open_mode("wb");
+    }
+    Header header = {};
+    Put(&header, sizeof(header));  // Placeholder until the directory is known.
+  }
+
+  /// Writes the column of trivial values.
+  template <typename T>
+  void Write(Column column, int result, const std::vector<T>& data) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    Align();
+    directory_.push_back({column, result, kTypeOf<T>, 0, pos_, data.size()});
+    Put(data.data(), data.size() * sizeof(T));
+  }
+
+  /// Writes the column of strings.
+  void Write(Column column, int result, const std::vector<std::string>& data) {
+    std::vector<std::uint64_t> offsets = {0};
+    for (const std::string& value : data)
+      offsets.push_back(offsets.back() + value.size());
+    Align();
+    directory_.push_back({column, result, Type::kString, 0, pos_, data.size()});
+    Put(offsets.data(), offsets.size() * sizeof(std::uint64_t));
+    for (const std::string& value : data)
+      Put(value.data(), value.size());
+  }
+
+  /// Writes the directory and the header.
+  ///
+  /// @param[in] num_results  The number of analysis results.
+  ///
+  /// @throws IOError  The write operations have failed.
+  void Finish(int num_results) {
+    Align();
+    Header header = {};
+    std::memcpy(header.signature, kSignature, sizeof(kSignature));
+    header.version = kVersion;
+    header.num_results = num_results;
+    header.directory = pos_;
+    header.num_columns = directory_.size();
+    Put(directory_.data(), directory_.size() * sizeof(ColumnEntry));
+    std::rewind(fp_.get());
+    Put(&header, sizeof(header));
+    if (std::fflush(fp_.get()) || std::ferror(fp_.get())) {
+      SCRAM_THROW(IOError("FILE error on write"))
+          << boost::errinfo_errno(errno);
+    }
+  }
+
+ private:
+  /// Writes raw bytes.
+  void Put(const void* data, std::size_t size) {
+    std::fwrite(data, 1, size, fp_.get());
+    pos_ += size;
+  }
+
+  /// Pads the file to the alignment of columns.
+  void Align() {
+    const char padding[kAlignment] = {};
+    Put(padding, (kAlignment - pos_ % kAlignment) % kAlignment);
+  }
+
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> fp_;  ///< The output.
+  std::uint64_t pos_ = 0;  ///< The current position in the file.
+  std::vector<ColumnEntry> directory_;  ///< The written columns.
+};
+
+/// The dictionary of basic events referenced by results.
+class Dictionary {
+ public:
+  /// @returns The index of the event in the dictionary.
+  int operator()(const mef::BasicEvent& event) {
+    auto [it, inserted] = indices_.try_emplace(&event, events_.size());
+    if (inserted)
+      events_.push_back(&event);
+    return it->second;
+  }
+
+  /// Writes the dictionary columns.
+  void Write(FileWriter* writer) const {
+    std::vector<std::string> names;
+    std::vector<std::int32_t> event_groups;
+    std::vector<std::uint64_t> member_offsets = {0};
+    std::vector<std::string> member_names;
+    std::unordered_map<const mef::CcfGroup*, int> groups;
+    std::vector<std::string> group_names;
+    std::vector<std::int32_t> group_sizes;
+    for (const mef::BasicEvent* event : events_) {
+      const auto* ccf_event = dynamic_cast<const mef::CcfEvent*>(event);
+      if (!ccf_event) {
+        names.push_back(event->id());
+        event_groups.push_back(-1);
+      } else {
+        const mef::CcfGroup& ccf_group = ccf_event->ccf_group();
+        names.push_back(event->name());
+        auto [it, inserted] = groups.try_emplace(&ccf_group, groups.size());
+        if (inserted) {
+          group_names.push_back(ccf_group.id());
+          group_sizes.push_back(ccf_group.members().size());
+        }
+        event_groups.push_back(it->second);
+        for (const mef::Gate* member : ccf_event->members())
+          member_names.push_back(member->name());
+      }
+      member_offsets.push_back(member_names.size());
+    }
+    writer->Write(Column::kEventNames, kGlobal, names);
+    writer->Write(Column::kEventCcfGroups, kGlobal, event_groups);
+    writer->Write(Column::kEventMemberOffsets, kGlobal, member_offsets);
+    writer->Write(Column::kMemberNames, kGlobal, member_names);
+    writer->Write(Column::kCcfGroupNames, kGlobal, group_names);
+    writer->Write(Column::kCcfGroupSizes, kGlobal, group_sizes);
+  }
+
+ private:
+  std::unordered_map<const mef::BasicEvent*, int> indices_;  ///< The lookup.
+  std::vector<const mef::BasicEvent*> events_;  ///< The events by index.
+};
+
+/// Writes the products of the fault tree analysis.
+void WriteProducts(int result, const core::FaultTreeAnalysis& fta,
+                   const core::ProbabilityAnalysis* prob_analysis,
+                   Dictionary* dictionary, FileWriter* writer) {
+  const core::ProductContainer& products = fta.products();
+  core::Pdag::IndexMap<double> p_vars;
+  if (prob_analysis)
+    p_vars = products.ExtractProbabilities();
+  std::vector<std::uint64_t> offsets = {0};
+  std::vector<std::int32_t> literals;
+  std::vector<double> probabilities;
+  for (const core::Product& product : products) {
+    for (const core::Literal& literal : product) {
+      std::int32_t index = (*dictionary)(literal.event) + 1;
+      literals.push_back(literal.complement ? -index : index);
+    }
+    offsets.push_back(literals.size());
+    if (prob_analysis)
+      probabilities.push_back(product.p(p_vars));
+  }
+  writer->Write(Column::kProductOffsets, result, offsets);
+  writer->Write(Column::kProductLiterals, result, literals);
+  if (!prob_analysis)
+    return;
+  writer->Write(Column::kProductProbabilities, result, probabilities);
+  double sum = std::accumulate(probabilities.begin(), probabilities.end(), 0.0);
+  if (sum == 0)
+    return;
+  for (double& p : probabilities)
+    p /= sum;
+  writer->Write(Column::kProductContributions, result, probabilities);
+}
+
+/// Writes the importance factors of events.
+void WriteImportance(int result, const core::ImportanceAnalysis& analysis,
+                     Dictionary* dictionary, FileWriter* writer) {
+  std::vector<std::int32_t> events;
+  std::vector<std::int32_t> occurrences;
+  std::vector<double> probabilities, mif, cif, dif, raw, rrw;
+  for (const core::ImportanceRecord& entry : analysis.importance()) {
+    events.push_back((*dictionary)(entry.event));
+    occurrences.push_back(entry.factors.occurrence);
+    probabilities.push_back(entry.event.p());
+    mif.push_back(entry.factors.mif);
+    cif.push_back(entry.factors.cif);
+    dif.push_back(entry.factors.dif);
+    raw.push_back(entry.factors.raw);
+    rrw.push_back(entry.factors.rrw);
+  }
+  writer->Write(Column::kImportanceEvents, result, events);
+  writer->Write(Column::kImportanceOccurrences, result, occurrences);
+  writer->Write(Column::kImportanceProbabilities, result, probabilities);
+  writer->Write(Column::kMif, result, mif);
+  writer->Write(Column::kCif, result, cif);
+  writer->Write(Column::kDif, result, dif);
+  writer->Write(Column::kRaw, result, raw);
+  writer->Write(Column::kRrw, result, rrw);
+}
+
+/// Writes the statistical measures of uncertainty analysis.
+void WriteUncertainty(int result, const core::UncertaintyAnalysis& analysis,
+                      FileWriter* writer) {
+  writer->Write(Column::kUncertaintyMeasures, result,
+                std::vector<double>{analysis.mean(), analysis.sigma(),
+                                    analysis.confidence_interval().first,
+                                    analysis.confidence_interval().second,
+                                    analysis.error_factor()});
+  writer->Write(Column::kQuantiles, result, analysis.quantiles());
+  std::vector<double> bounds;
+  std::vector<double> values;
+  for (const std::pair<double, double>& bin : analysis.distribution()) {
+    bounds.push_back(bin.first);
+    values.push_back(bin.second);
+  }
+  if (!values.empty())
+    values.pop_back();  // The last entry is only the upper bound.
+  writer->Write(Column::kHistogramBounds, result, bounds);
+  writer->Write(Column::kHistogramValues, result, values);
+}
+
+/// @returns The current UTC time in ISO 8601 extended form.
+std::string CurrentTime() {
+  std::time_t current_time = std::time(nullptr);
+  char iso_extended[20] = {};
+  std::strftime(iso_extended, sizeof(iso_extended), "%Y-%m-%dT%H:%M:%S",
+                std::gmtime(&current_time));
+  return iso_extended;
+}
+
+}  // namespace
+
+void Write(const core::RiskAnalysis& risk_an, const std::string& file) {
+  TIMER(DEBUG1, "Writing the binary report");
+  try {
+    FileWriter writer(file);
+    Dictionary dictionary;
+    std::vector<std::string> targets, initiating_events, alignments, phases,
+        warnings;
+    std::vector<double> probabilities;
+    for (int i = 0; i < risk_an.results().size(); ++i) {
+      const core::RiskAnalysis::Result& result = risk_an.results()[i];
+      struct {
+        void operator()(const mef::Gate* gate) {
+          targets.push_back(gate->id());
+          initiating_events.emplace_back();
+        }
+        void operator()(const std::pair<const mef::InitiatingEvent&,
+                                        const mef::Sequence&>& sequence) {
+          targets.push_back(sequence.second.name());
+          initiating_events.push_back(sequence.first.name());
+        }
+        std::vector<std::string>& targets;
+        std::vector<std::string>& initiating_events;
+      } extractor{targets, initiating_events};
+      std::visit(extractor, result.id.target);
+      alignments.push_back(
+          result.id.context ? result.id.context->alignment.name() : "");
+      phases.push_back(result.id.context ? result.id.context->phase.name()
+                                         : "");
+
+      std::string warning;
+      if (result.fault_tree_analysis)
+        warning = result.fault_tree_analysis->warnings();
+      probabilities.push_back(std::numeric_limits<double>::quiet_NaN());
+      if (result.probability_analysis) {
+        const std::string& p_warning = result.probability_analysis->warnings();
+        if (!p_warning.empty())
+          warning += (warning.empty() ? "" : "; ") + p_warning;
+        probabilities.back() = result.probability_analysis->p_total();
+      }
+      warnings.push_back(std::move(warning));
+
+      if (result.fault_tree_analysis)
+        WriteProducts(i, *result.fault_tree_analysis,
+                      result.probability_analysis.get(), &dictionary, &writer);
+      if (result.importance_analysis)
+        WriteImportance(i, *result.importance_analysis, &dictionary, &writer);
+      if (result.uncertainty_analysis)
+        WriteUncertainty(i, *result.uncertainty_analysis, &writer);
+    }
+    const mef::Model& model = risk_an.model();
+    writer.Write(Column::kModelName, kGlobal,
+                 std::vector<std::string>{
+                     model.HasDefaultName() ? "" : model.name()});
+    writer.Write(Column::kTime, kGlobal,
+                 std::vector<std::string>{CurrentTime()});
+    dictionary.Write(&writer);
+    writer.Write(Column::kTargets, kGlobal, targets);
+    writer.Write(Column::kInitiatingEvents, kGlobal, initiating_events);
+    writer.Write(Column::kAlignments, kGlobal, alignments);
+    writer.Write(Column::kPhases, kGlobal, phases);
+    writer.Write(Column::kWarnings, kGlobal, warnings);
+    writer.Write(Column::kProbabilities, kGlobal, probabilities);
+    writer.Finish(risk_an.results().size());
+  } catch (IOError& err) {
+    err << boost::errinfo_file_name(file);
+    throw;
+  }
+}
+
+Report::Report(const std::string& file) : file_(file) {
+  namespace bip = boost::interprocess;
+  auto corrupted = [&file] {
+    SCRAM_THROW(IOError("The binary report is corrupted."))
+        << boost::errinfo_file_name(file);
+  };
+  try {
+    mapping_ = bip::file_mapping(file.c_str(), bip::read_only);
+    region_ = bip::mapped_region(mapping_, bip::read_only);
+  } catch (const bip::interprocess_exception& err) {
+    SCRAM_THROW(IOError(err.what()))
+        << boost::errinfo_file_name(file) << boost::errinfo_file_open_mode("r");
+  }
+  const char* data = static_cast<const char*>(region_.get_address());
+  std::uint64_t size = region_.get_size();
+  Header header;
+  if (size < sizeof(header))
+    corrupted();
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.signature, kSignature, sizeof(kSignature)) ||
+      header.version != kVersion) {
+    SCRAM_THROW(IOError("The file is not a binary report of this version."))
+        << boost::errinfo_file_name(file);
+  }
+  if (header.directory > size || header.directory % kAlignment ||
+      header.num_columns > (size - header.directory) / sizeof(ColumnEntry)) {
+    corrupted();
+  }
+  num_results_ = header.num_results;
+  const auto* entries =
+      reinterpret_cast<const ColumnEntry*>(data + header.directory);
+  directory_.assign(entries, entries + header.num_columns);
+  for (const ColumnEntry& entry : directory_) {
+    std::uint64_t element_size = SizeOf(entry.type);
+    if (!element_size || entry.offset % kAlignment ||
+        (entry.result != kGlobal &&
+         (entry.result < 0 || entry.result >= num_results_)) ||
+        entry.offset > header.directory) {
+      corrupted();
+    }
+    std::uint64_t remaining = (header.directory - entry.offset) / element_size;
+    // String columns have one more offset than strings.
+    if (entry.type == Type::kString ? entry.size >= remaining
+                                    : entry.size > remaining) {
+      corrupted();
+    }
+    std::uint64_t num_elements = entry.size + (entry.type == Type::kString);
+    if (entry.type == Type::kString) {
+      const auto* offsets =
+          reinterpret_cast<const std::uint64_t*>(data + entry.offset);
+      std::uint64_t capacity = header.directory - entry.offset -
+                               num_elements * element_size;
+      if (offsets[0] || !std::is_sorted(offsets, offsets + num_elements) ||
+          offsets[entry.size] > capacity) {
+        corrupted();
+      }
+    }
+  }
+  auto key = [](const ColumnEntry& entry) {
+    return std::make_pair(entry.result, entry.column);
+  };
+  std::sort(directory_.begin(), directory_.end(),
+            [&key](const ColumnEntry& lhs, const ColumnEntry& rhs) {
+              return key(lhs) < key(rhs);
+            });
+  Validate();
+}
+
+void Report::Validate() const {
+  auto require = [this](bool condition) {
+    if (!condition) {
+      SCRAM_THROW(IOError("The binary report columns are inconsistent."))
+          << boost::errinfo_file_name(file_);
+    }
+  };
+  require(strings(Column::kModelName).size() == 1 &&
+          strings(Column::kTime).size() == 1);
+
+  int num_events = strings(Column::kEventNames).size();
+  int num_groups = strings(Column::kCcfGroupNames).size();
+  auto groups = column<std::int32_t>(Column::kEventCcfGroups);
+  auto member_offsets = column<std::uint64_t>(Column::kEventMemberOffsets);
+  require(groups.size() == num_events &&
+          member_offsets.size() == num_events + 1 &&
+          IsBoundaries(member_offsets, strings(Column::kMemberNames).size()) &&
+          column<std::int32_t>(Column::kCcfGroupSizes).size() == num_groups);
+  for (std::int32_t group : groups)
+    require(group >= -1 && group < num_groups);
+
+  for (Column result_column :
+       {Column::kTargets, Column::kInitiatingEvents, Column::kAlignments,
+        Column::kPhases, Column::kWarnings}) {
+    require(strings(result_column).size() == num_results_);
+  }
+  require(column<double>(Column::kProbabilities).size() == num_results_);
+
+  for (int i = 0; i < num_results_; ++i) {
+    if (has(Column::kProductOffsets, i)) {
+      auto offsets = column<std::uint64_t>(Column::kProductOffsets, i);
+      auto literals = column<std::int32_t>(Column::kProductLiterals, i);
+      require(IsBoundaries(offsets, literals.size()));
+      for (std::int32_t literal : literals)
+        require(literal && literal >= -num_events && literal <= num_events);
+      for (Column product_column :
+           {Column::kProductProbabilities, Column::kProductContributions}) {
+        auto values = column<double>(product_column, i);
+        require(values.empty() || values.size() == offsets.size() - 1);
+      }
+    }
+    if (has(Column::kImportanceEvents, i)) {
+      auto events = column<std::int32_t>(Column::kImportanceEvents, i);
+      for (std::int32_t event : events)
+        require(event >= 0 && event < num_events);
+      require(column<std::int32_t>(Column::kImportanceOccurrences, i).size() ==
+              events.size());
+      for (Column factor_column :
+           {Column::kImportanceProbabilities, Column::kMif, Column::kCif,
+            Column::kDif, Column::kRaw, Column::kRrw}) {
+        require(column<double>(factor_column, i).size() == events.size());
+      }
+    }
+    if (has(Column::kUncertaintyMeasures, i)) {
+      auto bounds = column<double>(Column::kHistogramBounds, i);
+      auto values = column<double>(Column::kHistogramValues, i);
+      require(column<double>(Column::kUncertaintyMeasures, i).size() == 5 &&
+              (values.empty() || bounds.size() == values.size() + 1));
+    }
+  }
+}
+
+const ColumnEntry* Report::Find(Column column, int result) const {
+  auto it = std::lower_bound(
+      directory_.begin(), directory_.end(), std::make_pair(result, column),
+      [](const ColumnEntry& entry, const std::pair<int, Column>& key) {
+        return std::make_pair(entry.result, entry.column) < key;
+      });
+  if (it == directory_.end() || it->result != result || it->column != column)
+    return nullptr;
+  return &*it;
+}
+
+const char* Report::Data(const ColumnEntry& entry, Type type) const {
+  if (entry.type != type) {
+    SCRAM_THROW(IOError("The binary report column has an unexpected type."))
+        << boost::errinfo_file_name(file_);
+  }
+  return static_cast<const char*>(region_.get_address()) + entry.offset;
+}
+
+template <typename T>
+boost::iterator_range<const T*> Report::column(Column column,
+                                               int result) const {
+  const ColumnEntry* entry = Find(column, result);
+  if (!entry)
+    return {};
+  const T* data = reinterpret_cast<const T*>(Data(*entry, kTypeOf<T>));
+  return {data, data + entry->size};
+}
+
+template boost::iterator_range<const std::int32_t*>
+Report::column<std::int32_t>(Column, int) const;
+template boost::iterator_range<const std::uint64_t*>
+Report::column<std::uint64_t>(Column, int) const;
+template boost::iterator_range<const double*> Report::column<double>(
+    Column, int) const;
+
+Report::Strings Report::strings(Column column, int result) const {
+  const ColumnEntry* entry = Find(column, result);
+  if (!entry)
+    return Strings(nullptr, nullptr, 0);
+  const auto* offsets =
+      reinterpret_cast<const std::uint64_t*>(Data(*entry, Type::kString));
+  return Strings(offsets,
+                 reinterpret_cast<const char*>(offsets + entry->size + 1),
+                 entry->size);
+}
+
+namespace {  // The XML conversion helpers.
+
+/// Puts the analysis id of the result into the XML element.
+void PutId(const Report& report, int result, xml::StreamElement* element) {
+  std::string_view initiating_event =
+      report.strings(Column::kInitiatingEvents)[result];
+  if (!initiating_event.empty())
+    element->SetAttribute("initiating-event", initiating_event);
+  element->SetAttribute("name", report.strings(Column::kTargets)[result]);
+  std::string_view alignment = report.strings(Column::kAlignments)[result];
+  if (!alignment.empty()) {
+    element->SetAttribute("alignment", alignment)
+        .SetAttribute("phase", report.strings(Column::kPhases)[result]);
+  }
+}
+
+/// Puts the dictionary event into the XML element.
+///
+/// @param[in] report  The binary report.
+/// @param[in] index  The index of the event in the dictionary.
+/// @param[in,out] parent  The parent element of the event.
+/// @param[in] add_data  The callback to put extra data into the event element.
+template <class T>
+void PutEvent(const Report& report, int index, xml::StreamElement* parent,
+              const T& add_data) {
+  std::int32_t group = report.column<std::int32_t>(
+      Column::kEventCcfGroups)[index];
+  if (group < 0) {
+    xml::StreamElement element = parent->AddChild("basic-event");
+    element.SetAttribute("name", report.strings(Column::kEventNames)[index]);
+    add_data(&element);
+    return;
+  }
+  auto offsets = report.column<std::uint64_t>(Column::kEventMemberOffsets);
+  xml::StreamElement element = parent->AddChild("ccf-event");
+  element
+      .SetAttribute("ccf-group", report.strings(Column::kCcfGroupNames)[group])
+      .SetAttribute("order",
+                    static_cast<int>(offsets[index + 1] - offsets[index]))
+      .SetAttribute("group-size",
+                    report.column<std::int32_t>(
+                        Column::kCcfGroupSizes)[group]);
+  add_data(&element);
+  Report::Strings members = report.strings(Column::kMemberNames);
+  for (std::uint64_t i = offsets[index]; i < offsets[index + 1]; ++i)
+    element.AddChild("basic-event").SetAttribute("name", members[i]);
+}
+
+/// Converts the products of the result.
+void ConvertProducts(const Report& report, int result,
+                     xml::StreamElement* results) {
+  auto offsets = report.column<std::uint64_t>(Column::kProductOffsets, result);
+  auto literals = report.column<std::int32_t>(Column::kProductLiterals, result);
+  auto probabilities =
+      report.column<double>(Column::kProductProbabilities, result);
+  auto contributions =
+      report.column<double>(Column::kProductContributions, result);
+  int num_products = offsets.size() - 1;
+  std::vector<bool> product_events(report.num_events());
+  std::vector<int> distribution;
+  for (int i = 0; i < num_products; ++i) {
+    int order = std::max<int>(offsets[i + 1] - offsets[i], 1);
+    if (distribution.size() < order)
+      distribution.resize(order);
+    ++distribution[order - 1];
+  }
+  for (std::int32_t literal : literals)
+    product_events[std::abs(literal) - 1] = true;
+
+  xml::StreamElement sum_of_products = results->AddChild("sum-of-products");
+  PutId(report, result, &sum_of_products);
+  std::string_view warning = report.strings(Column::kWarnings)[result];
+  if (!warning.empty())
+    sum_of_products.SetAttribute("warning", warning);
+  sum_of_products
+      .SetAttribute("basic-events", static_cast<int>(std::count(
+                                        product_events.begin(),
+                                        product_events.end(), true)))
+      .SetAttribute("products", num_products);
+  double p_total = report.column<double>(Column::kProbabilities)[result];
+  if (!std::isnan(p_total))
+    sum_of_products.SetAttribute("probability", p_total);
+  if (!distribution.empty()) {
+    std::string value;
+    for (int count : distribution)
+      value += (value.empty() ? "" : " ") + std::to_string(count);
+    sum_of_products.SetAttribute("distribution", value);
+  }
+
+  auto add_data = [](xml::StreamElement* /*element*/) {};
+  for (int i = 0; i < num_products; ++i) {
+    xml::StreamElement product = sum_of_products.AddChild("product");
+    product.SetAttribute(
+        "order", std::max<int>(offsets[i + 1] - offsets[i], 1));
+    if (!probabilities.empty())
+      product.SetAttribute("probability", probabilities[i]);
+    if (!contributions.empty())
+      product.SetAttribute("contribution", contributions[i]);
+    for (std::uint64_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+      if (literals[j] < 0) {
+        xml::StreamElement not_parent = product.AddChild("not");
+        PutEvent(report, -literals[j] - 1, &not_parent, add_data);
+      } else {
+        PutEvent(report, literals[j] - 1, &product, add_data);
+      }
+    }
+  }
+}
+
+/// Converts the importance factors of the result.
+void ConvertImportance(const Report& report, int result,
+                       xml::StreamElement* results) {
+  auto events = report.column<std::int32_t>(Column::kImportanceEvents, result);
+  auto occurrences =
+      report.column<std::int32_t>(Column::kImportanceOccurrences, result);
+  auto probabilities =
+      report.column<double>(Column::kImportanceProbabilities, result);
+  auto mif = report.column<double>(Column::kMif, result);
+  auto cif = report.column<double>(Column::kCif, result);
+  auto dif = report.column<double>(Column::kDif, result);
+  auto raw = report.column<double>(Column::kRaw, result);
+  auto rrw = report.column<double>(Column::kRrw, result);
+
+  xml::StreamElement importance = results->AddChild("importance");
+  PutId(report, result, &importance);
+  importance.SetAttribute("basic-events", static_cast<int>(events.size()));
+  for (int i = 0; i < events.size(); ++i) {
+    PutEvent(report, events[i], &importance,
+             [&](xml::StreamElement* element) {
+               element->SetAttribute("occurrence", occurrences[i])
+                   .SetAttribute("probability", probabilities[i])
+                   .SetAttribute("MIF", mif[i])
+                   .SetAttribute("CIF", cif[i])
+                   .SetAttribute("DIF", dif[i])
+                   .SetAttribute("RAW", raw[i])
+                   .SetAttribute("RRW", rrw[i]);
+             });
+  }
+}
+
+/// Converts the statistical measures of the result.
+void ConvertUncertainty(const Report& report, int result,
+                        xml::StreamElement* results) {
+  auto measures = report.column<double>(Column::kUncertaintyMeasures, result);
+  auto quantiles = report.column<double>(Column::kQuantiles, result);
+  auto bounds = report.column<double>(Column::kHistogramBounds, result);
+  auto values = report.column<double>(Column::kHistogramValues, result);
+
+  xml::StreamElement measure = results->AddChild("measure");
+  PutId(report, result, &measure);
+  measure.AddChild("mean").SetAttribute("value", measures[0]);
+  measure.AddChild("standard-deviation").SetAttribute("value", measures[1]);
+  measure.AddChild("confidence-range")
+      .SetAttribute("percentage", "95")
+      .SetAttribute("lower-bound", measures[2])
+      .SetAttribute("upper-bound", measures[3]);
+  measure.AddChild("error-factor")
+      .SetAttribute("percentage", "95")
+      .SetAttribute("value", measures[4]);
+  {
+    xml::StreamElement quantile_list = measure.AddChild("quantiles");
+    int num_quantiles = quantiles.size();
+    quantile_list.SetAttribute("number", num_quantiles);
+    double prev_bound = 0;
+    double delta = 1.0 / num_quantiles;
+    for (int i = 0; i < num_quantiles; ++i) {
+      quantile_list.AddChild("quantile")
+          .SetAttribute("number", i + 1)
+          .SetAttribute("value", delta * (i + 1))
+          .SetAttribute("lower-bound", prev_bound)
+          .SetAttribute("upper-bound", quantiles[i]);
+      prev_bound = quantiles[i];
+    }
+  }
+  {
+    xml::StreamElement hist = measure.AddChild("histogram");
+    int num_bins = values.size();
+    hist.SetAttribute("number", num_bins);
+    for (int i = 0; i < num_bins; ++i) {
+      hist.AddChild("bin")
+          .SetAttribute("number", i + 1)
+          .SetAttribute("value", values[i])
+          .SetAttribute("lower-bound", bounds[i])
+          .SetAttribute("upper-bound", bounds[i + 1]);
+    }
+  }
+}
+
+}  // namespace
+
+void ConvertToXml(const Report& report, std::FILE* out, bool indent) {
+  TIMER(DEBUG1, "Converting the binary report into XML");
+  xml::Stream xml_stream(out, indent, /*async=*/true);
+  xml::StreamElement root = xml_stream.root("report");
+  {
+    xml::StreamElement information = root.AddChild("information");
+    information.AddChild("software")
+        .SetAttribute("name", "SCRAM")
+        .SetAttribute("version", *SCRAM_GIT_REVISION != '\0'
+                                     ? SCRAM_GIT_REVISION
+                                     : SCRAM_VERSION)
+        .SetAttribute("contacts", "https://scram-pra.org");
+    information.AddChild("time").AddText(report.strings(Column::kTime)[0]);
+    xml::StreamElement model_features = information.AddChild("model-features");
+    std::string_view model_name = report.strings(Column::kModelName)[0];
+    if (!model_name.empty())
+      model_features.SetAttribute("name", model_name);
+  }
+  if (!report.num_results())
+    return;
+  xml::StreamElement results = root.AddChild("results");
+  for (int i = 0; i < report.num_results(); ++i) {
+    if (report.has(Column::kProductOffsets, i))
+      ConvertProducts(report, i, &results);
+    if (report.has(Column::kImportanceEvents, i))
+      ConvertImportance(report, i, &results);
+    if (report.has(Column::kUncertaintyMeasures, i))
+      ConvertUncertainty(report, i, &results);
+  }
+}
+
+void ConvertToXml(const Report& report, const std::string& file,
+                  bool indent) {
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> fp(
+      std::fopen(file.c_str(), "w"), &std::fclose);
+  try {
+    if (!fp) {
+      SCRAM_THROW(IOError("Cannot open the output file for report."))
+          << boost::errinfo_errno(errno) << boost::errinfo_file_open_mode("w");
+    }
+    ConvertToXml(report, fp.get(), indent);
+  } catch (IOError& err) {
+    err << boost::errinfo_file_name(file);
+    throw;
+  }
+}
+
+}  // namespace scram::binary
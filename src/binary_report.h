@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2014-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Binary columnar format of analysis results
+/// for post-processing tools that ingest large result sets.
+///
+/// The file is designed to be memory-mapped.
+/// It consists of the header, the column data, and the column directory:
+///
+///     Header     char[8] signature "SCRAMBR", u32 version,
+///                u32 the number of results,
+///                u64 the offset of the directory, u64 the number of columns.
+///     Data       Column arrays aligned at 8 bytes.
+///     Directory  Column entries (binary::ColumnEntry).
+///
+/// Numbers are stored in the host byte order.
+/// String columns are u64 offsets of N + 1 string boundaries
+/// followed by the UTF-8 bytes of all the strings.
+///
+/// @note The format caters the products, probabilities,
+///       importance factors, and uncertainty measures.
+///       Other analysis results are reported only in XML.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/range/iterator_range.hpp>
+
+#include "risk_analysis.h"
+
+namespace scram::binary {
+
+/// The column identifier in the binary report.
+/// The global columns are indexed by events or results,
+/// and the result columns belong to a single analysis result.
+enum class Column : std::uint32_t {
+  // Global columns.
+  kModelName = 0,  ///< (string, 1) The name of the model.
+  kTime,  ///< (string, 1) The UTC time of the report in ISO 8601.
+  kEventNames,  ///< (string, E) The dictionary of basic events.
+  kEventCcfGroups,  ///< (i32, E) The index of the CCF group or -1.
+  kEventMemberOffsets,  ///< (u64, E + 1) The CCF event members in kMemberNames.
+  kMemberNames,  ///< (string) The names of the CCF event members.
+  kCcfGroupNames,  ///< (string, G) The names of CCF groups.
+  kCcfGroupSizes,  ///< (i32, G) The number of members in CCF groups.
+  kTargets,  ///< (string, R) The gate or sequence names of results.
+  kInitiatingEvents,  ///< (string, R) The initiating events of sequences.
+  kAlignments,  ///< (string, R) The alignment names of results.
+  kPhases,  ///< (string, R) The phase names of results.
+  kWarnings,  ///< (string, R) The warnings of the analyses.
+  kProbabilities,  ///< (f64, R) The total probabilities or NaN.
+  // Result columns.
+  kProductOffsets,  ///< (u64, P + 1) The boundaries of products.
+  kProductLiterals,  ///< (i32) Event index + 1, negative for complements.
+  kProductProbabilities,  ///< (f64, P) The probabilities of products.
+  kProductContributions,  ///< (f64, P) The contributions of products.
+  kImportanceEvents,  ///< (i32, I) The indices of events.
+  kImportanceOccurrences,  ///< (i32, I) The number of products with events.
+  kImportanceProbabilities,  ///< (f64, I) The probabilities of events.
+  kMif,  ///< (f64, I) Birnbaum marginal importance factors.
+  kCif,  ///< (f64, I) Critical importance factors.
+  kDif,  ///< (f64, I) Fussel-Vesely diagnosis importance factors.
+  kRaw,  ///< (f64, I) Risk achievement worth factors.
+  kRrw,  ///< (f64, I) Risk reduction worth factors.
+  kUncertaintyMeasures,  ///< (f64, 5) Mean, sigma, 95% range, error factor.
+  kQuantiles,  ///< (f64, Q) The upper bounds of quantiles.
+  kHistogramBounds,  ///< (f64, B + 1) The boundaries of histogram bins.
+  kHistogramValues  ///< (f64, B) The values of histogram bins.
+};
+
+/// The type of column elements.
+enum class Type : std::uint32_t { kInt32 = 0, kUInt64, kFloat64, kString };
+
+const std::int32_t kGlobal = -1;  ///< The result index of global columns.
+
+/// The directory entry of a column.
+struct ColumnEntry {
+  Column column;  ///< The column identifier.
+  std::int32_t result;  ///< The result index or kGlobal.
+  Type type;  ///< The element type.
+  std::uint32_t reserved;  ///< Padding for the alignment.
+  std::uint64_t offset;  ///< The position of the data in the file.
+  std::uint64_t size;  ///< The number of elements (strings for kString).
+};
+
+/// Writes the binary report of the analysis results into a file.
+/// This function overwrites the file.
+///
+/// @param[in] risk_an  Risk analysis with results.
+/// @param[in] file  The output destination.
+///
+/// @throws IOError  The output file is not accessible,
+///                  or the write operation has failed.
+void Write(const core::RiskAnalysis& risk_an, const std::string& file);
+
+/// Read-only view of the memory-mapped binary report.
+class Report {
+ public:
+  /// Non-owning view of a column with strings.
+  class Strings {
+   public:
+    /// @param[in] offsets  The N + 1 boundaries of the strings.
+    /// @param[in] data  The bytes of the strings.
+    Strings(const std::uint64_t* offsets, const char* data, int size)
+        : offsets_(offsets), data_(data), size_(size) {}
+
+    /// @returns The number of strings in the column.
+    int size() const { return size_; }
+
+    /// @returns The string at the index.
+    std::string_view operator[](int index) const {
+      return {data_ + offsets_[index], offsets_[index + 1] - offsets_[index]};
+    }
+
+   private:
+    const std::uint64_t* offsets_;  ///< The boundaries of the strings.
+    const char* data_;  ///< The bytes of all the strings.
+    int size_;  ///< The number of strings.
+  };
+
+  /// Maps the report file into memory.
+  ///
+  /// @param[in] file  The binary report file.
+  ///
+  /// @throws IOError  The file is not accessible or not a valid report.
+  explicit Report(const std::string& file);
+
+  /// @returns The number of analysis results in the report.
+  int num_results() const { return num_results_; }
+
+  /// @returns The number of events in the dictionary.
+  int num_events() const { return strings(Column::kEventNames).size(); }
+
+  /// @param[in] column  The column identifier.
+  /// @param[in] result  The index of the result or kGlobal.
+  ///
+  /// @returns true if the report contains the column.
+  bool has(Column column, int result = kGlobal) const {
+    return Find(column, result);
+  }
+
+  /// @tparam T  The element type (std::int32_t, std::uint64_t, double).
+  ///
+  /// @param[in] column  The column identifier.
+  /// @param[in] result  The index of the result or kGlobal.
+  ///
+  /// @returns The elements of the column.
+  ///          An empty range if the column is not in the report.
+  ///
+  /// @throws IOError  The column has a different type.
+  template <typename T>
+  boost::iterator_range<const T*> column(Column column,
+                                         int result = kGlobal) const;
+
+  /// @param[in] column  The column identifier.
+  /// @param[in] result  The index of the result or kGlobal.
+  ///
+  /// @returns The string column.
+  ///          An empty column if the column is not in the report.
+  ///
+  /// @throws IOError  The column is not a string column.
+  Strings strings(Column column, int result = kGlobal) const;
+
+ private:
+  /// Checks the consistency of column sizes, offsets, and indices
+  /// so that the accessors and the XML conversion stay within the columns.
+  ///
+  /// @throws IOError  The columns are inconsistent.
+  void Validate() const;
+
+  /// @returns The directory entry of the column or nullptr.
+  const ColumnEntry* Find(Column column, int result) const;
+
+  /// @returns The pointer to the column data with the expected type.
+  ///
+  /// @throws IOError  The column has a different type.
+  const char* Data(const ColumnEntry& entry, Type type) const;
+
+  std::string file_;  ///< The report file path for error messages.
+  boost::interprocess::file_mapping mapping_;  ///< The open file.
+  boost::interprocess::mapped_region region_;  ///< The mapped file data.
+  int num_results_ = 0;  ///< The number of analysis results.
+  /// The column directory sorted by the result and column.
+  std::vector<ColumnEntry> directory_;
+};
+
+/// Explicit instantiations of column accessors for the element types.
+/// @{
+extern template boost::iterator_range<const std::int32_t*>
+Report::column<std::int32_t>(Column, int) const;
+extern template boost::iterator_range<const std::uint64_t*>
+Report::column<std::uint64_t>(Column, int) const;
+extern template boost::iterator_range<const double*>
+Report::column<double>(Column, int) const;
+/// @}
+
+/// Converts the binary report into the XML report
+/// with the results available in the binary format.
+///
+/// @param[in] report  The binary report.
+/// @param[out] out  The destination stream for the XML report.
+/// @param[in] indent  The flag to indent output for readability.
+///
+/// @throws IOError  The write operation has failed.
+void ConvertToXml(const Report& report, std::FILE* out, bool indent = true);
+
+/// A convenience function to convert the binary report into an XML file.
+/// This function overwrites the file.
+///
+/// @param[in] report  The binary report.
+/// @param[out] file  The output destination.
+/// @param[in] indent  The flag to indent output for readability.
+///
+/// @throws IOError  The output file is not accessible,
+///                  or the write operation has failed.
+void ConvertToXml(const Report& report, const std::string& file,
+                  bool indent = true);
+
+}  // namespace scram::binary
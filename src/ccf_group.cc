@@ -22,6 +22,8 @@
 
 #include <cmath>
 
+#include <algorithm>
+#include <string>
 #include <utility>
 
 #include <boost/algorithm/string/join.hpp>
@@ -39,7 +41,15 @@ namespace scram::mef {
 CcfEvent::CcfEvent(std::vector<Gate*> members, const CcfGroup* ccf_group)
     : BasicEvent(MakeName(members), ccf_group->base_path(), ccf_group->role()),
       ccf_group_(*ccf_group),
-      members_(std::move(members)) {}
+      members_(std::move(members)),
+      level_(members_.size()) {}
+
+CcfEvent::CcfEvent(Gate* member, int level, const CcfGroup* ccf_group)
+    : BasicEvent(MakeName({member}) + "{" + std::to_string(level) + "}",
+                 ccf_group->base_path(), ccf_group->role()),
+      ccf_group_(*ccf_group),
+      members_({member}),
+      level_(level) {}
 
 std::string CcfEvent::MakeName(const std::vector<Gate*>& members) {
   return "[" +
@@ -138,20 +148,60 @@ void CcfGroup::Validate() const {
 
 void CcfGroup::ApplyModel() {
   // Construct replacement proxy gates for member basic events.
-  std::vector<std::pair<Gate*, Formula::ArgSet>> proxy_gates;
   for (BasicEvent* member : members_) {
     auto new_gate = std::make_unique<Gate>(member->name(), member->base_path(),
                                            member->role());
     assert(member->id() == new_gate->id());
-    proxy_gates.push_back({new_gate.get(), {}});
+    member_gates_.push_back(new_gate.get());
     member->ccf_gate(std::move(new_gate));
   }
+}
+
+namespace {
+
+/// Helper function to calculate reciprocal of
+/// nCk (n-choose-k) combination.
+///
+/// @param[in] n  The total number elements.
+/// @param[in] k  Subset size.
+///
+/// @returns 1 / nCk
+double CalculateCombinationReciprocal(int n, int k) {
+  assert(n >= 0);
+  assert(k >= 0);
+  assert(n >= k);
+  if (n - k > k)
+    k = n - k;
+  double result = 1;
+  for (int i = 1; i <= n - k; ++i) {
+    result *= static_cast<double>(i) / static_cast<double>(k + i);
+  }
+  return result;
+}
+
+}  // namespace
+
+void CcfGroup::GenerateEvents(int max_combinations) {
+  if (generated_)
+    return;
+  generated_ = true;
+  assert(member_gates_.size() == members_.size() && "The model not applied.");
+  std::vector<std::pair<Gate*, Formula::ArgSet>> proxy_gates;
+  for (Gate* gate : member_gates_)
+    proxy_gates.push_back({gate, {}});
 
   ExpressionMap probabilities = this->CalculateProbabilities();
   assert(probabilities.size() > 1);
 
   // Generate CCF events.
+  int num_members = member_gates_.size();
+  int limit = std::max(max_combinations, num_members);
   for (auto& [level, prob] : probabilities) {
+    if (std::round(1 / CalculateCombinationReciprocal(num_members, level)) >
+        limit) {
+      FactorLevel(level, prob, &proxy_gates);
+      continue;
+    }
     using Iterator = decltype(proxy_gates)::iterator;
     auto combination_visitor = [this, prob](Iterator it_begin,
                                             Iterator it_end) {
@@ -181,6 +231,35 @@ void CcfGroup::ApplyModel() {
   }
 }
 
+void CcfGroup::FactorLevel(
+    int level, Expression* prob,
+    std::vector<std::pair<Gate*, Formula::ArgSet>>* proxy_gates) {
+  assert(level > 1 && level < proxy_gates->size());
+  std::string suffix = "{" + std::to_string(level) + "}";
+  // Any 'level' shares fail their members with the combination probability.
+  Expression* share_prob = Register<Pow>(
+      prob, Register<ConstantExpression>(1 / static_cast<double>(level)));
+  auto level_gate = std::make_unique<Gate>(Element::name() + suffix,
+                                           Id::base_path(), Id::role());
+  Formula::ArgSet shares;
+  for (auto& [member, args] : *proxy_gates) {
+    auto share = std::make_unique<CcfEvent>(member, level, this);
+    share->expression(share_prob);
+    shares.Add(share.get());
+    // The member fails only with its own share.
+    auto member_gate = std::make_unique<Gate>(member->name() + suffix,
+                                              Id::base_path(), Id::role());
+    member_gate->formula(std::make_unique<Formula>(
+        kAnd, Formula::ArgSet{share.get(), level_gate.get()}));
+    args.Add(member_gate.get());
+    ccf_events_.emplace_back(std::move(share));
+    level_gates_.emplace_back(std::move(member_gate));
+  }
+  level_gate->formula(
+      std::make_unique<Formula>(kAtleast, std::move(shares), level));
+  level_gates_.emplace_back(std::move(level_gate));
+}
+
 CcfGroup::ExpressionMap BetaFactorModel::CalculateProbabilities() {
   assert(CcfGroup::factors().size() == 1);
   assert(CcfGroup::members().size() == CcfGroup::factors().front().first);
@@ -199,30 +278,6 @@ CcfGroup::ExpressionMap BetaFactorModel::CalculateProbabilities() {
   return probabilities;
 }
 
-namespace {
-
-/// Helper function to calculate reciprocal of
-/// nCk (n-choose-k) combination.
-///
-/// @param[in] n  The total number elements.
-/// @param[in] k  Subset size.
-///
-/// @returns 1 / nCk
-double CalculateCombinationReciprocal(int n, int k) {
-  assert(n >= 0);
-  assert(k >= 0);
-  assert(n >= k);
-  if (n - k > k)
-    k = n - k;
-  double result = 1;
-  for (int i = 1; i <= n - k; ++i) {
-    result *= static_cast<double>(i) / static_cast<double>(k + i);
-  }
-  return result;
-}
-
-}  // namespace
-
 CcfGroup::ExpressionMap MglModel::CalculateProbabilities() {
   ExpressionMap probabilities;
   int max_level = CcfGroup::factors().back().first;
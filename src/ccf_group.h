@@ -56,6 +56,17 @@ class CcfEvent : public BasicEvent {
   /// @param[in] ccf_group  The CCF group that created this event.
   CcfEvent(std::vector<Gate*> members, const CcfGroup* ccf_group);
 
+  /// Constructs a share of a member in the CCF level
+  /// that is factored into a K/N structure
+  /// instead of member combinations.
+  /// The member fails at the level
+  /// if the shares of at least 'level' members fail.
+  ///
+  /// @param[in] member  The member gate of the share.
+  /// @param[in] level  The CCF level of the share.
+  /// @param[in] ccf_group  The CCF group that created this event.
+  CcfEvent(Gate* member, int level, const CcfGroup* ccf_group);
+
   /// @returns The CCF group that created this CCF event.
   const CcfGroup& ccf_group() const { return ccf_group_; }
 
@@ -63,6 +74,10 @@ class CcfEvent : public BasicEvent {
   ///          The members also own this CCF event through parentship.
   const std::vector<Gate*>& members() const { return members_; }
 
+  /// @returns The CCF level of this event,
+  ///          i.e., the number of members failed by the common cause.
+  int level() const { return level_; }
+
  private:
   /// Creates a mangled name
   /// that is specific to CCF events and unique per model.
@@ -74,6 +89,7 @@ class CcfEvent : public BasicEvent {
 
   const CcfGroup& ccf_group_;  ///< The originating CCF group.
   std::vector<Gate*> members_;  ///< Member parent gates of this CCF event.
+  int level_;  ///< The number of members failed by the common cause.
 };
 
 /// Abstract base class for all common cause failure models.
@@ -86,9 +102,18 @@ class CcfGroup : public Id {
 
   virtual ~CcfGroup() = default;
 
+  /// Mapping expressions and their application levels.
+  using ExpressionMap = std::vector<std::pair<int, Expression*>>;
+
   /// @returns Members of the CCF group with original names as keys.
   const std::vector<BasicEvent*>& members() const { return members_; }
 
+  /// @returns The probability distribution of the events.
+  Expression* distribution() const { return distribution_; }
+
+  /// @returns CCF factors of the model.
+  const ExpressionMap& factors() const { return factors_; }
+
   /// Adds a basic event into this CCF group.
   /// This function asserts that each basic event has unique string id.
   ///
@@ -141,20 +166,39 @@ class CcfGroup : public Id {
   /// Processes the given factors and members
   /// to create common cause failure probabilities and new events
   /// that can replace the members in a fault tree.
+  /// Only the member gates are created upfront;
+  /// the probabilities and CCF events are generated
+  /// by GenerateEvents() for common cause analysis.
   ///
   /// @pre The CCF is validated.
   void ApplyModel();
 
- protected:
-  /// Mapping expressions and their application levels.
-  using ExpressionMap = std::vector<std::pair<int, Expression*>>;
-
-  /// @returns The probability distribution of the events.
-  Expression* distribution() const { return distribution_; }
+  /// Generates the CCF events and the formulas of the member gates.
+  /// The levels with few member combinations get a CCF event per combination.
+  /// The levels with more combinations than the limit and the members
+  /// are factored into a K/N gate over a share event per member
+  /// with the probability of the level combination raised to 1/level.
+  /// The products of the level shares reproduce
+  /// the combination probabilities of the level,
+  /// but the products with more shares than the level are approximate,
+  /// and the exact probability of the level is lower
+  /// by about (1 - share)^(members - level).
+  ///
+  /// The events are generated only once;
+  /// the repeated calls have no effect.
+  ///
+  /// @param[in] max_combinations  The maximum number of combination events
+  ///                              to generate per level.
+  ///
+  /// @pre The model is applied.
+  void GenerateEvents(int max_combinations);
 
-  /// @returns CCF factors of the model.
-  const ExpressionMap& factors() const { return factors_; }
+  /// @returns The CCF events generated by the group so far.
+  const std::vector<std::unique_ptr<CcfEvent>>& ccf_events() const {
+    return ccf_events_;
+  }
 
+ protected:
   /// Registers a new expression for ownership by the group.
   /// @{
   template <class T, typename... Ts>
@@ -190,6 +234,15 @@ class CcfGroup : public Id {
   ///           for each level of groupings for CCF events.
   virtual ExpressionMap CalculateProbabilities() = 0;
 
+  /// Factors a CCF level into a K/N gate over member shares
+  /// instead of member combination events.
+  ///
+  /// @param[in] level  The CCF level to factor.
+  /// @param[in] prob  The probability of a member combination at the level.
+  /// @param[in,out] proxy_gates  The member gates and their formula arguments.
+  void FactorLevel(int level, Expression* prob,
+                   std::vector<std::pair<Gate*, Formula::ArgSet>>* proxy_gates);
+
   int prev_level_ = 0;  ///< To deduce optional levels from the previous level.
   Expression* distribution_ = nullptr;  ///< The group probability distribution.
   std::vector<BasicEvent*> members_;  ///< Members of CCF groups.
@@ -198,6 +251,10 @@ class CcfGroup : public Id {
   std::vector<std::unique_ptr<Expression>> expressions_;
   /// CCF events created by the group.
   std::vector<std::unique_ptr<CcfEvent>> ccf_events_;
+  std::vector<Gate*> member_gates_;  ///< The CCF gates of the members.
+  /// The K/N and member gates of the factored levels.
+  std::vector<std::unique_ptr<Gate>> level_gates_;
+  bool generated_ = false;  ///< The indication of generated events.
 };
 
 /// Common cause failure model that assumes,
@@ -0,0 +1,496 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the BDD/ZBDD snapshots.
+///
+/// The snapshot file starts with the signature, the format version, and the key.
+/// Vertices are stored in the post-order of their edges
+/// and refer to each other with their record numbers.
+/// The record numbers 0 and 1 are reserved for terminal vertices
+/// (the value of the terminal).
+/// ZBDD modules are stored before the vertices that refer to them.
+
+#include "diagram_cache.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include <fstream>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/exception/errinfo_file_open_mode.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "error.h"
+#include "event.h"
+#include "ext/fnv1a.h"
+#include "logger.h"
+
+namespace scram::core {
+
+namespace {
+
+const char kSignature[8] = "SCRAMDD";  ///< The file type signature.
+const std::uint32_t kVersion = 1;  ///< The version of the snapshot layout.
+const char kBddPrefix[] = "bdd";  ///< The file name prefix of BDD snapshots.
+const char kZbddPrefix[] = "zbdd";  ///< The file name prefix of ZBDD snapshots.
+
+/// The flags of vertex records.
+enum VertexFlag : std::uint8_t {
+  kModule = 1 << 0,
+  kCoherent = 1 << 1,
+  kComplementEdge = 1 << 2,  ///< BDD if-then-else vertices.
+  kMinimal = 1 << 3  ///< ZBDD set nodes.
+};
+
+/// Collects non-terminal vertices in the post-order of their edges.
+///
+/// @tparam T  The type of the non-terminal vertex.
+///
+/// @param[in] vertex  The root vertex of the graph.
+/// @param[in,out] refs  The record numbers of collected vertices by their ids.
+/// @param[in,out] vertices  The collected vertices in the record order.
+template <class T>
+void CollectVertices(const IntrusivePtr<Vertex<T>>& vertex,
+                     std::unordered_map<int, std::int32_t>* refs,
+                     std::vector<const T*>* vertices) noexcept {
+  if (vertex->terminal() || refs->count(vertex->id()))
+    return;
+  const T& node = T::Ref(vertex);
+  CollectVertices(node.high(), refs, vertices);
+  CollectVertices(node.low(), refs, vertices);
+  refs->emplace(vertex->id(), vertices->size() + 2);
+  vertices->push_back(&node);
+}
+
+/// @returns The record number of the collected or terminal vertex.
+template <class T>
+std::int32_t GetRef(const IntrusivePtr<Vertex<T>>& vertex,
+                    const std::unordered_map<int, std::int32_t>& refs) {
+  if (vertex->terminal())
+    return vertex->id();
+  return refs.find(vertex->id())->second;
+}
+
+/// Collects the non-terminal nodes of the PDAG in the index order.
+///
+/// @param[in] gate  The root gate of the graph.
+/// @param[in,out] gates  The collected gates.
+/// @param[in,out] variables  The collected variables.
+void CollectNodes(const Gate& gate, std::map<int, const Gate*>* gates,
+                  std::map<int, const Variable*>* variables) noexcept {
+  if (!gates->emplace(gate.index(), &gate).second)
+    return;
+  for (const auto& arg : gate.args<Variable>())
+    variables->emplace(arg.second.index(), &arg.second);
+  for (const auto& arg : gate.args<Gate>())
+    CollectNodes(arg.second, gates, variables);
+}
+
+}  // namespace
+
+/// Accumulates binary data of the snapshot.
+class DiagramCache::Writer {
+ public:
+  /// Writes the header of the snapshot.
+  ///
+  /// @param[in] key  The key of the snapshot.
+  explicit Writer(std::uint64_t key) {
+    buffer_.append(kSignature, sizeof(kSignature));
+    Write(kVersion);
+    Write(key);
+  }
+
+  /// Appends the raw bytes of a trivial value.
+  template <typename T>
+  void Write(T value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    buffer_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  /// @returns The accumulated data.
+  const std::string& buffer() const { return buffer_; }
+
+ private:
+  std::string buffer_;  ///< The binary data.
+};
+
+/// Bounds-checked consumer of the mapped snapshot data.
+class DiagramCache::Reader {
+ public:
+  /// @param[in] data  The beginning of the snapshot data.
+  /// @param[in] size  The size of the data in bytes.
+  Reader(const char* data, std::size_t size) : cur_(data), end_(data + size) {}
+
+  /// @returns true if the header matches the version and the key.
+  ///
+  /// @throws IOError  The data is truncated.
+  bool ReadHeader(std::uint64_t key) {
+    Require(sizeof(kSignature));
+    bool valid = !std::memcmp(cur_, kSignature, sizeof(kSignature));
+    cur_ += sizeof(kSignature);
+    return valid && Read<std::uint32_t>() == kVersion &&
+           Read<std::uint64_t>() == key;
+  }
+
+  /// @returns The trivial value at the current position.
+  ///
+  /// @throws IOError  The data is truncated.
+  template <typename T>
+  T Read() {
+    static_assert(std::is_trivially_copyable_v<T>);
+    Require(sizeof(T));
+    T value;
+    std::memcpy(&value, cur_, sizeof(T));
+    cur_ += sizeof(T);
+    return value;
+  }
+
+  /// @returns The vertex with the record number read from the data.
+  ///
+  /// @throws IOError  The record is not yet defined.
+  template <class T>
+  const T& ReadRef(const std::vector<T>& vertices) {
+    auto ref = Read<std::int32_t>();
+    if (ref < 0 || ref >= vertices.size() || !vertices[ref])
+      Corrupted();
+    return vertices[ref];
+  }
+
+  /// @returns true if all the data is consumed.
+  bool done() const { return cur_ == end_; }
+
+  /// @throws IOError  The data is inconsistent.
+  [[noreturn]] static void Corrupted() {
+    SCRAM_THROW(IOError("The diagram snapshot is corrupted."));
+  }
+
+ private:
+  /// @throws IOError  There are fewer bytes than required.
+  void Require(std::size_t size) const {
+    if (end_ - cur_ < size)
+      SCRAM_THROW(IOError("The diagram snapshot is truncated."));
+  }
+
+  const char* cur_;  ///< The current position.
+  const char* end_;  ///< The end of the data.
+};
+
+DiagramCache::DiagramCache(const std::string& directory, const Pdag& graph,
+                           const Settings& settings)
+    : directory_(directory), settings_(settings) {
+  ext::fnv1a hash;
+  hash.update(kVersion);
+  hash.update(settings.limit_order());
+  hash.update(settings.prime_implicants());
+  hash.update(graph.complement());
+  hash.update(graph.coherent());
+  const Gate& root = graph.root();
+  hash.update(root.index());
+
+  std::map<int, const Gate*> gates;
+  std::map<int, const Variable*> variables;
+  CollectNodes(root, &gates, &variables);
+  for (const auto& [index, gate] : gates) {
+    hash.update(index);
+    hash.update(gate->type());
+    hash.update(gate->type() == kAtleast ? gate->min_number() : 0);
+    hash.update(gate->order());
+    hash.update(gate->module());
+    hash.update(gate->coherent());
+    hash.update(gate->constant());
+    hash.update(gate->args().size());
+    for (int arg : gate->args())
+      hash.update(arg);
+  }
+  for (const auto& [index, variable] : variables) {
+    hash.update(index);
+    hash.update(variable->order());
+    const std::string& id = graph.basic_events()[index]->id();
+    hash.update(id.data(), id.size());
+    hash.update(id.size());
+  }
+  for (const Pdag::Substitution& substitution : graph.substitutions()) {
+    hash.update(substitution.hypothesis.size());
+    for (int index : substitution.hypothesis)
+      hash.update(index);
+    hash.update(substitution.source.size());
+    for (int index : substitution.source)
+      hash.update(index);
+    hash.update(substitution.target);
+  }
+  key_ = hash.value();
+}
+
+std::string DiagramCache::file(const char* prefix) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%s-%016" PRIx64 ".sdd", prefix, key_);
+  return (boost::filesystem::path(directory_) / name).string();
+}
+
+template <>
+std::unique_ptr<Bdd> DiagramCache::Load<Bdd>() const noexcept {
+  return LoadFile(kBddPrefix, &DiagramCache::ReadBdd);
+}
+
+template <>
+std::unique_ptr<Zbdd> DiagramCache::Load<Zbdd>() const noexcept {
+  return LoadFile(kZbddPrefix, &DiagramCache::ReadZbdd);
+}
+
+template <class Diagram>
+std::unique_ptr<Diagram> DiagramCache::LoadFile(
+    const char* prefix,
+    std::unique_ptr<Diagram> (*read)(Reader*, const Settings&)) const
+    noexcept {
+  namespace bip = boost::interprocess;
+  std::string path = file(prefix);
+  boost::system::error_code error;
+  if (!boost::filesystem::exists(path, error)) {
+    LOG(DEBUG2) << "The diagram snapshot " << path << " is not found";
+    return nullptr;
+  }
+  CLOCK(load_time);
+  try {
+    bip::file_mapping mapping(path.c_str(), bip::read_only);
+    bip::mapped_region region(mapping, bip::read_only);
+    Reader in(static_cast<const char*>(region.get_address()),
+              region.get_size());
+    if (!in.ReadHeader(key_)) {
+      LOG(DEBUG2) << "The diagram snapshot " << path << " is stale";
+      return nullptr;
+    }
+    std::unique_ptr<Diagram> diagram = read(&in, settings_);
+    if (!in.done())
+      Reader::Corrupted();
+    LOG(DEBUG2) << "Loaded the diagram snapshot " << path << " in "
+                << DUR(load_time);
+    return diagram;
+  } catch (const bip::interprocess_exception& err) {
+    LOG(WARNING) << "Cannot map the diagram snapshot " << path << ": "
+                 << err.what();
+  } catch (const Error& err) {
+    LOG(WARNING) << "Ignoring the corrupted diagram snapshot " << path << ": "
+                 << err.what();
+  }
+  return nullptr;
+}
+
+bool DiagramCache::Store(const Bdd& bdd) const noexcept {
+  Writer out(key_);
+  Write(bdd, &out);
+  return Store(out, kBddPrefix);
+}
+
+bool DiagramCache::Store(const Zbdd& zbdd) const noexcept {
+  Writer out(key_);
+  Write(zbdd, &out);
+  return Store(out, kZbddPrefix);
+}
+
+bool DiagramCache::Store(const Writer& writer, const char* prefix) const
+    noexcept {
+  namespace fs = boost::filesystem;
+  CLOCK(store_time);
+  std::string path = file(prefix);
+  try {
+    fs::create_directories(directory_);
+    // The snapshot replaces the old file only after a successful write.
+    // Analyses with the same diagrams may store them concurrently.
+    std::string temp_file = path + "." + fs::unique_path().string();
+    {
+      std::ofstream out(temp_file, std::ios::binary);
+      out.write(writer.buffer().data(), writer.buffer().size());
+      if (!out) {
+        SCRAM_THROW(IOError("Cannot write the diagram snapshot."))
+            << boost::errinfo_file_name(temp_file)
+            << boost::errinfo_file_open_mode("wb");
+      }
+    }
+    fs::rename(temp_file, path);
+  } catch (const std::exception& err) {
+    LOG(WARNING) << "Cannot store the diagram snapshot " << path << ": "
+                 << err.what();
+    return false;
+  }
+  LOG(DEBUG2) << "Stored the diagram snapshot " << path << " in "
+              << DUR(store_time);
+  return true;
+}
+
+void DiagramCache::Write(const Bdd& bdd, Writer* out) {
+  assert(bdd.zbdd_ && "The BDD is not analyzed.");
+  std::unordered_map<int, std::int32_t> refs;
+  std::vector<const Ite*> vertices;
+  CollectVertices(bdd.root_.vertex, &refs, &vertices);
+  for (const auto& entry : bdd.modules_)
+    CollectVertices(entry.second.vertex, &refs, &vertices);
+
+  out->Write<std::uint8_t>(bdd.coherent_);
+  out->Write<std::uint32_t>(vertices.size());
+  for (const Ite* ite : vertices) {
+    out->Write<std::int32_t>(ite->index());
+    out->Write<std::int32_t>(ite->order());
+    out->Write<std::uint8_t>((ite->module() ? kModule : 0) |
+                             (ite->coherent() ? kCoherent : 0) |
+                             (ite->complement_edge() ? kComplementEdge : 0));
+    out->Write(GetRef(ite->high(), refs));
+    out->Write(GetRef(ite->low(), refs));
+  }
+  out->Write<std::uint8_t>(bdd.root_.complement);
+  out->Write(GetRef(bdd.root_.vertex, refs));
+  out->Write<std::uint32_t>(bdd.modules_.size());
+  for (const auto& [index, function] : bdd.modules_) {
+    out->Write<std::int32_t>(index);
+    out->Write<std::uint8_t>(function.complement);
+    out->Write(GetRef(function.vertex, refs));
+  }
+  out->Write<std::uint32_t>(bdd.index_to_order_.size());
+  for (const auto& [index, order] : bdd.index_to_order_) {
+    out->Write<std::int32_t>(index);
+    out->Write<std::int32_t>(order);
+  }
+  Write(*bdd.zbdd_, out);
+}
+
+void DiagramCache::Write(const Zbdd& zbdd, Writer* out) {
+  out->Write<std::int32_t>(zbdd.module_index_);
+  out->Write<std::uint8_t>(zbdd.coherent_);
+  out->Write<std::int32_t>(zbdd.kSettings_.limit_order());
+  out->Write<std::uint32_t>(zbdd.modules_.size());
+  for (const auto& [index, module] : zbdd.modules_) {
+    out->Write<std::int32_t>(index);
+    Write(*module, out);
+  }
+
+  std::unordered_map<int, std::int32_t> refs;
+  std::vector<const SetNode*> vertices;
+  CollectVertices(zbdd.root_, &refs, &vertices);
+  out->Write<std::uint32_t>(vertices.size());
+  for (const SetNode* node : vertices) {
+    out->Write<std::int32_t>(node->index());
+    out->Write<std::int32_t>(node->order());
+    out->Write<std::uint8_t>((node->module() ? kModule : 0) |
+                             (node->coherent() ? kCoherent : 0) |
+                             (node->minimal() ? kMinimal : 0));
+    out->Write<std::int32_t>(node->max_set_order());
+    out->Write(GetRef(node->high(), refs));
+    out->Write(GetRef(node->low(), refs));
+  }
+  out->Write(GetRef(zbdd.root_, refs));
+}
+
+std::unique_ptr<Bdd> DiagramCache::ReadBdd(Reader* in,
+                                           const Settings& settings) {
+  bool coherent = in->Read<std::uint8_t>();
+  std::unique_ptr<Bdd> bdd(new Bdd(settings, coherent));
+  std::vector<Bdd::VertexPtr> vertices = {nullptr, bdd->kOne_};
+  std::vector<int> modules;  // The indices of module proxies.
+  for (auto num_vertices = in->Read<std::uint32_t>(); num_vertices;
+       --num_vertices) {
+    auto index = in->Read<std::int32_t>();
+    auto order = in->Read<std::int32_t>();
+    auto flags = in->Read<std::uint8_t>();
+    const Bdd::VertexPtr& high = in->ReadRef(vertices);
+    const Bdd::VertexPtr& low = in->ReadRef(vertices);
+    if (index <= 0 || order <= 0)
+      Reader::Corrupted();
+    ItePtr ite = bdd->FindOrAddVertex(index, high, low,
+                                      flags & kComplementEdge, order);
+    ite->module(flags & kModule);
+    ite->coherent(flags & kCoherent);
+    if (ite->module())
+      modules.push_back(index);
+    vertices.push_back(ite);
+  }
+  bdd->root_.complement = in->Read<std::uint8_t>();
+  bdd->root_.vertex = in->ReadRef(vertices);
+  for (auto num_modules = in->Read<std::uint32_t>(); num_modules;
+       --num_modules) {
+    auto index = in->Read<std::int32_t>();
+    bool complement = in->Read<std::uint8_t>();
+    if (!bdd->modules_.emplace(index, Bdd::Function{complement,
+                                                    in->ReadRef(vertices)})
+             .second) {
+      Reader::Corrupted();
+    }
+  }
+  for (int index : modules) {
+    if (!bdd->modules_.count(index))
+      Reader::Corrupted();
+  }
+  for (auto num_orders = in->Read<std::uint32_t>(); num_orders; --num_orders) {
+    auto index = in->Read<std::int32_t>();
+    bdd->index_to_order_.emplace(index, in->Read<std::int32_t>());
+  }
+  bdd->zbdd_ = ReadZbdd(in, settings);
+  bdd->Freeze();
+  return bdd;
+}
+
+std::unique_ptr<Zbdd> DiagramCache::ReadZbdd(Reader* in,
+                                             const Settings& settings) {
+  auto module_index = in->Read<std::int32_t>();
+  bool coherent = in->Read<std::uint8_t>();
+  auto limit_order = in->Read<std::int32_t>();
+  if (limit_order < 0)
+    Reader::Corrupted();
+  Settings adjusted(settings);
+  adjusted.limit_order(limit_order);
+  std::unique_ptr<Zbdd> zbdd(new Zbdd(adjusted, coherent, module_index));
+  for (auto num_modules = in->Read<std::uint32_t>(); num_modules;
+       --num_modules) {
+    auto index = in->Read<std::int32_t>();
+    if (!zbdd->modules_.emplace(index, ReadZbdd(in, settings)).second)
+      Reader::Corrupted();
+  }
+
+  std::vector<Zbdd::VertexPtr> vertices = {zbdd->kEmpty_, zbdd->kBase_};
+  for (auto num_vertices = in->Read<std::uint32_t>(); num_vertices;
+       --num_vertices) {
+    auto index = in->Read<std::int32_t>();
+    auto order = in->Read<std::int32_t>();
+    auto flags = in->Read<std::uint8_t>();
+    auto max_set_order = in->Read<std::int32_t>();
+    const Zbdd::VertexPtr& high = in->ReadRef(vertices);
+    const Zbdd::VertexPtr& low = in->ReadRef(vertices);
+    if (!index || order <= 0 || high->id() == low->id() ||
+        ((flags & kModule) && !zbdd->modules_.count(index))) {
+      Reader::Corrupted();
+    }
+    SetNodePtr node = zbdd->FindOrAddVertex(index, high, low, order,
+                                            flags & kModule, flags & kCoherent);
+    node->minimal(flags & kMinimal);
+    node->max_set_order(max_set_order);
+    vertices.push_back(node);
+  }
+  zbdd->root_ = in->ReadRef(vertices);
+  zbdd->Freeze();
+  return zbdd;
+}
+
+}  // namespace scram::core
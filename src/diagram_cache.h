@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Binary snapshots of decision diagrams for warm restarts.
+///
+/// The diagram structure depends only on the logic of the analysis target
+/// and the variable ordering,
+/// so the snapshot is keyed by the hash of the preprocessed PDAG
+/// (gates, variables with their orders and basic events, substitutions)
+/// and the settings that affect the products.
+/// Probabilities are not part of the snapshot.
+///
+/// The snapshot file is memory-mapped on load,
+/// and the vertices are registered in the post-order of their edges
+/// without any Boolean operations.
+/// The format is specific to the host (byte order and type sizes).
+
+#pragma once
+
+#include <cstdint>
+
+#include <memory>
+#include <string>
+
+#include "bdd.h"
+#include "pdag.h"
+#include "settings.h"
+#include "zbdd.h"
+
+namespace scram::core {
+
+/// Snapshot storage of BDD and ZBDD of a single preprocessed PDAG.
+class DiagramCache {
+ public:
+  /// Computes the key of the PDAG diagrams.
+  ///
+  /// @param[in] directory  The directory of the cache files.
+  /// @param[in] graph  The PDAG preprocessed for the diagram algorithm.
+  /// @param[in] settings  The analysis settings.
+  ///
+  /// @pre The PDAG has variable ordering.
+  DiagramCache(const std::string& directory, const Pdag& graph,
+               const Settings& settings);
+
+  /// @returns The key of the diagrams.
+  std::uint64_t key() const { return key_; }
+
+  /// Loads the analyzed diagram from the cache.
+  ///
+  /// @tparam Diagram  Bdd or Zbdd.
+  ///
+  /// @returns The diagram with the products ready for quantification.
+  /// @returns nullptr if the snapshot is missing, stale, or corrupted.
+  template <class Diagram>
+  std::unique_ptr<Diagram> Load() const noexcept;
+
+  /// Stores the snapshot of the analyzed diagram into the cache.
+  /// Failures are logged but otherwise ignored.
+  ///
+  /// @param[in] bdd  The BDD with the products.
+  ///
+  /// @returns true if the snapshot is written.
+  ///
+  /// @pre The diagram is analyzed (frozen) for the PDAG of the key.
+  bool Store(const Bdd& bdd) const noexcept;
+
+  /// @param[in] zbdd  The analyzed ZBDD.
+  ///
+  /// @copydoc DiagramCache::Store(const Bdd&) const
+  bool Store(const Zbdd& zbdd) const noexcept;
+
+ private:
+  class Writer;  ///< Accumulator of the binary snapshot data.
+  class Reader;  ///< Bounds-checked consumer of the snapshot data.
+
+  /// @returns The file path of the snapshot for the diagram type.
+  std::string file(const char* prefix) const;
+
+  /// Writes the snapshot data into the file.
+  ///
+  /// @returns true if the write is successful.
+  bool Store(const Writer& writer, const char* prefix) const noexcept;
+
+  /// Serializes the diagram vertices and modules.
+  /// @{
+  static void Write(const Bdd& bdd, Writer* out);
+  static void Write(const Zbdd& zbdd, Writer* out);
+  /// @}
+
+  /// Restores the diagram from its serialized vertices and modules.
+  ///
+  /// @throws IOError  The data is corrupted.
+  /// @{
+  static std::unique_ptr<Bdd> ReadBdd(Reader* in, const Settings& settings);
+  static std::unique_ptr<Zbdd> ReadZbdd(Reader* in, const Settings& settings);
+  /// @}
+
+  /// Maps the snapshot file and validates its header.
+  ///
+  /// @returns nullptr if the snapshot is missing or stale.
+  template <class Diagram>
+  std::unique_ptr<Diagram> LoadFile(
+      const char* prefix,
+      std::unique_ptr<Diagram> (*read)(Reader*, const Settings&)) const
+      noexcept;
+
+  std::string directory_;  ///< The cache directory.
+  Settings settings_;  ///< The settings to construct diagrams.
+  std::uint64_t key_;  ///< The hash of the PDAG and settings.
+};
+
+/// @returns The BDD from the cache.
+template <>
+std::unique_ptr<Bdd> DiagramCache::Load<Bdd>() const noexcept;
+
+/// @returns The ZBDD from the cache.
+template <>
+std::unique_ptr<Zbdd> DiagramCache::Load<Zbdd>() const noexcept;
+
+}  // namespace scram::core
@@ -125,6 +125,8 @@ class BasicEvent : public Event {
   bool HasCcf() const { return ccf_gate_ != nullptr; }
 
   /// @returns CCF group gate representing this basic event.
+  ///
+  /// @pre The CCF group has generated its events for the gate formula.
   const Gate& ccf_gate() const {
     assert(ccf_gate_);
     return *ccf_gate_;
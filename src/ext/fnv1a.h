@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Stable 64-bit hashing for keys of on-disk caches.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <type_traits>
+
+namespace ext {
+
+/// 64-bit FNV-1a hash of byte sequences.
+/// Unlike std::hash, the value is stable across runs and builds.
+class fnv1a {
+ public:
+  /// Mixes bytes into the hash.
+  void update(const void* data, std::size_t size) noexcept {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+      hash_ ^= bytes[i];
+      hash_ *= 1099511628211ULL;
+    }
+  }
+
+  /// Mixes a trivial value into the hash.
+  template <typename T>
+  void update(T value) noexcept {
+    static_assert(std::is_trivially_copyable_v<T>);
+    update(&value, sizeof(value));
+  }
+
+  /// @returns The current hash value.
+  std::uint64_t value() const noexcept { return hash_; }
+
+ private:
+  std::uint64_t hash_ = 14695981039346656037ULL;  ///< The offset basis.
+};
+
+}  // namespace ext
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of a vector-based map
+/// with a hash index for a large number of entries.
+
+#pragma once
+
+#include <cassert>
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ext {
+
+/// The default key projection for the hash index of the hybrid map.
+struct identity_key {
+  /// @returns The key itself.
+  template <typename Key>
+  const Key& operator()(const Key& key) const {
+    return key;
+  }
+};
+
+/// An adaptor map that stays linear (vector-based) for small sizes
+/// like the linear_map with the MoveEraser policy,
+/// but maintains a hash index of the entry positions
+/// once the number of entries exceeds the threshold.
+/// The index makes the lookup and erasure constant time on average
+/// for maps with thousands of entries,
+/// while the small maps keep the cache-friendliness of linear_map.
+///
+/// The entries are stored in the insertion order
+/// until erasures move the last entry into the erased position.
+/// The iteration order is, therefore,
+/// the same as of the linear_map with the MoveEraser policy
+/// regardless of the index.
+///
+/// The index is keyed by the projection of the keys.
+/// The keys can be modified through the iterators
+/// as long as their projections stay the same and unique,
+/// e.g., the sign of signed index keys with the absolute value projection.
+///
+/// @tparam Key  The type of the unique keys.
+/// @tparam Value  The type of the values associated with the keys.
+/// @tparam Threshold  The number of entries to start indexing.
+/// @tparam Projection  The unique projection of keys for the hash index.
+template <typename Key, typename Value, std::size_t Threshold = 32,
+          class Projection = identity_key>
+class hybrid_map {
+ public:
+  /// Public typedefs.
+  /// @{
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<key_type, mapped_type>;
+  using container_type = std::vector<value_type>;
+  /// @}
+
+  /// Iterator-related typedefs redeclared from the underlying container type.
+  /// @{
+  using reference = typename container_type::reference;
+  using const_reference = typename container_type::const_reference;
+  using iterator = typename container_type::iterator;
+  using const_iterator = typename container_type::const_iterator;
+  using size_type = typename container_type::size_type;
+  /// @}
+
+  /// Finds an entry in the map.
+  ///
+  /// @param[in] key  The key of the entry.
+  ///
+  /// @returns Iterator pointing to the entry,
+  ///          or end() if not found.
+  /// @{
+  const_iterator find(const key_type& key) const {
+    if (index_.empty()) {
+      return std::find_if(map_.cbegin(), map_.cend(), [&key](
+                              const value_type& p) { return p.first == key; });
+    }
+    auto it = index_.find(Projection()(key));
+    if (it == index_.end() || map_[it->second].first != key)
+      return map_.cend();
+    return std::next(map_.cbegin(), it->second);
+  }
+
+  iterator find(const key_type& key) {
+    auto it = std::as_const(*this).find(key);
+    return std::next(map_.begin(), std::distance(map_.cbegin(), it));
+  }
+  /// @}
+
+  /// Determines if an entry with the given key in the map.
+  ///
+  /// @param[in] key  The key of the entry.
+  ///
+  /// @returns 1 if there's an entry,
+  ///          0 otherwise.
+  size_type count(const key_type& key) const {
+    return hybrid_map::find(key) != map_.end();
+  }
+
+  /// Inserts a key-value pair into the map
+  /// if the pair is not in the map.
+  ///
+  /// @param[in] p  The entry.
+  ///
+  /// @returns A pair of an iterator and insertion flag.
+  ///          The iterator points to possibly inserted entry,
+  ///          and the flag indicates whether the entry is actually inserted.
+  std::pair<iterator, bool> insert(value_type p) {
+    auto it = hybrid_map::find(p.first);
+    if (it != map_.end())
+      return {it, false};
+    return {hybrid_map::emplace_unique(std::move(p.first),
+                                       std::move(p.second)),
+            true};
+  }
+
+  /// Appends an entry without checking for duplicates.
+  /// This is the bulk construction API
+  /// for callers that guarantee the key uniqueness.
+  ///
+  /// @param[in] key  The unique key of the entry.
+  /// @param[in] value  The value of the entry.
+  ///
+  /// @returns Iterator pointing to the new entry.
+  ///
+  /// @pre The key (and its projection) is not in the map.
+  iterator emplace_unique(key_type key, mapped_type value) {
+    assert(!hybrid_map::count(key) && "Duplicate key.");
+    map_.emplace_back(std::move(key), std::move(value));
+    if (!index_.empty()) {
+      index_.emplace(Projection()(map_.back().first), map_.size() - 1);
+    } else if (map_.size() > Threshold) {
+      hybrid_map::BuildIndex();
+    }
+    return std::prev(map_.end());
+  }
+
+  /// Erases the entry pointed by the iterator.
+  /// The last entry is moved into the erased position.
+  ///
+  /// @param[in] pos  The iterator pointing to the existing entry.
+  ///
+  /// @returns The iterator pointing to the original position.
+  ///
+  /// @warning The order of elements is changed after this erase.
+  /// @{
+  iterator erase(const_iterator pos) {
+    size_type i = std::distance(map_.cbegin(), pos);
+    if (!index_.empty())
+      index_.erase(Projection()(map_[i].first));
+    if (i != map_.size() - 1) {  // Prevent move into itself.
+      map_[i] = std::move(map_.back());
+      if (!index_.empty())
+        index_[Projection()(map_[i].first)] = i;
+    }
+    map_.pop_back();
+    if (map_.size() < Threshold / 2)
+      index_.clear();
+    return std::next(map_.begin(), i);
+  }
+
+  iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+  /// @}
+
+  /// Removes an entry with the given key.
+  ///
+  /// @param[in] key  The key of the entry to be removed.
+  ///
+  /// @returns 1 if the existing entry is removed.
+  ///          0 if no entry with the given key is found.
+  size_type erase(const key_type& key) {
+    auto it = hybrid_map::find(key);
+    if (it == map_.end())
+      return 0;
+    hybrid_map::erase(it);
+    return 1;
+  }
+
+  /// Removes all entries from the map.
+  void clear() noexcept {
+    map_.clear();
+    index_.clear();
+  }
+
+  /// Reserves the storage for the number of entries.
+  ///
+  /// @param[in] n  The expected number of entries.
+  void reserve(size_type n) {
+    map_.reserve(n);
+    if (n > Threshold)
+      index_.reserve(n);
+  }
+
+  /// Swaps data with another hybrid map.
+  ///
+  /// @param[in] other  The other map.
+  void swap(hybrid_map& other) noexcept {
+    map_.swap(other.map_);
+    index_.swap(other.index_);
+  }
+
+  /// @returns true if the map is indexed.
+  bool indexed() const { return !index_.empty(); }
+
+  /// @returns The number of entries in the map.
+  size_type size() const { return map_.size(); }
+
+  /// @returns true if the map is empty.
+  bool empty() const { return map_.empty(); }
+
+  /// @returns The underlying data container.
+  ///
+  /// @note The container is read-only to protect the index.
+  const container_type& data() const { return map_; }
+
+  /// Forward iterators.
+  /// @{
+  iterator begin() noexcept { return map_.begin(); }
+  iterator end() noexcept { return map_.end(); }
+  const_iterator begin() const noexcept { return map_.begin(); }
+  const_iterator end() const noexcept { return map_.end(); }
+  const_iterator cbegin() const noexcept { return map_.cbegin(); }
+  const_iterator cend() const noexcept { return map_.cend(); }
+  /// @}
+
+ private:
+  /// Indexes all the entries of the map.
+  void BuildIndex() {
+    index_.reserve(map_.capacity());
+    for (size_type i = 0; i < map_.size(); ++i)
+      index_.emplace(Projection()(map_[i].first), i);
+  }
+
+  /// The type of the index keys.
+  using index_key =
+      std::decay_t<decltype(std::declval<Projection>()(std::declval<Key>()))>;
+
+  container_type map_;  ///< The main underlying data container.
+  /// The positions of the entries by the key projections.
+  /// The index is empty for small maps.
+  std::unordered_map<index_key, size_type> index_;
+};
+
+}  // namespace ext
@@ -26,8 +26,10 @@
 #include <boost/container/flat_set.hpp>
 #include <boost/range/algorithm.hpp>
 
+#include "error.h"
 #include "event.h"
 #include "logger.h"
+#include "variable_order.h"
 
 namespace scram::core {
 
@@ -104,6 +106,14 @@ ProductContainer::ProductContainer(const Zbdd& products,
   }
 }
 
+Pdag::IndexMap<double> ProductContainer::ExtractProbabilities() const {
+  Pdag::IndexMap<double> p_vars;
+  p_vars.reserve(graph_.basic_events().size());
+  for (const mef::BasicEvent* event : graph_.basic_events())
+    p_vars.push_back(event->p());
+  return p_vars;
+}
+
 double Product::p() const {
   double p = 1;
   for (const Literal& literal : *this) {
@@ -117,11 +127,24 @@ FaultTreeAnalysis::FaultTreeAnalysis(const mef::Gate& root,
                                      const mef::Model* model)
     : Analysis(settings), top_event_(root), model_(model) {}
 
+FaultTreeAnalysis::FaultTreeAnalysis(const mef::Gate& root,
+                                     std::unique_ptr<Pdag> graph,
+                                     std::vector<PassProfile> preprocessing,
+                                     const Settings& settings,
+                                     const mef::Model* model)
+    : Analysis(settings),
+      top_event_(root),
+      model_(model),
+      graph_(std::move(graph)),
+      preprocessing_(std::move(preprocessing)) {}
+
 void FaultTreeAnalysis::Analyze() noexcept {
   CLOCK(analysis_time);
-  graph_ = std::make_unique<Pdag>(top_event_,
-                                  Analysis::settings().ccf_analysis(), model_);
-  this->Preprocess(graph_.get());
+  if (!graph_) {
+    graph_ = std::make_unique<Pdag>(
+        top_event_, Analysis::settings().ccf_analysis(), model_);
+    Accumulate(this->Preprocess(graph_.get()), &preprocessing_);
+  }
 #ifndef NDEBUG
   if (Analysis::settings().preprocessor)
     return;  // Preprocessor only option.
@@ -138,6 +161,27 @@ void FaultTreeAnalysis::Analyze() noexcept {
   LOG(DEBUG2) << "Stored the result for reporting in " << DUR(store_time);
 }
 
+void FaultTreeAnalysis::SeedVariableOrder(Pdag* graph) noexcept {
+  try {
+    VariableOrder order(Analysis::settings().variable_order());
+    int num_seeded = order.Seed(top_event_.id(), graph);
+    LOG(DEBUG2) << "Seeded the order of " << num_seeded << " variables";
+  } catch (const IOError& err) {
+    LOG(WARNING) << "Ignoring the variable order: " << err.what();
+  }
+}
+
+void FaultTreeAnalysis::SaveVariableOrder(const Bdd& bdd,
+                                          const Pdag& graph) noexcept {
+  try {
+    VariableOrder order(Analysis::settings().variable_order());
+    order.Record(top_event_.id(), bdd, graph);
+    order.Save();
+  } catch (const IOError& err) {
+    LOG(WARNING) << "Cannot save the variable order: " << err.what();
+  }
+}
+
 void FaultTreeAnalysis::Store(const Zbdd& products,
                               const Pdag& graph) noexcept {
   // Special cases of sets.
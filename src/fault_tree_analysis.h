@@ -23,6 +23,9 @@
 #include <cstdlib>
 
 #include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
 #include <unordered_set>
 #include <vector>
 
@@ -30,6 +33,8 @@
 #include <boost/iterator/transform_iterator.hpp>
 
 #include "analysis.h"
+#include "bdd.h"
+#include "diagram_cache.h"
 #include "pdag.h"
 #include "preprocessor.h"
 #include "settings.h"
@@ -87,6 +92,16 @@ class Product {
   /// @pre Events are initialized with expressions.
   double p() const;
 
+  /// @param[in] p_vars  Cached probabilities of the graph variables.
+  ///
+  /// @returns The product of the literal probabilities.
+  double p(const Pdag::IndexMap<double>& p_vars) const {
+    double p = 1;
+    for (int index : data_)
+      p *= index < 0 ? 1 - p_vars[-index] : p_vars[index];
+    return p;
+  }
+
   /// @returns A read proxy iterator that points to the first element.
   auto begin() const {
     return boost::make_transform_iterator(data_.begin(),
@@ -151,6 +166,20 @@ class ProductContainer {
   /// @returns The product distribution by order.
   const std::vector<int>& distribution() const { return distribution_; }
 
+  /// @returns The current probabilities of the graph variables
+  ///          to be reused in product calculations.
+  ///
+  /// @pre Events are initialized with expressions.
+  Pdag::IndexMap<double> ExtractProbabilities() const;
+
+  /// @param[in] p_vars  Cached probabilities of the graph variables.
+  ///
+  /// @returns The sum of the probabilities of all the products
+  ///          calculated without the enumeration of the products.
+  double CalculateProbabilitySum(const Pdag::IndexMap<double>& p_vars) const {
+    return products_.CalculateProbabilitySum(p_vars, distribution_.size());
+  }
+
  private:
   const Zbdd& products_;  ///< Container of analysis results.
   const Pdag& graph_;  ///< The analysis graph.
@@ -210,6 +239,26 @@ class FaultTreeAnalysis : public Analysis {
   FaultTreeAnalysis(const mef::Gate& root, const Settings& settings,
                     const mef::Model* model = nullptr);
 
+  /// Continues the analysis with a PDAG
+  /// that has already been constructed and preprocessed,
+  /// e.g., to select the algorithm from its structure.
+  /// The analysis proceeds directly to the algorithm
+  /// without preprocessing the graph again
+  /// so that the structures built from the graph stay valid.
+  ///
+  /// @param[in] root  The top event of the fault tree to analyze.
+  /// @param[in] graph  The PDAG of the top event
+  ///                   preprocessed for the analysis algorithm.
+  /// @param[in] preprocessing  The profiles of the done preprocessing.
+  /// @param[in] settings  Analysis settings for all calculations.
+  /// @param[in] model  The Model containing substitutions if any.
+  ///
+  /// @pre The graph is constructed with the same settings and model.
+  FaultTreeAnalysis(const mef::Gate& root, std::unique_ptr<Pdag> graph,
+                    std::vector<PassProfile> preprocessing,
+                    const Settings& settings,
+                    const mef::Model* model = nullptr);
+
   virtual ~FaultTreeAnalysis() = default;
 
   /// @returns The top gate that is passed to the analysis.
@@ -238,17 +287,53 @@ class FaultTreeAnalysis : public Analysis {
     return *products_;
   }
 
+  /// @returns The profiles of the preprocessing passes.
+  ///
+  /// @pre The analysis is done.
+  const std::vector<PassProfile>& preprocessing() const {
+    return preprocessing_;
+  }
+
+  /// @returns The variable reordering of the BDD analysis algorithm,
+  ///          or nullopt for other algorithms.
+  ///
+  /// @pre The analysis is done.
+  const std::optional<Bdd::Reordering>& reordering() const {
+    return reordering_;
+  }
+
  protected:
   /// @returns Pointer to the PDAG representing the fault tree.
   const Pdag* graph() const { return graph_.get(); }
 
+  /// Seeds the BDD variable ordering of the PDAG
+  /// with the order saved from previous runs.
+  ///
+  /// @param[in,out] graph  The PDAG preprocessed for BDD.
+  void SeedVariableOrder(Pdag* graph) noexcept;
+
+  /// Saves the final BDD variable order for future runs.
+  ///
+  /// @param[in] bdd  The BDD of the analysis.
+  /// @param[in] graph  The PDAG of the BDD.
+  void SaveVariableOrder(const Bdd& bdd, const Pdag& graph) noexcept;
+
+  /// Records the variable reordering of the BDD analysis for reporting.
+  ///
+  /// @param[in] reordering  The results of the BDD variable reordering.
+  void reordering(const Bdd::Reordering& reordering) {
+    reordering_ = reordering;
+  }
+
  private:
   /// Preprocesses a PDAG for future analysis with a specific algorithm.
   ///
   /// @param[in,out] graph  A valid PDAG for analysis.
   ///
+  /// @returns The profiles of the preprocessing passes.
+  ///
   /// @post The graph transformation is semantically equivalent/isomorphic.
-  virtual void Preprocess(Pdag* graph) noexcept = 0;
+  virtual std::vector<PassProfile> Preprocess(Pdag* graph) noexcept = 0;
 
   /// Generates a sum of products from a preprocessed PDAG.
   ///
@@ -271,6 +356,8 @@ class FaultTreeAnalysis : public Analysis {
   const mef::Model* model_;  ///< The optional Model with substitutions.
   std::unique_ptr<Pdag> graph_;  ///< PDAG of the fault tree.
   std::unique_ptr<const ProductContainer> products_;  ///< Container of results.
+  std::vector<PassProfile> preprocessing_;  ///< The preprocessing profiles.
+  std::optional<Bdd::Reordering> reordering_;  ///< The BDD reordering if any.
 };
 
 /// Fault tree analysis facility with specific algorithms.
@@ -289,14 +376,52 @@ class FaultTreeAnalyzer : public FaultTreeAnalysis {
   Algorithm* algorithm() { return algorithm_.get(); }
   /// @}
 
+  /// Adopts the algorithm constructed from the graph ahead of the analysis,
+  /// e.g., the trial BDD of the automatic algorithm selection.
+  ///
+  /// @param[in] algorithm  The constructed but not yet analyzed algorithm.
+  void algorithm(std::unique_ptr<Algorithm> algorithm) {
+    algorithm_ = std::move(algorithm);
+  }
+
  private:
-  void Preprocess(Pdag* graph) noexcept override {
-    CustomPreprocessor<Algorithm>{graph}();
+  std::vector<PassProfile> Preprocess(Pdag* graph) noexcept override {
+    CustomPreprocessor<Algorithm> preprocessor(
+        graph, Analysis::settings().preprocessing_budget());
+    preprocessor();
+    if constexpr (std::is_same_v<Algorithm, Bdd>) {
+      if (!Analysis::settings().variable_order().empty())
+        FaultTreeAnalysis::SeedVariableOrder(graph);
+    }
+    return preprocessor.profiles();
   }
 
   const Zbdd& GenerateProducts(const Pdag* graph) noexcept override {
-    algorithm_ = std::make_unique<Algorithm>(graph, Analysis::settings());
-    algorithm_->Analyze(graph);
+    std::unique_ptr<Algorithm> adopted = std::move(algorithm_);
+    auto construct = [this, graph, &adopted] {
+      algorithm_ = adopted ? std::move(adopted)
+                           : std::make_unique<Algorithm>(graph,
+                                                         Analysis::settings());
+      algorithm_->Analyze(graph);
+    };
+    if constexpr (std::is_same_v<Algorithm, Bdd> ||
+                  std::is_same_v<Algorithm, Zbdd>) {
+      const std::string& directory = Analysis::settings().diagram_cache();
+      if (!directory.empty()) {
+        DiagramCache cache(directory, *graph, Analysis::settings());
+        if (!(algorithm_ = cache.Load<Algorithm>())) {
+          construct();
+          cache.Store(*algorithm_);
+        }
+      }
+    }
+    if (!algorithm_)
+      construct();
+    if constexpr (std::is_same_v<Algorithm, Bdd>) {
+      FaultTreeAnalysis::reordering(algorithm_->reordering());
+      if (!Analysis::settings().variable_order().empty())
+        FaultTreeAnalysis::SaveVariableOrder(*algorithm_, *graph);
+    }
     return algorithm_->products();
   }
 
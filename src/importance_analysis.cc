@@ -144,4 +144,13 @@ double ImportanceAnalyzer<Bdd>::RetrieveProbability(
   return Ite::Ref(vertex).p();
 }
 
+double ImportanceAnalyzer<MonteCarlo>::CalculateMif(int index) noexcept {
+  if (mif_.empty()) {  // All factors are simulated upon the first request.
+    mif_ = simulator_->SimulateImportance(prob_analyzer()->p_vars());
+  }
+  const MonteCarlo::Estimate& mif = mif_[index + Pdag::kVariableStartIndex];
+  mif_intervals_.push_back(mif.confidence_interval);
+  return mif.mean;
+}
+
 }  // namespace scram::core
@@ -21,9 +21,11 @@
 
 #pragma once
 
+#include <utility>
 #include <vector>
 
 #include "bdd.h"
+#include "monte_carlo.h"
 #include "probability_analysis.h"
 #include "settings.h"
 
@@ -127,6 +129,8 @@ class ImportanceAnalyzerBase : public ImportanceAnalysis {
 
 /// Analyzer of importance factors
 /// with the help from probability analyzers.
+/// The marginal importance factors of all variables
+/// are calculated together in a single pass over the products.
 ///
 /// @tparam Calculator  Quantitative calculator of probability values.
 template <class Calculator>
@@ -134,26 +138,21 @@ class ImportanceAnalyzer : public ImportanceAnalyzerBase {
  public:
   /// @copydoc ImportanceAnalyzerBase::ImportanceAnalyzerBase
   explicit ImportanceAnalyzer(ProbabilityAnalyzer<Calculator>* prob_analyzer)
-      : ImportanceAnalyzerBase(prob_analyzer),
-        p_vars_(prob_analyzer->p_vars()) {}
+      : ImportanceAnalyzerBase(prob_analyzer) {}
 
  private:
   double CalculateMif(int index) noexcept override;
-  Pdag::IndexMap<double> p_vars_;  ///< A copy of variable probabilities.
+  Pdag::IndexMap<double> mif_;  ///< The factors of all variables.
 };
 
 template <class Calculator>
 double ImportanceAnalyzer<Calculator>::CalculateMif(int index) noexcept {
-  index += Pdag::kVariableStartIndex;
-  auto p_conditional = [index, this](bool state) {
-    p_vars_[index] = state;
-    return static_cast<ProbabilityAnalyzer<Calculator>*>(prob_analyzer())
-        ->CalculateTotalProbability(p_vars_);
-  };
-  double p_store = p_vars_[index];  // Save the original value for restoring.
-  double mif = p_conditional(true) - p_conditional(false);
-  p_vars_[index] = p_store;  // Restore the probability for next calculation.
-  return mif;
+  if (mif_.empty()) {  // All factors are calculated upon the first request.
+    auto* calculator =
+        static_cast<ProbabilityAnalyzer<Calculator>*>(prob_analyzer());
+    mif_ = calculator->CalculateMif(calculator->p_vars());
+  }
+  return mif_[index + Pdag::kVariableStartIndex];
 }
 
 /// Specialization of importance analyzer with Binary Decision Diagrams.
@@ -196,4 +195,37 @@ class ImportanceAnalyzer<Bdd> : public ImportanceAnalyzerBase {
   Bdd* bdd_graph_;  ///< Binary decision diagram for the analyzer.
 };
 
+/// Specialization of importance analyzer with direct Monte Carlo simulation.
+/// The marginal importance factors of all variables
+/// are estimated together on the same simulated scenarios.
+template <>
+class ImportanceAnalyzer<MonteCarlo> : public ImportanceAnalyzerBase {
+ public:
+  /// @copydoc ImportanceAnalyzerBase::ImportanceAnalyzerBase
+  explicit ImportanceAnalyzer(ProbabilityAnalyzer<MonteCarlo>* prob_analyzer)
+      : ImportanceAnalyzerBase(prob_analyzer),
+        simulator_(prob_analyzer->simulator()) {}
+
+  /// @returns The 95% confidence intervals of MIF estimates
+  ///          in the order of the importance records.
+  ///
+  /// @pre The importance analysis is done.
+  const std::vector<std::pair<double, double>>& mif_intervals() const {
+    return mif_intervals_;
+  }
+
+ private:
+  /// @returns Occurrences of basic events as gate arguments in the graph.
+  std::vector<int> occurrences() noexcept override {
+    return simulator_->occurrences();
+  }
+
+  double CalculateMif(int index) noexcept override;
+
+  MonteCarlo* simulator_;  ///< The simulator of the analysis graph.
+  Pdag::IndexMap<MonteCarlo::Estimate> mif_;  ///< Simulated MIF estimates.
+  /// The confidence intervals of the calculated MIF.
+  std::vector<std::pair<double, double>> mif_intervals_;
+};
+
 }  // namespace scram::core
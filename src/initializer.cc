@@ -20,9 +20,14 @@
 
 #include "initializer.h"
 
+#include <algorithm>
+#include <exception>
 #include <functional>  // std::mem_fn
+#include <iterator>
+#include <optional>
 #include <sstream>
 #include <type_traits>
+#include <unordered_set>
 
 #include <boost/exception/errinfo_at_line.hpp>
 #include <boost/exception/errinfo_file_name.hpp>
@@ -44,6 +49,7 @@
 #include "ext/algorithm.h"
 #include "ext/find_iterator.h"
 #include "logger.h"
+#include "parallel.h"
 
 namespace scram::mef {
 
@@ -70,26 +76,45 @@ RoleSpecifier GetRole(const std::string_view& s, RoleSpecifier parent_role) {
   return s.empty() ? parent_role : GetRole(s);
 }
 
-/// Attaches attributes and a label to the elements of the analysis.
-/// These attributes are not XML attributes
-/// but the Open-PSA format defined arbitrary attributes
-/// and a label that can be attached to many analysis elements.
+/// Removes elements from the component and its subcomponents.
 ///
-/// @param[in] xml_element  XML element.
-/// @param[out] element  The object that needs attributes and label.
+/// @param[in] elements  The elements to be removed.
+/// @param[in,out] component  The container of the elements.
+void PruneComponent(const std::unordered_set<const Element*>& elements,
+                    Component* component) {
+  auto prune = [&elements, component](auto* type_tag) {
+    using T = std::remove_pointer_t<decltype(type_tag)>;
+    std::vector<T*> pruned;
+    for (T& element : component->table<T>()) {
+      if (elements.count(&element))
+        pruned.push_back(&element);
+    }
+    for (T* element : pruned)
+      component->Remove(element);
+  };
+  prune(static_cast<Gate*>(nullptr));
+  prune(static_cast<BasicEvent*>(nullptr));
+  prune(static_cast<Parameter*>(nullptr));
+  prune(static_cast<CcfGroup*>(nullptr));
+  for (Component& sub_component : component->table<Component>())
+    PruneComponent(elements, &sub_component);
+}
+
+/// Attaches the label or attributes XML element data
+/// to the element of the analysis.
+///
+/// @param[in] xml_node  XML element with the label or attributes.
+/// @param[out] element  The object that needs attributes or label.
 ///
 /// @throws ValidityError  Invalid attribute setting.
-void AttachLabelAndAttributes(const xml::Element& xml_element,
-                              Element* element) {
-  if (std::optional<xml::Element> label = xml_element.child("label")) {
+void AttachLabelOrAttributes(const xml::Element& xml_node, Element* element) {
+  if (xml_node.name() == "label") {
     assert(element->label().empty() && "Resetting element label.");
-    element->label(std::string(label->text()));
-  }
-
-  std::optional<xml::Element> attributes = xml_element.child("attributes");
-  if (!attributes)
+    element->label(std::string(xml_node.text()));
     return;
-  for (const xml::Element& attribute : attributes->children()) {
+  }
+  assert(xml_node.name() == "attributes");
+  for (const xml::Element& attribute : xml_node.children()) {
     assert(attribute.name() == "attribute");
     try {
       element->AddAttribute({std::string(attribute.attribute("name")),
@@ -102,6 +127,23 @@ void AttachLabelAndAttributes(const xml::Element& xml_element,
   }
 }
 
+/// Attaches attributes and a label to the elements of the analysis.
+/// These attributes are not XML attributes
+/// but the Open-PSA format defined arbitrary attributes
+/// and a label that can be attached to many analysis elements.
+///
+/// @param[in] xml_element  XML element.
+/// @param[out] element  The object that needs attributes and label.
+///
+/// @throws ValidityError  Invalid attribute setting.
+void AttachLabelAndAttributes(const xml::Element& xml_element,
+                              Element* element) {
+  if (std::optional<xml::Element> label = xml_element.child("label"))
+    AttachLabelOrAttributes(*label, element);
+  if (std::optional<xml::Element> attributes = xml_element.child("attributes"))
+    AttachLabelOrAttributes(*attributes, element);
+}
+
 /// Constructs Element of type T from an XML element.
 template <class T>
 std::enable_if_t<std::is_base_of_v<Element, T>, std::unique_ptr<T>>
@@ -157,10 +199,11 @@ ConstructElement<Phase>(const xml::Element& xml_element) {
 
 Initializer::Initializer(const std::vector<std::string>& xml_files,
                          core::Settings settings, bool allow_extern,
-                         xml::Validator* extra_validator)
+                         xml::Validator* extra_validator, bool stream_input)
     : settings_(std::move(settings)),
       allow_extern_(allow_extern),
-      extra_validator_(extra_validator) {
+      extra_validator_(extra_validator),
+      stream_input_(stream_input && !extra_validator) {
   BLOG(WARNING, allow_extern_) << "Enabling external dynamic libraries";
   ProcessInputFiles(xml_files);
 }
@@ -195,26 +238,22 @@ void Initializer::ProcessInputFiles(const std::vector<std::string>& xml_files) {
   LOG(DEBUG1) << "Processing input files";
   CheckFileExistence(xml_files);
   CheckDuplicateFiles(xml_files);
-  for (const auto& xml_file : xml_files) {
-    CLOCK(parse_time);
-    LOG(DEBUG3) << "Parsing " << xml_file << " ...";
-    xml::Document document(xml_file, &validator);
-    if (extra_validator_)
-      extra_validator_->validate(document);
-    documents_.emplace_back(std::move(document));
-    LOG(DEBUG3) << "Parsed " << xml_file << " in " << DUR(parse_time);
-  }
-  CLOCK(def_time);
-  for (const xml::Document& document : documents_) {
-    try {
-      ProcessInputFile(document);
-    } catch (ValidityError& err) {
-      err << boost::errinfo_file_name(document.root().filename());
-      throw;
+  if (stream_input_) {
+    StreamInputFiles(xml_files, validator);
+  } else {
+    ParseInputFiles(xml_files, validator);
+    CLOCK(def_time);
+    for (const xml::Document& document : documents_) {
+      try {
+        ProcessInputFile(document);
+      } catch (ValidityError& err) {
+        err << boost::errinfo_file_name(document.root().filename());
+        throw;
+      }
     }
+    ProcessTbdElements();
+    LOG(DEBUG2) << "Element definition time " << DUR(def_time);
   }
-  ProcessTbdElements();
-  LOG(DEBUG2) << "Element definition time " << DUR(def_time);
   LOG(DEBUG1) << "Input files are processed in " << DUR(input_time);
 
   CLOCK(valid_time);
@@ -232,6 +271,242 @@ void Initializer::ProcessInputFiles(const std::vector<std::string>& xml_files) {
   LOG(DEBUG1) << "Setup time " << DUR(setup_time);
 }
 
+void Initializer::ParseInputFiles(const std::vector<std::string>& xml_files,
+                                  const xml::Validator& validator) {
+  CLOCK(parse_time);
+  std::vector<std::optional<xml::Document>> documents(xml_files.size());
+  std::vector<std::exception_ptr> errors(xml_files.size());
+  int num_threads = core::NumParallelThreads(xml_files.size());
+  xmlInitParser();  // The library initialization is not thread-safe.
+  core::ParallelFor(xml_files.size(), [&](int i) {
+    try {
+      CLOCK(file_time);
+      LOG(DEBUG3) << "Parsing " << xml_files[i] << " ...";
+      documents[i].emplace(xml_files[i]);
+      validator.validate(*documents[i]);
+      if (extra_validator_)
+        extra_validator_->validate(*documents[i]);
+      LOG(DEBUG3) << "Parsed " << xml_files[i] << " in " << DUR(file_time);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  });
+
+  for (const std::exception_ptr& error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+  for (std::optional<xml::Document>& document : documents)
+    documents_.emplace_back(std::move(*document));
+  LOG(DEBUG2) << "Parsed " << xml_files.size() << " input files with "
+              << num_threads << " threads in " << DUR(parse_time);
+}
+
+void Initializer::StreamInputFiles(const std::vector<std::string>& xml_files,
+                                   const xml::Validator& validator) {
+  /// The container of definitions open in the stream.
+  struct Scope {
+    Element* element;  ///< The owner of the label and attributes if any.
+    std::unique_ptr<Component> component;  ///< The fault tree or component.
+    std::string base_path;  ///< The path of the component data.
+  };
+  auto is_container = [](std::string_view name) {
+    return name == "opsa-mef" || name == "model-data" ||
+           name == "define-fault-tree" || name == "define-component";
+  };
+
+  CLOCK(register_time);
+  int num_subtrees = 0;  // Container elements are not materialized.
+  bool has_extern_functions = false;
+  for (const std::string& xml_file : xml_files) {
+    CLOCK(file_time);
+    LOG(DEBUG3) << "Registering " << xml_file << " ...";
+    try {
+      xml::Reader reader(xml_file, &validator);
+      std::vector<Scope> scopes;
+      while (reader.Read()) {
+        if (!reader.start()) {  // Only container end tags are read.
+          Scope scope = std::move(scopes.back());
+          scopes.pop_back();
+          if (!scope.component)
+            continue;
+          if (!scopes.back().component) {
+            Register(std::unique_ptr<FaultTree>(
+                         static_cast<FaultTree*>(scope.component.release())),
+                     reader.element());
+            continue;
+          }
+          try {
+            scopes.back().component->Add(std::move(scope.component));
+          } catch (ValidityError& err) {
+            err << boost::errinfo_at_line(reader.element().line());
+            throw;
+          }
+          continue;
+        }
+
+        xml::Element node = reader.element();
+        if (!is_container(node.name())) {
+          int ordinal = num_subtrees++;
+          if (node.name() == "define-extern-function") {
+            reader.Skip();  // Extern functions are defined before the others.
+            has_extern_functions = true;
+            continue;
+          }
+          xml::Element subtree = reader.Expand();
+          Scope& scope = scopes.back();
+          int num_tbd = tbd_.size();
+          if (subtree.name() == "label" || subtree.name() == "attributes") {
+            if (scope.element)
+              AttachLabelOrAttributes(subtree, scope.element);
+          } else if (scope.component) {
+            RegisterFaultTreeElement(subtree, scope.base_path,
+                                     scope.component.get());
+          } else if (scopes.size() == 1) {
+            ProcessTopElement(subtree);
+          } else {
+            RegisterModelDataElement(subtree);
+          }
+          // Save the locations of definitions instead of the XML handles.
+          for (int i = num_tbd; i < tbd_.size(); ++i) {
+            int child_index = -1;
+            if (tbd_[i].second != subtree) {
+              child_index = 0;
+              for (const xml::Element& child : subtree.children()) {
+                if (child == tbd_[i].second)
+                  break;
+                ++child_index;
+              }
+            }
+            tbd_locations_.emplace_back(ordinal, child_index);
+          }
+
+        } else if (node.name() == "opsa-mef") {
+          Element* model = nullptr;
+          if (!model_) {  // Create only one model for multiple files.
+            model_ =
+                std::make_unique<Model>(std::string(node.attribute("name")));
+            model_->mission_time().value(settings_.mission_time());
+            model = model_.get();
+          }
+          scopes.push_back({model, nullptr, ""});
+
+        } else if (node.name() == "model-data") {
+          scopes.push_back({nullptr, nullptr, ""});
+
+        } else if (node.name() == "define-fault-tree") {
+          auto fault_tree =
+              std::make_unique<FaultTree>(std::string(node.attribute("name")));
+          Element* element = fault_tree.get();
+          std::string base_path = fault_tree->name();
+          scopes.push_back({element, std::move(fault_tree), base_path});
+
+        } else {
+          assert(node.name() == "define-component");
+          const Scope& parent = scopes.back();
+          auto component = std::make_unique<Component>(
+              std::string(node.attribute("name")), parent.base_path,
+              GetRole(node.attribute("role"), parent.component->role()));
+          Element* element = component.get();
+          std::string base_path = parent.base_path + "." + component->name();
+          scopes.push_back({element, std::move(component), base_path});
+        }
+      }
+    } catch (ValidityError& err) {
+      err << boost::errinfo_file_name(xml_file);
+      throw;
+    }
+    LOG(DEBUG3) << "Registered " << xml_file << " in " << DUR(file_time);
+  }
+  LOG(DEBUG2) << "Element registration time " << DUR(register_time);
+
+  CLOCK(def_time);
+  if (has_extern_functions) {
+    for (const std::string& xml_file : xml_files) {
+      xml::Reader reader(xml_file);
+      int depth = 0;
+      while (reader.Read()) {
+        if (!reader.start()) {
+          --depth;
+        } else if (is_container(reader.element().name())) {
+          ++depth;
+        } else if (depth == 1 &&
+                   reader.element().name() == "define-extern-function") {
+          try {
+            DefineExternFunction(reader.Expand());
+          } catch (ValidityError& err) {
+            err << boost::errinfo_file_name(xml_file);
+            throw;
+          }
+        } else {
+          reader.Skip();
+        }
+      }
+    }
+  }
+
+  // The analysis targets require the elements on demand
+  // as the references of the defined elements are discovered.
+  // The stream is re-read until the required elements are defined.
+  bool closure = !settings_.targets().empty();
+  if (closure)
+    RequireTargets();
+  auto pending = [this, closure, defined = std::vector<bool>(tbd_.size())](
+                     int index) mutable {
+    if (defined[index] || (closure && !tbd_required_[index]))
+      return false;
+    defined[index] = true;
+    return true;
+  };
+  int num_defined = 0;
+  int num_passes = 0;
+  do {
+    ++num_passes;
+    // The documents have been validated in the registration pass.
+    int next_tbd = 0;
+    num_subtrees = 0;
+    for (const std::string& xml_file : xml_files) {
+      xml::Reader reader(xml_file);
+      while (reader.Read()) {
+        if (!reader.start() || is_container(reader.element().name()))
+          continue;
+        int ordinal = num_subtrees++;
+        int end_tbd = next_tbd;
+        while (end_tbd < tbd_.size() &&
+               tbd_locations_[end_tbd].first == ordinal) {
+          ++end_tbd;
+        }
+        std::optional<xml::Element> subtree;
+        // The definitions may require the later elements of the subtree.
+        for (; next_tbd < end_tbd; ++next_tbd) {
+          if (!pending(next_tbd))
+            continue;
+          if (!subtree)
+            subtree = reader.Expand();
+          int child_index = tbd_locations_[next_tbd].second;
+          tbd_[next_tbd].second =
+              child_index < 0 ? *subtree
+                              : *std::next(subtree->children().begin(),
+                                           child_index);
+          DefineTbdElement(next_tbd);
+          ++num_defined;
+        }
+        if (!subtree)
+          reader.Skip();
+      }
+    }
+    assert(next_tbd == tbd_.size() && "Unvisited TBD elements.");
+  } while (closure && num_defined < tbd_queue_.size());
+  assert(num_defined == (closure ? tbd_queue_.size() : tbd_.size()));
+  if (closure) {
+    RemoveUndefinedElements();
+    LOG(DEBUG2) << "Defined " << num_defined << " of " << tbd_.size()
+                << " elements for the analysis targets in " << num_passes
+                << " passes";
+  }
+  LOG(DEBUG2) << "Element definition time " << DUR(def_time);
+}
+
 template <class T>
 void Initializer::Register(std::unique_ptr<T> element,
                            const xml::Element& xml_element) {
@@ -357,54 +632,57 @@ void Initializer::ProcessInputFile(const xml::Document& document) {
     model_->mission_time().value(settings_.mission_time());
   }
 
-  for (const xml::Element& node : root.children()) {
-    if (node.name() == "define-initiating-event") {
-      std::unique_ptr<InitiatingEvent> initiating_event =
-          ConstructElement<InitiatingEvent>(node);
-      auto* ref_ptr = initiating_event.get();
-      Register(std::move(initiating_event), node);
-      tbd_.emplace_back(ref_ptr, node);
+  for (const xml::Element& node : root.children())
+    ProcessTopElement(node);
+}
 
-    } else if (node.name() == "define-rule") {
-      std::unique_ptr<Rule> rule = ConstructElement<Rule>(node);
-      auto* ref_ptr = rule.get();
-      Register(std::move(rule), node);
-      tbd_.emplace_back(ref_ptr, node);
+void Initializer::ProcessTopElement(const xml::Element& node) {
+  if (node.name() == "define-initiating-event") {
+    std::unique_ptr<InitiatingEvent> initiating_event =
+        ConstructElement<InitiatingEvent>(node);
+    auto* ref_ptr = initiating_event.get();
+    Register(std::move(initiating_event), node);
+    tbd_.emplace_back(ref_ptr, node);
 
-    } else if (node.name() == "define-event-tree") {
-      DefineEventTree(node);
+  } else if (node.name() == "define-rule") {
+    std::unique_ptr<Rule> rule = ConstructElement<Rule>(node);
+    auto* ref_ptr = rule.get();
+    Register(std::move(rule), node);
+    tbd_.emplace_back(ref_ptr, node);
 
-    } else if (node.name() == "define-fault-tree") {
-      DefineFaultTree(node);
+  } else if (node.name() == "define-event-tree") {
+    DefineEventTree(node);
 
-    } else if (node.name() == "define-CCF-group") {
-      Register<CcfGroup>(node, "", RoleSpecifier::kPublic);
+  } else if (node.name() == "define-fault-tree") {
+    DefineFaultTree(node);
 
-    } else if (node.name() == "define-alignment") {
-      std::unique_ptr<Alignment> alignment = ConstructElement<Alignment>(node);
-      auto* address = alignment.get();
-      Register(std::move(alignment), node);
-      tbd_.emplace_back(address, node);
+  } else if (node.name() == "define-CCF-group") {
+    Register<CcfGroup>(node, "", RoleSpecifier::kPublic);
 
-    } else if (node.name() == "define-substitution") {
-      std::unique_ptr<Substitution> substitution =
-          ConstructElement<Substitution>(node);
-      auto* address = substitution.get();
-      Register(std::move(substitution), node);
-      tbd_.emplace_back(address, node);
+  } else if (node.name() == "define-alignment") {
+    std::unique_ptr<Alignment> alignment = ConstructElement<Alignment>(node);
+    auto* address = alignment.get();
+    Register(std::move(alignment), node);
+    tbd_.emplace_back(address, node);
 
-    } else if (node.name() == "model-data") {
-      ProcessModelData(node);
+  } else if (node.name() == "define-substitution") {
+    std::unique_ptr<Substitution> substitution =
+        ConstructElement<Substitution>(node);
+    auto* address = substitution.get();
+    Register(std::move(substitution), node);
+    tbd_.emplace_back(address, node);
 
-    } else if (node.name() == "define-extern-library") {
-      if (!allow_extern_) {
-        SCRAM_THROW(
-            IllegalOperation("Loading external libraries is disallowed!"))
-            << boost::errinfo_file_name(node.filename())
-            << boost::errinfo_at_line(node.line());
-      }
-      DefineExternLibraries(node);
+  } else if (node.name() == "model-data") {
+    ProcessModelData(node);
+
+  } else if (node.name() == "define-extern-library") {
+    if (!allow_extern_) {
+      SCRAM_THROW(
+          IllegalOperation("Loading external libraries is disallowed!"))
+          << boost::errinfo_file_name(node.filename())
+          << boost::errinfo_at_line(node.line());
     }
+    DefineExternLibraries(node);
   }
 }
 
@@ -603,17 +881,116 @@ void Initializer::ProcessTbdElements() {
     }
   }
 
-  for (const auto& [tbd_element, xml_element] : tbd_) {
-    try {
+  if (!settings_.targets().empty())
+    return DefineTargetClosure();
+
+  for (int i = 0; i < tbd_.size(); ++i)
+    DefineTbdElement(i);
+}
+
+void Initializer::DefineTargetClosure() {
+  CLOCK(closure_time);
+  RequireTargets();
+  // The queue grows with the references of the defined elements.
+  for (int i = 0; i < tbd_queue_.size(); ++i)
+    DefineTbdElement(tbd_queue_[i]);
+  RemoveUndefinedElements();
+  LOG(DEBUG2) << "Defined " << tbd_queue_.size() << " of " << tbd_.size()
+              << " elements for the analysis targets in " << DUR(closure_time);
+}
+
+void Initializer::RequireTargets() {
+  tbd_required_.assign(tbd_.size(), false);
+  for (int i = 0; i < tbd_.size(); ++i) {
+    std::visit(
+        [this, i](auto* tbd_construct) {
+          using T = std::decay_t<decltype(*tbd_construct)>;
+          if constexpr (std::is_same_v<T, Gate> ||
+                        std::is_same_v<T, BasicEvent> ||
+                        std::is_same_v<T, Parameter>) {
+            tbd_indices_.emplace(tbd_construct, i);
+          } else if constexpr (std::is_same_v<T, CcfGroup>) {
+            for (const BasicEvent* member : tbd_construct->members())
+              tbd_indices_.emplace(member, i);
+          } else {  // Event tree constructs are always defined.
+            tbd_required_[i] = true;
+            tbd_queue_.push_back(i);
+          }
+        },
+        tbd_[i].first);
+  }
+
+  for (const std::string& target : settings_.targets()) {
+    if (model_->table<InitiatingEvent>().count(target) ||
+        model_->table<Sequence>().count(target)) {
+      continue;
+    }
+    auto it = model_->table<Gate>().find(target);
+    if (it == model_->table<Gate>().end()) {
+      SCRAM_THROW(SettingsError("The analysis target is not in the model."))
+          << errinfo_value(target);
+    }
+    RequireDefinition(&*it);
+  }
+}
+
+void Initializer::RemoveUndefinedElements() {
+  // The undefined fault tree data are removed from the containers
+  // before releasing them from the model.
+  auto for_each_undefined = [this](auto&& visitor) {
+    for (int i = 0; i < tbd_.size(); ++i) {
+      if (tbd_required_[i])
+        continue;
       std::visit(
-          [this, &xml_element](auto* tbd_construct) {
-            this->Define(xml_element, tbd_construct);
+          [&visitor](auto* tbd_construct) {
+            using T = std::decay_t<decltype(*tbd_construct)>;
+            if constexpr (std::is_same_v<T, CcfGroup>) {
+              for (BasicEvent* member : tbd_construct->members())
+                visitor(member);
+            }
+            visitor(tbd_construct);
           },
-          tbd_element);
-    } catch (ValidityError& err) {
-      err << boost::errinfo_file_name(xml_element.filename());
-      throw;
+          tbd_[i].first);
+    }
+  };
+  std::unordered_set<const Element*> undefined;
+  for_each_undefined([this, &undefined](auto* element) {
+    using T = std::decay_t<decltype(*element)>;
+    undefined.insert(element);
+    if constexpr (std::is_same_v<T, Gate>) {
+      path_gates_.erase(element->full_path());
+    } else if constexpr (std::is_same_v<T, BasicEvent>) {
+      path_basic_events_.erase(element->full_path());
+    } else if constexpr (std::is_same_v<T, Parameter>) {
+      path_parameters_.erase(element->full_path());
     }
+  });
+  for (FaultTree& fault_tree : model_->table<FaultTree>())
+    PruneComponent(undefined, &fault_tree);
+  for_each_undefined([this](auto* element) { model_->Remove(element); });
+}
+
+void Initializer::RequireDefinition(const Element* element) {
+  if (tbd_indices_.empty())
+    return;
+  auto it = tbd_indices_.find(element);
+  if (it == tbd_indices_.end() || tbd_required_[it->second])
+    return;
+  tbd_required_[it->second] = true;
+  tbd_queue_.push_back(it->second);
+}
+
+void Initializer::DefineTbdElement(int index) {
+  const auto& [tbd_element, xml_element] = tbd_[index];
+  try {
+    std::visit(
+        [this, &xml_element](auto* tbd_construct) {
+          this->Define(xml_element, tbd_construct);
+        },
+        tbd_element);
+  } catch (ValidityError& err) {
+    err << boost::errinfo_file_name(xml_element.filename());
+    throw;
   }
 }
 
@@ -664,44 +1041,52 @@ std::unique_ptr<Component> Initializer::DefineComponent(
 void Initializer::RegisterFaultTreeData(const xml::Element& ft_node,
                                         const std::string& base_path,
                                         Component* component) {
-  for (const xml::Element& node : ft_node.children()) {
-    if (node.name() == "define-basic-event") {
-      component->Add(Register<BasicEvent>(node, base_path, component->role()));
+  for (const xml::Element& node : ft_node.children())
+    RegisterFaultTreeElement(node, base_path, component);
+}
 
-    } else if (node.name() == "define-parameter") {
-      component->Add(Register<Parameter>(node, base_path, component->role()));
+void Initializer::RegisterFaultTreeElement(const xml::Element& node,
+                                           const std::string& base_path,
+                                           Component* component) {
+  if (node.name() == "define-basic-event") {
+    component->Add(Register<BasicEvent>(node, base_path, component->role()));
 
-    } else if (node.name() == "define-gate") {
-      component->Add(Register<Gate>(node, base_path, component->role()));
+  } else if (node.name() == "define-parameter") {
+    component->Add(Register<Parameter>(node, base_path, component->role()));
 
-    } else if (node.name() == "define-house-event") {
-      component->Add(Register<HouseEvent>(node, base_path, component->role()));
+  } else if (node.name() == "define-gate") {
+    component->Add(Register<Gate>(node, base_path, component->role()));
 
-    } else if (node.name() == "define-CCF-group") {
-      component->Add(Register<CcfGroup>(node, base_path, component->role()));
+  } else if (node.name() == "define-house-event") {
+    component->Add(Register<HouseEvent>(node, base_path, component->role()));
 
-    } else if (node.name() == "define-component") {
-      std::unique_ptr<Component> sub =
-          DefineComponent(node, base_path, component->role());
-      try {
-        component->Add(std::move(sub));
-      } catch (ValidityError& err) {
-        err << boost::errinfo_at_line(node.line());
-        throw;
-      }
+  } else if (node.name() == "define-CCF-group") {
+    component->Add(Register<CcfGroup>(node, base_path, component->role()));
+
+  } else if (node.name() == "define-component") {
+    std::unique_ptr<Component> sub =
+        DefineComponent(node, base_path, component->role());
+    try {
+      component->Add(std::move(sub));
+    } catch (ValidityError& err) {
+      err << boost::errinfo_at_line(node.line());
+      throw;
     }
   }
 }
 
 void Initializer::ProcessModelData(const xml::Element& model_data) {
-  for (const xml::Element& node : model_data.children()) {
-    if (node.name() == "define-basic-event") {
-      Register<BasicEvent>(node, "", RoleSpecifier::kPublic);
-    } else if (node.name() == "define-parameter") {
-      Register<Parameter>(node, "", RoleSpecifier::kPublic);
-    } else if (node.name() == "define-house-event") {
-      Register<HouseEvent>(node, "", RoleSpecifier::kPublic);
-    }
+  for (const xml::Element& node : model_data.children())
+    RegisterModelDataElement(node);
+}
+
+void Initializer::RegisterModelDataElement(const xml::Element& node) {
+  if (node.name() == "define-basic-event") {
+    Register<BasicEvent>(node, "", RoleSpecifier::kPublic);
+  } else if (node.name() == "define-parameter") {
+    Register<Parameter>(node, "", RoleSpecifier::kPublic);
+  } else if (node.name() == "define-house-event") {
+    Register<HouseEvent>(node, "", RoleSpecifier::kPublic);
   }
 }
 
@@ -746,6 +1131,7 @@ std::unique_ptr<Formula> Initializer::GetFormula(
           return GetHouseEvent(name, base_path);
         }
       }();
+      std::visit([this](auto* event) { RequireDefinition(event); }, arg_event);
       arg_set.Add(arg_event, complement);
     } catch (ValidityError& err) {
       err << boost::errinfo_at_line(element.line());
@@ -1217,7 +1603,8 @@ Expression* Initializer::GetExpression(const xml::Element& expr_element,
     Expression* expression = register_expression(kExpressionExtractors_.at(
         expr_type)(expr_element.children(), base_path, this));
     // Register for late validation after ensuring no cycles.
-    expressions_.emplace_back(expression, expr_element);
+    expressions_.emplace_back(expression, expr_element.filename(),
+                              expr_element.line());
     return expression;
   } catch (ValidityError& err) {
     err << boost::errinfo_at_line(expr_element.line());
@@ -1290,8 +1677,11 @@ void Initializer::DefineCcfFactor(const xml::Element& factor_node,
 
 Parameter* Initializer::GetParameter(std::string_view entity_reference,
                                      const std::string& base_path) {
-  return GetEntity(entity_reference, base_path, model_->table<Parameter>(),
-                   TableRange(path_parameters_));
+  Parameter* parameter =
+      GetEntity(entity_reference, base_path, model_->table<Parameter>(),
+                TableRange(path_parameters_));
+  RequireDefinition(parameter);
+  return parameter;
 }
 
 HouseEvent* Initializer::GetHouseEvent(std::string_view entity_reference,
@@ -1302,14 +1692,19 @@ HouseEvent* Initializer::GetHouseEvent(std::string_view entity_reference,
 
 BasicEvent* Initializer::GetBasicEvent(std::string_view entity_reference,
                                        const std::string& base_path) {
-  return GetEntity(entity_reference, base_path, model_->table<BasicEvent>(),
-                   TableRange(path_basic_events_));
+  BasicEvent* basic_event =
+      GetEntity(entity_reference, base_path, model_->table<BasicEvent>(),
+                TableRange(path_basic_events_));
+  RequireDefinition(basic_event);
+  return basic_event;
 }
 
 Gate* Initializer::GetGate(std::string_view entity_reference,
                            const std::string& base_path) {
-  return GetEntity(entity_reference, base_path, model_->table<Gate>(),
-                   TableRange(path_gates_));
+  Gate* gate = GetEntity(entity_reference, base_path, model_->table<Gate>(),
+                         TableRange(path_gates_));
+  RequireDefinition(gate);
+  return gate;
 }
 
 template <class P, class T>
@@ -1800,12 +2195,11 @@ void Initializer::ValidateExpressions() {
   cycle::CheckCycle<Parameter>(model_->table<Parameter>(), "parameter");
 
   // Validate expressions.
-  for (const std::pair<Expression*, xml::Element>& expression : expressions_) {
+  for (const auto& [expression, file, line] : expressions_) {
     try {
-      expression.first->Validate();
+      expression->Validate();
     } catch (ValidityError& err) {
-      err << boost::errinfo_file_name(expression.second.filename())
-          << boost::errinfo_at_line(expression.second.line());
+      err << boost::errinfo_file_name(file) << boost::errinfo_at_line(line);
       throw;
     }
   }
@@ -1834,8 +2228,11 @@ void Initializer::SetupForAnalysis() {
   {
     TIMER(DEBUG2, "Applying CCF models");
     // CCF groups must apply models to basic event members.
-    for (CcfGroup& group : model_->table<CcfGroup>())
+    for (CcfGroup& group : model_->table<CcfGroup>()) {
       group.ApplyModel();
+      if (settings_.ccf_analysis())
+        group.GenerateEvents(settings_.ccf_expansion_limit());
+    }
   }
 }
 
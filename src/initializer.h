@@ -24,6 +24,7 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <variant>
@@ -68,19 +69,31 @@ class Initializer : private boost::noncopyable {
   /// @param[in] allow_extern  Allow external libraries in the input.
   /// @param[in] extra_validator  Additional XML validator to be run
   ///                             after the MEF validator.
+  /// @param[in] stream_input  Read the input files with the streaming reader
+  ///                          instead of keeping their DOM documents
+  ///                          for the whole initialization.
+  ///                          The extra validation requires the DOM;
+  ///                          the streaming is ignored with the validator.
   ///
   /// @throws IOError  Input contains duplicate files.
   /// @throws IOError  One of the input files is not accessible.
   /// @throws xml::Error  The xml files contain errors or malformed.
   /// @throws xml::ValidityError  The xml files are not valid for schema.
   /// @throws mef::ValidityError  The input model contains errors.
+  /// @throws SettingsError  An analysis target is not in the model.
+  ///
+  /// @note If analysis targets are given in the settings,
+  ///       only the fault tree data reachable from the targets
+  ///       and the event tree constructs are defined and kept in the model.
+  ///       The streaming input defines all the elements.
   ///
   /// @warning Processing external libraries from XML input is **UNSAFE**.
   ///          It allows loading and executing arbitrary code during analysis.
   ///          Enable this feature for trusted input files and libraries only.
   Initializer(const std::vector<std::string>& xml_files,
               core::Settings settings, bool allow_extern = false,
-              xml::Validator* extra_validator = nullptr);
+              xml::Validator* extra_validator = nullptr,
+              bool stream_input = false);
 
   /// @returns The model built from the input files.
   std::unique_ptr<Model> model() && { return std::move(model_); }
@@ -157,6 +170,20 @@ class Initializer : private boost::noncopyable {
   /// @throws IOError  Input contains duplicate files.
   void ProcessInputFiles(const std::vector<std::string>& xml_files);
 
+  /// Parses and validates the input files concurrently
+  /// into the saved documents in the input order.
+  ///
+  /// @param[in] xml_files  The formatted XML input files.
+  /// @param[in] validator  The schema validator for the documents.
+  ///
+  /// @throws xml::Error  The xml files are erroneous or malformed.
+  /// @throws xml::ValidityError The xml files do not pass validation.
+  /// @throws IOError  One of the input files is not accessible.
+  ///
+  /// @note The error of the first failed file in the input order is reported.
+  void ParseInputFiles(const std::vector<std::string>& xml_files,
+                       const xml::Validator& validator);
+
   /// Reads one input XML file document with the structure of analysis entities.
   /// Initializes the analysis from the given document.
   /// Puts all events into their appropriate containers.
@@ -172,6 +199,37 @@ class Initializer : private boost::noncopyable {
   /// @throws IllegalOperation  Loading external libraries is disallowed.
   void ProcessInputFile(const xml::Document& document);
 
+  /// Reads the input files with the streaming reader
+  /// without keeping the DOM of the documents.
+  ///
+  /// The files are read in two passes.
+  /// The first pass validates the documents and registers all the elements
+  /// recording the location of their definitions in the stream.
+  /// The second pass re-reads the recorded element subtrees
+  /// and defines the elements in the registration order.
+  /// Only one element subtree is kept in memory at any time.
+  /// If analysis targets are given in the settings,
+  /// only the target closure is defined
+  /// with as many passes as needed to reach the referenced elements.
+  ///
+  /// @param[in] xml_files  The formatted XML input files.
+  /// @param[in] validator  The schema validator for the documents.
+  ///
+  /// @throws xml::Error  The xml files are erroneous or malformed.
+  /// @throws xml::ValidityError The xml files do not pass validation.
+  /// @throws mef::ValidityError  The input model contains errors.
+  /// @throws IllegalOperation  Loading external libraries is disallowed.
+  void StreamInputFiles(const std::vector<std::string>& xml_files,
+                        const xml::Validator& validator);
+
+  /// Registers an element defined at the top level of the input document.
+  ///
+  /// @param[in] node  The child XML element of the document root.
+  ///
+  /// @throws ValidityError  The input model contains errors.
+  /// @throws IllegalOperation  Loading external libraries is disallowed.
+  void ProcessTopElement(const xml::Element& node);
+
   /// Processes definitions of elements
   /// that are left to be determined later.
   /// This late definition happens primarily due to unregistered dependencies.
@@ -179,6 +237,46 @@ class Initializer : private boost::noncopyable {
   /// @throws ValidityError  The elements contain undefined dependencies.
   void ProcessTbdElements();
 
+  /// Defines the element left to be determined later.
+  ///
+  /// @param[in] index  The index of the element in the TBD container.
+  ///
+  /// @throws ValidityError  The element contains undefined dependencies.
+  void DefineTbdElement(int index);
+
+  /// Defines only the TBD elements needed by the analysis targets.
+  /// The event tree constructs are always defined,
+  /// and the fault tree data are defined on demand
+  /// starting from the target gates and the event tree references.
+  /// The fault tree data left undefined are removed from the model.
+  ///
+  /// @throws SettingsError  A target is not in the model.
+  /// @throws ValidityError  The elements contain undefined dependencies.
+  ///
+  /// @pre Analysis targets are given in the settings.
+  void DefineTargetClosure();
+
+  /// Indexes the TBD elements for definitions on demand
+  /// and requires the definitions of the analysis target gates.
+  /// The event tree constructs are always required.
+  ///
+  /// @throws SettingsError  A target is not in the model.
+  ///
+  /// @pre Analysis targets are given in the settings.
+  void RequireTargets();
+
+  /// Removes the fault tree data left undefined by the target closure
+  /// from the model and its containers.
+  ///
+  /// @pre All the required TBD elements are defined.
+  void RemoveUndefinedElements();
+
+  /// Requests the late definition of the referenced element
+  /// if the loading is restricted to the analysis targets.
+  ///
+  /// @param[in] element  The element referenced by the defined elements.
+  void RequireDefinition(const Element* element);
+
   /// Registers an element into the model.
   ///
   /// @tparam T  The element type.
@@ -263,11 +361,27 @@ class Initializer : private boost::noncopyable {
                              const std::string& base_path,
                              Component* component);
 
+  /// Registers a fault tree or component data element.
+  ///
+  /// @param[in] node  XML element defining the data.
+  /// @param[in] base_path  Series of ancestor containers in the path with dots.
+  /// @param[in,out] component  The owner of the data.
+  ///
+  /// @throws ValidityError  There are issues with registering the data.
+  void RegisterFaultTreeElement(const xml::Element& node,
+                                const std::string& base_path,
+                                Component* component);
+
   /// Processes model data with definitions of events and analysis.
   ///
   /// @param[in] model_data  XML node with model data description.
   void ProcessModelData(const xml::Element& model_data);
 
+  /// Registers an event or parameter defined in the model data.
+  ///
+  /// @param[in] node  XML element defining the event or parameter.
+  void RegisterModelDataElement(const xml::Element& node);
+
   /// Creates a Boolean formula from the XML elements
   /// describing the formula with events and other nested formulas.
   ///
@@ -364,6 +478,9 @@ class Initializer : private boost::noncopyable {
   /// @returns Pointer to the entity found by following the given reference.
   ///
   /// @throws UndefinedElement  The entity cannot be found.
+  ///
+  /// @note The found entity is required to be defined
+  ///       if the loading is restricted to the analysis targets.
   /// @{
   Parameter* GetParameter(std::string_view entity_reference,
                           const std::string& base_path);
@@ -494,6 +611,7 @@ class Initializer : private boost::noncopyable {
   core::Settings settings_;  ///< Settings for analysis.
   bool allow_extern_;  ///< Allow processing MEF 'extern-library'.
   xml::Validator* extra_validator_;  ///< The optional extra XML validation.
+  bool stream_input_;  ///< Read the input without the DOM documents.
 
   /// Saved XML documents to keep elements alive.
   std::vector<xml::Document> documents_;
@@ -515,8 +633,23 @@ class Initializer : private boost::noncopyable {
                InitiatingEvent, Rule, Alignment, Substitution>
       tbd_;
 
-  /// Container of defined expressions for later validation due to cycles.
-  std::vector<std::pair<Expression*, xml::Element>> expressions_;
+  /// The locations of the TBD element definitions in the streamed input
+  /// as the ordinal of the materialized XML subtree
+  /// and the index of the child element in the subtree (-1 for the root).
+  /// The XML elements in the TBD container are rebound
+  /// upon re-reading the subtrees in the definition pass.
+  std::vector<std::pair<int, int>> tbd_locations_;
+
+  /// The indices of the fault tree data in the TBD container
+  /// for the definitions on demand.
+  /// The CCF group members are mapped to the index of their group.
+  std::unordered_map<const Element*, int> tbd_indices_;
+  std::vector<bool> tbd_required_;  ///< The TBD elements to be defined.
+  std::vector<int> tbd_queue_;  ///< The required TBD elements in order.
+
+  /// Container of defined expressions for later validation due to cycles
+  /// with the file and line of their definitions.
+  std::vector<std::tuple<Expression*, std::string, int>> expressions_;
   /// Container for event tree links to check for cycles.
   std::vector<Link*> links_;
 
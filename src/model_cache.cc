@@ -0,0 +1,947 @@
+/*
+ * Copyright (C) 2014-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the binary model cache.
+///
+/// The cache file starts with the signature, the format version, and the key.
+/// Expressions are stored in the post-order of their arguments,
+/// so every record refers only to already loaded constructs.
+
+#include "model_cache.h"
+
+#include <cstring>
+
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/exception/errinfo_file_open_mode.hpp>
+#include <boost/filesystem.hpp>
+
+#include "error.h"
+#include "expression/boolean.h"
+#include "expression/conditional.h"
+#include "expression/constant.h"
+#include "expression/exponential.h"
+#include "expression/numerical.h"
+#include "expression/random_deviate.h"
+#include "ext/fnv1a.h"
+#include "logger.h"
+
+namespace scram::mef {
+
+namespace {  // The binary layout helpers.
+
+const char kSignature[8] = "SCRAMMC";  ///< The file type signature.
+
+/// The version of the cache layout.
+/// The version must change with the layout or the expression type table.
+const std::uint32_t kVersion = 1;
+
+/// Accumulates binary data for the cache file.
+class Writer {
+ public:
+  /// Appends the raw bytes of a trivial value.
+  /// Boolean values are stored as bytes of 0 or 1.
+  template <typename T>
+  void Write(T value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if constexpr (std::is_same_v<T, bool>) {
+      Write<std::uint8_t>(value);
+    } else {
+      buffer_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+  }
+
+  /// Appends raw bytes.
+  void Write(const char* data, std::size_t size) { buffer_.append(data, size); }
+
+  /// Appends the string with its size.
+  void Write(const std::string& value) {
+    Write<std::uint32_t>(value.size());
+    buffer_.append(value);
+  }
+
+  /// @returns The accumulated data.
+  const std::string& buffer() const { return buffer_; }
+
+ private:
+  std::string buffer_;  ///< The binary data.
+};
+
+/// Bounds-checked consumer of the binary cache data.
+class Reader {
+ public:
+  /// @param[in] data  The data of the cache file.
+  /// @param[in] offset  The starting position in the data.
+  Reader(const std::string& data, std::size_t offset)
+      : cur_(data.data() + offset), end_(data.data() + data.size()) {}
+
+  /// @returns The trivial value at the current position.
+  ///
+  /// @throws IOError  The data is truncated or not a Boolean byte.
+  template <typename T>
+  T Read() {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if constexpr (std::is_same_v<T, bool>) {
+      auto value = Read<std::uint8_t>();
+      if (value > 1)
+        SCRAM_THROW(IOError("The model cache has an invalid Boolean value."));
+      return value;
+    } else {
+      Require(sizeof(T));
+      T value;
+      std::memcpy(&value, cur_, sizeof(T));
+      cur_ += sizeof(T);
+      return value;
+    }
+  }
+
+  /// @returns The string with its size at the current position.
+  ///
+  /// @throws IOError  The data is truncated.
+  std::string ReadString() {
+    auto size = Read<std::uint32_t>();
+    Require(size);
+    std::string value(cur_, size);
+    cur_ += size;
+    return value;
+  }
+
+  /// @returns The construct at the position read from the data.
+  ///
+  /// @throws IOError  The position is out of range.
+  template <typename T>
+  T* ReadRef(const std::vector<T*>& constructs) {
+    auto index = Read<std::int32_t>();
+    if (index < 0 || index >= constructs.size())
+      SCRAM_THROW(IOError("The model cache refers to an undefined construct."));
+    return constructs[index];
+  }
+
+  /// @returns true if all the data is consumed.
+  bool done() const { return cur_ == end_; }
+
+ private:
+  /// @throws IOError  There are fewer bytes than required.
+  void Require(std::size_t size) const {
+    if (end_ - cur_ < size)
+      SCRAM_THROW(IOError("The model cache is truncated."));
+  }
+
+  const char* cur_;  ///< The current position.
+  const char* end_;  ///< The end of the data.
+};
+
+/// The kinds of expression records.
+enum class Record : std::uint8_t {
+  kConstant = 0,
+  kOne,  ///< ConstantExpression::kOne.
+  kZero,  ///< ConstantExpression::kZero.
+  kPi,  ///< ConstantExpression::kPi.
+  kMissionTime,  ///< The model mission time.
+  kParameter,
+  kFormula  ///< The built-in expression from the type table.
+};
+
+/// The kinds of CCF group models.
+enum class CcfModel : std::uint8_t {
+  kBetaFactor = 0,
+  kMgl,
+  kAlphaFactor,
+  kPhiFactor
+};
+
+/// The kinds of formula argument events in the order of Formula::ArgEvent.
+enum class ArgKind : std::uint8_t { kGate = 0, kBasicEvent, kHouseEvent };
+
+}  // namespace
+
+namespace {  // Expression construction from flat arguments.
+
+/// The function to construct an expression from its arguments.
+using BuildFunction = std::unique_ptr<Expression> (*)(std::vector<Expression*>);
+
+/// @returns The number of constructor arguments for Expression types.
+/// @{
+template <class T, class A, class... As>
+constexpr int count_args() {
+  if constexpr (std::is_constructible_v<T, A, As...>) {
+    return 1 + sizeof...(As);
+  } else {
+    return count_args<T, A, A, As...>();
+  }
+}
+
+template <class T>
+constexpr int num_args() {
+  if constexpr (std::is_constructible_v<T, std::vector<Expression*>>) {
+    return -1;
+  } else {
+    return count_args<T, Expression*>();
+  }
+}
+/// @}
+
+/// Constructs an expression with the fixed number of arguments.
+template <class T, std::size_t... Is>
+std::unique_ptr<Expression> BuildFixed(const std::vector<Expression*>& args,
+                                       std::index_sequence<Is...>) {
+  if (args.size() != sizeof...(Is))
+    SCRAM_THROW(IOError("Invalid number of expression arguments in cache."));
+  return std::make_unique<T>(args[Is]...);
+}
+
+/// Constructs an expression in the same order of arguments
+/// as the expression has registered.
+template <class T>
+std::unique_ptr<Expression> Build(std::vector<Expression*> args) {
+  if constexpr (num_args<T>() < 0) {
+    return std::make_unique<T>(std::move(args));
+  } else {
+    return BuildFixed<T>(args, std::make_index_sequence<num_args<T>()>());
+  }
+}
+
+/// Specialization due to overloaded constructors.
+template <>
+std::unique_ptr<Expression> Build<LognormalDeviate>(
+    std::vector<Expression*> args) {
+  if (args.size() == 3)
+    return BuildFixed<LognormalDeviate>(args, std::make_index_sequence<3>());
+  return BuildFixed<LognormalDeviate>(args, std::make_index_sequence<2>());
+}
+
+/// Specialization due to overloaded constructors.
+template <>
+std::unique_ptr<Expression> Build<PeriodicTest>(std::vector<Expression*> args) {
+  switch (args.size()) {
+    case 4:
+      return BuildFixed<PeriodicTest>(args, std::make_index_sequence<4>());
+    case 5:
+      return BuildFixed<PeriodicTest>(args, std::make_index_sequence<5>());
+    default:
+      return BuildFixed<PeriodicTest>(args, std::make_index_sequence<11>());
+  }
+}
+
+/// Specialization for boundaries followed by weights.
+template <>
+std::unique_ptr<Expression> Build<Histogram>(std::vector<Expression*> args) {
+  if (args.size() < 3 || args.size() % 2 == 0)
+    SCRAM_THROW(IOError("Invalid number of histogram arguments in cache."));
+  auto midpoint = std::next(args.begin(), args.size() / 2 + 1);
+  return std::make_unique<Histogram>(
+      std::vector<Expression*>(args.begin(), midpoint),
+      std::vector<Expression*>(midpoint, args.end()));
+}
+
+/// Specialization for the default value followed by case conditions and values.
+template <>
+std::unique_ptr<Expression> Build<Switch>(std::vector<Expression*> args) {
+  if (args.size() % 2 == 0)
+    SCRAM_THROW(IOError("Invalid number of switch arguments in cache."));
+  std::vector<Switch::Case> cases;
+  for (auto it = std::next(args.begin()); it != args.end(); it += 2)
+    cases.push_back({**it, **std::next(it)});
+  return std::make_unique<Switch>(std::move(cases), args.front());
+}
+
+/// The built-in expression types with their construction functions.
+/// The position of the type is its tag in the cache.
+const std::pair<std::type_index, BuildFunction> kExpressionTypes[] = {
+    {typeid(Exponential), &Build<Exponential>},
+    {typeid(Glm), &Build<Glm>},
+    {typeid(Weibull), &Build<Weibull>},
+    {typeid(PeriodicTest), &Build<PeriodicTest>},
+    {typeid(UniformDeviate), &Build<UniformDeviate>},
+    {typeid(NormalDeviate), &Build<NormalDeviate>},
+    {typeid(LognormalDeviate), &Build<LognormalDeviate>},
+    {typeid(GammaDeviate), &Build<GammaDeviate>},
+    {typeid(BetaDeviate), &Build<BetaDeviate>},
+    {typeid(Histogram), &Build<Histogram>},
+    {typeid(Neg), &Build<Neg>},
+    {typeid(Add), &Build<Add>},
+    {typeid(Sub), &Build<Sub>},
+    {typeid(Mul), &Build<Mul>},
+    {typeid(Div), &Build<Div>},
+    {typeid(Abs), &Build<Abs>},
+    {typeid(Acos), &Build<Acos>},
+    {typeid(Asin), &Build<Asin>},
+    {typeid(Atan), &Build<Atan>},
+    {typeid(Cos), &Build<Cos>},
+    {typeid(Sin), &Build<Sin>},
+    {typeid(Tan), &Build<Tan>},
+    {typeid(Cosh), &Build<Cosh>},
+    {typeid(Sinh), &Build<Sinh>},
+    {typeid(Tanh), &Build<Tanh>},
+    {typeid(Exp), &Build<Exp>},
+    {typeid(Log), &Build<Log>},
+    {typeid(Log10), &Build<Log10>},
+    {typeid(Mod), &Build<Mod>},
+    {typeid(Pow), &Build<Pow>},
+    {typeid(Sqrt), &Build<Sqrt>},
+    {typeid(Ceil), &Build<Ceil>},
+    {typeid(Floor), &Build<Floor>},
+    {typeid(Min), &Build<Min>},
+    {typeid(Max), &Build<Max>},
+    {typeid(Mean), &Build<Mean>},
+    {typeid(Not), &Build<Not>},
+    {typeid(And), &Build<And>},
+    {typeid(Or), &Build<Or>},
+    {typeid(Eq), &Build<Eq>},
+    {typeid(Df), &Build<Df>},
+    {typeid(Lt), &Build<Lt>},
+    {typeid(Gt), &Build<Gt>},
+    {typeid(Leq), &Build<Leq>},
+    {typeid(Geq), &Build<Geq>},
+    {typeid(Ite), &Build<Ite>},
+    {typeid(Switch), &Build<Switch>}};
+
+/// @returns The tag of the built-in expression type.
+/// @returns -1 if the expression type is not in the table.
+int GetExpressionTag(const Expression& expression) {
+  static const std::unordered_map<std::type_index, int> tags = [] {
+    std::unordered_map<std::type_index, int> result;
+    for (int i = 0; i < std::size(kExpressionTypes); ++i)
+      result.emplace(kExpressionTypes[i].first, i);
+    return result;
+  }();
+  auto it = tags.find(typeid(expression));
+  return it == tags.end() ? -1 : it->second;
+}
+
+}  // namespace
+
+namespace {  // Model snapshot writing and loading.
+
+/// Writes the model constructs into the binary buffer.
+class CacheWriter {
+ public:
+  /// @param[in] model  Fully initialized and valid model.
+  explicit CacheWriter(const Model& model) : model_(model) {}
+
+  /// Writes the complete snapshot.
+  ///
+  /// @param[in] key  The key of the cache.
+  ///
+  /// @returns false if the model has unsupported constructs.
+  bool Write(std::uint64_t key);
+
+  /// @returns The snapshot data.
+  const std::string& buffer() const { return writer_.buffer(); }
+
+ private:
+  /// @returns true if the model has only constructs supported by the cache.
+  bool IsSupported() const {
+    return model_.initiating_events().empty() &&
+           model_.event_trees().empty() && model_.sequences().empty() &&
+           model_.rules().empty() && model_.alignments().empty() &&
+           model_.substitutions().empty() && model_.libraries().empty() &&
+           model_.extern_functions().empty();
+  }
+
+  /// Orders the expression and its arguments in post-order.
+  ///
+  /// @returns false if the expression is unsupported.
+  bool Collect(const Expression* expression);
+
+  /// Writes expression records in the collected order.
+  void WriteExpressions();
+
+  /// Writes the element label and attributes.
+  void WriteElement(const Element& element);
+
+  /// Writes the name, base path, and role of the element
+  /// followed by its label and attributes.
+  void WriteId(const Id& element);
+
+  /// Writes the contents of the component and its sub-components.
+  void WriteComponent(const Component& component);
+
+  /// Writes the position of the construct in its table.
+  template <typename T>
+  void WriteRef(const std::unordered_map<const T*, int>& table, const T* key) {
+    assert(table.count(key) && "Undefined construct.");
+    writer_.Write<std::int32_t>(table.find(key)->second);
+  }
+
+  const Model& model_;  ///< The model to snapshot.
+  Writer writer_;  ///< The binary data.
+  std::vector<const Expression*> expressions_;  ///< Expressions in post-order.
+  std::unordered_map<const Expression*, int> expression_index_;
+  std::unordered_map<const Gate*, int> gate_index_;
+  std::unordered_map<const BasicEvent*, int> basic_event_index_;
+  std::unordered_map<const HouseEvent*, int> house_event_index_;
+  std::unordered_map<const CcfGroup*, int> ccf_group_index_;
+};
+
+bool CacheWriter::Collect(const Expression* expression) {
+  if (expression_index_.count(expression))
+    return true;
+  if (!dynamic_cast<const ConstantExpression*>(expression) &&
+      !dynamic_cast<const Parameter*>(expression) &&
+      expression != &model_.mission_time() &&
+      GetExpressionTag(*expression) < 0) {
+    return false;
+  }
+  for (const Expression* arg : expression->args()) {
+    if (!Collect(arg))
+      return false;
+  }
+  expression_index_.emplace(expression, expressions_.size());
+  expressions_.push_back(expression);
+  return true;
+}
+
+void CacheWriter::WriteExpressions() {
+  writer_.Write<std::uint32_t>(expressions_.size());
+  for (const Expression* expression : expressions_) {
+    if (expression == &ConstantExpression::kOne) {
+      writer_.Write(Record::kOne);
+    } else if (expression == &ConstantExpression::kZero) {
+      writer_.Write(Record::kZero);
+    } else if (expression == &ConstantExpression::kPi) {
+      writer_.Write(Record::kPi);
+    } else if (expression == &model_.mission_time()) {
+      writer_.Write(Record::kMissionTime);
+    } else if (auto* constant =
+                   dynamic_cast<const ConstantExpression*>(expression)) {
+      writer_.Write(Record::kConstant);
+      writer_.Write(const_cast<ConstantExpression*>(constant)->value());
+    } else if (auto* parameter = dynamic_cast<const Parameter*>(expression)) {
+      writer_.Write(Record::kParameter);
+      WriteId(*parameter);
+      writer_.Write(parameter->unit());
+      writer_.Write(parameter->usage());
+      WriteRef(expression_index_, parameter->args().front());
+    } else {
+      writer_.Write(Record::kFormula);
+      writer_.Write<std::uint8_t>(GetExpressionTag(*expression));
+      writer_.Write<std::uint32_t>(expression->args().size());
+      for (const Expression* arg : expression->args())
+        WriteRef(expression_index_, arg);
+    }
+  }
+}
+
+void CacheWriter::WriteElement(const Element& element) {
+  writer_.Write(element.label());
+  writer_.Write<std::uint32_t>(element.attributes().size());
+  for (const Attribute& attribute : element.attributes()) {
+    writer_.Write(attribute.name());
+    writer_.Write(attribute.value());
+    writer_.Write(attribute.type());
+  }
+}
+
+void CacheWriter::WriteId(const Id& element) {
+  writer_.Write(element.name());
+  writer_.Write(element.base_path());
+  writer_.Write(element.role());
+  WriteElement(element);
+}
+
+void CacheWriter::WriteComponent(const Component& component) {
+  writer_.Write(component.name());
+  writer_.Write(component.base_path());
+  writer_.Write(component.role());
+  WriteElement(component);
+
+  auto write_refs = [this](const auto& range, const auto& table) {
+    writer_.Write<std::uint32_t>(range.size());
+    for (const auto& element : range)
+      WriteRef(table, &element);
+  };
+  write_refs(component.gates(), gate_index_);
+  write_refs(component.basic_events(), basic_event_index_);
+  write_refs(component.house_events(), house_event_index_);
+  writer_.Write<std::uint32_t>(component.parameters().size());
+  for (const Parameter& parameter : component.parameters())
+    WriteRef<Expression>(expression_index_, &parameter);
+  write_refs(component.ccf_groups(), ccf_group_index_);
+
+  writer_.Write<std::uint32_t>(component.components().size());
+  for (const Component& sub_component : component.components())
+    WriteComponent(sub_component);
+}
+
+bool CacheWriter::Write(std::uint64_t key) {
+  if (!IsSupported())
+    return false;
+  for (const Parameter& parameter : model_.parameters()) {
+    if (!Collect(&parameter))
+      return false;
+  }
+  for (const BasicEvent& basic_event : model_.basic_events()) {
+    if (basic_event.HasExpression() && !Collect(&basic_event.expression()))
+      return false;
+  }
+  for (const CcfGroup& ccf_group : model_.ccf_groups()) {
+    if (!Collect(ccf_group.distribution()))
+      return false;
+    for (const auto& factor : ccf_group.factors()) {
+      if (!Collect(factor.second))
+        return false;
+    }
+  }
+
+  writer_.Write(kSignature, sizeof(kSignature));
+  writer_.Write(kVersion);
+  writer_.Write(key);
+  writer_.Write(model_.GetOptionalName());
+  WriteElement(model_);
+  WriteExpressions();
+
+  writer_.Write<std::uint32_t>(model_.house_events().size());
+  for (const HouseEvent& house_event : model_.house_events()) {
+    house_event_index_.emplace(&house_event, house_event_index_.size());
+    WriteId(house_event);
+    writer_.Write(house_event.usage());
+    writer_.Write(house_event.state());
+  }
+
+  writer_.Write<std::uint32_t>(model_.basic_events().size());
+  for (const BasicEvent& basic_event : model_.basic_events()) {
+    basic_event_index_.emplace(&basic_event, basic_event_index_.size());
+    WriteId(basic_event);
+    writer_.Write(basic_event.usage());
+    writer_.Write(basic_event.HasExpression());
+    if (basic_event.HasExpression())
+      WriteRef(expression_index_, &basic_event.expression());
+  }
+
+  writer_.Write<std::uint32_t>(model_.gates().size());
+  for (const Gate& gate : model_.gates()) {
+    gate_index_.emplace(&gate, gate_index_.size());
+    WriteId(gate);
+    writer_.Write(gate.usage());
+  }
+  for (const Gate& gate : model_.gates()) {
+    const Formula& formula = gate.formula();
+    writer_.Write(formula.connective());
+    writer_.Write<std::int32_t>(formula.min_number().value_or(-1));
+    writer_.Write<std::int32_t>(formula.max_number().value_or(-1));
+    writer_.Write<std::uint32_t>(formula.args().size());
+    for (const Formula::Arg& arg : formula.args()) {
+      writer_.Write(arg.complement);
+      writer_.Write(static_cast<ArgKind>(arg.event.index()));
+      std::visit(
+          [this](const auto* event) {
+            using T = std::decay_t<decltype(*event)>;
+            if constexpr (std::is_same_v<T, Gate>) {
+              WriteRef(gate_index_, event);
+            } else if constexpr (std::is_same_v<T, BasicEvent>) {
+              WriteRef(basic_event_index_, event);
+            } else {
+              WriteRef(house_event_index_, event);
+            }
+          },
+          arg.event);
+    }
+  }
+
+  writer_.Write<std::uint32_t>(model_.ccf_groups().size());
+  for (const CcfGroup& ccf_group : model_.ccf_groups()) {
+    ccf_group_index_.emplace(&ccf_group, ccf_group_index_.size());
+    if (dynamic_cast<const BetaFactorModel*>(&ccf_group)) {
+      writer_.Write(CcfModel::kBetaFactor);
+    } else if (dynamic_cast<const MglModel*>(&ccf_group)) {
+      writer_.Write(CcfModel::kMgl);
+    } else if (dynamic_cast<const AlphaFactorModel*>(&ccf_group)) {
+      writer_.Write(CcfModel::kAlphaFactor);
+    } else {
+      assert(dynamic_cast<const PhiFactorModel*>(&ccf_group));
+      writer_.Write(CcfModel::kPhiFactor);
+    }
+    WriteId(ccf_group);
+    writer_.Write<std::uint32_t>(ccf_group.members().size());
+    for (const BasicEvent* member : ccf_group.members())
+      WriteRef(basic_event_index_, member);
+    WriteRef(expression_index_, ccf_group.distribution());
+    writer_.Write<std::uint32_t>(ccf_group.factors().size());
+    for (const auto& [level, factor] : ccf_group.factors()) {
+      writer_.Write<std::int32_t>(level);
+      WriteRef(expression_index_, factor);
+    }
+  }
+
+  writer_.Write<std::uint32_t>(model_.fault_trees().size());
+  for (const FaultTree& fault_tree : model_.fault_trees())
+    WriteComponent(fault_tree);
+  return true;
+}
+
+/// Reconstructs the model from the binary data.
+class CacheLoader {
+ public:
+  /// @param[in] data  The snapshot data.
+  /// @param[in] header_size  The size of the already checked header.
+  CacheLoader(const std::string& data, std::size_t header_size)
+      : reader_(data, header_size) {}
+
+  /// Loads the model constructs.
+  ///
+  /// @returns The model with all the constructs defined.
+  ///
+  /// @throws Error  The data is corrupted.
+  std::unique_ptr<Model> Load();
+
+ private:
+  /// Loads the element label and attributes.
+  void LoadElement(Element* element);
+
+  /// Loads the element with an id.
+  template <class T>
+  std::unique_ptr<T> LoadId() {
+    std::string name = reader_.ReadString();
+    std::string base_path = reader_.ReadString();
+    auto element = std::make_unique<T>(std::move(name), std::move(base_path),
+                                       ReadRole());
+    LoadElement(element.get());
+    return element;
+  }
+
+  /// @returns The role specifier.
+  RoleSpecifier ReadRole() {
+    auto role = reader_.Read<RoleSpecifier>();
+    if (role != RoleSpecifier::kPublic && role != RoleSpecifier::kPrivate)
+      SCRAM_THROW(IOError("Invalid role specifier in the model cache."));
+    return role;
+  }
+
+  /// Loads the expression records.
+  void LoadExpressions();
+
+  /// Loads the component contents and its sub-components.
+  void LoadComponent(Component* component);
+
+  Reader reader_;  ///< The consumer of the snapshot data.
+  Model* model_ = nullptr;  ///< The model under construction.
+  std::vector<Expression*> expressions_;
+  std::vector<Parameter*> parameters_;  ///< Parallel to the expressions.
+  std::vector<Gate*> gates_;
+  std::vector<BasicEvent*> basic_events_;
+  std::vector<HouseEvent*> house_events_;
+  std::vector<CcfGroup*> ccf_groups_;
+};
+
+void CacheLoader::LoadElement(Element* element) {
+  element->label(reader_.ReadString());
+  for (auto n = reader_.Read<std::uint32_t>(); n; --n) {
+    std::string name = reader_.ReadString();
+    std::string value = reader_.ReadString();
+    element->AddAttribute(
+        {std::move(name), std::move(value), reader_.ReadString()});
+  }
+}
+
+void CacheLoader::LoadExpressions() {
+  for (auto n = reader_.Read<std::uint32_t>(); n; --n) {
+    Expression* expression = nullptr;
+    Parameter* parameter = nullptr;
+    switch (reader_.Read<Record>()) {
+      case Record::kConstant: {
+        auto constant =
+            std::make_unique<ConstantExpression>(reader_.Read<double>());
+        expression = constant.get();
+        model_->Add(std::move(constant));
+        break;
+      }
+      case Record::kOne:
+        expression = &ConstantExpression::kOne;
+        break;
+      case Record::kZero:
+        expression = &ConstantExpression::kZero;
+        break;
+      case Record::kPi:
+        expression = &ConstantExpression::kPi;
+        break;
+      case Record::kMissionTime:
+        expression = &model_->mission_time();
+        break;
+      case Record::kParameter: {
+        auto element = LoadId<Parameter>();
+        auto unit = reader_.Read<Units>();
+        if (unit >= kNumUnits)
+          SCRAM_THROW(IOError("Invalid parameter unit in the model cache."));
+        element->unit(unit);
+        element->usage(reader_.Read<bool>());
+        element->expression(reader_.ReadRef(expressions_));
+        expression = parameter = element.get();
+        model_->Add(std::move(element));
+        break;
+      }
+      case Record::kFormula: {
+        auto tag = reader_.Read<std::uint8_t>();
+        if (tag >= std::size(kExpressionTypes))
+          SCRAM_THROW(IOError("Invalid expression type in the model cache."));
+        std::vector<Expression*> args;
+        for (auto num_args = reader_.Read<std::uint32_t>(); num_args;
+             --num_args) {
+          args.push_back(reader_.ReadRef(expressions_));
+        }
+        auto formula = kExpressionTypes[tag].second(std::move(args));
+        expression = formula.get();
+        model_->Add(std::move(formula));
+        break;
+      }
+      default:
+        SCRAM_THROW(IOError("Invalid expression record in the model cache."));
+    }
+    expressions_.push_back(expression);
+    parameters_.push_back(parameter);
+  }
+}
+
+void CacheLoader::LoadComponent(Component* component) {
+  auto load_refs = [this](const auto& constructs, auto add) {
+    for (auto n = reader_.Read<std::uint32_t>(); n; --n) {
+      auto* element = reader_.ReadRef(constructs);
+      if (!element)
+        SCRAM_THROW(IOError("Invalid reference in the model cache."));
+      add(element);
+    }
+  };
+  auto add = [component](auto* element) { component->Add(element); };
+  load_refs(gates_, add);
+  load_refs(basic_events_, add);
+  load_refs(house_events_, add);
+  load_refs(parameters_, add);
+  load_refs(ccf_groups_, add);
+
+  for (auto n = reader_.Read<std::uint32_t>(); n; --n) {
+    std::string name = reader_.ReadString();
+    std::string base_path = reader_.ReadString();
+    auto sub_component = std::make_unique<Component>(
+        std::move(name), std::move(base_path), ReadRole());
+    LoadElement(sub_component.get());
+    LoadComponent(sub_component.get());
+    component->Add(std::move(sub_component));
+  }
+}
+
+std::unique_ptr<Model> CacheLoader::Load() {
+  auto model = std::make_unique<Model>(reader_.ReadString());
+  model_ = model.get();
+  LoadElement(model_);
+  LoadExpressions();
+
+  for (auto n = reader_.Read<std::uint32_t>(); n; --n) {
+    auto house_event = LoadId<HouseEvent>();
+    house_event->usage(reader_.Read<bool>());
+    house_event->state(reader_.Read<bool>());
+    house_events_.push_back(house_event.get());
+    model_->Add(std::move(house_event));
+  }
+
+  for (auto n = reader_.Read<std::uint32_t>(); n; --n) {
+    auto basic_event = LoadId<BasicEvent>();
+    basic_event->usage(reader_.Read<bool>());
+    if (reader_.Read<bool>())
+      basic_event->expression(reader_.ReadRef(expressions_));
+    basic_events_.push_back(basic_event.get());
+    model_->Add(std::move(basic_event));
+  }
+
+  for (auto n = reader_.Read<std::uint32_t>(); n; --n) {
+    auto gate = LoadId<Gate>();
+    gate->usage(reader_.Read<bool>());
+    gates_.push_back(gate.get());
+    model_->Add(std::move(gate));
+  }
+  for (Gate* gate : gates_) {
+    auto connective = reader_.Read<Connective>();
+    if (connective >= kNumConnectives)
+      SCRAM_THROW(IOError("Invalid connective in the model cache."));
+    auto min_number = reader_.Read<std::int32_t>();
+    auto max_number = reader_.Read<std::int32_t>();
+    Formula::ArgSet args;
+    for (auto n = reader_.Read<std::uint32_t>(); n; --n) {
+      bool complement = reader_.Read<bool>();
+      switch (reader_.Read<ArgKind>()) {
+        case ArgKind::kGate:
+          args.Add(reader_.ReadRef(gates_), complement);
+          break;
+        case ArgKind::kBasicEvent:
+          args.Add(reader_.ReadRef(basic_events_), complement);
+          break;
+        case ArgKind::kHouseEvent:
+          args.Add(reader_.ReadRef(house_events_), complement);
+          break;
+        default:
+          SCRAM_THROW(IOError("Invalid formula argument in the model cache."));
+      }
+    }
+    auto as_optional = [](int number) -> std::optional<int> {
+      if (number < 0)
+        return {};
+      return number;
+    };
+    gate->formula(std::make_unique<Formula>(connective, std::move(args),
+                                            as_optional(min_number),
+                                            as_optional(max_number)));
+  }
+
+  for (auto n = reader_.Read<std::uint32_t>(); n; --n) {
+    std::unique_ptr<CcfGroup> ccf_group;
+    switch (reader_.Read<CcfModel>()) {
+      case CcfModel::kBetaFactor:
+        ccf_group = LoadId<BetaFactorModel>();
+        break;
+      case CcfModel::kMgl:
+        ccf_group = LoadId<MglModel>();
+        break;
+      case CcfModel::kAlphaFactor:
+        ccf_group = LoadId<AlphaFactorModel>();
+        break;
+      case CcfModel::kPhiFactor:
+        ccf_group = LoadId<PhiFactorModel>();
+        break;
+      default:
+        SCRAM_THROW(IOError("Invalid CCF model in the model cache."));
+    }
+    for (auto num_members = reader_.Read<std::uint32_t>(); num_members;
+         --num_members) {
+      ccf_group->AddMember(reader_.ReadRef(basic_events_));
+    }
+    ccf_group->AddDistribution(reader_.ReadRef(expressions_));
+    for (auto num_factors = reader_.Read<std::uint32_t>(); num_factors;
+         --num_factors) {
+      auto level = reader_.Read<std::int32_t>();
+      ccf_group->AddFactor(reader_.ReadRef(expressions_), level);
+    }
+    ccf_groups_.push_back(ccf_group.get());
+    model_->Add(std::move(ccf_group));
+  }
+
+  for (auto n = reader_.Read<std::uint32_t>(); n; --n) {
+    auto fault_tree = std::make_unique<FaultTree>(reader_.ReadString());
+    reader_.ReadString();  // The empty base path.
+    ReadRole();
+    LoadElement(fault_tree.get());
+    LoadComponent(fault_tree.get());
+    model_->Add(std::move(fault_tree));
+  }
+
+  if (!reader_.done())
+    SCRAM_THROW(IOError("Unexpected trailing data in the model cache."));
+  return model;
+}
+
+}  // namespace
+
+std::uint64_t ComputeCacheKey(const std::vector<std::string>& xml_files,
+                              const core::Settings& settings) {
+  ext::fnv1a hash;
+  hash.update(kVersion);
+  hash.update(settings.probability_analysis());
+  hash.update<std::uint64_t>(settings.targets().size());
+  for (const std::string& target : settings.targets()) {
+    hash.update<std::uint64_t>(target.size());
+    hash.update(target.data(), target.size());
+  }
+  hash.update<std::uint64_t>(xml_files.size());
+  for (const std::string& xml_file : xml_files) {
+    std::ifstream in(xml_file, std::ios::binary);
+    if (!in) {
+      SCRAM_THROW(IOError("Input file doesn't exist."))
+          << boost::errinfo_file_name(xml_file);
+    }
+    std::string content((std::istreambuf_iterator<char>(in)),
+                        std::istreambuf_iterator<char>());
+    hash.update<std::uint64_t>(content.size());
+    hash.update(content.data(), content.size());
+  }
+  return hash.value();
+}
+
+std::unique_ptr<Model> LoadCache(const std::string& file, std::uint64_t key,
+                                 const core::Settings& settings) {
+  CLOCK(load_time);
+  std::ifstream in(file, std::ios::binary);
+  if (!in) {
+    LOG(DEBUG1) << "The model cache " << file << " is not found";
+    return nullptr;
+  }
+  std::string data((std::istreambuf_iterator<char>(in)),
+                   std::istreambuf_iterator<char>());
+  const std::size_t header_size =
+      sizeof(kSignature) + sizeof(kVersion) + sizeof(key);
+  if (data.size() < header_size ||
+      std::memcmp(data.data(), kSignature, sizeof(kSignature)) ||
+      std::memcmp(data.data() + sizeof(kSignature), &kVersion,
+                  sizeof(kVersion)) ||
+      std::memcmp(data.data() + sizeof(kSignature) + sizeof(kVersion), &key,
+                  sizeof(key))) {
+    LOG(DEBUG1) << "The model cache " << file << " is stale";
+    return nullptr;
+  }
+  std::unique_ptr<Model> model;
+  try {
+    model = CacheLoader(data, header_size).Load();
+  } catch (const Error& err) {
+    LOG(WARNING) << "Ignoring the corrupted model cache " << file << ": "
+                 << err.what();
+    return nullptr;
+  }
+  model->mission_time().value(settings.mission_time());
+  for (FaultTree& fault_tree : model->table<FaultTree>())
+    fault_tree.CollectTopEvents();
+  for (CcfGroup& ccf_group : model->table<CcfGroup>()) {
+    ccf_group.ApplyModel();
+    if (settings.ccf_analysis())
+      ccf_group.GenerateEvents(settings.ccf_expansion_limit());
+  }
+  LOG(DEBUG1) << "Loaded the model cache " << file << " in "
+              << DUR(load_time);
+  return model;
+}
+
+bool WriteCache(const Model& model, const std::string& file,
+                std::uint64_t key) {
+  CacheWriter writer(model);
+  if (!writer.Write(key)) {
+    LOG(WARNING) << "The model has constructs unsupported by the model cache";
+    return false;
+  }
+  // The snapshot replaces the old cache only after a successful write.
+  std::string temp_file = file + ".tmp";
+  {
+    std::ofstream out(temp_file, std::ios::binary);
+    out.write(writer.buffer().data(), writer.buffer().size());
+    if (!out) {
+      SCRAM_THROW(IOError("Cannot write the model cache."))
+          << boost::errinfo_file_name(file)
+          << boost::errinfo_file_open_mode("wb");
+    }
+  }
+  boost::system::error_code error;
+  boost::filesystem::rename(temp_file, file, error);
+  if (error) {
+    SCRAM_THROW(IOError("Cannot replace the model cache."))
+        << boost::errinfo_file_name(file);
+  }
+  return true;
+}
+
+}  // namespace scram::mef
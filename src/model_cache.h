@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2014-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Binary snapshots of initialized models
+/// to skip XML parsing, validation, and initialization on reload.
+///
+/// The snapshot is keyed by the contents of the input files
+/// and the settings that affect the initialization.
+/// The format is specific to the host (byte order and type sizes).
+///
+/// @note The cache caters only fault tree models
+///       (fault trees, components, events, parameters, CCF groups,
+///       and built-in expressions).
+///
+/// @warning Files included with XInclude are not part of the key.
+
+#pragma once
+
+#include <cstdint>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model.h"
+#include "settings.h"
+
+namespace scram::mef {
+
+/// Computes the key of the model cache.
+///
+/// @param[in] xml_files  The MEF XML input files in the input order.
+/// @param[in] settings  The analysis settings for the initialization.
+///
+/// @returns The hash of the input contents and the cache format.
+///
+/// @throws IOError  One of the input files is not accessible.
+std::uint64_t ComputeCacheKey(const std::vector<std::string>& xml_files,
+                              const core::Settings& settings);
+
+/// Loads the model from the cache file.
+///
+/// @param[in] file  The cache file.
+/// @param[in] key  The expected key of the cache.
+/// @param[in] settings  The analysis settings for the initialization.
+///
+/// @returns The fully initialized model.
+/// @returns nullptr if the cache is missing, stale, or corrupted.
+std::unique_ptr<Model> LoadCache(const std::string& file, std::uint64_t key,
+                                 const core::Settings& settings);
+
+/// Writes the snapshot of the model into the cache file.
+///
+/// @param[in] model  Fully initialized and valid model.
+/// @param[in] file  The cache file.
+/// @param[in] key  The key of the cache.
+///
+/// @returns false if the model has constructs unsupported by the cache.
+///
+/// @throws IOError  The cache file is not accessible for writing.
+bool WriteCache(const Model& model, const std::string& file,
+                std::uint64_t key);
+
+}  // namespace scram::mef
@@ -0,0 +1,409 @@
+/*
+ * Copyright (C) 2014-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the bit-parallel direct Monte Carlo simulation.
+///
+/// The scenarios are simulated in blocks of words.
+/// Each block has its own pseudo-random number generator
+/// seeded by the block number,
+/// so the results do not depend on the number of worker threads.
+
+#include "monte_carlo.h"
+
+#include <cmath>
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <random>
+
+#include "logger.h"
+#include "parallel.h"
+
+namespace scram::core {
+
+namespace {
+
+const int kBlockWords = 16;  ///< The number of words in a simulation block.
+const MonteCarlo::Word kAllOnes = ~MonteCarlo::Word(0);  ///< All scenarios.
+
+/// @returns The number of scenarios set in the word.
+int Count(MonteCarlo::Word word) {
+  return std::bitset<MonteCarlo::kWordSize>(word).count();
+}
+
+/// Samples independent Bernoulli draws into words.
+/// The gaps between successes are drawn from the geometric distribution,
+/// so the cost is proportional to the number of rare outcomes
+/// rather than the number of scenarios.
+///
+/// @param[in] p  The probability of success.
+/// @param[out] words  The destination words.
+/// @param[in] num_words  The number of words to fill.
+/// @param[in,out] rng  The pseudo-random number generator.
+void Sample(double p, MonteCarlo::Word* words, int num_words,
+            std::mt19937_64* rng) noexcept {
+  if (p <= 0 || p >= 1) {
+    std::fill_n(words, num_words, p <= 0 ? 0 : kAllOnes);
+    return;
+  }
+  bool inverse = p > 0.5;  // Sample the rarer outcome.
+  std::fill_n(words, num_words, 0);
+  std::int64_t num_bits =
+      static_cast<std::int64_t>(num_words) * MonteCarlo::kWordSize;
+  // The geometric gaps are drawn by inversion
+  // and saturated at the number of bits
+  // because the gaps of tiny probabilities overflow the integer type.
+  double log_q = std::log1p(-(inverse ? 1 - p : p));
+  std::uniform_real_distribution<double> uniform;
+  auto gap = [&uniform, log_q, num_bits, rng] {
+    double draw = std::floor(std::log1p(-uniform(*rng)) / log_q);
+    return draw < num_bits ? static_cast<std::int64_t>(draw) : num_bits;
+  };
+  for (std::int64_t pos = gap(); pos < num_bits; pos += 1 + gap()) {
+    words[pos / MonteCarlo::kWordSize] |= MonteCarlo::Word(1)
+                                          << (pos % MonteCarlo::kWordSize);
+  }
+  if (inverse) {
+    for (int i = 0; i < num_words; ++i)
+      words[i] = ~words[i];
+  }
+}
+
+}  // namespace
+
+/// The simulation results
+/// as sums of outcomes over scenarios.
+struct MonteCarlo::Tally {
+  std::int64_t top = 0;  ///< The number of scenarios with the true graph.
+  std::vector<std::int64_t> mif;  ///< Sums of importance differences by slot.
+  /// Sums of squared importance differences by slot.
+  std::vector<std::int64_t> mif_squares;
+
+  /// Adds the counts of another tally.
+  ///
+  /// @param[in] other  The tally with the same layout.
+  void Merge(const Tally& other) noexcept {
+    top += other.top;
+    assert(mif.size() == other.mif.size() && "Mismatched tally layouts.");
+    for (std::size_t i = 0; i < other.mif.size(); ++i) {
+      mif[i] += other.mif[i];
+      mif_squares[i] += other.mif_squares[i];
+    }
+  }
+};
+
+/// The evaluator of the program on blocks of scenarios.
+class MonteCarlo::Worker {
+ public:
+  /// @param[in] host  The simulator with the compiled program.
+  /// @param[in] importance  The flag to estimate marginal importance.
+  Worker(const MonteCarlo& host, bool importance) noexcept
+      : host_(host), values_(host.num_slots_ * kBlockWords) {
+    tally_.mif.resize(importance ? host.num_slots_ : 0);
+    tally_.mif_squares.resize(tally_.mif.size());
+    if (importance) {
+      forced_.resize(values_.size());
+      dirty_.resize(host.num_slots_);
+    }
+    int max_number = 1;
+    for (const Instruction& instruction : host.program_) {
+      if (instruction.type == kAtleast)
+        max_number = std::max(max_number, instruction.min_number);
+    }
+    counters_.resize(max_number * kBlockWords);
+  }
+
+  /// @returns The accumulated results of the worker.
+  const Tally& tally() const { return tally_; }
+
+  /// Simulates a block of scenarios.
+  ///
+  /// @param[in] block  The block number.
+  /// @param[in] seed  The base seed of the simulation.
+  /// @param[in] p_vars  The probabilities of the variables.
+  void operator()(int block, std::uint64_t seed,
+                  const Pdag::IndexMap<double>& p_vars) noexcept {
+    int num_words =
+        std::min(kBlockWords, host_.num_words_ - block * kBlockWords);
+    std::seed_seq seeds{seed, static_cast<std::uint64_t>(block)};
+    std::mt19937_64 rng(seeds);
+
+    std::fill_n(values_.begin(), kBlockWords, kAllOnes);  // The constant.
+    for (const std::pair<int, int>& variable : host_.variables_)
+      Sample(p_vars[variable.second], Values(variable.first), num_words, &rng);
+    auto source = [this](int slot) -> const Word* { return Values(slot); };
+    for (const Instruction& instruction : host_.program_)
+      Evaluate(instruction, Values(instruction.slot), source, num_words);
+
+    Word mask = host_.root_complement_ ? kAllOnes : 0;
+    const Word* top = Values(host_.root_slot_);
+    for (int i = 0; i < num_words; ++i)
+      tally_.top += Count(top[i] ^ mask);
+
+    if (!tally_.mif.empty()) {
+      for (const std::pair<int, int>& variable : host_.variables_)
+        EvaluateImportance(variable.first, num_words);
+    }
+  }
+
+ private:
+  /// @returns The values of the slot.
+  Word* Values(int slot) { return &values_[slot * kBlockWords]; }
+
+  /// @returns The values of the slot under the forced variable state.
+  Word* Forced(int slot) { return &forced_[slot * kBlockWords]; }
+
+  /// Evaluates an instruction with bitwise kernels.
+  ///
+  /// @tparam T  The provider of argument values by slots.
+  ///
+  /// @param[in] instruction  The gate instruction.
+  /// @param[out] out  The destination words.
+  /// @param[in] source  The provider of argument words.
+  /// @param[in] num_words  The number of words in the block.
+  template <class T>
+  void Evaluate(const Instruction& instruction, Word* out, const T& source,
+                int num_words) noexcept {
+    auto fold = [&instruction, &out, &source, num_words](Word init,
+                                                         auto&& op) {
+      std::fill_n(out, num_words, init);
+      for (const Arg& arg : instruction.args) {
+        const Word* in = source(arg.slot);
+        Word mask = arg.complement ? kAllOnes : 0;
+        for (int i = 0; i < num_words; ++i)
+          out[i] = op(out[i], in[i] ^ mask);
+      }
+    };
+    auto invert = [&out, num_words] {
+      for (int i = 0; i < num_words; ++i)
+        out[i] = ~out[i];
+    };
+    switch (instruction.type) {
+      case kAnd:
+      case kNand:
+        fold(kAllOnes, [](Word x, Word y) { return x & y; });
+        if (instruction.type == kNand)
+          invert();
+        break;
+      case kOr:
+      case kNor:
+        fold(0, [](Word x, Word y) { return x | y; });
+        if (instruction.type == kNor)
+          invert();
+        break;
+      case kXor:
+        fold(0, [](Word x, Word y) { return x ^ y; });
+        break;
+      case kNull:
+      case kNot:
+        assert(instruction.args.size() == 1 && "Single arg gates.");
+        fold(kAllOnes, [](Word x, Word y) { return x & y; });
+        if (instruction.type == kNot)
+          invert();
+        break;
+      case kAtleast: {
+        // Bit-sliced saturating counters:
+        // counter[j] holds the scenarios with at least (j + 1) true args.
+        int k = instruction.min_number;
+        std::fill_n(counters_.begin(), k * kBlockWords, 0);
+        for (const Arg& arg : instruction.args) {
+          const Word* in = source(arg.slot);
+          Word mask = arg.complement ? kAllOnes : 0;
+          for (int j = k - 1; j > 0; --j) {
+            Word* counter = &counters_[j * kBlockWords];
+            const Word* lower = &counters_[(j - 1) * kBlockWords];
+            for (int i = 0; i < num_words; ++i)
+              counter[i] |= lower[i] & (in[i] ^ mask);
+          }
+          for (int i = 0; i < num_words; ++i)
+            counters_[i] |= in[i] ^ mask;
+        }
+        std::copy_n(&counters_[(k - 1) * kBlockWords], num_words, out);
+        break;
+      }
+    }
+  }
+
+  /// Accumulates the marginal importance of a variable
+  /// by re-evaluating only the gates affected by the variable.
+  ///
+  /// @param[in] var_slot  The slot of the variable.
+  /// @param[in] num_words  The number of words in the block.
+  void EvaluateImportance(int var_slot, int num_words) noexcept {
+    Word top[2][kBlockWords];
+    auto source = [this](int slot) -> const Word* {
+      return dirty_[slot] ? Forced(slot) : Values(slot);
+    };
+    for (int state = 0; state < 2; ++state) {
+      std::fill(dirty_.begin(), dirty_.end(), false);
+      dirty_[var_slot] = true;
+      std::fill_n(Forced(var_slot), num_words, state ? kAllOnes : 0);
+      for (const Instruction& instruction : host_.program_) {
+        if (std::none_of(instruction.args.begin(), instruction.args.end(),
+                         [this](const Arg& arg) { return dirty_[arg.slot]; }))
+          continue;
+        Evaluate(instruction, Forced(instruction.slot), source, num_words);
+        dirty_[instruction.slot] = true;
+      }
+      std::copy_n(source(host_.root_slot_), num_words, top[state]);
+    }
+    for (int i = 0; i < num_words; ++i) {
+      // The complement of the root negates the difference.
+      int difference = Count(top[1][i]) - Count(top[0][i]);
+      tally_.mif[var_slot] +=
+          host_.root_complement_ ? -difference : difference;
+      tally_.mif_squares[var_slot] += Count(top[1][i] ^ top[0][i]);
+    }
+  }
+
+  const MonteCarlo& host_;  ///< The simulator with the program.
+  Tally tally_;  ///< The accumulated results.
+  std::vector<Word> values_;  ///< Values of slots in the current block.
+  std::vector<Word> forced_;  ///< Values under the forced variable state.
+  std::vector<char> dirty_;  ///< The slots affected by the forced variable.
+  std::vector<Word> counters_;  ///< Scratch counters for K/N gates.
+};
+
+MonteCarlo::MonteCarlo(const Pdag* graph, const Settings& settings) noexcept
+    : graph_(graph),
+      kSettings_(settings),
+      num_words_((settings.num_trials() + kWordSize - 1) / kWordSize),
+      num_slots_(1),  // The constant slot.
+      root_complement_(graph->complement()) {
+  std::unordered_map<int, int> gate_slots;
+  Pdag::IndexMap<int> var_slots(graph->basic_events().size());
+  root_slot_ = Compile(graph->root(), &gate_slots, &var_slots);
+  LOG(DEBUG3) << "Compiled the simulation program with " << program_.size()
+              << " gates and " << variables_.size() << " variables";
+}
+
+int MonteCarlo::Compile(const Gate& gate,
+                        std::unordered_map<int, int>* gate_slots,
+                        Pdag::IndexMap<int>* var_slots) noexcept {
+  if (auto it = gate_slots->find(gate.index()); it != gate_slots->end())
+    return it->second;
+
+  Instruction instruction{gate.type(), gate.min_number(), 0, {}};
+  instruction.args.reserve(gate.args().size());
+  if (gate.constant()) {
+    assert(gate.args().size() == 1 && "Constant args must be cleaned.");
+    instruction.args.push_back({0, *gate.args().begin() < 0});
+  }
+  for (const auto& arg : gate.args<Variable>()) {
+    int& slot = (*var_slots)[arg.second.index()];
+    if (!slot) {  // The constant slot is never assigned to variables.
+      slot = num_slots_++;
+      variables_.emplace_back(slot, arg.second.index());
+    }
+    instruction.args.push_back({slot, arg.first < 0});
+  }
+  for (const auto& arg : gate.args<Gate>()) {
+    instruction.args.push_back(
+        {Compile(arg.second, gate_slots, var_slots), arg.first < 0});
+  }
+  instruction.slot = num_slots_++;
+  gate_slots->emplace(gate.index(), instruction.slot);
+  program_.push_back(std::move(instruction));
+  return program_.back().slot;
+}
+
+Pdag::IndexMap<int> MonteCarlo::occurrences() const noexcept {
+  std::vector<int> slot_indices(num_slots_);
+  for (const std::pair<int, int>& variable : variables_)
+    slot_indices[variable.first] = variable.second;
+  Pdag::IndexMap<int> result(graph_->basic_events().size());
+  for (const Instruction& instruction : program_) {
+    for (const Arg& arg : instruction.args) {
+      if (slot_indices[arg.slot])
+        result[slot_indices[arg.slot]]++;
+    }
+  }
+  return result;
+}
+
+MonteCarlo::Tally MonteCarlo::Run(const Pdag::IndexMap<double>& p_vars,
+                                  bool importance) noexcept {
+  int num_blocks = (num_words_ + kBlockWords - 1) / kBlockWords;
+  std::uint64_t seed = kSettings_.seed() >= 0 ? kSettings_.seed()
+                                              : std::random_device{}();
+  int num_threads = NumParallelThreads(num_blocks);
+
+  std::vector<Worker> workers;
+  workers.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i)
+    workers.emplace_back(*this, importance);
+
+  std::atomic<int> next_block(0);
+  // Each task owns its worker and takes the blocks left by the others.
+  ParallelFor(num_threads, [&next_block, num_blocks, seed, &p_vars,
+                            &workers](int i) {
+    for (int block = next_block++; block < num_blocks; block = next_block++)
+      workers[i](block, seed, p_vars);
+  });
+
+  Tally tally = workers.front().tally();
+  for (int i = 1; i < num_threads; ++i)
+    tally.Merge(workers[i].tally());
+  return tally;
+}
+
+MonteCarlo::Estimate
+MonteCarlo::Simulate(const Pdag::IndexMap<double>& p_vars) noexcept {
+  CLOCK(sim_time);
+  LOG(DEBUG4) << "Simulating " << num_trials() << " scenarios...";
+  Tally tally = Run(p_vars, /*importance=*/false);
+  // Bernoulli outcomes are equal to their squares.
+  Estimate estimate = MakeEstimate(tally.top, tally.top, num_trials(), 0, 1);
+  LOG(DEBUG4) << "Estimated probability " << estimate.mean << " in "
+              << DUR(sim_time);
+  return estimate;
+}
+
+Pdag::IndexMap<MonteCarlo::Estimate>
+MonteCarlo::SimulateImportance(const Pdag::IndexMap<double>& p_vars) noexcept {
+  CLOCK(sim_time);
+  LOG(DEBUG4) << "Simulating importance on " << num_trials() << " scenarios...";
+  Tally tally = Run(p_vars, /*importance=*/true);
+  Pdag::IndexMap<Estimate> result(graph_->basic_events().size(),
+                                  Estimate{0, 0, {0, 0}});
+  for (const std::pair<int, int>& variable : variables_) {
+    result[variable.second] =
+        MakeEstimate(tally.mif[variable.first],
+                     tally.mif_squares[variable.first], num_trials(), -1, 1);
+  }
+  LOG(DEBUG4) << "Estimated importance in " << DUR(sim_time);
+  return result;
+}
+
+MonteCarlo::Estimate MonteCarlo::MakeEstimate(double sum, double sum_squares,
+                                              double num_trials,
+                                              double min_value,
+                                              double max_value) noexcept {
+  assert(num_trials > 0 && "No trials for the estimate.");
+  const double kZ95 = 1.96;  // The 97.5% quantile of the standard normal.
+  double mean = sum / num_trials;
+  double variance = std::max(0.0, sum_squares / num_trials - mean * mean);
+  double sigma = std::sqrt(variance / num_trials);
+  return {mean,
+          sigma,
+          {std::max(min_value, mean - kZ95 * sigma),
+           std::min(max_value, mean + kZ95 * sigma)}};
+}
+
+}  // namespace scram::core
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2014-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Direct Monte Carlo simulation of PDAGs.
+/// The simulation does not go through products;
+/// instead, the gate network is evaluated directly
+/// on many random scenarios at once.
+/// Each bit of a machine word is a separate scenario,
+/// so Boolean connectives become bitwise operations over words.
+
+#pragma once
+
+#include <cstdint>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "pdag.h"
+#include "settings.h"
+
+namespace scram::core {
+
+/// Bit-parallel direct Monte Carlo simulator of PDAGs.
+///
+/// The graph is compiled into a flat program of gate instructions
+/// in topological order.
+/// Variables are sampled as words of independent Bernoulli draws,
+/// and gates are evaluated with AND/OR/XOR/ATLEAST bitwise kernels.
+/// Scenarios are simulated in blocks of words
+/// distributed among worker threads.
+class MonteCarlo : private boost::noncopyable {
+ public:
+  using Word = std::uint64_t;  ///< The bit-parallel scenario container.
+  static const int kWordSize = 64;  ///< The number of scenarios per word.
+
+  /// Statistical estimate of a mean value from simulation.
+  struct Estimate {
+    double mean;  ///< The point estimate.
+    double sigma;  ///< The standard error of the estimate.
+    /// The 95% confidence interval of the mean.
+    std::pair<double, double> confidence_interval;
+  };
+
+  /// Compiles the simulation program for the graph.
+  ///
+  /// @param[in] graph  Preprocessed PDAG.
+  /// @param[in] settings  The analysis settings with the number of trials.
+  ///
+  /// @pre The graph is not modified during the lifetime of the simulator.
+  MonteCarlo(const Pdag* graph, const Settings& settings) noexcept;
+
+  /// @returns The actual number of simulated scenarios.
+  ///          The requested number of trials is rounded up to full words.
+  std::int64_t num_trials() const {
+    return static_cast<std::int64_t>(num_words_) * kWordSize;
+  }
+
+  /// @returns The number of gate argument occurrences of graph variables
+  ///          mapped by variable indices.
+  Pdag::IndexMap<int> occurrences() const noexcept;
+
+  /// Estimates the probability of the graph function.
+  ///
+  /// @param[in] p_vars  The probabilities of the variables.
+  ///
+  /// @returns The estimate of the total probability.
+  Estimate Simulate(const Pdag::IndexMap<double>& p_vars) noexcept;
+
+  /// Estimates the Birnbaum marginal importance of graph variables.
+  /// The importance of a variable is estimated
+  /// on the same scenarios with the variable forced to true and false.
+  ///
+  /// @param[in] p_vars  The probabilities of the variables.
+  ///
+  /// @returns The estimates of the marginal importance factors
+  ///          mapped by variable indices.
+  ///          Variables not in the graph have zero estimates.
+  Pdag::IndexMap<Estimate>
+  SimulateImportance(const Pdag::IndexMap<double>& p_vars) noexcept;
+
+  /// Computes the estimate statistics from the simulation sums.
+  ///
+  /// @param[in] sum  The sum of the scenario outcomes.
+  /// @param[in] sum_squares  The sum of the squared scenario outcomes.
+  /// @param[in] num_trials  The number of scenarios.
+  /// @param[in] min_value  The lower bound of the estimated value.
+  /// @param[in] max_value  The upper bound of the estimated value.
+  ///
+  /// @returns The estimate with the normal approximation of the interval
+  ///          clipped to the range of the estimated value.
+  static Estimate MakeEstimate(double sum, double sum_squares,
+                               double num_trials, double min_value,
+                               double max_value) noexcept;
+
+ private:
+  /// The argument slot of an instruction.
+  struct Arg {
+    int slot;  ///< The position of the argument values.
+    bool complement;  ///< Indication of the negated argument.
+  };
+
+  /// Gate evaluation instruction.
+  struct Instruction {
+    Connective type;  ///< The connective of the gate.
+    int min_number;  ///< The K of K/N connectives.
+    int slot;  ///< The destination slot of the gate values.
+    std::vector<Arg> args;  ///< The argument slots.
+  };
+
+  /// Accumulated simulation counts of a worker.
+  struct Tally;
+
+  /// Simulation buffers private to a worker.
+  class Worker;
+
+  /// Compiles gates into instructions in topological order.
+  ///
+  /// @param[in] gate  The current gate.
+  /// @param[in,out] gate_slots  The compiled gates mapped to their slots.
+  /// @param[in,out] var_slots  The slots of variables mapped by indices.
+  ///
+  /// @returns The slot of the gate values.
+  int Compile(const Gate& gate, std::unordered_map<int, int>* gate_slots,
+              Pdag::IndexMap<int>* var_slots) noexcept;
+
+  /// Runs the simulation on all blocks with worker threads.
+  ///
+  /// @param[in] p_vars  The probabilities of the variables.
+  /// @param[in] importance  The flag to estimate marginal importance.
+  ///
+  /// @returns The merged counts of all workers.
+  Tally Run(const Pdag::IndexMap<double>& p_vars, bool importance) noexcept;
+
+  const Pdag* graph_;  ///< The simulated graph.
+  const Settings kSettings_;  ///< Analysis settings.
+  int num_words_;  ///< The total number of words to simulate.
+  int num_slots_;  ///< The number of value slots in the program.
+  int root_slot_;  ///< The slot of the root gate.
+  bool root_complement_;  ///< Indication of the complement graph.
+  std::vector<std::pair<int, int>> variables_;  ///< Variable {slot, index}.
+  std::vector<Instruction> program_;  ///< The gates in topological order.
+};
+
+}  // namespace scram::core
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the parallel task execution.
+
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace scram::core {
+
+namespace {
+
+thread_local bool is_parallel_worker = false;  ///< The worker mark.
+
+}  // namespace
+
+bool IsParallelWorker() noexcept { return is_parallel_worker; }
+
+int NumParallelThreads(int num_tasks) noexcept {
+  if (is_parallel_worker)
+    return 1;
+  return std::min<int>(num_tasks,
+                       std::max<int>(1, std::thread::hardware_concurrency()));
+}
+
+void ParallelFor(int num_tasks,
+                 const std::function<void(int)>& task) noexcept {
+  int num_threads = NumParallelThreads(num_tasks);
+  if (num_threads <= 1) {
+    bool was_worker = is_parallel_worker;
+    is_parallel_worker = true;
+    for (int i = 0; i < num_tasks; ++i)
+      task(i);
+    is_parallel_worker = was_worker;
+    return;
+  }
+  std::atomic<int> next_task = 0;
+  auto worker = [&next_task, &task, num_tasks] {
+    is_parallel_worker = true;
+    for (int i = next_task++; i < num_tasks; i = next_task++)
+      task(i);
+    is_parallel_worker = false;
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (int i = 1; i < num_threads; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread& thread : threads)
+    thread.join();
+}
+
+}  // namespace scram::core
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Execution of independent tasks on worker threads.
+///
+/// The workers are marked per thread,
+/// so the parallel algorithms nested in the tasks run serially
+/// instead of oversubscribing the hardware threads.
+
+#pragma once
+
+#include <functional>
+
+namespace scram::core {
+
+/// @returns true if the calling thread runs the tasks of ParallelFor.
+bool IsParallelWorker() noexcept;
+
+/// @param[in] num_tasks  The number of tasks.
+///
+/// @returns The number of threads ParallelFor runs the tasks on.
+///          1 if the calling thread is already a parallel worker.
+int NumParallelThreads(int num_tasks) noexcept;
+
+/// Runs independent tasks on as many threads as the hardware supports.
+/// The calling thread takes tasks as well.
+/// The tasks run serially on the calling thread
+/// if it is already a parallel worker.
+///
+/// @param[in] num_tasks  The number of tasks.
+/// @param[in] task  The thread-safe task for the given task position.
+void ParallelFor(int num_tasks, const std::function<void(int)>& task) noexcept;
+
+}  // namespace scram::core
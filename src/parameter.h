@@ -103,7 +103,15 @@ class Parameter : public Expression, public Id, public NodeMark, public Usage {
   /// @param[in] unit  A valid unit.
   void unit(Units unit) { unit_ = unit; }
 
-  double value() noexcept override { return expression_->value(); }
+  /// Shifts the mean value of this parameter
+  /// for numerical differentiation of dependent expressions.
+  ///
+  /// @param[in] delta  The additive shift (0 to restore the original value).
+  ///
+  /// @note The shift does not apply to intervals or samples.
+  void shift(double delta) { shift_ = delta; }
+
+  double value() noexcept override { return expression_->value() + shift_; }
   Interval interval() noexcept override { return expression_->interval(); }
 
  private:
@@ -111,6 +119,7 @@ class Parameter : public Expression, public Id, public NodeMark, public Usage {
 
   Units unit_ = kUnitless;  ///< Units of this parameter.
   Expression* expression_ = nullptr;  ///< Expression for this parameter.
+  double shift_ = 0;  ///< The shift of the mean value.
 };
 
 }  // namespace scram::mef
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2014-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementations of parametric studies of the total probability.
+
+#include "parametric_analysis.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+#include "event.h"
+#include "logger.h"
+#include "parameter.h"
+
+namespace scram::core {
+
+namespace {
+
+/// The number of grid points quantified together.
+/// The batch bounds the memory for variable probabilities.
+const int kBatchSize = 256;
+
+/// Counts the swept parameters an expression depends on.
+///
+/// @param[in] expression  The expression to traverse.
+/// @param[in] swept  The swept parameters.
+/// @param[in,out] visited  The already traversed expressions.
+///
+/// @returns The number of unique swept parameters in the arguments.
+int CountDependencies(mef::Expression* expression,
+                      const std::unordered_set<const mef::Expression*>& swept,
+                      std::unordered_set<const mef::Expression*>* visited) {
+  int count = 0;
+  for (mef::Expression* arg : expression->args()) {
+    if (!visited->insert(arg).second)
+      continue;
+    if (swept.count(arg))
+      ++count;
+    count += CountDependencies(arg, swept, visited);
+  }
+  return count;
+}
+
+}  // namespace
+
+ParametricAnalysis::ParametricAnalysis(const ProbabilityAnalysis* prob_analysis,
+                                       std::vector<ParametricAxis> axes,
+                                       mef::MissionTime* mission_time)
+    : Analysis(prob_analysis->settings()),
+      axes_(std::move(axes)),
+      mission_time_(mission_time) {
+  // The mission time and the parameters other parameters depend on
+  // must be set first.
+  std::unordered_set<const mef::Expression*> swept;
+  for (const ParametricAxis& axis : axes_) {
+    if (axis.parameter)
+      swept.insert(axis.parameter);
+  }
+  std::vector<std::pair<int, int>> ranks;  // <dependencies, axis>
+  for (int i = 0; i < axes_.size(); ++i) {
+    int rank = -1;
+    if (axes_[i].parameter) {
+      std::unordered_set<const mef::Expression*> visited;
+      rank = CountDependencies(axes_[i].parameter, swept, &visited);
+    }
+    ranks.emplace_back(rank, i);
+  }
+  std::sort(ranks.begin(), ranks.end());
+  for (const auto& rank : ranks)
+    order_.push_back(rank.second);
+}
+
+std::vector<double> ParametricAnalysis::values(int point) const {
+  std::vector<double> result(axes_.size());
+  for (int i = axes_.size() - 1; i >= 0; --i) {
+    int num_values = axes_[i].values.size();
+    result[i] = axes_[i].values[point % num_values];
+    point /= num_values;
+  }
+  return result;
+}
+
+void ParametricAnalysis::Analyze() noexcept {
+  CLOCK(sweep_time);
+  LOG(DEBUG3) << "Calculating the parametric study...";
+  int num_points = 1;
+  for (const ParametricAxis& axis : axes_)
+    num_points *= axis.values.size();
+
+  const Pdag* graph = this->graph();
+  double original_time = mission_time_->value();
+  p_total_.reserve(num_points);
+  std::vector<Pdag::IndexMap<double>> p_vars;
+  bool adjusted = false;  // Probabilities out of [0, 1] at grid points.
+  for (int start = 0; start < num_points; start += kBatchSize) {
+    p_vars.clear();
+    for (int point = start; point < std::min(start + kBatchSize, num_points);
+         ++point) {
+      Apply(values(point));
+      Pdag::IndexMap<double>& p_point = p_vars.emplace_back();
+      p_point.reserve(graph->basic_events().size());
+      for (const mef::BasicEvent* event : graph->basic_events()) {
+        double p = event->p();
+        if (!(p >= 0 && p <= 1)) {  // NaN is out of the range as well.
+          adjusted = true;
+          p = p > 1 ? 1 : 0;
+        }
+        p_point.push_back(p);
+      }
+    }
+    std::vector<double> results = this->Quantify(p_vars);
+    p_total_.insert(p_total_.end(), results.begin(), results.end());
+  }
+  for (const ParametricAxis& axis : axes_) {
+    if (axis.parameter)
+      axis.parameter->shift(0);
+  }
+  mission_time_->value(original_time);
+  if (adjusted)
+    Analysis::AddWarning("Swept probabilities have been adjusted to [0, 1].");
+  LOG(DEBUG3) << "Calculated " << num_points << " grid points in "
+              << DUR(sweep_time);
+  Analysis::AddAnalysisTime(DUR(sweep_time));
+}
+
+void ParametricAnalysis::Apply(const std::vector<double>& values) noexcept {
+  for (int i : order_) {
+    const ParametricAxis& axis = axes_[i];
+    if (!axis.parameter) {
+      mission_time_->value(values[i]);
+      continue;
+    }
+    // The nominal value reflects the already applied dependencies.
+    axis.parameter->shift(0);
+    axis.parameter->shift(values[i] - axis.parameter->value());
+  }
+}
+
+ParametricAnalyzer<Bdd>::ParametricAnalyzer(
+    ProbabilityAnalyzer<Bdd>* prob_analyzer, std::vector<ParametricAxis> axes,
+    mef::MissionTime* mission_time)
+    : ParametricAnalysis(prob_analyzer, std::move(axes), mission_time),
+      graph_(prob_analyzer->graph()) {
+  const Bdd& bdd = *prob_analyzer->bdd_graph();
+  std::unordered_map<const Ite*, int> slots;
+  root_slot_ = Compile(bdd.root().vertex, bdd.modules(), &slots);
+  root_complement_ = bdd.root().complement;
+}
+
+int ParametricAnalyzer<Bdd>::Compile(
+    const Bdd::VertexPtr& vertex,
+    const std::unordered_map<int, Bdd::Function>& modules,
+    std::unordered_map<const Ite*, int>* slots) noexcept {
+  if (vertex->terminal())
+    return 0;
+  const Ite& ite = Ite::Ref(vertex);
+  if (auto it = slots->find(&ite); it != slots->end())
+    return it->second;
+  Node node{ite.index(), ite.module(), false, ite.complement_edge(), 0, 0};
+  if (ite.module()) {
+    const Bdd::Function& res = modules.find(ite.index())->second;
+    node.index = Compile(res.vertex, modules, slots);
+    node.module_complement = res.complement;
+  }
+  node.high = Compile(ite.high(), modules, slots);
+  node.low = Compile(ite.low(), modules, slots);
+  nodes_.push_back(node);
+  int slot = nodes_.size();
+  slots->emplace(&ite, slot);
+  return slot;
+}
+
+double ParametricAnalyzer<Bdd>::Evaluate(
+    const Pdag::IndexMap<double>& p_vars,
+    std::vector<double>* values) const noexcept {
+  values->resize(nodes_.size() + 1);
+  std::vector<double>& p = *values;
+  p[0] = 1;
+  for (int i = 0; i < nodes_.size(); ++i) {
+    const Node& node = nodes_[i];
+    double p_var = 0;
+    if (node.module) {
+      p_var = p[node.index];
+      if (node.module_complement)
+        p_var = 1 - p_var;
+    } else {
+      p_var = p_vars[node.index];
+    }
+    double low = node.complement_edge ? 1 - p[node.low] : p[node.low];
+    p[i + 1] = p_var * p[node.high] + (1 - p_var) * low;
+  }
+  double prob = p[root_slot_];
+  return root_complement_ ? 1 - prob : prob;
+}
+
+std::vector<double> ParametricAnalyzer<Bdd>::Quantify(
+    const std::vector<Pdag::IndexMap<double>>& p_vars) noexcept {
+  std::vector<double> results(p_vars.size());
+  ParallelFor(p_vars.size(), [&](int i) {
+    thread_local std::vector<double> values;
+    results[i] = Evaluate(p_vars[i], &values);
+  });
+  return results;
+}
+
+std::vector<double> ParametricAnalyzer<MonteCarlo>::Quantify(
+    const std::vector<Pdag::IndexMap<double>>& p_vars) noexcept {
+  std::vector<double> results;
+  for (const Pdag::IndexMap<double>& p_point : p_vars)
+    results.push_back(prob_analyzer_->CalculateTotalProbability(p_point));
+  return results;
+}
+
+}  // namespace scram::core
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2014-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Parametric studies of the total probability
+/// over grids of parameter values.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis.h"
+#include "bdd.h"
+#include "monte_carlo.h"
+#include "parallel.h"
+#include "probability_analysis.h"
+
+namespace scram::mef {  // Decouple from the analysis code header.
+class MissionTime;
+class Parameter;
+}  // namespace scram::mef
+
+namespace scram::core {
+
+/// The axis of a parametric study grid.
+struct ParametricAxis {
+  std::string name;  ///< The name of the swept quantity.
+  mef::Parameter* parameter;  ///< The swept parameter or nullptr for time.
+  std::vector<double> values;  ///< The grid values along the axis.
+};
+
+/// Parametric study of the total probability
+/// on the Cartesian product of axis grids.
+/// The analysis products or diagrams are built once
+/// and requantified with variable probabilities at every grid point.
+class ParametricAnalysis : public Analysis {
+ public:
+  /// @param[in] prob_analysis  Completed probability analysis.
+  /// @param[in] axes  The grid axes with unique swept quantities.
+  /// @param[in] mission_time  The mission time expression of the model.
+  ParametricAnalysis(const ProbabilityAnalysis* prob_analysis,
+                     std::vector<ParametricAxis> axes,
+                     mef::MissionTime* mission_time);
+
+  virtual ~ParametricAnalysis() = default;
+
+  /// Quantifies the total probability at every grid point.
+  ///
+  /// @pre Analysis is called only once.
+  ///
+  /// @post The parameters and the mission time have their original values.
+  void Analyze() noexcept;
+
+  /// @returns The axes of the grid.
+  const std::vector<ParametricAxis>& axes() const { return axes_; }
+
+  /// @returns The total probabilities at grid points in row-major order,
+  ///          i.e., the values of the last axis change the fastest.
+  ///
+  /// @pre The analysis is done.
+  const std::vector<double>& p_total() const { return p_total_; }
+
+  /// @param[in] point  The position of the grid point.
+  ///
+  /// @returns The values of axes at the grid point.
+  std::vector<double> values(int point) const;
+
+ private:
+  /// @returns The analysis graph with variables.
+  virtual const Pdag* graph() noexcept = 0;
+
+  /// Calculates the total probabilities for a batch of grid points.
+  ///
+  /// @param[in] p_vars  The probabilities of variables at grid points.
+  ///
+  /// @returns The total probabilities in the order of the points.
+  virtual std::vector<double>
+  Quantify(const std::vector<Pdag::IndexMap<double>>& p_vars) noexcept = 0;
+
+  /// Sets the swept quantities to the values of a grid point.
+  ///
+  /// @param[in] values  The axis values of the grid point.
+  void Apply(const std::vector<double>& values) noexcept;
+
+  std::vector<ParametricAxis> axes_;  ///< The grid axes.
+  /// The order to set parameters before the parameters depending on them.
+  std::vector<int> order_;
+  mef::MissionTime* mission_time_;  ///< The mission time expression.
+  std::vector<double> p_total_;  ///< The results at the grid points.
+};
+
+/// Parametric study with the help from probability analyzers.
+/// Grid points are requantified in parallel.
+///
+/// @tparam Calculator  Quantitative analysis calculator.
+///
+/// @pre The calculation of the total probability is thread-safe.
+template <class Calculator>
+class ParametricAnalyzer : public ParametricAnalysis {
+ public:
+  /// @param[in] prob_analyzer  Instantiated probability analyzer.
+  /// @param[in] axes  The grid axes with unique swept quantities.
+  /// @param[in] mission_time  The mission time expression of the model.
+  ParametricAnalyzer(ProbabilityAnalyzer<Calculator>* prob_analyzer,
+                     std::vector<ParametricAxis> axes,
+                     mef::MissionTime* mission_time)
+      : ParametricAnalysis(prob_analyzer, std::move(axes), mission_time),
+        prob_analyzer_(prob_analyzer) {}
+
+ private:
+  const Pdag* graph() noexcept override { return prob_analyzer_->graph(); }
+
+  std::vector<double>
+  Quantify(const std::vector<Pdag::IndexMap<double>>& p_vars) noexcept override;
+
+  /// Calculator of the total probability.
+  ProbabilityAnalyzer<Calculator>* prob_analyzer_;
+};
+
+template <class Calculator>
+std::vector<double> ParametricAnalyzer<Calculator>::Quantify(
+    const std::vector<Pdag::IndexMap<double>>& p_vars) noexcept {
+  std::vector<double> results(p_vars.size());
+  ParallelFor(p_vars.size(), [&](int i) {
+    results[i] = prob_analyzer_->CalculateTotalProbability(p_vars[i]);
+  });
+  return results;
+}
+
+/// Specialization of the parametric study with Binary Decision Diagrams.
+/// The BDD is flattened into an array of vertices in topological order
+/// for thread-safe evaluation without vertex marks.
+template <>
+class ParametricAnalyzer<Bdd> : public ParametricAnalysis {
+ public:
+  /// @copydoc ParametricAnalyzer::ParametricAnalyzer
+  ParametricAnalyzer(ProbabilityAnalyzer<Bdd>* prob_analyzer,
+                     std::vector<ParametricAxis> axes,
+                     mef::MissionTime* mission_time);
+
+ private:
+  /// The flat representation of a BDD vertex.
+  struct Node {
+    int index;  ///< The variable index or the module slot.
+    bool module;  ///< Indication of the module vertex.
+    bool module_complement;  ///< The complement of the module function.
+    bool complement_edge;  ///< The complement of the low edge.
+    int high;  ///< The slot of the high branch.
+    int low;  ///< The slot of the low branch.
+  };
+
+  const Pdag* graph() noexcept override { return graph_; }
+
+  std::vector<double>
+  Quantify(const std::vector<Pdag::IndexMap<double>>& p_vars) noexcept override;
+
+  /// Flattens vertices in depth-first post-order.
+  ///
+  /// @param[in] vertex  The root vertex of a function graph.
+  /// @param[in] modules  The BDD module functions.
+  /// @param[in,out] slots  The flattened vertices and their value slots.
+  ///
+  /// @returns The slot of the vertex probability.
+  int Compile(const Bdd::VertexPtr& vertex,
+              const std::unordered_map<int, Bdd::Function>& modules,
+              std::unordered_map<const Ite*, int>* slots) noexcept;
+
+  /// Evaluates the probability of the flat BDD.
+  ///
+  /// @param[in] p_vars  The probabilities of the variables.
+  /// @param[out] values  The buffer for vertex probabilities.
+  ///
+  /// @returns The total probability.
+  double Evaluate(const Pdag::IndexMap<double>& p_vars,
+                  std::vector<double>* values) const noexcept;
+
+  const Pdag* graph_;  ///< The analysis graph.
+  std::vector<Node> nodes_;  ///< The vertex at slot i is at position i - 1.
+  int root_slot_;  ///< The slot of the root vertex (0 for the terminal).
+  bool root_complement_;  ///< The complement of the root function.
+};
+
+/// Specialization of the parametric study with direct Monte Carlo simulation.
+/// Grid points are simulated one after another
+/// because the simulator is parallel on its own.
+template <>
+class ParametricAnalyzer<MonteCarlo> : public ParametricAnalysis {
+ public:
+  /// @copydoc ParametricAnalyzer::ParametricAnalyzer
+  ParametricAnalyzer(ProbabilityAnalyzer<MonteCarlo>* prob_analyzer,
+                     std::vector<ParametricAxis> axes,
+                     mef::MissionTime* mission_time)
+      : ParametricAnalysis(prob_analyzer, std::move(axes), mission_time),
+        prob_analyzer_(prob_analyzer) {}
+
+ private:
+  const Pdag* graph() noexcept override { return prob_analyzer_->graph(); }
+
+  std::vector<double>
+  Quantify(const std::vector<Pdag::IndexMap<double>>& p_vars) noexcept override;
+
+  /// The simulator of the total probability.
+  ProbabilityAnalyzer<MonteCarlo>* prob_analyzer_;
+};
+
+}  // namespace scram::core
@@ -26,6 +26,7 @@
 #include "pdag.h"
 
 #include <iostream>
+#include <limits>
 #include <string>
 #include <unordered_set>
 
@@ -42,7 +43,7 @@ namespace scram::core {
 
 void NodeParentManager::AddParent(const GatePtr& gate) {
   assert(!parents_.count(gate->index()) && "Adding an existing parent.");
-  parents_.data().emplace_back(gate->index(), gate);
+  parents_.emplace_unique(gate->index(), gate);
 }
 
 Node::Node(Pdag* graph) noexcept
@@ -60,6 +61,7 @@ Gate::Gate(Connective type, Pdag* graph) noexcept
     : Node(graph),
       type_(type),
       mark_(false),
+      dirty_(false),
       module_(false),
       coherent_(false),
       min_number_(0),
@@ -74,6 +76,7 @@ void Gate::type(Connective type) {  // Don't use in Gate constructor!
   type_ = type;
   if (type_ == kNull)
     Pdag::NullGateRegistrar()(shared_from_this());
+  MarkDirty();
 }
 
 GatePtr Gate::Clone() noexcept {
@@ -94,6 +97,7 @@ GatePtr Gate::Clone() noexcept {
     arg.second->AddParent(clone);
   if (constant_)
     constant_->AddParent(clone);
+  clone->MarkDirty();
   return clone;
 }
 
@@ -123,6 +127,7 @@ void Gate::AddConstantArg<true>() noexcept {
       assert(args_.size() >= 2);
       assert(min_number_ > 0);
       --min_number_;
+      MarkDirty();
       if (min_number_ == 1)
         type(kOr);
       break;
@@ -171,9 +176,10 @@ void Gate::TransferArg(int index, const GatePtr& recipient) noexcept {
   assert(index != 0);
   assert(args_.count(index));
   args_.erase(index);
+  MarkDirty();
 
   if (auto it_g = ext::find(gate_args_, index)) {
-    it_g->second->EraseParent(Node::index());
+    EraseParentOf(it_g->second);
     recipient->AddArg(*it_g);
     gate_args_.erase(it_g);
 
@@ -208,6 +214,7 @@ void Gate::NegateArgs() noexcept {
     arg.first *= -1;
   for (auto& arg : variable_args_)
     arg.first *= -1;
+  MarkDirty();
 }
 
 void Gate::NegateArg(int existing_arg) noexcept {
@@ -217,6 +224,7 @@ void Gate::NegateArg(int existing_arg) noexcept {
 
   args_.erase(existing_arg);
   args_.insert(-existing_arg);
+  MarkDirty();
 
   if (auto it_g = ext::find(gate_args_, existing_arg)) {
     it_g->first *= -1;
@@ -246,7 +254,8 @@ void Gate::CoalesceGate(const GatePtr& arg_gate) noexcept {
 
   args_.erase(arg_gate->index());  // Erase at the end to avoid the type change.
   gate_args_.erase(arg_gate->index());
-  arg_gate->EraseParent(Node::index());
+  EraseParentOf(arg_gate);
+  MarkDirty();
 }
 
 void Gate::JoinNullGate(int index) noexcept {
@@ -258,7 +267,8 @@ void Gate::JoinNullGate(int index) noexcept {
   auto it_g = gate_args_.find(index);
   GatePtr null_gate = it_g->second;
   gate_args_.erase(it_g);
-  null_gate->EraseParent(Node::index());
+  EraseParentOf(null_gate);
+  MarkDirty();
 
   assert(null_gate->type_ == kNull);
   assert(null_gate->args_.size() == 1);
@@ -288,9 +298,10 @@ void Gate::EraseArg(int index) noexcept {
   assert(index != 0);
   assert(args_.count(index));
   args_.erase(index);
+  MarkDirty();
 
   if (auto it_g = ext::find(gate_args_, index)) {
-    it_g->second->EraseParent(Node::index());
+    EraseParentOf(it_g->second);
     gate_args_.erase(it_g);
 
   } else if (auto it_v = ext::find(variable_args_, index)) {
@@ -299,6 +310,7 @@ void Gate::EraseArg(int index) noexcept {
 
   } else {
     assert(constant_);
+    Pdag::ConstantGuard guard(&Node::graph(), -1);
     constant_->EraseParent(Node::index());
     constant_ = nullptr;
   }
@@ -306,16 +318,19 @@ void Gate::EraseArg(int index) noexcept {
 
 void Gate::EraseArgs() noexcept {
   args_.clear();
+  MarkDirty();
   for (const auto& arg : gate_args_)
-    arg.second->EraseParent(Node::index());
+    EraseParentOf(arg.second);
   gate_args_.clear();
 
   for (const auto& arg : variable_args_)
     arg.second->EraseParent(Node::index());
   variable_args_.clear();
 
-  if (constant_)
+  if (constant_) {
+    Pdag::ConstantGuard guard(&Node::graph(), -1);
     constant_->EraseParent(Node::index());
+  }
   constant_ = nullptr;
 }
 
@@ -326,9 +341,17 @@ void Gate::MakeConstant(bool state) noexcept {
   constant_ = Node::graph().constant();
   int index = state ? constant_->index() : -constant_->index();
   args_.insert(index);
+  Pdag::ConstantGuard guard(&Node::graph(), 1);
   constant_->AddParent(shared_from_this());
 }
 
+void Gate::MarkDirty() noexcept { Pdag::DirtyGateRegistrar()(this); }
+
+void Gate::EraseParentOf(const GatePtr& arg) noexcept {
+  arg->EraseParent(Node::index());
+  arg->MarkDirty();
+}
+
 void Gate::ProcessDuplicateArg(int index) noexcept {
   assert(type_ != kNot && type_ != kNull);
   assert(args_.count(index));
@@ -452,6 +475,7 @@ Pdag::Pdag() noexcept
       coherent_(true),
       normal_(true),
       register_null_gates_(true),
+      track_dirty_gates_(false),
       constant_(new Constant(this)) {}
 
 Pdag::Pdag(const mef::Gate& root, bool ccf, const mef::Model* model) noexcept
@@ -568,7 +592,17 @@ void Pdag::AddArg(const GatePtr& parent, const T& event, bool complement,
     if (!pdag_gate) {
       pdag_gate = ConstructGate(event.formula(), ccf, nodes);
     }
-    parent->AddArg(pdag_gate, complement);
+    if (parent->args().count(pdag_gate->index()) ||
+        parent->args().count(-pdag_gate->index())) {
+      // Equal sub-trees of the same formula share the gate,
+      // so pass-through gates hold the construction invariant.
+      auto null_gate = std::make_shared<Gate>(kNull, this);
+      null_gate->AddArg(pdag_gate);
+      parent->AddArg(null_gate, complement);
+      null_gates_.push_back(null_gate);
+    } else {
+      parent->AddArg(pdag_gate, complement);
+    }
 
   } else {
     static_assert(std::is_same_v<T, mef::BasicEvent>);
@@ -627,13 +661,22 @@ GatePtr Pdag::ConstructGate(const mef::Formula& formula, bool ccf,
     default:
       assert((type == kOr || type == kAnd) && "Unexpected gate type.");
   }
+  int num_gates = boost::count_if(formula.args(), [](const auto& arg) {
+    return std::holds_alternative<mef::Gate*>(arg.event);
+  });
+  parent->ReserveArgs(num_gates, formula.args().size() - num_gates);
   for (const mef::Formula::Arg& arg : formula.args()) {
     if (arg.complement)
       coherent_ = false;
     AddArg(parent, arg.event, arg.complement, ccf, nodes);
   }
-
-  return parent;
+  // Pass-through gates are tracked for removal by the preprocessor.
+  if (parent->type() == kNull || parent->constant())
+    return parent;
+  // The arguments are constructed bottom-up and already unique,
+  // so the structurally equal instances of the same sub-tree
+  // collapse into a single gate.
+  return nodes->unique_gates.insert(parent).first;
 }
 
 GatePtr Pdag::ConstructComplexGate(const mef::Formula& formula, bool ccf,
@@ -796,20 +839,120 @@ void Pdag::RemoveNullGates() noexcept {
   BLOG(DEBUG5, HasConstants()) << "Got CONST gates to clear!";
   BLOG(DEBUG5, HasNullGates()) << "Got NULL gates to clear!";
   Clear<kGateMark>();  // New gates may get created without marks!
-  register_null_gates_ = false;
-  for (const GateWeakPtr& ptr : null_gates_) {
+  Partition* partition = this->partition();
+  bool& register_null_gates =
+      partition ? partition->register_null_gates_ : register_null_gates_;
+  std::vector<GateWeakPtr>& null_gates =
+      partition ? partition->null_gates_ : null_gates_;
+  register_null_gates = false;
+  for (const GateWeakPtr& ptr : null_gates) {
     if (ptr.expired())
       continue;
     PropagateNullGate(ptr.lock());
   }
-  null_gates_.clear();
-  register_null_gates_ = true;
+  null_gates.clear();
+  register_null_gates = true;
   assert(root()->constant() || !HasConstants());
   assert(root()->type() == kNull || !HasNullGates());
 }
 
+int Pdag::NodeIndexGenerator::operator()(Pdag* graph) const {
+  if (Partition* partition = graph->partition()) {
+    assert(partition->end_index_ - partition->next_index_ >=
+               partition->stride_ &&
+           "The reserved partition indices are exhausted.");
+    return partition->next_index_ += partition->stride_;
+  }
+  return ++graph->node_index_;
+}
+
+void Pdag::NullGateRegistrar::operator()(GatePtr gate) const {
+  assert(gate->type() == kNull && "Only Null logic gates are expected.");
+  Pdag& graph = gate->graph();
+  if (Partition* partition = graph.partition()) {
+    if (partition->register_null_gates_)
+      partition->null_gates_.emplace_back(std::move(gate));
+  } else if (graph.register_null_gates_) {
+    graph.null_gates_.emplace_back(std::move(gate));
+  }
+}
+
+Pdag::ConstantGuard::ConstantGuard(Pdag* graph, int num_parents) noexcept {
+  if (Partition* partition = graph->partition()) {
+    lock_ = std::unique_lock(graph->constant_mutex_);
+    partition->num_constants_ += num_parents;
+  }
+}
+
+thread_local Pdag::Partition* Pdag::Partition::current_ = nullptr;
+
+Pdag::Partition::Partition(Pdag* graph, int num_nodes) noexcept
+    : graph_(*graph),
+      next_index_(graph->node_index_),
+      end_index_(graph->node_index_ += num_nodes),
+      stride_(1),
+      register_null_gates_(true),
+      num_constants_(0) {}
+
+Pdag::Partition::Partition(Pdag* graph, int slot, int num_slots) noexcept
+    : graph_(*graph),
+      next_index_(graph->node_index_ + slot + 1 - num_slots),
+      end_index_(std::numeric_limits<int>::max()),
+      stride_(num_slots),
+      register_null_gates_(true),
+      num_constants_(0) {
+  assert(slot >= 0 && slot < num_slots);
+}
+
+void Pdag::Partition::Merge() noexcept {
+  assert(!current_ && "Merging from a partition.");
+  for (const Replacement& replacement : replacements_) {
+    for (const GateWeakPtr& ptr : replacement.parents) {
+      GatePtr parent = ptr.lock();
+      int sign = parent->GetArgSign(replacement.root);
+      parent->EraseArg(sign * replacement.root->index());
+      parent->AddArg(replacement.gate, sign < 0);
+    }
+  }
+  replacements_.clear();
+  graph_.node_index_ = std::max(graph_.node_index_, next_index_);
+  for (auto* gates : {&null_gates_, &null_roots_}) {
+    graph_.null_gates_.insert(graph_.null_gates_.end(), gates->begin(),
+                              gates->end());
+    gates->clear();
+  }
+  graph_.dirty_gates_.insert(graph_.dirty_gates_.end(), dirty_gates_.begin(),
+                             dirty_gates_.end());
+  dirty_gates_.clear();
+}
+
+void Pdag::TrackDirtyGates(bool flag) noexcept {
+  assert(!partition() && "Graph-wide registration in a partition.");
+  for (const GateWeakPtr& ptr : dirty_gates_) {
+    if (GatePtr gate = ptr.lock())
+      gate->dirty(false);
+  }
+  dirty_gates_.clear();
+  track_dirty_gates_ = flag;
+}
+
+std::vector<GateWeakPtr> Pdag::PopDirtyGates() noexcept {
+  Partition* partition = this->partition();
+  std::vector<GateWeakPtr>& dirty_gates =
+      partition ? partition->dirty_gates_ : dirty_gates_;
+  for (const GateWeakPtr& ptr : dirty_gates) {
+    if (GatePtr gate = ptr.lock())
+      gate->dirty(false);
+  }
+  std::vector<GateWeakPtr> gates;
+  gates.swap(dirty_gates);
+  return gates;
+}
+
 void Pdag::PropagateNullGate(const GatePtr& gate) noexcept {
   assert(gate->type() == kNull);
+  if (gate == root())
+    return;  // The module root in the partition keeps its outside parents.
   while (!gate->parents().empty()) {
     GatePtr parent = gate->parents().begin()->second.lock();
     int sign = parent->GetArgSign(gate);
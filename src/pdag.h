@@ -33,21 +33,25 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <array>
 #include <iosfwd>
 #include <memory>
+#include <mutex>
 #include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include <boost/container/flat_set.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 
 #include "ext/find_iterator.h"
 #include "ext/index_map.h"
-#include "ext/linear_map.h"
+#include "ext/hybrid_map.h"
 
 namespace scram::mef {  // Declarations to decouple from the MEF initialization.
 class Model;  // Provider of substitutions.
@@ -73,7 +77,9 @@ class NodeParentManager : private boost::noncopyable {
   using Parent = std::pair<int, GateWeakPtr>;  ///< Parent index and ptr.
 
   /// A map type of parent gate positive indices and weak pointers to them.
-  using ParentMap = ext::linear_map<int, GateWeakPtr, ext::MoveEraser>;
+  /// Shared variables may have thousands of parents,
+  /// so the map switches to hashed lookup past the threshold.
+  using ParentMap = ext::hybrid_map<int, GateWeakPtr>;
 
   /// @returns The parents of a node.
   const ParentMap& parents() const { return parents_; }
@@ -297,12 +303,22 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
   using ConstArg = std::pair<int, const T&>;
   /// @}
 
+  /// The projection of signed argument indices onto node indices.
+  /// The sign of arguments can change in place
+  /// without invalidating the hash index of wide gates.
+  struct ArgIndex {
+    /// @returns The positive index of the argument node.
+    int operator()(int index) const { return std::abs(index); }
+  };
+
   /// An associative container type to store the gate arguments.
   /// This container type maps the index of the argument to the pointer to it.
+  /// The container is linear for small gates
+  /// and hashed for very wide gates.
   ///
   /// @tparam T  The type of the argument node.
   template <class T>
-  using ArgMap = ext::linear_map<int, std::shared_ptr<T>, ext::MoveEraser>;
+  using ArgMap = ext::hybrid_map<int, std::shared_ptr<T>, 32, ArgIndex>;
 
   /// An ordered set of gate argument indices.
   using ArgSet = boost::container::flat_set<int>;
@@ -358,7 +374,10 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
   /// @param[in] number  The min number of ATLEAST gate.
   ///
   /// @pre The min number is appropriate for the gate logic and arguments.
-  void min_number(int number) { min_number_ = number; }
+  void min_number(int number) {
+    min_number_ = number;
+    MarkDirty();
+  }
 
   /// @returns true if this gate has become constant.
   bool constant() const { return constant_ != nullptr; }
@@ -412,6 +431,15 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
   /// @pre The marks are continuous.
   void mark(bool flag) { mark_ = flag; }
 
+  /// @returns true if the gate is registered
+  ///          as changed for incremental transformations.
+  bool dirty() const { return dirty_; }
+
+  /// Sets the registration of this gate as changed.
+  ///
+  /// @param[in] flag  true if the gate is in the graph's dirty gate list.
+  void dirty(bool flag) { dirty_ = flag; }
+
   /// @returns Pre-assigned index of one of gate's descendants.
   int descendant() const { return descendant_; }
 
@@ -556,9 +584,23 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
       return ProcessComplementArg(index);
 
     args_.insert(index);
-    mutable_args<T>().data().emplace_back(index, arg);
+    mutable_args<T>().emplace_unique(index, arg);
     arg->AddParent(shared_from_this());
+    MarkDirty();
+  }
+
+  /// Reserves the argument storage for the bulk construction of the gate.
+  /// The lookup index of very wide argument maps only gets its buckets;
+  /// the arguments are indexed as they are added.
+  ///
+  /// @param[in] num_gates  The expected number of gate arguments.
+  /// @param[in] num_variables  The expected number of variable arguments.
+  void ReserveArgs(int num_gates, int num_variables) noexcept {
+    args_.reserve(num_gates + num_variables);
+    gate_args_.reserve(num_gates);
+    variable_args_.reserve(num_variables);
   }
+
   /// Wrapper to add gate arguments with index retrieval from the arg.
   template <class T>
   void AddArg(const std::shared_ptr<T>& arg, bool complement = false) noexcept {
@@ -733,8 +775,19 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
       type(target_type);
   }
 
+  /// Registers this gate as changed
+  /// if the graph tracks dirty gates.
+  void MarkDirty() noexcept;
+
+  /// Erases this gate from the parents of an argument gate
+  /// and registers the argument as changed.
+  ///
+  /// @param[in] arg  The argument gate losing this parent.
+  void EraseParentOf(const GatePtr& arg) noexcept;
+
   Connective type_;  ///< Type of this gate.
   bool mark_;  ///< Marking for linear traversal of a graph.
+  bool dirty_;  ///< Registration in the dirty gate list of the graph.
   bool module_;  ///< Indication of an independent module gate.
   bool coherent_;  ///< Indication of a coherent graph.
   int min_number_;  ///< Min number for ATLEAST gate.
@@ -760,6 +813,64 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
 template <>
 void Gate::AddArg<Constant>(int index, const ConstantPtr& arg) noexcept;
 
+/// Container of unique gates.
+/// This container acts like an unordered set of gates.
+/// The gates are equivalent
+/// if they have the same semantics.
+/// However, this set does not test
+/// for the isomorphism of the gates' Boolean formulas.
+class GateSet {
+ public:
+  /// Inserts a gate into the set
+  /// if it is semantically unique.
+  ///
+  /// @param[in] gate  The gate to insert.
+  ///
+  /// @returns A pair of the unique gate and
+  ///          the insertion success flag.
+  std::pair<GatePtr, bool> insert(const GatePtr& gate) noexcept {
+    auto result = table_[gate->type()].insert(gate);
+    return {*result.first, result.second};
+  }
+
+ private:
+  /// Functor for hashing gates by their arguments.
+  ///
+  /// @note The hashing discards the logic of the gate.
+  struct Hash {
+    /// Operator overload for hashing.
+    ///
+    /// @param[in] gate  The gate which hash must be calculated.
+    ///
+    /// @returns Hash value of the gate
+    ///          from its arguments but not logic.
+    std::size_t operator()(const GatePtr& gate) const noexcept {
+      return boost::hash_range(gate->args().begin(), gate->args().end());
+    }
+  };
+  /// Functor for equality test for gates by their arguments.
+  ///
+  /// @note The equality discards the logic of the gate.
+  struct Equal {
+    /// Operator overload for gate argument equality test.
+    ///
+    /// @param[in] lhs  The first gate.
+    /// @param[in] rhs  The second gate.
+    ///
+    /// @returns true if the gate arguments are equal.
+    bool operator()(const GatePtr& lhs, const GatePtr& rhs) const noexcept {
+      assert(lhs->type() == rhs->type());
+      if (lhs->args() != rhs->args())
+        return false;
+      if (lhs->type() == kAtleast && lhs->min_number() != rhs->min_number())
+        return false;
+      return true;
+    }
+  };
+  /// Container of gates grouped by their types.
+  std::array<std::unordered_set<GatePtr, Hash, Equal>, kNumConnectives> table_;
+};
+
 /// PDAG is a propositional directed acyclic graph.
 /// This class provides a simpler representation of a fault tree
 /// that takes into account the indices of events
@@ -791,18 +902,144 @@ class Pdag : private boost::noncopyable {
     /// @returns A new unique index in the graph.
     ///
     /// @param[in,out] graph  A graph within which the index is unique.
-    int operator()(Pdag* graph) const { return ++graph->node_index_; }
+    int operator()(Pdag* graph) const;
   };
 
   /// Registers pass-through or Null logic gates belonging to the graph.
   class NullGateRegistrar {
     friend class Gate;
     /// @param[in] gate  A Null gate with a single argument.
-    void operator()(GatePtr gate) const {
-      assert(gate->type() == kNull && "Only Null logic gates are expected.");
-      if (gate->graph().register_null_gates_)
-        gate->graph().null_gates_.emplace_back(std::move(gate));
+    void operator()(GatePtr gate) const;
+  };
+
+  class DirtyGateRegistrar;
+  class ConstantGuard;
+
+  /// Graph state for transformations of independent modules
+  /// in worker threads.
+  /// The nodes created in an active partition
+  /// take indices reserved upon the partition construction.
+  /// The graph functions called in an active partition
+  /// see the module as the whole graph:
+  /// the module is the root,
+  /// and the pass-through and dirty gates are registered in the partition.
+  /// The parents of the module root are left intact
+  /// until the partition is merged into the graph.
+  /// The resulting graph does not depend on the scheduling of the threads.
+  ///
+  /// @pre The transformations in the partition
+  ///      do not share nodes with other partitions
+  ///      except for the graph constant.
+  class Partition : private boost::noncopyable {
+    friend class Pdag;
+    friend class NodeIndexGenerator;
+    friend class NullGateRegistrar;
+    friend class DirtyGateRegistrar;
+    friend class ConstantGuard;
+
+   public:
+    /// Reserves the range of indices for new nodes of the partition.
+    ///
+    /// @param[in,out] graph  The host graph.
+    /// @param[in] num_nodes  The max number of nodes created in the partition.
+    Partition(Pdag* graph, int num_nodes) noexcept;
+
+    /// Interleaves the indices for new nodes of partitions
+    /// with unknown numbers of new nodes.
+    /// The partition takes every num_slots-th index
+    /// after the last index of the graph.
+    ///
+    /// @param[in] graph  The host graph.
+    /// @param[in] slot  The position of the partition in [0, num_slots).
+    /// @param[in] num_slots  The number of the interleaved partitions.
+    ///
+    /// @pre All the interleaved partitions are constructed
+    ///      before any of them is merged.
+    Partition(Pdag* graph, int slot, int num_slots) noexcept;
+
+    /// Runs a transformation with the partition active in the current thread.
+    ///
+    /// @param[in,out] root  The root of the module, which may get replaced.
+    /// @param[in] transform  The transformation of the partition nodes.
+    template <typename F>
+    void Run(GatePtr* root, F&& transform) noexcept {
+      assert(!current_ && "Nested partitions.");
+      assert(!(*root)->parents().empty() && "The graph root in a partition.");
+      std::vector<GateWeakPtr> parents;  // The parents outside the module.
+      for (const auto& parent : (*root)->parents())
+        parents.push_back(parent.second);
+      current_ = this;
+      root_ = *root;
+      transform();
+      if (root_ != *root) {  // Splice into the parents upon the merge.
+        replacements_.push_back({*root, root_, std::move(parents)});
+        *root = root_;
+      }
+      if (root_->type() == kNull)
+        null_roots_.push_back(root_);  // Removal needs the parents.
+      root_ = nullptr;
+      current_ = nullptr;
     }
+
+    /// Replaces the module roots in their parents
+    /// and registers the pass-through and dirty gates in the graph.
+    ///
+    /// @pre No thread runs transformations in the partition.
+    void Merge() noexcept;
+
+   private:
+    /// The replacement of a module root.
+    struct Replacement {
+      GatePtr root;  ///< The original root.
+      GatePtr gate;  ///< The new root.
+      std::vector<GateWeakPtr> parents;  ///< The parents outside the module.
+    };
+
+    static thread_local Partition* current_;  ///< The active thread partition.
+
+    Pdag& graph_;  ///< The host graph.
+    int next_index_;  ///< The last index given to a new node.
+    int end_index_;  ///< The last reserved index.
+    int stride_;  ///< The step between the partition indices.
+    bool register_null_gates_;  ///< The partition analog of the graph flag.
+    int num_constants_;  ///< The number of the partition constant gates.
+    GatePtr root_;  ///< The root of the running module.
+    std::vector<Replacement> replacements_;  ///< The replaced module roots.
+    std::vector<GateWeakPtr> null_roots_;  ///< The module roots of NULL type.
+    std::vector<GateWeakPtr> null_gates_;  ///< The partition NULL type gates.
+    std::vector<GateWeakPtr> dirty_gates_;  ///< The partition dirty gates.
+  };
+
+  /// Registers gates with changed arguments or parents
+  /// for incremental transformations.
+  class DirtyGateRegistrar {
+    friend class Gate;
+    /// @param[in] gate  The changed gate.
+    void operator()(Gate* gate) const {
+      Pdag& graph = gate->graph();
+      if (!graph.track_dirty_gates_ || gate->dirty())
+        return;
+      GateWeakPtr ptr = gate->weak_from_this();
+      if (ptr.expired())
+        return;  // The gate is under construction or destruction.
+      gate->dirty(true);
+      if (Partition* partition = graph.partition()) {
+        partition->dirty_gates_.emplace_back(std::move(ptr));
+      } else {
+        graph.dirty_gates_.emplace_back(std::move(ptr));
+      }
+    }
+  };
+
+  /// Serializes the changes of the graph constant parents
+  /// by the gates of concurrent partitions.
+  class ConstantGuard : private boost::noncopyable {
+    friend class Gate;
+    /// @param[in,out] graph  The graph of the constant.
+    /// @param[in] num_parents  The change in the number of the parents.
+    ConstantGuard(Pdag* graph, int num_parents) noexcept;
+
+    std::unique_lock<std::mutex> lock_;  ///< Held in active partitions.
   };
 
   /// Non-declarative substitutions.
@@ -842,6 +1079,7 @@ class Pdag : private boost::noncopyable {
   /// @param[in] model  The Model containing substitutions if any.
   ///
   /// @pre No new Variable nodes are introduced after the construction.
+  /// @pre The CCF groups have generated their events for CCF incorporation.
   ///
   /// @post All declarative substitutions are applied,
   ///       and all non-declarative substitutions are collected for application.
@@ -875,6 +1113,7 @@ class Pdag : private boost::noncopyable {
   void coherent(bool flag) { coherent_ = flag; }
 
   /// @returns true if all gates of the fault tree are normalized AND/OR.
+  ///          K/N gates may remain for analyses that handle them natively.
   bool normal() const { return normal_; }
 
   /// @param[in] flag  true if the graph has been normalized.
@@ -884,12 +1123,22 @@ class Pdag : private boost::noncopyable {
 
   /// @returns The shared pointer to current root gate of the graph.
   ///          nullptr iff the graph has been constructed root-less.
-  const GatePtr& root() { return root_; }
+  ///
+  /// @note The root of the module in the active partition.
+  const GatePtr& root() {
+    if (Partition* partition = this->partition())
+      return partition->root_;
+    return root_;
+  }
 
   /// @returns The current root gate of the graph.
   ///
   /// @pre The graph has been constructed with a root gate.
-  const Gate& root() const { return *root_; }
+  const Gate& root() const {
+    if (Partition* partition = this->partition())
+      return *partition->root_;
+    return *root_;
+  }
 
   /// Sets the root gate.
   /// This function is helpful for transformations.
@@ -898,7 +1147,11 @@ class Pdag : private boost::noncopyable {
   void root(const GatePtr& gate) {
     assert(gate && "The graph cannot be made root-less.");
     assert(this == &gate->graph() && "The gate is from a different graph.");
-    root_ = gate;
+    if (Partition* partition = this->partition()) {
+      partition->root_ = gate;
+    } else {
+      root_ = gate;
+    }
   }
 
   /// @returns true if graph = ~root.
@@ -913,10 +1166,18 @@ class Pdag : private boost::noncopyable {
   const ConstantPtr& constant() const { return constant_; }
 
   /// @returns true if the graph contains pass-through gates with a constant.
-  bool HasConstants() const { return !constant_->parents().empty(); }
+  bool HasConstants() const {
+    if (Partition* partition = this->partition())
+      return partition->num_constants_ > 0;
+    return !constant_->parents().empty();
+  }
 
   /// @returns true if the graph has at least one pass-through logic gate.
-  bool HasNullGates() const { return !null_gates_.empty(); }
+  bool HasNullGates() const {
+    if (Partition* partition = this->partition())
+      return !partition->null_gates_.empty();
+    return !null_gates_.empty();
+  }
 
   /// @returns true if the graph represents a trivial Boolean function;
   ///               that is, graph = Constant or graph = Variable.
@@ -976,20 +1237,41 @@ class Pdag : private boost::noncopyable {
   ///       and the whole graph is constant,
   ///       so no further processing is required.
   ///
+  /// @note The NULL type root of the module in the active partition
+  ///       is left for the removal after the partition merge.
+  ///
   /// @warning Gate marks will get cleared by this function.
   void RemoveNullGates() noexcept;
 
+  /// Starts or stops the registration of gates
+  /// whose arguments or parents change.
+  /// Incremental transformations use the registered gates as a worklist
+  /// instead of traversing the whole graph again.
+  ///
+  /// @param[in] flag  true to start the registration.
+  ///
+  /// @pre No partition is active.
+  ///
+  /// @post The previously registered gates are discarded.
+  void TrackDirtyGates(bool flag) noexcept;
+
+  /// @returns The gates changed since the last call.
+  ///          The gates removed from the graph since then are expired.
+  ///
+  /// @post The registration of the returned gates is cleared.
+  std::vector<GateWeakPtr> PopDirtyGates() noexcept;
+
   /// Clears marks from graph nodes.
   ///
   /// @tparam Mark  The kind of the mark.
   template <NodeMark Mark>
   void Clear() noexcept {
     if constexpr (Mark == kGateMark) {
-      Clear<kGateMark>(root_);
+      Clear<kGateMark>(root());
 
     } else {
       Clear<kGateMark>();
-      Clear<Mark>(root_);
+      Clear<Mark>(root());
       Clear<kGateMark>();
     }
   }
@@ -1012,6 +1294,7 @@ class Pdag : private boost::noncopyable {
   struct ProcessedNodes {  /// @{
     std::unordered_map<const mef::Gate*, GatePtr> gates;
     std::unordered_map<const mef::BasicEvent*, VariablePtr> variables;
+    GateSet unique_gates;  ///< Hash-consing of structurally equal gates.
   };  /// @}
 
   /// Gathers and initializes Variables from Basic Events.
@@ -1049,7 +1332,9 @@ class Pdag : private boost::noncopyable {
   /// @param[in] ccf  A flag to replace basic events with CCF gates.
   /// @param[in,out] nodes  The mapping of processed nodes.
   ///
-  /// @returns Pointer to the newly created indexed gate.
+  /// @returns Pointer to the newly created indexed gate
+  ///          or the already constructed gate with the same connective
+  ///          and arguments.
   ///
   /// @pre The Connective enum in the MEF is the same as in PDAG.
   GatePtr ConstructGate(const mef::Formula& formula, bool ccf,
@@ -1115,6 +1400,13 @@ class Pdag : private boost::noncopyable {
       bool complement, bool ccf, ProcessedNodes* nodes) noexcept;
   /// @}
 
+  /// @returns The partition active in the current thread for this graph.
+  ///          nullptr if the graph is transformed as a whole.
+  Partition* partition() const {
+    Partition* partition = Partition::current_;
+    return partition && &partition->graph_ == this ? partition : nullptr;
+  }
+
   /// Propagate NULL type gates bottom-up.
   /// This is a helper function for algorithms
   /// that may produce and need to remove NULL type gates.
@@ -1129,8 +1421,13 @@ class Pdag : private boost::noncopyable {
   bool coherent_;  ///< Indication that the graph does not contain negation.
   bool normal_;  ///< Indication for the graph containing only OR and AND gates.
   bool register_null_gates_;  ///< Automatically register pass-through gates.
+  bool track_dirty_gates_;  ///< Register gates changed by transformations.
+  /// Gates with changed arguments or parents since the last worklist pop.
+  /// The list outlives the gates upon the graph destruction.
+  std::vector<GateWeakPtr> dirty_gates_;
   GatePtr root_;  ///< The root gate of this graph.
   ConstantPtr constant_;  ///< The single constant TRUE for the whole graph.
+  std::mutex constant_mutex_;  ///< The constant parents in partitions.
   /// Mapping for basic events and their Variable indices.
   IndexMap<const mef::BasicEvent*> basic_events_;
   /// Container for NULL type gates to be tracked and cleaned by algorithms.
@@ -72,15 +72,20 @@
 
 #include "preprocessor.h"
 
+#include <cstdint>
 #include <cstdlib>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <deque>
+#include <limits>
 #include <list>
+#include <map>
 #include <queue>
+#include <string_view>
 #include <unordered_set>
 
-#include <boost/functional/hash.hpp>
 #include <boost/math/special_functions/sign.hpp>
 #include <boost/range/algorithm.hpp>
 #include <boost/range/algorithm_ext.hpp>
@@ -88,6 +93,7 @@
 #include "ext/algorithm.h"
 #include "ext/find_iterator.h"
 #include "logger.h"
+#include "parallel.h"
 
 namespace scram::core {
 
@@ -167,11 +173,90 @@ void MarkCoherence(Pdag* graph) noexcept {
 
 }  // namespace pdag
 
-Preprocessor::Preprocessor(Pdag* graph) noexcept : graph_(graph) {}
+void Accumulate(const std::vector<PassProfile>& profiles,
+                std::vector<PassProfile>* total) noexcept {
+  for (const PassProfile& profile : profiles) {
+    auto it = boost::find_if(*total, [&profile](const PassProfile& done) {
+      return std::string_view(done.name) == profile.name;
+    });
+    if (it == total->end()) {
+      total->push_back(profile);
+    } else {
+      it->runs += profile.runs;
+      it->skips += profile.skips;
+      it->time += profile.time;
+      it->gates += profile.gates;
+      it->args += profile.args;
+    }
+  }
+}
+
+Preprocessor::Preprocessor(Pdag* graph) noexcept : Preprocessor(graph, 0) {}
+
+Preprocessor::Preprocessor(Pdag* graph, double pass_budget) noexcept
+    : graph_(graph), pass_budget_(pass_budget) {}
 
 void Preprocessor::operator()() noexcept {
   TIMER(DEBUG2, "Preprocessing");
   this->Run();
+  for (const PassProfile& profile : profiles_) {
+    LOG(DEBUG3) << "Pass " << profile.name << ": " << profile.runs
+                << " run(s), " << profile.skips << " skip(s) in "
+                << profile.time << "; gates " << profile.gates << ", args "
+                << profile.args;
+  }
+}
+
+template <class F>
+void Preprocessor::RunPass(const char* name, bool optional, F&& pass) noexcept {
+  const int kMaxIdleRuns = 2;  // The limit before skipping optional passes.
+  auto it = boost::find_if(profiles_, [name](const PassProfile& profile) {
+    return std::string_view(profile.name) == name;
+  });
+  if (it == profiles_.end()) {
+    it = profiles_.insert(it, PassProfile{name});
+    idle_runs_.push_back(0);
+  }
+  PassProfile& profile = *it;
+  int& idle_runs = idle_runs_[it - profiles_.begin()];
+  auto exhausted = [this, &profile] {
+    return pass_budget_ && profile.time >= pass_budget_;
+  };
+  if (optional && (idle_runs >= kMaxIdleRuns || exhausted())) {
+    profile.skips++;
+    return;
+  }
+  auto [num_gates, num_args] = CountGraph();
+  bool repeat = true;
+  while (repeat && !(optional && exhausted())) {
+    CLOCK(pass_time);
+    repeat = pass();
+    profile.time += DUR(pass_time);
+    profile.runs++;
+  }
+  auto [new_num_gates, new_num_args] = CountGraph();
+  profile.gates += new_num_gates - num_gates;
+  profile.args += new_num_args - num_args;
+  if (new_num_gates == num_gates && new_num_args == num_args) {
+    idle_runs++;
+  } else {
+    idle_runs = 0;
+  }
+}
+
+std::pair<int, int> Preprocessor::CountGraph() const noexcept {
+  std::unordered_set<int> gates;
+  int num_args = 0;
+  auto count = [&gates, &num_args](auto& self, const Gate& gate) -> void {
+    if (!gates.insert(gate.index()).second)
+      return;
+    num_args += gate.args().size();
+    for (const auto& arg : gate.args<Gate>())
+      self(self, arg.second);
+  };
+  if (!graph_->IsTrivial())
+    count(count, *graph_->root());
+  return {gates.size(), num_args};
 }
 
 void Preprocessor::Run() noexcept {
@@ -183,64 +268,6 @@ void Preprocessor::Run() noexcept {
                   });
 }
 
-/// Container of unique gates.
-/// This container acts like an unordered set of gates.
-/// The gates are equivalent
-/// if they have the same semantics.
-/// However, this set does not test
-/// for the isomorphism of the gates' Boolean formulas.
-class Preprocessor::GateSet {
- public:
-  /// Inserts a gate into the set
-  /// if it is semantically unique.
-  ///
-  /// @param[in] gate  The gate to insert.
-  ///
-  /// @returns A pair of the unique gate and
-  ///          the insertion success flag.
-  std::pair<GatePtr, bool> insert(const GatePtr& gate) noexcept {
-    auto result = table_[gate->type()].insert(gate);
-    return {*result.first, result.second};
-  }
-
- private:
-  /// Functor for hashing gates by their arguments.
-  ///
-  /// @note The hashing discards the logic of the gate.
-  struct Hash {
-    /// Operator overload for hashing.
-    ///
-    /// @param[in] gate  The gate which hash must be calculated.
-    ///
-    /// @returns Hash value of the gate
-    ///          from its arguments but not logic.
-    std::size_t operator()(const GatePtr& gate) const noexcept {
-      return boost::hash_range(gate->args().begin(), gate->args().end());
-    }
-  };
-  /// Functor for equality test for gates by their arguments.
-  ///
-  /// @note The equality discards the logic of the gate.
-  struct Equal {
-    /// Operator overload for gate argument equality test.
-    ///
-    /// @param[in] lhs  The first gate.
-    /// @param[in] rhs  The second gate.
-    ///
-    /// @returns true if the gate arguments are equal.
-    bool operator()(const GatePtr& lhs, const GatePtr& rhs) const noexcept {
-      assert(lhs->type() == rhs->type());
-      if (lhs->args() != rhs->args())
-        return false;
-      if (lhs->type() == kAtleast && lhs->min_number() != rhs->min_number())
-        return false;
-      return true;
-    }
-  };
-  /// Container of gates grouped by their types.
-  std::array<std::unordered_set<GatePtr, Hash, Equal>, kNumConnectives> table_;
-};
-
 namespace {  // PDAG structure verification tools.
 
 /// Functor to sanity check the marks of PDAG gates.
@@ -321,14 +348,20 @@ void Preprocessor::RunPhaseOne() noexcept {
   TIMER(DEBUG2, "Preprocessing Phase I");
   graph_->Log();
   if (graph_->HasNullGates()) {
-    TIMER(DEBUG3, "Removing NULL gates");
-    graph_->RemoveNullGates();
+    RunPass("null-gate-removal", /*optional=*/false, [this] {
+      TIMER(DEBUG3, "Removing NULL gates");
+      graph_->RemoveNullGates();
+      return false;
+    });
     if (graph_->IsTrivial())
       return;
   }
   SANITY_ASSERT;
   if (!graph_->coherent()) {
-    NormalizeGates(/*full=*/false);
+    RunPass("partial-normalization", /*optional=*/false, [this] {
+      NormalizeGates(/*full=*/false);
+      return false;
+    });
   }
 }
 
@@ -336,27 +369,53 @@ void Preprocessor::RunPhaseTwo() noexcept {
   TIMER(DEBUG2, "Preprocessing Phase II");
   SANITY_ASSERT;
   graph_->Log();
+  auto detect_modules = [this](Pdag*) {
+    RunPass("module-detection", /*optional=*/false, [this] {
+      DetectModules();
+      return false;
+    });
+  };
+  auto coalesce_gates = [this](Pdag*) {
+    RunPass("gate-coalescing", /*optional=*/false, [this] {
+      CoalesceGates(/*common=*/false);
+      return false;
+    });
+  };
   pdag::Transform(graph_,
                   [this](Pdag*) {
-                    while (ProcessMultipleDefinitions())
-                      continue;
+                    RunPass("multiple-definitions", /*optional=*/true, [this] {
+                      ProcessMultipleDefinitions();
+                      return false;
+                    });
                   },
-                  [this](Pdag*) { DetectModules(); },
+                  detect_modules, coalesce_gates,
                   [this](Pdag*) {
-                    while (CoalesceGates(/*common=*/false))
-                      continue;
+                    RunPass("common-args-merging", /*optional=*/true, [this] {
+                      MergeCommonArgs();
+                      return false;
+                    });
                   },
-                  [this](Pdag*) { MergeCommonArgs(); },
-                  [this](Pdag*) { DetectDistributivity(); },
-                  [this](Pdag*) { DetectModules(); },
-                  [this](Pdag*) { BooleanOptimization(); },
-                  [this](Pdag*) { DecomposeCommonNodes(); },
-                  [this](Pdag*) { DetectModules(); },
                   [this](Pdag*) {
-                    while (CoalesceGates(/*common=*/false))
-                      continue;
+                    RunPass("distributivity", /*optional=*/true, [this] {
+                      DetectDistributivity();
+                      return false;
+                    });
                   },
-                  [this](Pdag*) { DetectModules(); });
+                  detect_modules,
+                  [this](Pdag*) {
+                    RunPass("boolean-optimization", /*optional=*/true, [this] {
+                      BooleanOptimization();
+                      return false;
+                    });
+                  },
+                  [this](Pdag*) {
+                    RunPass("common-node-decomposition", /*optional=*/true,
+                            [this] {
+                              DecomposeCommonNodes();
+                              return false;
+                            });
+                  },
+                  detect_modules, coalesce_gates, detect_modules);
   graph_->Log();
 }
 
@@ -365,7 +424,10 @@ void Preprocessor::RunPhaseThree() noexcept {
   SANITY_ASSERT;
   graph_->Log();
   assert(!graph_->normal());
-  NormalizeGates(/*full=*/true);
+  RunPass("full-normalization", /*optional=*/false, [this] {
+    NormalizeGates(/*full=*/true);
+    return false;
+  });
   graph_->normal(true);
 
   if (graph_->IsTrivial())
@@ -374,26 +436,57 @@ void Preprocessor::RunPhaseThree() noexcept {
   RunPhaseTwo();
 }
 
+namespace {
+
+/// Turns the gate into its complement by the De Morgan's law.
+///
+/// @param[in,out] gate  The positive OR, AND, K/N, or NULL gate.
+void ComplementLogic(Gate* gate) noexcept {
+  switch (gate->type()) {
+    case kOr:
+      gate->type(kAnd);
+      break;
+    case kAnd:
+      gate->type(kOr);
+      break;
+    case kAtleast:  // ~K/N(x_i) = (N-K+1)/N(~x_i)
+      gate->min_number(gate->args().size() - gate->min_number() + 1);
+      break;
+    default:
+      assert(gate->type() == kNull && "Unexpected gate for complements.");
+  }
+  gate->NegateArgs();
+}
+
+}  // namespace
+
 void Preprocessor::RunPhaseFour() noexcept {
   TIMER(DEBUG2, "Preprocessing Phase IV");
   SANITY_ASSERT;
   graph_->Log();
   assert(!graph_->coherent());
-  LOG(DEBUG3) << "Propagating complements...";
-  if (graph_->complement()) {
-    const GatePtr& root = graph_->root();
-    assert(root->type() == kOr || root->type() == kAnd ||
-           root->type() == kNull);
-    if (root->type() == kOr || root->type() == kAnd)
-      root->type(root->type() == kOr ? kAnd : kOr);
-    root->NegateArgs();
-    graph_->complement() = false;
-  }
-  std::unordered_map<int, GatePtr> complements;
-  graph_->Clear<Pdag::kGateMark>();
-  PropagateComplements(graph_->root(), false, &complements);
-  complements.clear();
-  LOG(DEBUG3) << "Complement propagation is done!";
+  RunPass("complement-propagation", /*optional=*/false, [this] {
+    LOG(DEBUG3) << "Propagating complements...";
+    if (graph_->complement()) {
+      const GatePtr& root = graph_->root();
+      assert(root->type() == kOr || root->type() == kAnd ||
+             root->type() == kAtleast || root->type() == kNull);
+      ComplementLogic(root.get());
+      graph_->complement() = false;
+    }
+    graph_->Clear<Pdag::kGateMark>();
+    // The modules without complements are processed and marked in advance.
+    std::vector<GatePtr> modules = GatherModules(/*positive=*/true);
+    TransformModules(&modules, [this](const GatePtr& module) {
+      std::unordered_map<int, GatePtr> complements;
+      PropagateComplements(module, false, &complements);
+    });
+    std::unordered_map<int, GatePtr> complements;
+    PropagateComplements(graph_->root(), false, &complements);
+    complements.clear();
+    LOG(DEBUG3) << "Complement propagation is done!";
+    return false;
+  });
 
   if (graph_->IsTrivial())
     return;
@@ -405,8 +498,13 @@ void Preprocessor::RunPhaseFive() noexcept {
   TIMER(DEBUG2, "Preprocessing Phase V");
   SANITY_ASSERT;
   graph_->Log();
-  while (CoalesceGates(/*common=*/true))
-    continue;
+  auto coalesce_common_gates = [this] {
+    RunPass("common-gate-coalescing", /*optional=*/false, [this] {
+      CoalesceGates(/*common=*/true);
+      return false;
+    });
+  };
+  coalesce_common_gates();
 
   if (graph_->IsTrivial())
     return;
@@ -415,8 +513,7 @@ void Preprocessor::RunPhaseFive() noexcept {
   if (graph_->IsTrivial())
     return;
 
-  while (CoalesceGates(/*common=*/true))
-    continue;
+  coalesce_common_gates();
 
   if (graph_->IsTrivial())
     return;
@@ -502,6 +599,8 @@ void Preprocessor::NormalizeGates(bool full) noexcept {
   NotifyParentsOfNegativeGates(root_gate);
 
   graph_->Clear<Pdag::kGateMark>();
+  if (full)
+    NormalizeModules();
   NormalizeGate(root_gate, full);  // Registers null gates only.
 
   assert(!graph_->HasConstants());
@@ -518,6 +617,135 @@ void Preprocessor::NotifyParentsOfNegativeGates(const GatePtr& gate) noexcept {
   }
 }
 
+std::vector<GatePtr> Preprocessor::GatherModules(bool positive) noexcept {
+  const int kMinModuleSize = 64;  // The min number of gates worth a thread.
+  std::vector<GatePtr> modules;  // The outermost modules under the root.
+  std::unordered_set<int> complements;  // The modules under odd complements.
+  std::unordered_set<int> visited;  // The gate indices signed by the parity.
+  auto gather = [&](auto& self, const GatePtr& gate, bool odd) -> void {
+    for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
+      bool arg_odd = odd ^ (arg.first < 0);
+      int index = arg.second->index();
+      if (arg.second->module()) {
+        if (visited.insert(index).second)
+          modules.push_back(arg.second);
+        if (arg_odd)
+          complements.insert(index);
+      } else if (visited.insert(arg_odd ? -index : index).second) {
+        self(self, arg.second, arg_odd);
+      }
+    }
+  };
+  gather(gather, graph_->root(), false);
+
+  std::unordered_set<int> counted;
+  boost::remove_erase_if(modules, [&](const GatePtr& module) {
+    if (positive && complements.count(module->index()))
+      return true;
+    int num_gates = 0;
+    auto count = [&](auto& self, const GatePtr& gate) -> void {
+      if (num_gates == kMinModuleSize || !counted.insert(gate->index()).second)
+        return;
+      ++num_gates;
+      for (const Gate::Arg<Gate>& arg : gate->args<Gate>())
+        self(self, arg.second);
+    };
+    count(count, module);
+    return num_gates < kMinModuleSize;
+  });
+  return modules;
+}
+
+template <class F>
+void Preprocessor::TransformModules(std::vector<GatePtr>* modules,
+                                    F&& transform) noexcept {
+  const int kMaxPartitions = 64;  // Interleaved indices grow with the number.
+  if (modules->size() < 2) {
+    modules->clear();  // The whole graph transformation is enough.
+    return;
+  }
+  int num_partitions = std::min<int>(modules->size(), kMaxPartitions);
+  LOG(DEBUG4) << "Transforming " << modules->size() << " modules in "
+              << num_partitions << " partitions...";
+  std::deque<Pdag::Partition> partitions;
+  for (int i = 0; i < num_partitions; ++i)
+    partitions.emplace_back(graph_, i, num_partitions);
+  ParallelFor(num_partitions, [modules, &transform, &partitions,
+                               num_partitions](int i) {
+    for (int j = i; j < modules->size(); j += num_partitions) {
+      GatePtr* module = &(*modules)[j];
+      partitions[i].Run(module, [&transform, module] { transform(*module); });
+    }
+  });
+  for (Pdag::Partition& partition : partitions)
+    partition.Merge();  // The same registration order for any threads.
+}
+
+void Preprocessor::NormalizeModules() noexcept {
+  // The max number of node indices reserved for all the partitions.
+  const std::int64_t kMaxReservedNodes = std::numeric_limits<int>::max() / 2;
+  // The exact number of new gates of K/N normalization by (N, K).
+  std::map<std::pair<int, int>, std::int64_t> atleast_gates;
+  auto count_atleast = [&atleast_gates, kMaxReservedNodes](
+                           auto& self, int num_args,
+                           int min_number) -> std::int64_t {
+    if (num_args == min_number || min_number == 1)
+      return 0;
+    auto [it, inserted] = atleast_gates.emplace(
+        std::pair(num_args, min_number), 0);
+    if (inserted) {  // Saturated to stay within the integer range.
+      it->second = std::min(kMaxReservedNodes + 1,
+                            3 + self(self, num_args - 1, min_number - 1) +
+                                self(self, num_args - 1, min_number));
+    }
+    return it->second;
+  };
+  struct Task {
+    GatePtr module;  ///< The root of the partition.
+    std::int64_t num_gates;  ///< The number of new gates in the partition.
+  };
+  std::vector<Task> tasks;
+  std::int64_t num_reserved_nodes = 0;
+  std::unordered_set<int> visited;
+  for (const GatePtr& module : GatherModules(/*positive=*/false)) {
+    std::int64_t num_new_gates = 0;
+    auto count = [&](auto& self, const GatePtr& gate) -> void {
+      if (gate->type() == kXor) {
+        num_new_gates += 2;
+      } else if (gate->type() == kAtleast && !native_atleast()) {
+        num_new_gates = std::min(
+            kMaxReservedNodes + 1,
+            num_new_gates + count_atleast(count_atleast, gate->args().size(),
+                                          gate->min_number()));
+      }
+      for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
+        if (visited.insert(arg.second->index()).second)
+          self(self, arg.second);
+      }
+    };
+    count(count, module);
+    // Modules beyond the index reservation are left for the whole graph.
+    if (num_reserved_nodes + num_new_gates <= kMaxReservedNodes) {
+      num_reserved_nodes += num_new_gates;
+      tasks.push_back({module, num_new_gates});
+    }
+  }
+  if (tasks.size() < 2)
+    return;  // The whole graph normalization is enough.
+
+  LOG(DEBUG4) << "Normalizing " << tasks.size() << " modules in parallel...";
+  std::deque<Pdag::Partition> partitions;
+  for (const Task& task : tasks)
+    partitions.emplace_back(graph_, static_cast<int>(task.num_gates));
+  ParallelFor(tasks.size(), [this, &tasks, &partitions](int i) {
+    GatePtr* module = &tasks[i].module;
+    partitions[i].Run(module,
+                      [this, module] { NormalizeGate(*module, /*full=*/true); });
+  });
+  for (Pdag::Partition& partition : partitions)
+    partition.Merge();  // The same registration order for any threads.
+}
+
 void Preprocessor::NormalizeGate(const GatePtr& gate, bool full) noexcept {
   if (gate->mark())
     return;
@@ -546,7 +774,7 @@ void Preprocessor::NormalizeGate(const GatePtr& gate, bool full) noexcept {
     case kAtleast:
       assert(gate->args().size() > 2);
       assert(gate->min_number() > 1);
-      if (full)
+      if (full && !native_atleast())
         NormalizeAtleastGate(gate);
       break;
     case kNot:
@@ -652,20 +880,17 @@ void Preprocessor::PropagateComplements(
       assert(it->second->mark());
       continue;  // Existing complements are already processed.
     }
-    Connective type = arg_gate->type();
-    assert(type == kAnd || type == kOr);
-    Connective complement_type = type == kOr ? kAnd : kOr;
+    assert(arg_gate->type() == kAnd || arg_gate->type() == kOr ||
+           arg_gate->type() == kAtleast);
     GatePtr complement;
     if (arg_gate->parents().size() == 1) {  // Optimization. Reuse.
-      arg_gate->type(complement_type);
-      arg_gate->NegateArgs();
+      ComplementLogic(arg_gate.get());
       complement = arg_gate;
     } else {
       complement = arg_gate->Clone();
       if (arg_gate->module())
         arg_gate->module(false);  // Not good.
-      complement->type(complement_type);
-      complement->NegateArgs();
+      ComplementLogic(complement.get());
       complements->emplace(arg_gate->index(), complement);
     }
     to_swap.emplace_back(arg.first, complement);
@@ -685,17 +910,61 @@ bool Preprocessor::CoalesceGates(bool common) noexcept {
   assert(!graph_->HasNullGates());
   if (graph_->root()->constant())
     return false;
+  graph_->TrackDirtyGates(true);
   graph_->Clear<Pdag::kGateMark>();
-  bool ret = CoalesceGates(graph_->root(), common);
+  std::atomic<bool> changed_modules = false;
+  std::vector<GatePtr> modules = GatherModules(/*positive=*/false);
+  TransformModules(&modules, [this, common, &changed_modules](
+                                 const GatePtr& module) {
+    bool changed = CoalesceGates(module, common);
+    CoalesceDirtyGates(changed, common);
+    if (changed)
+      changed_modules = true;
+  });
+  for (const GatePtr& module : modules)
+    module->mark(true);  // Null gate removal clears the marks.
+  bool ret = CoalesceGates(graph_->root(), common) || changed_modules;
+  CoalesceDirtyGates(ret, common);
+  graph_->TrackDirtyGates(false);
+  return ret;
+}
 
+void Preprocessor::CoalesceDirtyGates(bool changed, bool common) noexcept {
   graph_->RemoveNullGates();  // Actually, only constants are created.
-  return ret;
+  // New coalescing is possible only for the changed gates and their parents.
+  while (changed && !graph_->root()->constant()) {
+    changed = false;
+    for (const GateWeakPtr& ptr : graph_->PopDirtyGates()) {
+      GatePtr gate = ptr.lock();
+      if (!gate)
+        continue;
+      std::vector<GatePtr> parents;  // Coalescing changes the parents.
+      if (gate != graph_->root()) {  // The module root parents are outside.
+        for (const auto& parent : gate->parents())
+          parents.push_back(parent.second.lock());
+      }
+      changed |= CoalesceArgs(gate, common);
+      for (const GatePtr& parent : parents)
+        changed |= CoalesceArgs(parent, common);
+    }
+    graph_->RemoveNullGates();
+  }
 }
 
 bool Preprocessor::CoalesceGates(const GatePtr& gate, bool common) noexcept {
   if (gate->mark())
     return false;
   gate->mark(true);
+  assert(!gate->args().empty());
+  bool changed = false;  // Indication if the graph is changed.
+  for (const Gate::Arg<Gate>& arg : gate->args<Gate>())
+    changed |= CoalesceGates(arg.second, common);
+  return CoalesceArgs(gate, common) || changed;
+}
+
+bool Preprocessor::CoalesceArgs(const GatePtr& gate, bool common) noexcept {
+  if (gate->parents().empty() && gate != graph_->root())
+    return false;  // The gate has been removed from the graph.
   Connective target_type = kNull;  // What kind of arg gate are we looking for?
   switch (gate->type()) {
     case kNand:
@@ -709,17 +978,11 @@ bool Preprocessor::CoalesceGates(const GatePtr& gate, bool common) noexcept {
       target_type = kOr;
       break;
     default:
-      target_type = kNull;  // Implicit no operation!
+      return false;  // Coalescing is impossible.
   }
-  assert(!gate->args().empty());
   std::vector<GatePtr> to_join;  // Gate arguments of the same logic.
-  bool changed = false;  // Indication if the graph is changed.
   for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
     const GatePtr& arg_gate = arg.second;
-    changed |= CoalesceGates(arg_gate, common);
-
-    if (target_type == kNull)
-      continue;  // Coalescing is impossible.
     if (arg_gate->constant())
       continue;  // No args to join.
     if (arg.first < 0)
@@ -733,14 +996,13 @@ bool Preprocessor::CoalesceGates(const GatePtr& gate, bool common) noexcept {
       to_join.push_back(arg_gate);
   }
 
-  changed |= !to_join.empty();
   for (const GatePtr& arg : to_join) {
     gate->CoalesceGate(arg);
     if (gate->constant())
       break;  // The parent is constant. No need to join other arguments.
     assert(gate->args().size() > 1);  // Does not produce NULL type gates.
   }
-  return changed;
+  return !to_join.empty();
 }
 
 bool Preprocessor::ProcessMultipleDefinitions() noexcept {
@@ -761,6 +1023,7 @@ bool Preprocessor::ProcessMultipleDefinitions() noexcept {
 
   if (multi_def.empty())
     return false;
+  graph_->TrackDirtyGates(true);
   LOG(DEBUG4) << multi_def.size() << " gates are multiply defined.";
   for (const auto& def : multi_def) {
     LOG(DEBUG5) << "Gate " << def.first->index() << ": " << def.second.size()
@@ -772,9 +1035,52 @@ bool Preprocessor::ProcessMultipleDefinitions() noexcept {
     }
   }
   graph_->RemoveNullGates();
+
+  // New definitions may only appear among the changed gates.
+  for (bool changed = true; changed && !graph_->root()->constant();) {
+    changed = false;
+    for (const GateWeakPtr& ptr : graph_->PopDirtyGates()) {
+      GatePtr gate = ptr.lock();
+      if (!gate)
+        continue;
+      if (GatePtr definition = FindDefinition(gate)) {
+        ReplaceGate(gate, definition);
+        changed = true;
+      }
+    }
+    graph_->RemoveNullGates();
+  }
+  graph_->TrackDirtyGates(false);
   return true;
 }
 
+GatePtr Preprocessor::FindDefinition(const GatePtr& gate) noexcept {
+  if (gate->parents().empty() || gate->module() || gate->type() == kNull)
+    return nullptr;  // Removed, root, unique, or constant gates.
+  // Any other definition is a parent of every argument.
+  const NodeParentManager::ParentMap* candidates = nullptr;
+  auto choose = [&candidates](const auto& args) {
+    for (const auto& arg : args) {
+      if (!candidates || arg.second->parents().size() < candidates->size())
+        candidates = &arg.second->parents();
+    }
+  };
+  choose(gate->args<Gate>());
+  choose(gate->args<Variable>());
+  assert(candidates && "Corrupted gate.");
+  for (const auto& candidate : *candidates) {
+    GatePtr other = candidate.second.lock();
+    if (other == gate || other->parents().empty() || other->module())
+      continue;
+    if (other->type() != gate->type() || other->args() != gate->args())
+      continue;
+    if (gate->type() == kAtleast && other->min_number() != gate->min_number())
+      continue;
+    return other;
+  }
+  return nullptr;
+}
+
 void Preprocessor::DetectMultipleDefinitions(
     const GatePtr& gate,
     std::unordered_map<GatePtr, std::vector<GateWeakPtr>>* multi_def,
@@ -1784,18 +2090,28 @@ void Preprocessor::BooleanOptimization() noexcept {
   if (graph_->root()->module() == false)
     graph_->root()->module(true);
 
-  std::vector<GateWeakPtr> common_gates;
-  std::vector<std::weak_ptr<Variable>> common_variables;
-  GatherCommonNodes(&common_gates, &common_variables);
-  for (const auto& gate : common_gates)
-    ProcessCommonNode(gate);
-  for (const auto& var : common_variables)
-    ProcessCommonNode(var);
+  auto optimize = [this](const std::unordered_set<int>& modules) {
+    std::vector<GateWeakPtr> common_gates;
+    std::vector<std::weak_ptr<Variable>> common_variables;
+    GatherCommonNodes(&common_gates, &common_variables, modules);
+    for (const auto& gate : common_gates)
+      ProcessCommonNode(gate);
+    for (const auto& var : common_variables)
+      ProcessCommonNode(var);
+  };
+  std::vector<GatePtr> modules = GatherModules(/*positive=*/false);
+  TransformModules(&modules, [&optimize](const GatePtr&) { optimize({}); });
+  graph_->RemoveNullGates();  // The module roots may become constant.
+  std::unordered_set<int> optimized_modules;
+  for (const GatePtr& module : modules)
+    optimized_modules.insert(module->index());
+  optimize(optimized_modules);
 }
 
 void Preprocessor::GatherCommonNodes(
     std::vector<GateWeakPtr>* common_gates,
-    std::vector<std::weak_ptr<Variable>>* common_variables) noexcept {
+    std::vector<std::weak_ptr<Variable>>* common_variables,
+    const std::unordered_set<int>& modules) noexcept {
   graph_->Clear<Pdag::kVisit>();
   std::queue<Gate*> gates_queue;
   gates_queue.push(graph_->root().get());
@@ -1808,7 +2124,8 @@ void Preprocessor::GatherCommonNodes(
       if (arg_gate->Visited())
         continue;
       arg_gate->Visit(1);
-      gates_queue.push(arg_gate.get());
+      if (!modules.count(arg_gate->index()))
+        gates_queue.push(arg_gate.get());
       if (arg_gate->parents().size() > 1)
         common_gates->push_back(arg_gate);
     }
@@ -2102,7 +2419,7 @@ bool Preprocessor::DecomposeCommonNodes() noexcept {
 
   std::vector<GateWeakPtr> common_gates;
   std::vector<std::weak_ptr<Variable>> common_variables;
-  GatherCommonNodes(&common_gates, &common_variables);
+  GatherCommonNodes(&common_gates, &common_variables, {});
 
   graph_->Clear<Pdag::kVisit>();
   AssignTiming(0, graph_->root());  // Required for optimization.
@@ -2408,4 +2725,9 @@ void CustomPreprocessor<Mocus>::InvertOrder() noexcept {
     var->order(shift + var->order());
 }
 
+void CustomPreprocessor<MonteCarlo>::Run() noexcept {
+  pdag::Transform(graph_, [this](Pdag*) { RunPhaseOne(); },
+                  [this](Pdag*) { RunPhaseTwo(); });
+}
+
 }  // namespace scram::core
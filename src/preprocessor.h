@@ -24,6 +24,7 @@
 #include <memory>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -82,6 +83,23 @@ void MarkCoherence(Pdag* graph) noexcept;
 
 }  // namespace pdag
 
+/// Profile of a preprocessing pass accumulated over its runs.
+struct PassProfile {
+  const char* name;  ///< The unique name of the pass.
+  int runs = 0;  ///< The number of runs including fixpoint iterations.
+  int skips = 0;  ///< The number of skipped runs.
+  double time = 0;  ///< The total wall time of the runs in seconds.
+  int gates = 0;  ///< The total change in the number of gates.
+  int args = 0;  ///< The total change in the number of gate arguments.
+};
+
+/// Adds up the profiles of passes with the same names.
+///
+/// @param[in] profiles  The profiles of another preprocessing.
+/// @param[in,out] total  The accumulated profiles.
+void Accumulate(const std::vector<PassProfile>& profiles,
+                std::vector<PassProfile>* total) noexcept;
+
 /// The class provides main preprocessing operations
 /// over a PDAG
 /// to simplify the fault tree
@@ -103,14 +121,22 @@ class Preprocessor : private boost::noncopyable {
   ///          which will mess the new structure of the PDAG.
   explicit Preprocessor(Pdag* graph) noexcept;
 
+  /// @copydoc Preprocessor::Preprocessor(Pdag*)
+  ///
+  /// @param[in] pass_budget  The time budget in seconds
+  ///                         for each optional optimization pass.
+  ///                         0 for unlimited time.
+  Preprocessor(Pdag* graph, double pass_budget) noexcept;
+
   virtual ~Preprocessor() = default;
 
   /// Runs the graph preprocessing.
   void operator()() noexcept;
 
- protected:
-  class GateSet;  ///< Container of unique gates by semantics.
+  /// @returns The profiles of the passes in the order of their first run.
+  const std::vector<PassProfile>& profiles() const { return profiles_; }
 
+ protected:
   /// Runs the default preprocessing
   /// that achieves the graph in a normal form.
   virtual void Run() noexcept = 0;
@@ -160,6 +186,8 @@ class Preprocessor : private boost::noncopyable {
   /// the graph is in negation normal form.
   ///
   /// @note Complements are propagated to the variables of the graph.
+  /// @note Large modules without complements are processed
+  ///       in worker threads.
   void RunPhaseFour() noexcept;
 
   /// The final phase
@@ -205,6 +233,47 @@ class Preprocessor : private boost::noncopyable {
   ///          so it is not handled here.
   void NotifyParentsOfNegativeGates(const GatePtr& gate) noexcept;
 
+  /// Gathers the outermost independent modules under the root
+  /// large enough to be transformed in worker threads.
+  ///
+  /// @param[in] positive  Exclude the modules
+  ///                      reached through an odd number of complements.
+  ///
+  /// @returns The module gates in the order of the traversal.
+  std::vector<GatePtr> GatherModules(bool positive) noexcept;
+
+  /// Transforms modules in worker threads.
+  /// Each module is transformed in its own graph partition,
+  /// so the graph does not depend on the number of threads.
+  /// The transformation sees its module as the root of the whole graph
+  /// (the gate marks, node visits, NULL type and dirty gates),
+  /// and the module root replacement is spliced into the parents
+  /// after all the modules are transformed.
+  ///
+  /// @tparam F  The transformation of a module root gate.
+  ///
+  /// @param[in,out] modules  The independent modules to transform.
+  ///                         Replaced roots are updated.
+  ///                         Fewer than two modules are cleared
+  ///                         for the transformation of the whole graph.
+  /// @param[in] transform  The transformation of the module.
+  ///
+  /// @post The NULL type module roots are registered in the graph.
+  template <class F>
+  void TransformModules(std::vector<GatePtr>* modules, F&& transform) noexcept;
+
+  /// Fully normalizes the outermost independent modules
+  /// in worker threads.
+  /// Each module gets a reserved range of node indices.
+  /// Small modules are left for the normalization of the whole graph.
+  ///
+  /// @note This is a helper function for NormalizeGates().
+  ///
+  /// @warning Gate marks must be clear.
+  /// @warning The parents of negative gates are assumed to be
+  ///          notified about the change of their arguments' types.
+  void NormalizeModules() noexcept;
+
   /// Normalizes complex gates into OR, AND gates.
   ///
   /// @param[in,out] gate  The gate to be processed.
@@ -250,7 +319,9 @@ class Preprocessor : private boost::noncopyable {
   /// Propagates complements of argument gates down to leafs
   /// according to the De Morgan's law
   /// in order to remove any negative logic from the graph's gates.
-  /// The resulting graph will contain only positive gates, OR and AND types.
+  /// The resulting graph will contain only positive gates,
+  /// OR, AND, and K/N types.
+  /// The complement of K/N gate is (N-K+1)/N gate of complement arguments.
   /// After this function, the PDAG is in negation normal form.
   ///
   /// @param[in,out] gate  The starting gate to traverse the graph.
@@ -259,7 +330,7 @@ class Preprocessor : private boost::noncopyable {
   /// @param[in,out] complements  The processed complements of shared gates.
   ///
   /// @note The graph must be normalized.
-  ///       It must contain only OR and AND gates.
+  ///       It must contain only OR, AND, and K/N gates.
   ///
   /// @warning Gate marks must be clear.
   /// @warning If the root gate has a negative sign,
@@ -270,7 +341,10 @@ class Preprocessor : private boost::noncopyable {
   PropagateComplements(const GatePtr& gate, bool keep_modules,
                        std::unordered_map<int, GatePtr>* complements) noexcept;
 
-  /// Runs gate coalescence on the whole PDAG.
+  /// Runs gate coalescence on the whole PDAG
+  /// until no more gates can be coalesced.
+  /// After the first traversal,
+  /// only the changed gates and their parents are revisited.
   ///
   /// @param[in] common  A flag to also coalesce common/shared gates.
   ///                    These gates may be important for other algorithms.
@@ -278,10 +352,22 @@ class Preprocessor : private boost::noncopyable {
   /// @returns true if the graph has been changed.
   ///
   /// @note Module gates are omitted from coalescing to preserve them.
+  /// @note Large modules are coalesced in worker threads.
   ///
   /// @warning Gate marks are used.
   bool CoalesceGates(bool common) noexcept;
 
+  /// Coalesces the registered dirty gates and their parents
+  /// until no more gates can be coalesced.
+  ///
+  /// @param[in] changed  true if the first traversal has changed the graph.
+  /// @param[in] common  A flag to also coalesce common/shared gates.
+  ///
+  /// @pre The graph tracks dirty gates.
+  ///
+  /// @warning Gate marks are cleared.
+  void CoalesceDirtyGates(bool changed, bool common) noexcept;
+
   /// Coalesces positive argument gates
   /// with the same OR or AND logic as parents.
   /// This function merges similar logic gates of NAND and NOR as well.
@@ -302,19 +388,36 @@ class Preprocessor : private boost::noncopyable {
   /// @warning Gate marks are used.
   bool CoalesceGates(const GatePtr& gate, bool common) noexcept;
 
+  /// Coalesces the argument gates of the same logic into the gate
+  /// without traversing the graph.
+  ///
+  /// @param[in,out] gate  The parent gate.
+  /// @param[in] common  A flag to also join common gates.
+  ///
+  /// @returns true if any argument gate is coalesced.
+  bool CoalesceArgs(const GatePtr& gate, bool common) noexcept;
+
   /// Detects and replaces multiple definitions of gates.
   /// Gates with the same logic and inputs
   /// but different indices are considered redundant.
   ///
   /// @returns true if multiple definitions are found and replaced.
   ///
-  /// @note This function does not recursively detect multiple definitions
-  ///       due to replaced redundant arguments of gates.
-  ///       The replaced gates are considered a new graph,
-  ///       and this function must be called again
-  ///       to verify that the new graph does not have multiple definitions.
+  /// @note The replacements may make the parents of redundant gates
+  ///       multiple definitions as well.
+  ///       These new definitions are searched among the changed gates only
+  ///       instead of traversing the whole graph again.
   bool ProcessMultipleDefinitions() noexcept;
 
+  /// Finds another definition of a gate
+  /// among the parents of its arguments.
+  ///
+  /// @param[in] gate  The gate in the graph.
+  ///
+  /// @returns A gate in the graph with the same logic and arguments.
+  /// @returns nullptr if the gate is unique, a module, or the root.
+  GatePtr FindDefinition(const GatePtr& gate) noexcept;
+
   /// Traverses the PDAG to collect multiple definitions of gates.
   ///
   /// @param[in] gate  The gate to traverse the sub-graph.
@@ -683,6 +786,7 @@ class Preprocessor : private boost::noncopyable {
   /// The graph structure is optimized
   /// by removing the redundancies if possible.
   /// This optimization helps reduce the number of common nodes.
+  /// The common nodes of large modules are processed in worker threads.
   ///
   /// @warning Boolean optimization may replace the root gate of the graph.
   /// @warning Node visit information is manipulated.
@@ -697,13 +801,16 @@ class Preprocessor : private boost::noncopyable {
   ///
   /// @param[out] common_gates  Gates with more than one parent.
   /// @param[out] common_variables  Common variables.
+  /// @param[in] modules  The indices of the gates not to traverse
+  ///                     (e.g., the already processed modules).
   ///
   /// @note Constant nodes are not expected to be operated.
   ///
   /// @warning Node visit information is manipulated.
   void GatherCommonNodes(
       std::vector<GateWeakPtr>* common_gates,
-      std::vector<std::weak_ptr<Variable>>* common_variables) noexcept;
+      std::vector<std::weak_ptr<Variable>>* common_variables,
+      const std::unordered_set<int>& modules) noexcept;
 
   /// Tries to simplify the graph by removing redundancies
   /// generated by a common node.
@@ -991,8 +1098,31 @@ class Preprocessor : private boost::noncopyable {
   void GatherNodes(const GatePtr& gate, std::vector<GatePtr>* gates,
                    std::vector<VariablePtr>* variables) noexcept;
 
+  /// Runs a preprocessing pass with profiling.
+  /// Optional passes are skipped
+  /// once they exhaust their time budget
+  /// or stop changing the graph in consecutive runs.
+  ///
+  /// @param[in] name  The unique name of the pass.
+  /// @param[in] optional  true if the pass only optimizes the graph.
+  /// @param[in] pass  The pass returning true to run again (fixpoint).
+  template <class F>
+  void RunPass(const char* name, bool optional, F&& pass) noexcept;
+
+  /// @returns The number of gates and gate arguments in the graph.
+  std::pair<int, int> CountGraph() const noexcept;
+
+  /// @returns true if the analysis algorithm handles K/N gates natively,
+  ///          so the full normalization keeps them intact.
+  virtual bool native_atleast() const noexcept { return false; }
+
   /// @todo Eliminate the protected data.
   Pdag* graph_;  ///< The PDAG to preprocess.
+
+ private:
+  double pass_budget_;  ///< The time budget for optional passes.
+  std::vector<PassProfile> profiles_;  ///< The profiles of passes.
+  std::vector<int> idle_runs_;  ///< Consecutive runs without changes.
 };
 
 /// Undefined template class for specialization of Preprocessor
@@ -1014,6 +1144,9 @@ class CustomPreprocessor<Bdd> : public Preprocessor {
   /// Performs preprocessing for analyses with Binary Decision Diagrams.
   /// This preprocessing assigns the order for variables for BDD construction.
   void Run() noexcept override;
+
+  /// @returns true since BDD applies the threshold logic directly.
+  bool native_atleast() const noexcept override { return true; }
 };
 
 class Zbdd;
@@ -1030,6 +1163,9 @@ class CustomPreprocessor<Zbdd> : public Preprocessor {
   /// Complements are propagated to variables.
   /// This preprocessing assigns the order for variables for ZBDD construction.
   void Run() noexcept override;
+
+  /// @returns true since ZBDD applies the threshold logic directly.
+  bool native_atleast() const noexcept override { return true; }
 };
 
 class Mocus;
@@ -1049,6 +1185,9 @@ class CustomPreprocessor<Mocus> : public CustomPreprocessor<Zbdd> {
   /// The variable ordering is assigned specifically for MOCUS.
   void Run() noexcept override;
 
+  /// @returns false since MOCUS expands gates of AND/OR logic only.
+  bool native_atleast() const noexcept override { return false; }
+
   /// Groups and inverts the topological ordering for nodes.
   /// The inversion is done to simplify the work of MOCUS facilities,
   /// which rely on the top-down approach.
@@ -1063,4 +1202,19 @@ class CustomPreprocessor<Mocus> : public CustomPreprocessor<Zbdd> {
   void InvertOrder() noexcept;
 };
 
+class MonteCarlo;
+
+/// Specialization of preprocessing for direct simulation of PDAGs.
+template <>
+class CustomPreprocessor<MonteCarlo> : public Preprocessor {
+ public:
+  using Preprocessor::Preprocessor;
+
+ private:
+  /// Simplifies the graph without the normalization of gates.
+  /// The simulation evaluates all connectives natively,
+  /// so K/N and XOR gates are not expanded into AND/OR gates.
+  void Run() noexcept override;
+};
+
 }  // namespace scram::core
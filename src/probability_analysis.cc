@@ -21,10 +21,13 @@
 
 #include "probability_analysis.h"
 
+#include <algorithm>
+
 #include <boost/range/algorithm/find_if.hpp>
 
 #include "event.h"
 #include "logger.h"
+#include "parallel.h"
 #include "parameter.h"
 #include "settings.h"
 #include "zbdd.h"
@@ -33,7 +36,14 @@ namespace scram::core {
 
 ProbabilityAnalysis::ProbabilityAnalysis(const FaultTreeAnalysis* fta,
                                          mef::MissionTime* mission_time)
-    : Analysis(fta->settings()), p_total_(0), mission_time_(mission_time) {}
+    : Analysis(fta->settings()), p_total_(0), mission_time_(mission_time) {
+  // The qualitative analysis may be shared by phases of other mission times.
+  Analysis::settings().mission_time(mission_time->value());
+}
+
+ProbabilityAnalysis::ProbabilityAnalysis(const Settings& settings,
+                                         mef::MissionTime* mission_time)
+    : Analysis(settings), p_total_(0), mission_time_(mission_time) {}
 
 void ProbabilityAnalysis::Analyze() noexcept {
   CLOCK(p_time);
@@ -167,22 +177,206 @@ double CutSetProbabilityCalculator::Calculate(
   return p_sub_set;
 }
 
+ProductMatrix::ProductMatrix(const Zbdd& products) {
+  offsets_.push_back(0);
+  for (const std::vector<int>& product : products) {
+    for (int index : product) {
+      assert(index > 0 && "Complements in a cut set.");
+      columns_.push_back(index - Pdag::kVariableStartIndex);
+    }
+    offsets_.push_back(columns_.size());
+  }
+}
+
+namespace {
+
+/// The number of products in a block of the parallel reduction.
+/// Small product sets are reduced sequentially in a single block.
+const int kReductionBlockSize = 1 << 15;
+
+/// The minimum number of products to spread the reduction over threads.
+/// Smaller product sets are not worth the start of worker threads.
+const int kParallelReductionRows = 1 << 17;
+
+/// Reduces values of products in blocks on worker threads.
+/// The block partials are combined in the block order,
+/// so the result does not depend on the number of threads.
+/// The blocks are reduced serially for small product sets
+/// or inside the tasks of other parallel algorithms.
+///
+/// @tparam T  The value type.
+/// @tparam Reducer  Reduction of a row range to a value: (first, last) -> T.
+/// @tparam Combiner  Binary combination of values: (T, T) -> T.
+///
+/// @param[in] num_rows  The number of products.
+/// @param[in] identity  The identity value of the combination.
+/// @param[in] reduce  The reduction of product ranges.
+/// @param[in] combine  The combination of block partials.
+///
+/// @returns The reduced value of all products.
+template <typename T, class Reducer, class Combiner>
+T ParallelReduce(int num_rows, T identity, const Reducer& reduce,
+                 const Combiner& combine) noexcept {
+  int num_blocks = (num_rows + kReductionBlockSize - 1) / kReductionBlockSize;
+  if (num_blocks <= 1)
+    return reduce(0, num_rows);
+  std::vector<T> partials(num_blocks, identity);
+  auto reduce_block = [&partials, &reduce, num_rows](int i) {
+    int first = i * kReductionBlockSize;
+    partials[i] = reduce(first, std::min(first + kReductionBlockSize,
+                                         num_rows));
+  };
+  if (num_rows < kParallelReductionRows) {
+    for (int i = 0; i < num_blocks; ++i)
+      reduce_block(i);
+  } else {
+    ParallelFor(num_blocks, reduce_block);
+  }
+  T result = identity;
+  for (const T& partial : partials)
+    result = combine(result, partial);
+  return result;
+}
+
+/// Calculates the probability of a cut set
+/// together with the probabilities of the cut set without each member.
+/// Prefix and suffix products avoid the division by member probabilities,
+/// which may be 0.
+///
+/// @param[in] first  The first column of the product row.
+/// @param[in] last  The end of the product row.
+/// @param[in] p_vars  Zero-based probabilities of variables.
+/// @param[out] p_rest  The probabilities without members at the same positions.
+///
+/// @returns The total probability of the cut set.
+double CalculateWithoutMembers(const int* first, const int* last,
+                               const double* p_vars,
+                               std::vector<double>* p_rest) noexcept {
+  int size = last - first;
+  p_rest->resize(size);
+  double prefix = 1;
+  for (int i = 0; i < size; ++i) {
+    (*p_rest)[i] = prefix;
+    prefix *= p_vars[first[i]];
+  }
+  double suffix = 1;
+  for (int i = size - 1; i >= 0; --i) {
+    (*p_rest)[i] *= suffix;
+    suffix *= p_vars[first[i]];
+  }
+  return prefix;
+}
+
+}  // namespace
+
 double RareEventCalculator::Calculate(
-    const Zbdd& cut_sets, const Pdag::IndexMap<double>& p_vars) noexcept {
+    const ProductMatrix& cut_sets,
+    const Pdag::IndexMap<double>& p_vars) noexcept {
+  const int* offsets = cut_sets.offsets().data();
+  const int* columns = cut_sets.columns().data();
+  const double* p = p_vars.data();
+  double sum = ParallelReduce(
+      cut_sets.size(), 0.0,
+      [offsets, columns, p](int first, int last) {
+        double block_sum = 0;
+        for (int i = first; i < last; ++i) {
+          block_sum += CutSetProbabilityCalculator::Calculate(
+              columns + offsets[i], columns + offsets[i + 1], p);
+        }
+        return block_sum;
+      },
+      [](double lhs, double rhs) { return lhs + rhs; });
+  return sum > 1 ? 1 : sum;
+}
+
+Pdag::IndexMap<double> RareEventCalculator::CalculateMif(
+    const ProductMatrix& cut_sets,
+    const Pdag::IndexMap<double>& p_vars) noexcept {
+  const std::vector<int>& offsets = cut_sets.offsets();
+  const int* columns = cut_sets.columns().data();
+  std::vector<double> mif(p_vars.size());  // Zero-based like columns.
+  std::vector<double> p_rest;
   double sum = 0;
-  for (const std::vector<int>& cut_set : cut_sets) {
-    sum += CutSetProbabilityCalculator::Calculate(cut_set, p_vars);
+  for (int i = 0; i < cut_sets.size(); ++i) {
+    const int* first = columns + offsets[i];
+    sum += CalculateWithoutMembers(first, columns + offsets[i + 1],
+                                   p_vars.data(), &p_rest);
+    for (int j = 0; j < p_rest.size(); ++j)
+      mif[first[j]] += p_rest[j];
   }
-  return sum > 1 ? 1 : sum;
+  // The conditional sums are adjusted to 1 as the total probability.
+  Pdag::IndexMap<double> result(p_vars.size());
+  for (int i = 0; i < mif.size(); ++i) {
+    double p_false = sum - p_vars.data()[i] * mif[i];
+    double p_true = p_false + mif[i];
+    result[i + Pdag::kVariableStartIndex] =
+        std::min(p_true, 1.0) - std::min(p_false, 1.0);
+  }
+  return result;
 }
 
 double McubCalculator::Calculate(
-    const Zbdd& cut_sets, const Pdag::IndexMap<double>& p_vars) noexcept {
+    const ProductMatrix& cut_sets,
+    const Pdag::IndexMap<double>& p_vars) noexcept {
+  const int* offsets = cut_sets.offsets().data();
+  const int* columns = cut_sets.columns().data();
+  const double* p = p_vars.data();
+  double m = ParallelReduce(
+      cut_sets.size(), 1.0,
+      [offsets, columns, p](int first, int last) {
+        double block_m = 1;
+        for (int i = first; i < last; ++i) {
+          block_m *= 1 - CutSetProbabilityCalculator::Calculate(
+                             columns + offsets[i], columns + offsets[i + 1], p);
+        }
+        return block_m;
+      },
+      [](double lhs, double rhs) { return lhs * rhs; });
+  return 1 - m;
+}
+
+Pdag::IndexMap<double> McubCalculator::CalculateMif(
+    const ProductMatrix& cut_sets,
+    const Pdag::IndexMap<double>& p_vars) noexcept {
+  // The complement product of cut sets without the ones with the variable
+  // is the total product divided by the product of the variable cut sets.
+  // Zero factors are counted separately to keep the division valid.
+  // The containers are zero-based like columns.
+  const std::vector<int>& offsets = cut_sets.offsets();
+  const int* columns = cut_sets.columns().data();
+  std::vector<double> m_member(p_vars.size(), 1);
+  std::vector<int> zeros_member(p_vars.size());
+  std::vector<double> m_without(p_vars.size(), 1);  // Cut sets w/o member.
   double m = 1;
-  for (const std::vector<int>& cut_set : cut_sets) {
-    m *= 1 - CutSetProbabilityCalculator::Calculate(cut_set, p_vars);
+  int zeros = 0;
+  std::vector<double> p_rest;
+  for (int i = 0; i < cut_sets.size(); ++i) {
+    const int* first = columns + offsets[i];
+    double factor = 1 - CalculateWithoutMembers(first, columns + offsets[i + 1],
+                                                p_vars.data(), &p_rest);
+    if (factor == 0) {
+      ++zeros;
+    } else {
+      m *= factor;
+    }
+    for (int j = 0; j < p_rest.size(); ++j) {
+      int column = first[j];
+      if (factor == 0) {
+        ++zeros_member[column];
+      } else {
+        m_member[column] *= factor;
+      }
+      m_without[column] *= 1 - p_rest[j];
+    }
   }
-  return 1 - m;
+  Pdag::IndexMap<double> mif(p_vars.size());
+  for (int i = 0; i < m_member.size(); ++i) {
+    if (zeros > zeros_member[i] || m_member[i] == 0)
+      continue;  // The other cut sets are certain.
+    mif[i + Pdag::kVariableStartIndex] =
+        m / m_member[i] * (1 - m_without[i]);
+  }
+  return mif;
 }
 
 void ProbabilityAnalyzerBase::ExtractVariableProbabilities() {
@@ -253,7 +447,8 @@ void ProbabilityAnalyzer<Bdd>::CreateBdd(
 
   CLOCK(prep_time);  // Overall preprocessing time.
   LOG(DEBUG2) << "Preprocessing...";
-  CustomPreprocessor<Bdd>{&graph}();
+  CustomPreprocessor<Bdd>{&graph,
+                          Analysis::settings().preprocessing_budget()}();
   LOG(DEBUG2) << "Finished preprocessing in " << DUR(prep_time);
 
   CLOCK(bdd_time);  // BDD based calculation time.
@@ -290,4 +485,51 @@ double ProbabilityAnalyzer<Bdd>::CalculateProbability(
   return ite.p();
 }
 
+namespace {
+
+/// Constructs the PDAG of the target for direct simulation.
+///
+/// @param[in] root  The top gate of the analysis target.
+/// @param[in] settings  Analysis settings for the graph construction.
+/// @param[in] model  The Model containing substitutions if any.
+///
+/// @returns The preprocessed PDAG.
+std::unique_ptr<Pdag> ConstructSimulationGraph(const mef::Gate& root,
+                                               const Settings& settings,
+                                               const mef::Model* model) {
+  auto graph = std::make_unique<Pdag>(root, settings.ccf_analysis(), model);
+  CustomPreprocessor<MonteCarlo>{graph.get(),
+                                 settings.preprocessing_budget()}();
+  return graph;
+}
+
+}  // namespace
+
+ProbabilityAnalyzer<MonteCarlo>::ProbabilityAnalyzer(
+    const mef::Gate& root, const Settings& settings, const mef::Model* model,
+    mef::MissionTime* mission_time)
+    : ProbabilityAnalyzer(ConstructSimulationGraph(root, settings, model),
+                          settings, mission_time) {}
+
+ProbabilityAnalyzer<MonteCarlo>::ProbabilityAnalyzer(
+    std::unique_ptr<Pdag> graph, const Settings& settings,
+    mef::MissionTime* mission_time)
+    : ProbabilityAnalyzerBase(graph.get(), settings, mission_time),
+      pdag_(std::move(graph)),
+      simulator_(pdag_.get(), Analysis::settings()) {
+  if (!pdag_->substitutions().empty())
+    Analysis::AddWarning("Non-declarative substitutions are not simulated.");
+}
+
+MonteCarlo::Estimate ProbabilityAnalyzer<MonteCarlo>::estimate() const {
+  double num_trials = simulator_.num_trials();
+  double sum = ProbabilityAnalysis::p_total() * num_trials;
+  return MonteCarlo::MakeEstimate(sum, sum, num_trials, 0, 1);
+}
+
+double ProbabilityAnalyzer<MonteCarlo>::CalculateTotalProbability(
+    const Pdag::IndexMap<double>& p_vars) noexcept {
+  return simulator_.Simulate(p_vars).mean;
+}
+
 }  // namespace scram::core
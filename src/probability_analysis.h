@@ -20,16 +20,20 @@
 
 #pragma once
 
+#include <memory>
 #include <utility>
 #include <vector>
 
 #include "analysis.h"
 #include "bdd.h"
 #include "fault_tree_analysis.h"
+#include "monte_carlo.h"
 #include "pdag.h"
 
 namespace scram::mef {
 class MissionTime;
+class Model;
+class Gate;
 }  // namespace scram::mef
 
 namespace scram::core {
@@ -59,6 +63,9 @@ class ProbabilityAnalysis : public Analysis {
   /// Probability analysis
   /// with the results of qualitative analysis.
   ///
+  /// The settings of the fault tree analysis are taken
+  /// with the current value of the mission time expression.
+  ///
   /// @param[in] fta  Fault tree analysis with results.
   /// @param[in] mission_time  The mission time expression of the model.
   ///
@@ -67,6 +74,13 @@ class ProbabilityAnalysis : public Analysis {
   ProbabilityAnalysis(const FaultTreeAnalysis* fta,
                       mef::MissionTime* mission_time);
 
+  /// Probability analysis
+  /// without the results of qualitative analysis.
+  ///
+  /// @param[in] settings  Analysis settings for all calculations.
+  /// @param[in] mission_time  The mission time expression of the model.
+  ProbabilityAnalysis(const Settings& settings, mef::MissionTime* mission_time);
+
   virtual ~ProbabilityAnalysis() = default;
 
   /// Performs quantitative analysis on the supplied fault tree.
@@ -122,6 +136,35 @@ class ProbabilityAnalysis : public Analysis {
   std::unique_ptr<Sil> sil_;  ///< The Safety Integrity Level results.
 };
 
+class Zbdd;  // The container of analysis products for computations.
+
+/// Compressed sparse row (CSR) storage of products.
+/// The products are exported from the ZBDD once
+/// for repeated quantification with different variable probabilities,
+/// so the calculations do not traverse ZBDD vertices and modules.
+class ProductMatrix {
+ public:
+  /// Exports products into the flat storage.
+  ///
+  /// @param[in] products  Products with positive indices of variables.
+  explicit ProductMatrix(const Zbdd& products);
+
+  /// @returns The number of products (rows).
+  int size() const { return offsets_.size() - 1; }
+
+  /// @returns The start positions of products in the column array
+  ///          with the end of the last product as the sentinel.
+  const std::vector<int>& offsets() const { return offsets_; }
+
+  /// @returns The zero-based positions of product variables
+  ///          for direct access to contiguous probability data.
+  const std::vector<int>& columns() const { return columns_; }
+
+ private:
+  std::vector<int> offsets_;  ///< The start positions of rows.
+  std::vector<int> columns_;  ///< Variable positions of all rows.
+};
+
 /// Quantitative calculator of a probability value of a single cut set.
 class CutSetProbabilityCalculator {
  public:
@@ -140,9 +183,24 @@ class CutSetProbabilityCalculator {
   /// @pre Indices of events directly map to vector indices.
   double Calculate(const std::vector<int>& cut_set,
                    const Pdag::IndexMap<double>& p_vars) noexcept;
-};
 
-class Zbdd;  // The container of analysis products for computations.
+  /// Calculates a probability of a cut set in the product matrix.
+  /// The loop gathers and multiplies contiguous data,
+  /// which is open to vectorization by compilers.
+  ///
+  /// @param[in] first  The first column of the product row.
+  /// @param[in] last  The end of the product row.
+  /// @param[in] p_vars  Zero-based probabilities of variables.
+  ///
+  /// @returns The total probability of the cut set.
+  static double Calculate(const int* first, const int* last,
+                          const double* p_vars) noexcept {
+    double p_sub_set = 1;
+    for (; first != last; ++first)
+      p_sub_set *= p_vars[*first];
+    return p_sub_set;
+  }
+};
 
 /// Quantitative calculator of probability values
 /// with the Rare-Event approximation.
@@ -160,8 +218,22 @@ class RareEventCalculator : private CutSetProbabilityCalculator {
   ///       the probability is adjusted to 1.
   ///       It is very unwise to use the rare-event approximation
   ///       with large probability values.
-  double Calculate(const Zbdd& cut_sets,
+  double Calculate(const ProductMatrix& cut_sets,
                    const Pdag::IndexMap<double>& p_vars) noexcept;
+
+  /// Calculates marginal importance factors of all variables
+  /// in a single pass over the cut sets.
+  /// The contributions of cut sets are accumulated into their members.
+  ///
+  /// @param[in] cut_sets  A collection of sets of indices of basic events.
+  /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
+  ///
+  /// @returns The differences of the total probabilities
+  ///          conditioned on the occurrence and non-occurrence of variables
+  ///          with the same adjustment to 1 as the total probability.
+  Pdag::IndexMap<double>
+  CalculateMif(const ProductMatrix& cut_sets,
+               const Pdag::IndexMap<double>& p_vars) noexcept;
 };
 
 /// Quantitative calculator of probability values
@@ -175,8 +247,21 @@ class McubCalculator : private CutSetProbabilityCalculator {
   /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
   ///
   /// @returns The total probability with the MCUB approximation.
-  double Calculate(const Zbdd& cut_sets,
+  double Calculate(const ProductMatrix& cut_sets,
                    const Pdag::IndexMap<double>& p_vars) noexcept;
+
+  /// Calculates marginal importance factors of all variables
+  /// in a single pass over the cut sets.
+  /// The complement products of cut sets are accumulated into their members.
+  ///
+  /// @param[in] cut_sets  A collection of sets of indices of basic events.
+  /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
+  ///
+  /// @returns The differences of the total probabilities
+  ///          conditioned on the occurrence and non-occurrence of variables.
+  Pdag::IndexMap<double>
+  CalculateMif(const ProductMatrix& cut_sets,
+               const Pdag::IndexMap<double>& p_vars) noexcept;
 };
 
 /// Base class for Probability analyzers.
@@ -192,7 +277,7 @@ class ProbabilityAnalyzerBase : public ProbabilityAnalysis {
                           mef::MissionTime* mission_time)
       : ProbabilityAnalysis(fta, mission_time),
         graph_(fta->graph()),
-        products_(fta->algorithm()->products()) {
+        products_(&fta->algorithm()->products()) {
     ExtractVariableProbabilities();
   }
 
@@ -200,12 +285,33 @@ class ProbabilityAnalyzerBase : public ProbabilityAnalysis {
   const Pdag* graph() const { return graph_; }
 
   /// @returns The resulting products of the fault tree analyzer.
-  const Zbdd& products() const { return products_; }
+  ///
+  /// @pre The analyzer is constructed from a fault tree analyzer.
+  const Zbdd& products() const {
+    assert(products_ && "No products for the analysis.");
+    return *products_;
+  }
 
   /// @returns A mapping for probability values with indices.
   const Pdag::IndexMap<double>& p_vars() const { return p_vars_; }
 
  protected:
+  /// Constructs probability analyzer directly from a PDAG
+  /// without products of qualitative analysis.
+  ///
+  /// @param[in] graph  The PDAG of the analysis target.
+  /// @param[in] settings  Analysis settings for all calculations.
+  /// @param[in] mission_time  The mission time expression of the model.
+  ///
+  /// @pre The graph outlives the analyzer.
+  ProbabilityAnalyzerBase(const Pdag* graph, const Settings& settings,
+                          mef::MissionTime* mission_time)
+      : ProbabilityAnalysis(settings, mission_time),
+        graph_(graph),
+        products_(nullptr) {
+    ExtractVariableProbabilities();
+  }
+
   ~ProbabilityAnalyzerBase() override = default;
 
  private:
@@ -239,7 +345,7 @@ class ProbabilityAnalyzerBase : public ProbabilityAnalysis {
   void ExtractVariableProbabilities();
 
   const Pdag* graph_;  ///< PDAG from the fault tree analysis.
-  const Zbdd& products_;  ///< A collection of products.
+  const Zbdd* products_;  ///< A collection of products if any.
   Pdag::IndexMap<double> p_vars_;  ///< Variable probabilities.
 };
 
@@ -250,15 +356,34 @@ class ProbabilityAnalyzerBase : public ProbabilityAnalysis {
 template <class Calculator>
 class ProbabilityAnalyzer : public ProbabilityAnalyzerBase {
  public:
-  using ProbabilityAnalyzerBase::ProbabilityAnalyzerBase;
+  /// Exports the products of the fault tree analyzer
+  /// into the flat storage for calculations.
+  ///
+  /// @copydetails ProbabilityAnalyzerBase::ProbabilityAnalyzerBase
+  template <class Algorithm>
+  ProbabilityAnalyzer(const FaultTreeAnalyzer<Algorithm>* fta,
+                      mef::MissionTime* mission_time)
+      : ProbabilityAnalyzerBase(fta, mission_time),
+        cut_sets_(ProbabilityAnalyzerBase::products()) {}
 
   double CalculateTotalProbability(
       const Pdag::IndexMap<double>& p_vars) noexcept final {
-    return calc_.Calculate(ProbabilityAnalyzerBase::products(), p_vars);
+    return calc_.Calculate(cut_sets_, p_vars);
+  }
+
+  /// Calculates marginal importance factors of all variables at once.
+  ///
+  /// @param[in] p_vars  A map of probabilities of the graph variables.
+  ///
+  /// @returns The factors mapped by the variable indices.
+  Pdag::IndexMap<double>
+  CalculateMif(const Pdag::IndexMap<double>& p_vars) noexcept {
+    return calc_.CalculateMif(cut_sets_, p_vars);
   }
 
  private:
   Calculator calc_;  ///< Provider of the calculation logic.
+  ProductMatrix cut_sets_;  ///< The flat products for calculations.
 };
 
 /// Specialization of probability analyzer with Binary Decision Diagrams.
@@ -330,4 +455,44 @@ class ProbabilityAnalyzer<Bdd> : public ProbabilityAnalyzerBase {
   bool owner_;  ///< Indication that pointers are handles.
 };
 
+/// Specialization of probability analyzer with direct Monte Carlo simulation.
+/// The analyzer owns the PDAG of the target
+/// and does not require the results of qualitative analysis.
+template <>
+class ProbabilityAnalyzer<MonteCarlo> : public ProbabilityAnalyzerBase {
+ public:
+  /// Constructs and preprocesses the PDAG of the analysis target.
+  ///
+  /// @param[in] root  The top gate of the analysis target.
+  /// @param[in] settings  Analysis settings for all calculations.
+  /// @param[in] model  The Model containing substitutions if any.
+  /// @param[in] mission_time  The mission time expression of the model.
+  ProbabilityAnalyzer(const mef::Gate& root, const Settings& settings,
+                      const mef::Model* model, mef::MissionTime* mission_time);
+
+  /// @returns The simulator of the PDAG.
+  MonteCarlo* simulator() { return &simulator_; }
+
+  /// @returns The number of simulated scenarios per probability estimate.
+  std::int64_t num_trials() const { return simulator_.num_trials(); }
+
+  /// @returns The statistics of the total probability estimate.
+  ///
+  /// @pre The analysis is done.
+  MonteCarlo::Estimate estimate() const;
+
+  double CalculateTotalProbability(
+      const Pdag::IndexMap<double>& p_vars) noexcept final;
+
+ private:
+  /// @param[in] graph  The preprocessed PDAG of the analysis target.
+  /// @param[in] settings  Analysis settings for all calculations.
+  /// @param[in] mission_time  The mission time expression of the model.
+  ProbabilityAnalyzer(std::unique_ptr<Pdag> graph, const Settings& settings,
+                      mef::MissionTime* mission_time);
+
+  std::unique_ptr<Pdag> pdag_;  ///< The owned PDAG of the target.
+  MonteCarlo simulator_;  ///< The simulation facility for the PDAG.
+};
+
 }  // namespace scram::core
@@ -25,6 +25,7 @@
 #include <array>
 #include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
 
 #include <boost/predef.h>
@@ -133,6 +134,15 @@ void Project::GatherOptions(const xml::Element& root) {
 
       } else if (name == "limits") {
         SetLimits(option_group);
+
+      } else if (name == "sweep") {
+        settings_.sweep({std::string(option_group.attribute("parameter")),
+                         *option_group.attribute<double>("start"),
+                         *option_group.attribute<double>("stop"),
+                         *option_group.attribute<int>("points")});
+
+      } else if (name == "target") {
+        settings_.target(std::string(option_group.attribute("name")));
       }
     } catch (SettingsError& err) {
       err << boost::errinfo_at_line(option_group.line());
@@ -161,6 +171,8 @@ void Project::SetAnalysis(const xml::Element& analysis) {
            [this](bool flag) { settings_.importance_analysis(flag); });
   set_flag("uncertainty",
            [this](bool flag) { settings_.uncertainty_analysis(flag); });
+  set_flag("sensitivity",
+           [this](bool flag) { settings_.sensitivity_analysis(flag); });
   set_flag("ccf", [this](bool flag) { settings_.ccf_analysis(flag); });
   set_flag("sil",
            [this](bool flag) { settings_.safety_integrity_levels(flag); });
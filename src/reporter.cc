@@ -22,6 +22,7 @@
 
 #include <ctime>
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -68,9 +69,27 @@ void PutId(const core::RiskAnalysis::Result::Id& id,
 
 }  // namespace
 
+Reporter& Reporter::limit_order(int order) {
+  if (order < 0)
+    SCRAM_THROW(SettingsError(
+        "The limit on the order of reported products cannot be negative."))
+        << errinfo_value(std::to_string(order));
+  limit_order_ = order;
+  return *this;
+}
+
+Reporter& Reporter::limit_products(int num_products) {
+  if (num_products < 0)
+    SCRAM_THROW(SettingsError(
+        "The limit on the number of reported products cannot be negative."))
+        << errinfo_value(std::to_string(num_products));
+  limit_products_ = num_products;
+  return *this;
+}
+
 void Reporter::Report(const core::RiskAnalysis& risk_an, std::FILE* out,
                       bool indent) {
-  xml::Stream xml_stream(out, indent);
+  xml::Stream xml_stream(out, indent, /*async=*/true);
   xml::StreamElement report = xml_stream.root("report");
   ReportInformation(risk_an, &report);
 
@@ -96,6 +115,12 @@ void Reporter::Report(const core::RiskAnalysis& risk_an, std::FILE* out,
     if (result.importance_analysis)
       ReportResults(result.id, *result.importance_analysis, &results);
 
+    if (result.sensitivity_analysis)
+      ReportResults(result.id, *result.sensitivity_analysis, &results);
+
+    if (result.parametric_analysis)
+      ReportResults(result.id, *result.parametric_analysis, &results);
+
     if (result.uncertainty_analysis)
       ReportResults(result.id, *result.uncertainty_analysis, &results);
   }
@@ -121,7 +146,7 @@ void Reporter::Report(const core::RiskAnalysis& risk_an,
 template <>
 void Reporter::ReportCalculatedQuantity<core::FaultTreeAnalysis>(
     const core::Settings& settings, xml::StreamElement* information) {
-  {
+  if (settings.algorithm() != core::Algorithm::kMonteCarlo) {
     xml::StreamElement quant = information->AddChild("calculated-quantity");
     if (settings.prime_implicants()) {
       quant.SetAttribute("name", "Prime Implicants");
@@ -138,6 +163,12 @@ void Reporter::ReportCalculatedQuantity<core::FaultTreeAnalysis>(
         break;
       case core::Algorithm::kMocus:
         methods.SetAttribute("name", "MOCUS");
+        break;
+      case core::Algorithm::kAuto:
+        methods.SetAttribute("name", "Automatic Selection");
+        break;
+      case core::Algorithm::kMonteCarlo:
+        assert(false && "No products in the direct simulation.");
     }
     methods.AddChild("limits")
         .AddChild("product-order")
@@ -167,7 +198,16 @@ void Reporter::ReportCalculatedQuantity<core::ProbabilityAnalysis>(
   xml::StreamElement methods = quant.AddChild("calculation-method");
   switch (settings.approximation()) {
     case core::Approximation::kNone:
-      methods.SetAttribute("name", "Binary Decision Diagram");
+      switch (settings.algorithm()) {
+        case core::Algorithm::kMonteCarlo:
+          methods.SetAttribute("name", "Direct Monte Carlo Simulation");
+          break;
+        case core::Algorithm::kAuto:
+          methods.SetAttribute("name", "Automatic Selection");
+          break;
+        default:
+          methods.SetAttribute("name", "Binary Decision Diagram");
+      }
       break;
     case core::Approximation::kRareEvent:
       methods.SetAttribute("name", "Rare-Event Approximation");
@@ -179,6 +219,11 @@ void Reporter::ReportCalculatedQuantity<core::ProbabilityAnalysis>(
   limits.AddChild("mission-time").AddText(settings.mission_time());
   if (settings.time_step())
     limits.AddChild("time-step").AddText(settings.time_step());
+  if (settings.algorithm() == core::Algorithm::kMonteCarlo) {
+    limits.AddChild("number-of-trials").AddText(settings.num_trials());
+    if (settings.seed() >= 0)
+      limits.AddChild("seed").AddText(settings.seed());
+  }
 }
 
 /// Describes the importance analysis and techniques.
@@ -192,6 +237,27 @@ void Reporter::ReportCalculatedQuantity<core::ImportanceAnalysis>(
                     "importance factors of events.");
 }
 
+/// Describes the sensitivity analysis and techniques.
+template <>
+void Reporter::ReportCalculatedQuantity<core::SensitivityAnalysis>(
+    const core::Settings& /*settings*/, xml::StreamElement* information) {
+  information->AddChild("calculated-quantity")
+      .SetAttribute("name", "Sensitivity Analysis")
+      .SetAttribute("definition",
+                    "Partial derivatives of the total probability "
+                    "with respect to parameters.");
+}
+
+/// Describes the parametric study and its grid.
+template <>
+void Reporter::ReportCalculatedQuantity<core::ParametricAnalysis>(
+    const core::Settings& /*settings*/, xml::StreamElement* information) {
+  information->AddChild("calculated-quantity")
+      .SetAttribute("name", "Parametric Study")
+      .SetAttribute("definition",
+                    "Total probability over grids of parameter values.");
+}
+
 /// Describes the uncertainty analysis and techniques.
 template <>
 void Reporter::ReportCalculatedQuantity<core::UncertaintyAnalysis>(
@@ -227,6 +293,12 @@ void Reporter::ReportCalculatedQuantity<core::RiskAnalysis>(
   if (settings.importance_analysis()) {
     ReportCalculatedQuantity<core::ImportanceAnalysis>(settings, information);
   }
+  if (settings.sensitivity_analysis()) {
+    ReportCalculatedQuantity<core::SensitivityAnalysis>(settings, information);
+  }
+  if (!settings.sweeps().empty()) {
+    ReportCalculatedQuantity<core::ParametricAnalysis>(settings, information);
+  }
   if (settings.uncertainty_analysis()) {
     ReportCalculatedQuantity<core::UncertaintyAnalysis>(settings, information);
   }
@@ -318,9 +390,50 @@ void Reporter::ReportPerformance(const core::RiskAnalysis& risk_an,
   for (const core::RiskAnalysis::Result& result : risk_an.results()) {
     xml::StreamElement calc_time = performance.AddChild("calculation-time");
     scram::PutId(result.id, &calc_time);
-    if (result.fault_tree_analysis)
+    if (result.fault_tree_analysis) {
       calc_time.AddChild("products")
           .AddText(result.fault_tree_analysis->analysis_time());
+      const auto& profiles = result.fault_tree_analysis->preprocessing();
+      if (!profiles.empty()) {
+        xml::StreamElement preprocessing = calc_time.AddChild("preprocessing");
+        for (const core::PassProfile& profile : profiles) {
+          preprocessing.AddChild("pass")
+              .SetAttribute("name", profile.name)
+              .SetAttribute("runs", profile.runs)
+              .SetAttribute("skips", profile.skips)
+              .SetAttribute("time", profile.time)
+              .SetAttribute("gates", profile.gates)
+              .SetAttribute("args", profile.args);
+        }
+      }
+      if (const auto& reordering = result.fault_tree_analysis->reordering()) {
+        calc_time.AddChild("bdd-reordering")
+            .SetAttribute("count", reordering->count)
+            .SetAttribute("size-before", reordering->size_before)
+            .SetAttribute("size-after", reordering->size_after)
+            .SetAttribute("time", reordering->time);
+      }
+    }
+    if (result.algorithm_selection) {
+      const core::AlgorithmSelection& selection = *result.algorithm_selection;
+      const core::PdagMetrics& metrics = selection.metrics;
+      calc_time.AddChild("algorithm-selection")
+          .SetAttribute("algorithm", core::kAlgorithmToString[static_cast<int>(
+                                         selection.algorithm)])
+          .SetAttribute("approximation",
+                        core::kApproximationToString[static_cast<int>(
+                            selection.approximation)])
+          .SetAttribute("reason", selection.reason)
+          .SetAttribute("gates", metrics.num_gates)
+          .SetAttribute("variables", metrics.num_variables)
+          .SetAttribute("modules", metrics.num_modules)
+          .SetAttribute("noncoherent-gates", metrics.num_noncoherent_gates)
+          .SetAttribute("shared-variables", metrics.num_shared_variables)
+          .SetAttribute("max-module-variables", metrics.max_module_variables)
+          .SetAttribute("max-module-shared-variables",
+                        metrics.max_module_shared_variables)
+          .SetAttribute("trial-vertices", selection.trial_vertices);
+    }
 
     if (result.probability_analysis)
       calc_time.AddChild("probability")
@@ -330,6 +443,14 @@ void Reporter::ReportPerformance(const core::RiskAnalysis& risk_an,
       calc_time.AddChild("importance")
           .AddText(result.importance_analysis->analysis_time());
 
+    if (result.sensitivity_analysis)
+      calc_time.AddChild("sensitivity")
+          .AddText(result.sensitivity_analysis->analysis_time());
+
+    if (result.parametric_analysis)
+      calc_time.AddChild("parametric")
+          .AddText(result.parametric_analysis->analysis_time());
+
     if (result.uncertainty_analysis)
       calc_time.AddChild("uncertainty")
           .AddText(result.uncertainty_analysis->analysis_time());
@@ -380,38 +501,56 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
   xml::StreamElement sum_of_products = results->AddChild("sum-of-products");
   scram::PutId(id, &sum_of_products);
 
+  const core::ProductContainer& products = fta.products();
+  int num_reported = 0;  // The number of products within the order limit.
+  for (int i = 0; i < products.distribution().size(); ++i) {
+    if (!limit_order_ || i < limit_order_)
+      num_reported += products.distribution()[i];
+  }
+  if (limit_products_)
+    num_reported = std::min(num_reported, limit_products_);
+
   std::string warning = fta.warnings();
   if (prob_analysis && prob_analysis->warnings().empty() == false)
     warning += (warning.empty() ? "" : "; ") + prob_analysis->warnings();
+  if (num_reported < products.size()) {
+    warning += (warning.empty() ? "" : "; ") + std::string("Only ") +
+               std::to_string(num_reported) + " products are reported";
+  }
   if (!warning.empty())
     sum_of_products.SetAttribute("warning", warning);
 
   sum_of_products
-      .SetAttribute("basic-events", fta.products().product_events().size())
-      .SetAttribute("products", fta.products().size());
+      .SetAttribute("basic-events", products.product_events().size())
+      .SetAttribute("products", products.size());
 
   if (prob_analysis)
     sum_of_products.SetAttribute("probability", prob_analysis->p_total());
 
-  if (fta.products().empty() == false) {
+  if (products.empty() == false) {
     sum_of_products.SetAttribute(
         "distribution",
-        boost::join(fta.products().distribution() |
+        boost::join(products.distribution() |
                         boost::adaptors::transformed(
                             [](int number) { return std::to_string(number); }),
                     " "));
   }
 
+  if (!num_reported)
+    return;
+  core::Pdag::IndexMap<double> p_vars;
   double sum = 0;  // Sum of probabilities for contribution calculations.
   if (prob_analysis) {
-    for (const core::Product& product_set : fta.products())
-      sum += product_set.p();
+    p_vars = products.ExtractProbabilities();
+    sum = products.CalculateProbabilitySum(p_vars);
   }
-  for (const core::Product& product_set : fta.products()) {
+  for (const core::Product& product_set : products) {
+    if (limit_order_ && product_set.order() > limit_order_)
+      continue;
     xml::StreamElement product = sum_of_products.AddChild("product");
     product.SetAttribute("order", product_set.order());
     if (prob_analysis) {
-      double prob = product_set.p();
+      double prob = product_set.p(p_vars);
       product.SetAttribute("probability", prob);
       if (sum != 0)
         product.SetAttribute("contribution", prob / sum);
@@ -419,12 +558,31 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
     for (const core::Literal& literal : product_set) {
       ReportLiteral(literal, &product);
     }
+    if (--num_reported == 0)
+      break;
   }
 }
 
 void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
                              const core::ProbabilityAnalysis& prob_analysis,
                              xml::StreamElement* results) {
+  if (const auto* simulation = dynamic_cast<
+          const core::ProbabilityAnalyzer<core::MonteCarlo>*>(&prob_analysis)) {
+    xml::StreamElement estimate = results->AddChild("estimate");
+    scram::PutId(id, &estimate);
+    if (!prob_analysis.warnings().empty())
+      estimate.SetAttribute("warning", prob_analysis.warnings());
+    core::MonteCarlo::Estimate result = simulation->estimate();
+    estimate.SetAttribute("trials",
+                          static_cast<std::size_t>(simulation->num_trials()));
+    estimate.AddChild("mean").SetAttribute("value", result.mean);
+    estimate.AddChild("standard-error").SetAttribute("value", result.sigma);
+    estimate.AddChild("confidence-range")
+        .SetAttribute("percentage", "95")
+        .SetAttribute("lower-bound", result.confidence_interval.first)
+        .SetAttribute("upper-bound", result.confidence_interval.second);
+  }
+
   if (!prob_analysis.p_time().empty()) {
     xml::StreamElement curve = results->AddChild("curve");
     scram::PutId(id, &curve);
@@ -476,10 +634,15 @@ void Reporter::ReportResults(
   importance.SetAttribute("basic-events",
                           importance_analysis.importance().size());
 
-  for (const core::ImportanceRecord& entry : importance_analysis.importance()) {
+  const auto* simulation =
+      dynamic_cast<const core::ImportanceAnalyzer<core::MonteCarlo>*>(
+          &importance_analysis);
+  for (int i = 0; i < importance_analysis.importance().size(); ++i) {
+    const core::ImportanceRecord& entry = importance_analysis.importance()[i];
     const core::ImportanceFactors& factors = entry.factors;
     const mef::BasicEvent& event = entry.event;
-    auto add_data = [&event, &factors](xml::StreamElement* element) {
+    auto add_data = [&event, &factors, simulation,
+                     i](xml::StreamElement* element) {
       element->SetAttribute("occurrence", factors.occurrence)
           .SetAttribute("probability", event.p())
           .SetAttribute("MIF", factors.mif)
@@ -487,11 +650,65 @@ void Reporter::ReportResults(
           .SetAttribute("DIF", factors.dif)
           .SetAttribute("RAW", factors.raw)
           .SetAttribute("RRW", factors.rrw);
+      if (simulation) {
+        element->SetAttribute("MIF-lower-bound",
+                              simulation->mif_intervals()[i].first)
+            .SetAttribute("MIF-upper-bound",
+                          simulation->mif_intervals()[i].second);
+      }
     };
     ReportBasicEvent(event, &importance, add_data);
   }
 }
 
+void Reporter::ReportResults(
+    const core::RiskAnalysis::Result::Id& id,
+    const core::SensitivityAnalysis& sensitivity_analysis,
+    xml::StreamElement* results) {
+  xml::StreamElement sensitivity = results->AddChild("sensitivity");
+  scram::PutId(id, &sensitivity);
+  if (!sensitivity_analysis.warnings().empty()) {
+    sensitivity.SetAttribute("warning", sensitivity_analysis.warnings());
+  }
+  sensitivity.SetAttribute("parameters",
+                           sensitivity_analysis.sensitivity().size());
+  for (const core::SensitivityRecord& entry :
+       sensitivity_analysis.sensitivity()) {
+    sensitivity.AddChild("parameter")
+        .SetAttribute("name", entry.parameter.id())
+        .SetAttribute("value", entry.value)
+        .SetAttribute("derivative", entry.derivative)
+        .SetAttribute("elasticity", entry.elasticity);
+  }
+}
+
+void Reporter::ReportResults(
+    const core::RiskAnalysis::Result::Id& id,
+    const core::ParametricAnalysis& parametric_analysis,
+    xml::StreamElement* results) {
+  xml::StreamElement study = results->AddChild("parametric-study");
+  scram::PutId(id, &study);
+  if (!parametric_analysis.warnings().empty()) {
+    study.SetAttribute("warning", parametric_analysis.warnings());
+  }
+  study.SetAttribute("points", parametric_analysis.p_total().size());
+  for (const core::ParametricAxis& axis : parametric_analysis.axes()) {
+    study.AddChild("axis")
+        .SetAttribute("name", axis.name)
+        .SetAttribute("points", axis.values.size());
+  }
+  // The grid values of a point are listed in the order of the axes.
+  for (int i = 0; i < parametric_analysis.p_total().size(); ++i) {
+    xml::StreamElement point = study.AddChild("point");
+    point.SetAttribute("probability", parametric_analysis.p_total()[i]);
+    const char* separator = "";
+    for (double value : parametric_analysis.values(i)) {
+      point.AddText(separator).AddText(value);
+      separator = " ";
+    }
+  }
+}
+
 void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
                              const core::UncertaintyAnalysis& uncert_analysis,
                              xml::StreamElement* results) {
@@ -570,7 +787,7 @@ void Reporter::ReportBasicEvent(const mef::BasicEvent& basic_event,
     const mef::CcfGroup& ccf_group = ccf_event->ccf_group();
     xml::StreamElement element = parent->AddChild("ccf-event");
     element.SetAttribute("ccf-group", ccf_group.id())
-        .SetAttribute("order", ccf_event->members().size())
+        .SetAttribute("order", ccf_event->level())
         .SetAttribute("group-size", ccf_group.members().size());
     add_data(&element);
     for (const mef::Gate* member : ccf_event->members()) {
@@ -30,6 +30,8 @@
 #include "model.h"
 #include "probability_analysis.h"
 #include "risk_analysis.h"
+#include "parametric_analysis.h"
+#include "sensitivity_analysis.h"
 #include "settings.h"
 #include "uncertainty_analysis.h"
 #include "xml_stream.h"
@@ -39,6 +41,28 @@ namespace scram {
 /// Facilities to report analysis results.
 class Reporter {
  public:
+  /// Limits the order of products reported for fault tree analyses
+  /// to keep the size of reports with huge product sets under control.
+  /// The product counts and distributions still describe all the products.
+  ///
+  /// @param[in] order  The maximum order of reported products.
+  ///                   0 for no limit.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The order is negative.
+  Reporter& limit_order(int order);
+
+  /// Limits the number of products reported for each fault tree analysis.
+  ///
+  /// @param[in] num_products  The maximum number of reported products.
+  ///                          0 for no limit.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is negative.
+  Reporter& limit_products(int num_products);
+
   /// Reports the results of risk analysis on a model.
   /// The XML report is formed as a single document.
   ///
@@ -49,6 +73,9 @@ class Reporter {
   /// @pre The output destination is used only by this reporter.
   ///      There is going to be no appending to the stream after the report.
   ///
+  /// @note The output is written on a background thread
+  ///       while the report is being generated.
+  ///
   /// @throws IOError  The write operation has failed.
   void Report(const core::RiskAnalysis& risk_an, std::FILE* out,
               bool indent = true);
@@ -159,6 +186,24 @@ class Reporter {
                      const core::ImportanceAnalysis& importance_analysis,
                      xml::StreamElement* results);
 
+  /// Reports results of sensitivity analysis.
+  ///
+  /// @param[in] id  The analysis id.
+  /// @param[in] sensitivity_analysis  Sensitivity analysis with results.
+  /// @param[in,out] results  XML element to for all results.
+  void ReportResults(const core::RiskAnalysis::Result::Id& id,
+                     const core::SensitivityAnalysis& sensitivity_analysis,
+                     xml::StreamElement* results);
+
+  /// Reports the table of the parametric study.
+  ///
+  /// @param[in] id  The analysis id.
+  /// @param[in] parametric_analysis  Parametric study with results.
+  /// @param[in,out] results  XML element to for all results.
+  void ReportResults(const core::RiskAnalysis::Result::Id& id,
+                     const core::ParametricAnalysis& parametric_analysis,
+                     xml::StreamElement* results);
+
   /// Reports the results of uncertainty analysis.
   ///
   /// @param[in] id  The analysis id.
@@ -190,6 +235,9 @@ class Reporter {
   template <class T>
   void ReportBasicEvent(const mef::BasicEvent& basic_event,
                         xml::StreamElement* parent, const T& add_data);
+
+  int limit_order_ = 0;  ///< The limit on the order of reported products.
+  int limit_products_ = 0;  ///< The limit on the number of reported products.
 };
 
 }  // namespace scram
@@ -20,18 +20,54 @@
 
 #include "risk_analysis.h"
 
+#include <type_traits>
+#include <unordered_set>
+
+#include <boost/range/algorithm.hpp>
+
 #include "bdd.h"
+#include "error.h"
 #include "expression/random_deviate.h"
 #include "ext/scope_guard.h"
 #include "fault_tree.h"
 #include "logger.h"
 #include "mocus.h"
+#include "monte_carlo.h"
+#include "parameter.h"
+#include "variable_order.h"
 #include "zbdd.h"
 
 namespace scram::core {
 
 RiskAnalysis::RiskAnalysis(mef::Model* model, const Settings& settings)
-    : Analysis(settings), model_(model) {}
+    : Analysis(settings), model_(model) {
+  for (const Settings::Sweep& sweep : settings.sweeps()) {
+    mef::Parameter* parameter = nullptr;
+    if (sweep.parameter != Settings::kMissionTime) {
+      auto it = model_->table<mef::Parameter>().find(sweep.parameter);
+      if (it == model_->table<mef::Parameter>().end()) {
+        SCRAM_THROW(SettingsError("The sweep parameter is not in the model."))
+            << errinfo_value(sweep.parameter);
+      }
+      parameter = &*it;
+    }
+    std::vector<double> values;
+    double step = sweep.num_points > 1
+                      ? (sweep.stop - sweep.start) / (sweep.num_points - 1)
+                      : 0;
+    for (int i = 0; i < sweep.num_points; ++i)
+      values.push_back(sweep.start + i * step);
+    sweep_axes_.push_back({sweep.parameter, parameter, std::move(values)});
+  }
+  for (const std::string& target : settings.targets()) {
+    if (!model_->table<mef::Gate>().count(target) &&
+        !model_->table<mef::InitiatingEvent>().count(target) &&
+        !model_->table<mef::Sequence>().count(target)) {
+      SCRAM_THROW(SettingsError("The analysis target is not in the model."))
+          << errinfo_value(target);
+    }
+  }
+}
 
 void RiskAnalysis::Analyze() noexcept {
   assert(results_.empty() && "Rerunning the analysis.");
@@ -39,6 +75,12 @@ void RiskAnalysis::Analyze() noexcept {
   // Otherwise it defaults to the implementation dependent value.
   if (Analysis::settings().seed() >= 0)
     mef::RandomDeviate::seed(Analysis::settings().seed());
+  // The model may have been initialized without common cause analysis.
+  if (Analysis::settings().ccf_analysis()) {
+    int limit = Analysis::settings().ccf_expansion_limit();
+    for (mef::CcfGroup& ccf_group : model_->table<mef::CcfGroup>())
+      ccf_group.GenerateEvents(limit);
+  }
 
   if (model_->alignments().empty()) {
     RunAnalysis();
@@ -81,15 +123,28 @@ void RiskAnalysis::RunAnalysis(std::optional<Context> context) noexcept {
     }
   }
 
+  const std::vector<std::string>& targets = Analysis::settings().targets();
+  auto is_target = [&targets](const std::string& id) {
+    return targets.empty() || boost::find(targets, id) != targets.end();
+  };
+  bool has_sequence_targets =
+      boost::find_if(targets, [this](const std::string& id) {
+        return model_->table<mef::Sequence>().count(id);
+      }) != targets.end();
+
   for (const mef::InitiatingEvent& initiating_event :
        model_->initiating_events()) {
-    if (initiating_event.event_tree()) {
+    bool is_target_event = is_target(initiating_event.name());
+    if (initiating_event.event_tree() &&
+        (is_target_event || has_sequence_targets)) {
       LOG(INFO) << "Running event tree analysis: " << initiating_event.name();
       auto eta = std::make_unique<EventTreeAnalysis>(
           initiating_event, Analysis::settings(), model_->context());
       eta->Analyze();
       for (EventTreeAnalysis::Result& result : eta->sequences()) {
         const mef::Sequence& sequence = result.sequence;
+        if (!is_target_event && !is_target(sequence.name()))
+          continue;
         LOG(INFO) << "Running analysis for sequence: " << sequence.name();
         results_.push_back(
             {{std::pair<const mef::InitiatingEvent&, const mef::Sequence&>{
@@ -99,29 +154,81 @@ void RiskAnalysis::RunAnalysis(std::optional<Context> context) noexcept {
         if (result.is_expression_only) {
           results_.back().fault_tree_analysis = nullptr;
           results_.back().importance_analysis = nullptr;
+          results_.back().sensitivity_analysis = nullptr;
+          results_.back().parametric_analysis = nullptr;
         }
         if (Analysis::settings().probability_analysis())
           result.p_sequence = results_.back().probability_analysis->p_total();
         LOG(INFO) << "Finished analysis for sequence: " << sequence.name();
       }
-      event_tree_results_.push_back(
-          {initiating_event, context, std::move(eta)});
+      // Partially analyzed event trees are not reported.
+      if (is_target_event) {
+        event_tree_results_.push_back(
+            {initiating_event, context, std::move(eta)});
+      }
       LOG(INFO) << "Finished event tree analysis: " << initiating_event.name();
     }
   }
 
-  for (const mef::FaultTree& ft : model_->fault_trees()) {
-    for (const mef::Gate* target : ft.top_events()) {
-      LOG(INFO) << "Running analysis for gate: " << target->id();
-      results_.push_back({{target, context}});
+  auto analyze_gate = [this, &context](const mef::Gate* target) {
+    LOG(INFO) << "Running analysis for gate: " << target->id();
+    results_.push_back({{target, context}});
+    if (context) {
+      RunPhaseAnalysis(*target, &results_.back());
+    } else {
       RunAnalysis(*target, &results_.back());
-      LOG(INFO) << "Finished analysis for gate: " << target->id();
+    }
+    LOG(INFO) << "Finished analysis for gate: " << target->id();
+  };
+  if (targets.empty()) {
+    for (const mef::FaultTree& ft : model_->fault_trees()) {
+      for (const mef::Gate* target : ft.top_events())
+        analyze_gate(target);
+    }
+  } else {
+    for (const std::string& id : targets) {
+      auto it = model_->table<mef::Gate>().find(id);
+      if (it != model_->table<mef::Gate>().end())
+        analyze_gate(&*it);
     }
   }
 }
 
-void RiskAnalysis::RunAnalysis(const mef::Gate& target,
-                               Result* result) noexcept {
+/// Runs the direct simulation on the target without qualitative analysis.
+template <>
+RiskAnalysis::FaultTreeAnalyzerPtr RiskAnalysis::RunAnalysis<MonteCarlo>(
+    const mef::Gate& target, Result* result) noexcept {
+  assert(Analysis::settings().probability_analysis());
+  auto pa = std::make_unique<ProbabilityAnalyzer<MonteCarlo>>(
+      target, Analysis::settings(), model_, &model_->mission_time());
+  pa->Analyze();
+  if (Analysis::settings().importance_analysis()) {
+    auto ia = std::make_unique<ImportanceAnalyzer<MonteCarlo>>(pa.get());
+    ia->Analyze();
+    result->importance_analysis = std::move(ia);
+  }
+  if (Analysis::settings().sensitivity_analysis()) {
+    auto sa = std::make_unique<SensitivityAnalyzer<MonteCarlo>>(pa.get());
+    sa->Analyze();
+    result->sensitivity_analysis = std::move(sa);
+  }
+  if (!sweep_axes_.empty()) {
+    auto sweep = std::make_unique<ParametricAnalyzer<MonteCarlo>>(
+        pa.get(), sweep_axes_, &model_->mission_time());
+    sweep->Analyze();
+    result->parametric_analysis = std::move(sweep);
+  }
+  if (Analysis::settings().uncertainty_analysis()) {
+    auto ua = std::make_unique<UncertaintyAnalyzer<MonteCarlo>>(pa.get());
+    ua->Analyze();
+    result->uncertainty_analysis = std::move(ua);
+  }
+  result->probability_analysis = std::move(pa);
+  return {};
+}
+
+RiskAnalysis::FaultTreeAnalyzerPtr RiskAnalysis::RunAnalysis(
+    const mef::Gate& target, Result* result) noexcept {
   switch (Analysis::settings().algorithm()) {
     case Algorithm::kBdd:
       return RunAnalysis<Bdd>(target, result);
@@ -129,17 +236,134 @@ void RiskAnalysis::RunAnalysis(const mef::Gate& target,
       return RunAnalysis<Zbdd>(target, result);
     case Algorithm::kMocus:
       return RunAnalysis<Mocus>(target, result);
+    case Algorithm::kMonteCarlo:
+      return RunAnalysis<MonteCarlo>(target, result);
+    case Algorithm::kAuto:
+      break;
+  }
+  auto graph = std::make_unique<Pdag>(
+      target, Analysis::settings().ccf_analysis(), model_);
+  CustomPreprocessor<Bdd> preprocessor(
+      graph.get(), Analysis::settings().preprocessing_budget());
+  preprocessor();
+  if (!Analysis::settings().variable_order().empty()) {
+    try {
+      VariableOrder order(Analysis::settings().variable_order());
+      order.Seed(target.id(), graph.get());
+    } catch (const IOError& err) {
+      LOG(WARNING) << "Ignoring the variable order: " << err.what();
+    }
+  }
+  std::unique_ptr<Bdd> trial;
+  const AlgorithmSelection& selection =
+      result->algorithm_selection.emplace(
+          SelectAlgorithm(*graph, Analysis::settings(), &trial));
+  LOG(INFO) << "Selected "
+            << kAlgorithmToString[static_cast<int>(selection.algorithm)]
+            << " for gate " << target.id() << ": " << selection.reason;
+
+  Settings settings(Analysis::settings());
+  settings.algorithm(selection.algorithm)
+      .approximation(selection.approximation);
+  switch (selection.algorithm) {
+    case Algorithm::kBdd: {
+      auto fta = std::make_unique<FaultTreeAnalyzer<Bdd>>(
+          target, std::move(graph), preprocessor.profiles(), settings, model_);
+      fta->algorithm(std::move(trial));
+      return RunAnalysis(std::move(fta), result);
+    }
+    case Algorithm::kZbdd: {
+      // ZBDD needs the Boolean optimization passes on top of the BDD ones.
+      CustomPreprocessor<Zbdd> zbdd_preprocessor(
+          graph.get(), Analysis::settings().preprocessing_budget());
+      zbdd_preprocessor();
+      std::vector<PassProfile> profiles = preprocessor.profiles();
+      Accumulate(zbdd_preprocessor.profiles(), &profiles);
+      return RunAnalysis(std::make_unique<FaultTreeAnalyzer<Zbdd>>(
+                             target, std::move(graph), std::move(profiles),
+                             settings, model_),
+                         result);
+    }
+    default:
+      assert(false && "Unexpected algorithm selection.");
+      return {};
+  }
+}
+
+void RiskAnalysis::RunPhaseAnalysis(const mef::Gate& target,
+                                    Result* result) noexcept {
+  if (Analysis::settings().algorithm() == Algorithm::kMonteCarlo) {
+    RunAnalysis(target, result);  // No qualitative analysis to share.
+    return;
+  }
+  PhaseCache& cache = phase_cache_[&target];
+  if (cache.analyses.empty()) {  // The cone is the same for all phases.
+    std::unordered_set<const mef::Gate*> visited;
+    auto gather = [&cache, &visited](auto& self,
+                                     const mef::Formula& formula) -> void {
+      for (const mef::Formula::Arg& arg : formula.args()) {
+        if (auto* gate = std::get_if<mef::Gate*>(&arg.event)) {
+          if (visited.insert(*gate).second)
+            self(self, (*gate)->formula());
+        } else if (auto* house = std::get_if<mef::HouseEvent*>(&arg.event)) {
+          if (boost::find(cache.house_events, *house) ==
+              cache.house_events.end()) {
+            cache.house_events.push_back(*house);
+          }
+        }
+      }
+    };
+    gather(gather, target.formula());
+  }
+  std::vector<bool> states;
+  for (const mef::HouseEvent* house_event : cache.house_events)
+    states.push_back(house_event->state());
+
+  auto [it, inserted] = cache.analyses.try_emplace(std::move(states));
+  auto& [fta, selection] = it->second;
+  if (inserted) {
+    fta = RunAnalysis(target, result);
+    selection = result->algorithm_selection;
+    return;
   }
+  LOG(INFO) << "Reusing the qualitative analysis of gate " << target.id()
+            << " from a previous phase";
+  result->algorithm_selection = selection;
+  std::visit(
+      [this, result](const auto& analyzer) {
+        if constexpr (!std::is_same_v<std::decay_t<decltype(analyzer)>,
+                                      std::monostate>) {
+          RunProbabilityAnalysis(analyzer, result);
+        }
+      },
+      fta);
 }
 
 template <class Algorithm>
-void RiskAnalysis::RunAnalysis(const mef::Gate& target,
-                               Result* result) noexcept {
-  auto fta = std::make_unique<FaultTreeAnalyzer<Algorithm>>(
-      target, Analysis::settings(), model_);
+RiskAnalysis::FaultTreeAnalyzerPtr RiskAnalysis::RunAnalysis(
+    const mef::Gate& target, Result* result) noexcept {
+  return RunAnalysis(std::make_unique<FaultTreeAnalyzer<Algorithm>>(
+                         target, Analysis::settings(), model_),
+                     result);
+}
+
+template <class Algorithm>
+RiskAnalysis::FaultTreeAnalyzerPtr RiskAnalysis::RunAnalysis(
+    std::unique_ptr<FaultTreeAnalyzer<Algorithm>> fta,
+    Result* result) noexcept {
   fta->Analyze();
-  if (Analysis::settings().probability_analysis()) {
-    switch (Analysis::settings().approximation()) {
+  std::shared_ptr<FaultTreeAnalyzer<Algorithm>> analyzer = std::move(fta);
+  RunProbabilityAnalysis(analyzer, result);
+  return analyzer;
+}
+
+template <class Algorithm>
+void RiskAnalysis::RunProbabilityAnalysis(
+    const std::shared_ptr<FaultTreeAnalyzer<Algorithm>>& fta,
+    Result* result) noexcept {
+  const Settings& settings = std::as_const(*fta).settings();
+  if (settings.probability_analysis()) {
+    switch (settings.approximation()) {
       case Approximation::kNone:
         RunAnalysis<Algorithm, Bdd>(fta.get(), result);
         break;
@@ -150,7 +374,7 @@ void RiskAnalysis::RunAnalysis(const mef::Gate& target,
         RunAnalysis<Algorithm, McubCalculator>(fta.get(), result);
     }
   }
-  result->fault_tree_analysis = std::move(fta);
+  result->fault_tree_analysis = fta;
 }
 
 template <class Algorithm, class Calculator>
@@ -164,6 +388,17 @@ void RiskAnalysis::RunAnalysis(FaultTreeAnalyzer<Algorithm>* fta,
     ia->Analyze();
     result->importance_analysis = std::move(ia);
   }
+  if (Analysis::settings().sensitivity_analysis()) {
+    auto sa = std::make_unique<SensitivityAnalyzer<Calculator>>(pa.get());
+    sa->Analyze();
+    result->sensitivity_analysis = std::move(sa);
+  }
+  if (!sweep_axes_.empty()) {
+    auto sweep = std::make_unique<ParametricAnalyzer<Calculator>>(
+        pa.get(), sweep_axes_, &model_->mission_time());
+    sweep->Analyze();
+    result->parametric_analysis = std::move(sweep);
+  }
   if (Analysis::settings().uncertainty_analysis()) {
     auto ua = std::make_unique<UncertaintyAnalyzer<Calculator>>(pa.get());
     ua->Analyze();
@@ -20,12 +20,15 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <optional>
+#include <unordered_map>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "algorithm_selection.h"
 #include "alignment.h"
 #include "analysis.h"
 #include "event.h"
@@ -33,7 +36,9 @@
 #include "fault_tree_analysis.h"
 #include "importance_analysis.h"
 #include "model.h"
+#include "parametric_analysis.h"
 #include "probability_analysis.h"
+#include "sensitivity_analysis.h"
 #include "settings.h"
 #include "uncertainty_analysis.h"
 
@@ -61,12 +66,19 @@ class RiskAnalysis : public Analysis {
     const Id id;  ///< The main analysis input or target.
 
     /// Optional analyses, i.e., may be nullptr.
+    /// The fault tree analysis is shared by the results of alignment phases
+    /// that resolve the target into the same logic.
     /// @{
-    std::unique_ptr<const FaultTreeAnalysis> fault_tree_analysis;
+    std::shared_ptr<const FaultTreeAnalysis> fault_tree_analysis;
     std::unique_ptr<const ProbabilityAnalysis> probability_analysis;
     std::unique_ptr<const ImportanceAnalysis> importance_analysis;
     std::unique_ptr<const UncertaintyAnalysis> uncertainty_analysis;
+    std::unique_ptr<const SensitivityAnalysis> sensitivity_analysis;
+    std::unique_ptr<const ParametricAnalysis> parametric_analysis;
     /// @}
+
+    /// The decision of the automatic algorithm selection if requested.
+    std::optional<AlgorithmSelection> algorithm_selection;
   };
 
   /// The analysis results grouped by an event-tree.
@@ -86,6 +98,9 @@ class RiskAnalysis : public Analysis {
   ///       because mission time and event-tree walk context are manipulated.
   ///       However, at the end of analysis, everything is reset.
   ///
+  /// @throws SettingsError  The swept parameter is not in the model.
+  /// @throws SettingsError  An analysis target is not in the model.
+  ///
   /// @todo Make the analysis work with a constant model.
   RiskAnalysis(mef::Model* model, const Settings& settings);
 
@@ -111,6 +126,32 @@ class RiskAnalysis : public Analysis {
   }
 
  private:
+  /// The fault tree analyzers of the qualitative algorithms
+  /// available for the quantitative analysis of other phases.
+  /// The direct simulation does not provide the analyzer.
+  using FaultTreeAnalyzerPtr =
+      std::variant<std::monostate, std::shared_ptr<FaultTreeAnalyzer<Bdd>>,
+                   std::shared_ptr<FaultTreeAnalyzer<Zbdd>>,
+                   std::shared_ptr<FaultTreeAnalyzer<Mocus>>>;
+
+  /// The analyses of a model gate across alignment phases.
+  ///
+  /// The preprocessed graph and diagrams of a target
+  /// depend only on the states of the house events in its cone
+  /// since the settings are the same for all the phases
+  /// except for the mission time,
+  /// which affects only the quantitative analysis.
+  struct PhaseCache {
+    /// The house events in the cone of the gate
+    /// gathered upon the first phase.
+    std::vector<const mef::HouseEvent*> house_events;
+    /// The qualitative analyses and algorithm selections
+    /// by the states of the house events.
+    std::map<std::vector<bool>,
+             std::pair<FaultTreeAnalyzerPtr, std::optional<AlgorithmSelection>>>
+        analyses;
+  };
+
   /// Runs the whole analysis with the given alignment.
   ///
   /// @param[in] context  The optional context with the current alignment/phase.
@@ -122,10 +163,27 @@ class RiskAnalysis : public Analysis {
 
   /// Runs all possible analysis on a given target.
   /// Analysis types are deduced from the settings.
+  /// The automatic algorithm selection preprocesses the target PDAG
+  /// and hands it over to the selected algorithm.
   ///
   /// @param[in] target  Analysis target.
   /// @param[in,out] result  The result container element.
-  void RunAnalysis(const mef::Gate& target, Result* result) noexcept;
+  ///
+  /// @returns The fault tree analyzer of the target if any.
+  FaultTreeAnalyzerPtr RunAnalysis(const mef::Gate& target,
+                                   Result* result) noexcept;
+
+  /// Runs the analysis of a model gate in an alignment phase
+  /// reusing the qualitative analysis of a previous phase
+  /// with the same states of the house events in the gate cone.
+  /// Only the quantitative analysis is rerun
+  /// for the mission time of the phase.
+  ///
+  /// @param[in] target  The model gate as the analysis target.
+  /// @param[in,out] result  The result container element.
+  ///
+  /// @pre The target gate outlives the analysis.
+  void RunPhaseAnalysis(const mef::Gate& target, Result* result) noexcept;
 
   /// Defines and runs Qualitative analysis on the target.
   /// Calls the Quantitative analysis if requested in settings.
@@ -134,8 +192,37 @@ class RiskAnalysis : public Analysis {
   ///
   /// @param[in] target  Analysis target.
   /// @param[in,out] result  The result container element.
+  ///
+  /// @returns The fault tree analyzer of the target if any.
+  template <class Algorithm>
+  FaultTreeAnalyzerPtr RunAnalysis(const mef::Gate& target,
+                                   Result* result) noexcept;
+
+  /// Runs Qualitative analysis with the prepared analyzer.
+  /// Calls the Quantitative analysis if requested in its settings.
+  ///
+  /// @tparam Algorithm  Qualitative analysis algorithm.
+  ///
+  /// @param[in] fta  The analyzer of the target.
+  /// @param[in,out] result  The result container element.
+  ///
+  /// @returns The analyzer after the qualitative analysis.
+  template <class Algorithm>
+  FaultTreeAnalyzerPtr RunAnalysis(
+      std::unique_ptr<FaultTreeAnalyzer<Algorithm>> fta,
+      Result* result) noexcept;
+
+  /// Attaches the Qualitative analysis to the result
+  /// and runs the Quantitative analysis if requested in its settings.
+  ///
+  /// @tparam Algorithm  Qualitative analysis algorithm.
+  ///
+  /// @param[in] fta  The analyzer after the qualitative analysis.
+  /// @param[in,out] result  The result container element.
   template <class Algorithm>
-  void RunAnalysis(const mef::Gate& target, Result* result) noexcept;
+  void RunProbabilityAnalysis(
+      const std::shared_ptr<FaultTreeAnalyzer<Algorithm>>& fta,
+      Result* result) noexcept;
 
   /// Defines and runs Quantitative analysis on the target.
   ///
@@ -151,8 +238,11 @@ class RiskAnalysis : public Analysis {
   void RunAnalysis(FaultTreeAnalyzer<Algorithm>* fta, Result* result) noexcept;
 
   mef::Model* model_;  ///< The model with constructs.
+  std::vector<ParametricAxis> sweep_axes_;  ///< The parametric study grid.
   std::vector<Result> results_;  ///< The analysis result storage.
   std::vector<EtaResult> event_tree_results_;  ///< Grouping of sequences.
+  /// The analyses of model gates shared across alignment phases.
+  std::unordered_map<const mef::Gate*, PhaseCache> phase_cache_;
 };
 
 }  // namespace scram::core
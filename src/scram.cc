@@ -19,6 +19,7 @@
 /// Main entrance.
 
 #include <cstdarg>
+#include <cstdint>
 #include <cstdio>  // vsnprintf
 #include <cstring>  // strerror
 
@@ -33,13 +34,16 @@
 #include <boost/version.hpp>
 
 #include <libxml/parser.h>  // xmlInitParser, xmlCleanupParser
+#include <libxml/globals.h>  // xmlThrDefSetGenericErrorFunc
 #include <libxml/xmlerror.h>  // initGenericErrorDefaultFunc
 #include <libxml/xmlversion.h>  // LIBXML_TEST_VERSION, LIBXML_DOTTED_VERSION
 
+#include "binary_report.h"
 #include "error.h"
 #include "ext/scope_guard.h"
 #include "initializer.h"
 #include "logger.h"
+#include "model_cache.h"
 #include "project.h"
 #include "reporter.h"
 #include "risk_analysis.h"
@@ -66,19 +70,35 @@ po::options_description ConstructOptions() {
       ("project", OPT_VALUE(path), "Project file with analysis configurations")
       ("allow-extern", "**UNSAFE** Allow external libraries")
       ("validate", "Validate input files without analysis")
+      ("model-cache", OPT_VALUE(path),
+       "Binary cache file of the initialized model")
+      ("stream-input", "Read input files without keeping their XML DOM")
+      ("diagram-cache", OPT_VALUE(path),
+       "Directory of BDD/ZBDD snapshots for unchanged logic")
+      ("variable-order", OPT_VALUE(path),
+       "File to seed and save BDD variable orders by basic events")
       ("bdd", "Perform qualitative analysis with BDD")
       ("zbdd", "Perform qualitative analysis with ZBDD")
       ("mocus", "Perform qualitative analysis with MOCUS")
+      ("monte-carlo", "Perform direct Monte Carlo simulation without products")
+      ("auto", "Select the qualitative analysis algorithm per target")
       ("prime-implicants", "Calculate prime implicants")
       ("probability", "Perform probability analysis")
       ("importance", "Perform importance analysis")
       ("uncertainty", "Perform uncertainty analysis")
+      ("sensitivity", "Perform sensitivity analysis to parameters")
       ("ccf", "Perform common-cause failure analysis")
+      ("ccf-expansion-limit", OPT_VALUE(int),
+       "Max CCF combination events per level before K/N factoring")
       ("sil", "Compute the Safety Integrity Level metrics")
       ("rare-event", "Use the rare event approximation")
       ("mcub", "Use the MCUB approximation")
       ("limit-order,l", OPT_VALUE(int), "Upper limit for the product order")
       ("cut-off", OPT_VALUE(double), "Cut-off probability for products")
+      ("reorder-threshold", OPT_VALUE(int),
+       "BDD size to trigger dynamic variable reordering")
+      ("preprocessing-budget", OPT_VALUE(double),
+       "Time budget in seconds for each optional preprocessing pass")
       ("mission-time", OPT_VALUE(double), "System mission time in hours")
       ("time-step", OPT_VALUE(double),
        "Time step in hours for probability analysis")
@@ -87,9 +107,22 @@ po::options_description ConstructOptions() {
       ("num-quantiles", OPT_VALUE(int),
        "Number of quantiles for distributions")
       ("num-bins", OPT_VALUE(int), "Number of bins for histograms")
+      ("sweep", po::value<std::vector<std::string>>()
+                    ->value_name("param=start:stop:n"),
+       "Parametric sweep of a parameter or mission-time")
+      ("target", po::value<std::vector<std::string>>()->value_name("id"),
+       "Analyze only the gate, initiating event, or sequence")
       ("seed", OPT_VALUE(int), "Seed for the pseudo-random number generator")
       ("output,o", OPT_VALUE(path), "Output file for reports")
       ("no-indent", "Omit indentation whitespace in output XML")
+      ("binary-output", OPT_VALUE(path),
+       "Output file for the binary columnar report")
+      ("binary-to-xml", OPT_VALUE(path),
+       "Convert the binary report into the XML report")
+      ("report-limit-order", OPT_VALUE(int),
+       "Upper limit for the order of reported products")
+      ("report-limit-products", OPT_VALUE(int),
+       "Upper limit for the number of reported products")
       ("verbosity", OPT_VALUE(int), "Set log verbosity");
 #ifndef NDEBUG
   po::options_description debug("Debug Options");
@@ -105,6 +138,43 @@ po::options_description ConstructOptions() {
 }
 #undef OPT_VALUE
 
+/// Parses the parametric sweep range argument.
+///
+/// @param[in] arg  The range in the "param=start:stop:n" format.
+///
+/// @returns The sweep range for the settings.
+///
+/// @throws SettingsError  The argument format is invalid.
+scram::core::Settings::Sweep ParseSweep(const std::string& arg) {
+  auto fail = [&arg] {
+    SCRAM_THROW(scram::SettingsError("The sweep range format is invalid."))
+        << scram::errinfo_value(arg);
+  };
+  auto eq = arg.find('=');
+  auto first = arg.find(':', eq);
+  auto second = arg.find(':', first + 1);
+  if (eq == 0 || eq == std::string::npos || first == std::string::npos ||
+      second == std::string::npos) {
+    fail();
+  }
+  try {
+    std::size_t end = 0;
+    auto start = std::stod(arg.substr(eq + 1, first - eq - 1), &end);
+    if (end != first - eq - 1)
+      fail();
+    auto stop = std::stod(arg.substr(first + 1, second - first - 1), &end);
+    if (end != second - first - 1)
+      fail();
+    auto num_points = std::stoi(arg.substr(second + 1), &end);
+    if (end != arg.size() - second - 1)
+      fail();
+    return {arg.substr(0, eq), start, stop, num_points};
+  } catch (const std::logic_error&) {  // Conversion failure.
+    fail();
+  }
+  return {};
+}
+
 /// Parses the command-line arguments.
 ///
 /// @param[in] argc  Count of arguments.
@@ -163,14 +233,17 @@ int ParseArguments(int argc, char* argv[], po::variables_map* vm) {
     }
   }
 
-  if (!vm->count("input-files") && !vm->count("project")) {
+  if (!vm->count("input-files") && !vm->count("project") &&
+      !vm->count("binary-to-xml")) {
     std::cerr << "No input or configuration file is given.\n\n";
     print_help(std::cerr);
     return 1;
   }
-  if ((vm->count("bdd") + vm->count("zbdd") + vm->count("mocus")) > 1) {
-    std::cerr << "Mutually exclusive qualitative analysis algorithms.\n"
-              << "(MOCUS/BDD/ZBDD) cannot be applied at the same time.\n\n";
+  if ((vm->count("bdd") + vm->count("zbdd") + vm->count("mocus") +
+       vm->count("monte-carlo") + vm->count("auto")) > 1) {
+    std::cerr << "Mutually exclusive analysis algorithms.\n"
+              << "(MOCUS/BDD/ZBDD/Monte-Carlo/Auto) cannot be applied"
+              << " at the same time.\n\n";
     print_help(std::cerr);
     return 1;
   }
@@ -207,6 +280,10 @@ void ConstructSettings(const po::variables_map& vm,
     settings->algorithm(scram::core::Algorithm::kZbdd);
   } else if (vm.count("mocus")) {
     settings->algorithm(scram::core::Algorithm::kMocus);
+  } else if (vm.count("monte-carlo")) {
+    settings->algorithm(scram::core::Algorithm::kMonteCarlo);
+  } else if (vm.count("auto")) {
+    settings->algorithm(scram::core::Algorithm::kAuto);
   }
   settings->prime_implicants(vm.count("prime-implicants"));
   // Determine if the probability approximation is requested.
@@ -222,14 +299,30 @@ void ConstructSettings(const po::variables_map& vm,
   settings->probability_analysis(vm.count("probability"));
   settings->importance_analysis(vm.count("importance"));
   settings->uncertainty_analysis(vm.count("uncertainty"));
+  settings->sensitivity_analysis(vm.count("sensitivity"));
   settings->ccf_analysis(vm.count("ccf"));
+  SET("ccf-expansion-limit", int, ccf_expansion_limit);
   SET("seed", int, seed);
   SET("limit-order", int, limit_order);
   SET("cut-off", double, cut_off);
+  SET("reorder-threshold", int, reorder_threshold);
+  SET("preprocessing-budget", double, preprocessing_budget);
   SET("mission-time", double, mission_time);
   SET("num-trials", int, num_trials);
   SET("num-quantiles", int, num_quantiles);
   SET("num-bins", int, num_bins);
+  if (vm.count("sweep")) {
+    for (const std::string& arg : vm["sweep"].as<std::vector<std::string>>())
+      settings->sweep(ParseSweep(arg));
+  }
+  if (vm.count("target")) {
+    for (const std::string& id : vm["target"].as<std::vector<std::string>>())
+      settings->target(id);
+  }
+  if (vm.count("diagram-cache"))
+    settings->diagram_cache(vm["diagram-cache"].as<std::string>());
+  if (vm.count("variable-order"))
+    settings->variable_order(vm["variable-order"].as<std::string>());
 #ifndef NDEBUG
   settings->preprocessor = vm.count("preprocessor");
   settings->print = vm.count("print");
@@ -237,6 +330,38 @@ void ConstructSettings(const po::variables_map& vm,
 }
 #undef SET
 
+/// Initializes the model from the input files
+/// or from the binary model cache if requested and up to date.
+///
+/// @param[in] vm  Variables map of program options.
+/// @param[in] input_files  The MEF XML input files.
+/// @param[in] settings  The analysis settings.
+///
+/// @returns The fully initialized model.
+///
+/// @throws Error  The input files or the cache are not accessible or invalid.
+std::unique_ptr<scram::mef::Model> InitializeModel(
+    const po::variables_map& vm, const std::vector<std::string>& input_files,
+    const scram::core::Settings& settings) {
+  bool allow_extern = vm.count("allow-extern");
+  bool stream_input = vm.count("stream-input");
+  auto initialize = [&] {
+    return scram::mef::Initializer(input_files, settings, allow_extern,
+                                   nullptr, stream_input)
+        .model();
+  };
+  if (!vm.count("model-cache"))
+    return initialize();
+
+  const auto& cache_file = vm["model-cache"].as<std::string>();
+  std::uint64_t key = scram::mef::ComputeCacheKey(input_files, settings);
+  if (auto model = scram::mef::LoadCache(cache_file, key, settings))
+    return model;
+  std::unique_ptr<scram::mef::Model> model = initialize();
+  scram::mef::WriteCache(*model, cache_file, key);
+  return model;
+}
+
 /// Main body of command-line entrance to run the program.
 ///
 /// @param[in] vm  Variables map of program options.
@@ -245,6 +370,17 @@ void ConstructSettings(const po::variables_map& vm,
 /// @throws boost::exception  Boost errors with the variables map.
 /// @throws std::exception  All other problems.
 void RunScram(const po::variables_map& vm) {
+  bool indent = vm.count("no-indent") ? false : true;
+  if (vm.count("binary-to-xml")) {
+    scram::binary::Report report(vm["binary-to-xml"].as<std::string>());
+    if (vm.count("output")) {
+      scram::binary::ConvertToXml(report, vm["output"].as<std::string>(),
+                                  indent);
+    } else {
+      scram::binary::ConvertToXml(report, stdout, indent);
+    }
+    return;
+  }
   scram::core::Settings settings;  // Analysis settings.
   std::vector<std::string> input_files;
   // Get configurations if any.
@@ -265,8 +401,7 @@ void RunScram(const po::variables_map& vm) {
   // into valid analysis containers and constructs.
   // Throws if anything is invalid.
   std::unique_ptr<scram::mef::Model> model =
-      scram::mef::Initializer(input_files, settings, vm.count("allow-extern"))
-          .model();
+      InitializeModel(vm, input_files, settings);
 #ifndef NDEBUG
   if (vm.count("serialize"))
     return Serialize(*model, stdout);
@@ -274,6 +409,12 @@ void RunScram(const po::variables_map& vm) {
   if (vm.count("validate"))
     return;  // Stop if only validation is requested.
 
+  scram::Reporter reporter;
+  if (vm.count("report-limit-order"))
+    reporter.limit_order(vm["report-limit-order"].as<int>());
+  if (vm.count("report-limit-products"))
+    reporter.limit_products(vm["report-limit-products"].as<int>());
+
   // Initiate risk analysis with the given information.
   scram::core::RiskAnalysis analysis(model.get(), settings);
   analysis.Analyze();
@@ -281,8 +422,8 @@ void RunScram(const po::variables_map& vm) {
   if (vm.count("no-report") || vm.count("preprocessor") || vm.count("print"))
     return;
 #endif
-  scram::Reporter reporter;
-  bool indent = vm.count("no-indent") ? false : true;
+  if (vm.count("binary-output"))
+    scram::binary::Write(analysis, vm["binary-output"].as<std::string>());
   if (vm.count("output")) {
     reporter.Report(analysis, vm["output"].as<std::string>(), indent);
   } else {
@@ -344,6 +485,8 @@ int main(int argc, char* argv[]) {
 
   xmlGenericErrorFunc xml_error_printer = LogXmlError;
   initGenericErrorDefaultFunc(&xml_error_printer);
+  // Input files are parsed in worker threads with their own error handlers.
+  xmlThrDefSetGenericErrorFunc(nullptr, LogXmlError);
 
   try {
     // Parse command-line options.
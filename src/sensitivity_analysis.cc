@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2014-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementations of functions to provide
+/// sensitivity of the total probability to model parameters.
+
+#include "sensitivity_analysis.h"
+
+#include <cmath>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "event.h"
+#include "logger.h"
+#include "parameter.h"
+
+namespace scram::core {
+
+namespace {
+
+/// The relative step for central differences of expressions.
+/// The cube root of the machine epsilon balances
+/// the truncation and round-off errors.
+const double kRelativeStep = 6e-6;
+
+/// Collects parameters of an expression and its arguments.
+///
+/// @param[in] expression  The expression to traverse.
+/// @param[in,out] visited  The already traversed expressions.
+/// @param[in,out] parameters  The unique parameters of the expression.
+void CollectParameters(mef::Expression* expression,
+                       std::unordered_set<const mef::Expression*>* visited,
+                       std::vector<mef::Parameter*>* parameters) noexcept {
+  if (!visited->insert(expression).second)
+    return;
+  if (auto* parameter = dynamic_cast<mef::Parameter*>(expression))
+    parameters->push_back(parameter);
+  for (mef::Expression* arg : expression->args())
+    CollectParameters(arg, visited, parameters);
+}
+
+}  // namespace
+
+SensitivityAnalysis::SensitivityAnalysis(
+    const ProbabilityAnalysis* prob_analysis)
+    : Analysis(prob_analysis->settings()) {}
+
+void SensitivityAnalysis::Analyze() noexcept {
+  CLOCK(sens_time);
+  LOG(DEBUG3) << "Calculating sensitivity to parameters...";
+  double p_total = this->p_total();
+  const std::vector<const mef::BasicEvent*>& basic_events =
+      this->basic_events();
+  Pdag::IndexMap<double> gradient = this->CalculateGradient();
+
+  // Parameters with the positions of their dependent events.
+  std::vector<std::pair<mef::Parameter*, std::vector<int>>> dependents;
+  std::unordered_map<const mef::Parameter*, int> positions;
+  for (int i = 0; i < basic_events.size(); ++i) {
+    std::unordered_set<const mef::Expression*> visited;
+    std::vector<mef::Parameter*> parameters;
+    CollectParameters(&basic_events[i]->expression(), &visited, &parameters);
+    for (mef::Parameter* parameter : parameters) {
+      auto [it, inserted] = positions.emplace(parameter, dependents.size());
+      if (inserted)
+        dependents.push_back({parameter, {}});
+      dependents[it->second].second.push_back(i);
+    }
+  }
+
+  std::vector<double> p_up;
+  for (const auto& [parameter, events] : dependents) {
+    double value = parameter->value();
+    double step = kRelativeStep * (value ? std::abs(value) : 1);
+    p_up.clear();
+    parameter->shift(step);
+    for (int i : events)
+      p_up.push_back(basic_events[i]->p());
+    parameter->shift(-step);
+    double derivative = 0;
+    for (int j = 0; j < events.size(); ++j) {
+      double dp = (p_up[j] - basic_events[events[j]]->p()) / (2 * step);
+      derivative += gradient[events[j] + Pdag::kVariableStartIndex] * dp;
+    }
+    parameter->shift(0);
+    double elasticity = p_total ? value * derivative / p_total : 0;
+    sensitivity_.push_back({*parameter, value, derivative, elasticity});
+  }
+  LOG(DEBUG3) << "Calculated sensitivity of " << sensitivity_.size()
+              << " parameters in " << DUR(sens_time);
+  Analysis::AddAnalysisTime(DUR(sens_time));
+}
+
+Pdag::IndexMap<double> SensitivityAnalyzer<Bdd>::CalculateGradient() noexcept {
+  auto* calculator = static_cast<ProbabilityAnalyzer<Bdd>*>(prob_analyzer());
+  const Pdag::IndexMap<double>& p_vars = calculator->p_vars();
+  Pdag::IndexMap<double> gradient(p_vars.size());
+  const Bdd::Function& root = bdd_graph_->root();
+  if (root.vertex->terminal())
+    return gradient;
+  // The forward pass restores vertex probabilities
+  // possibly changed by other analyses.
+  calculator->CalculateTotalProbability(p_vars);
+  bool original_mark = Ite::Ref(root.vertex).mark();
+  std::vector<Ite*> vertices;
+  CollectVertices(root.vertex, !original_mark, &vertices);
+
+  auto retrieve_probability = [](const Bdd::VertexPtr& vertex) {
+    return vertex->terminal() ? 1 : Ite::Ref(vertex).p();
+  };
+  auto propagate = [](const Bdd::VertexPtr& vertex, double adjoint) {
+    if (vertex->terminal())
+      return;
+    Ite& ite = Ite::Ref(vertex);
+    ite.factor(ite.factor() + adjoint);
+  };
+  // The adjoint of a vertex is accumulated in its factor field
+  // as the partial derivative of the root probability.
+  Ite::Ref(root.vertex).factor(root.complement ? -1 : 1);
+  // Parents precede children in the reverse post-order.
+  for (auto it = vertices.rbegin(); it != vertices.rend(); ++it) {
+    Ite& ite = **it;
+    double adjoint = ite.factor();
+    if (adjoint == 0)
+      continue;
+    double high = retrieve_probability(ite.high());
+    double low = retrieve_probability(ite.low());
+    if (ite.complement_edge())
+      low = 1 - low;
+    double p_var = 0;
+    if (ite.module()) {
+      const Bdd::Function& res =
+        bdd_graph_->modules().find(ite.index())->second;
+      p_var = retrieve_probability(res.vertex);
+      if (res.complement)
+        p_var = 1 - p_var;
+      double d_module = adjoint * (high - low);
+      propagate(res.vertex, res.complement ? -d_module : d_module);
+    } else {
+      p_var = p_vars[ite.index()];
+      gradient[ite.index()] += adjoint * (high - low);
+    }
+    propagate(ite.high(), adjoint * p_var);
+    double d_low = adjoint * (1 - p_var);
+    propagate(ite.low(), ite.complement_edge() ? -d_low : d_low);
+  }
+  bdd_graph_->ClearMarks(original_mark);
+  return gradient;
+}
+
+void SensitivityAnalyzer<Bdd>::CollectVertices(
+    const Bdd::VertexPtr& vertex, bool mark,
+    std::vector<Ite*>* vertices) noexcept {
+  if (vertex->terminal())
+    return;
+  Ite& ite = Ite::Ref(vertex);
+  if (ite.mark() == mark)
+    return;
+  ite.mark(mark);
+  ite.factor(0);
+  if (ite.module()) {
+    const Bdd::Function& res =
+        bdd_graph_->modules().find(ite.index())->second;
+    CollectVertices(res.vertex, mark, vertices);
+  }
+  CollectVertices(ite.high(), mark, vertices);
+  CollectVertices(ite.low(), mark, vertices);
+  vertices->push_back(&ite);
+}
+
+Pdag::IndexMap<double>
+SensitivityAnalyzer<MonteCarlo>::CalculateGradient() noexcept {
+  Pdag::IndexMap<double> gradient;
+  for (const MonteCarlo::Estimate& mif :
+       simulator_->SimulateImportance(prob_analyzer()->p_vars())) {
+    gradient.push_back(mif.mean);
+  }
+  return gradient;
+}
+
+}  // namespace scram::core
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2014-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Contains functionality to do sensitivity analysis
+/// of the total probability with respect to model parameters.
+
+#pragma once
+
+#include <vector>
+
+#include "bdd.h"
+#include "monte_carlo.h"
+#include "probability_analysis.h"
+#include "settings.h"
+
+namespace scram::mef {  // Decouple from the analysis code header.
+class BasicEvent;
+class Parameter;
+}  // namespace scram::mef
+
+namespace scram::core {
+
+/// Sensitivity of the total probability to a model parameter.
+struct SensitivityRecord {
+  const mef::Parameter& parameter;  ///< The parameter of event expressions.
+  double value;  ///< The mean value of the parameter.
+  double derivative;  ///< The partial derivative of the total probability.
+  double elasticity;  ///< The relative sensitivity d(ln P) / d(ln value).
+};
+
+/// Analysis of the sensitivity of the total probability
+/// to the parameters of basic event expressions.
+///
+/// The partial derivatives with respect to event probabilities
+/// are provided by calculators in a single pass over the analysis data.
+/// These are chained with the derivatives of event expressions
+/// with respect to the parameters.
+/// The expression derivatives are taken with central differences
+/// of the expression mean values,
+/// so no analysis is rerun for perturbed parameters.
+class SensitivityAnalysis : public Analysis {
+ public:
+  /// Sensitivity analysis
+  /// on the fault tree represented by
+  /// its probability analysis.
+  ///
+  /// @param[in] prob_analysis  Completed probability analysis.
+  explicit SensitivityAnalysis(const ProbabilityAnalysis* prob_analysis);
+
+  virtual ~SensitivityAnalysis() = default;
+
+  /// Calculates the partial derivatives of the total probability
+  /// with respect to all parameters of basic event expressions.
+  ///
+  /// @pre Analysis is called only once.
+  ///
+  /// @note The parameters are shifted temporarily during the analysis.
+  void Analyze() noexcept;
+
+  /// @returns A collection of parameters and their sensitivity measures
+  ///          in the order of discovery in basic event expressions.
+  ///
+  /// @pre The sensitivity analysis is done.
+  const std::vector<SensitivityRecord>& sensitivity() const {
+    return sensitivity_;
+  }
+
+ private:
+  /// @returns Total probability from the probability analysis.
+  virtual double p_total() noexcept = 0;
+  /// @returns All basic events of the analysis graph.
+  virtual const std::vector<const mef::BasicEvent*>&
+  basic_events() noexcept = 0;
+
+  /// Calculates the partial derivatives of the total probability
+  /// with respect to the probabilities of all variables.
+  ///
+  /// @returns The gradient mapped by variable indices.
+  virtual Pdag::IndexMap<double> CalculateGradient() noexcept = 0;
+
+  /// Container of parameters and their sensitivity measures.
+  std::vector<SensitivityRecord> sensitivity_;
+};
+
+/// Base class for analyzers of sensitivity
+/// with the help from probability analyzers.
+class SensitivityAnalyzerBase : public SensitivityAnalysis {
+ public:
+  /// Constructs sensitivity analyzer from probability analyzer.
+  ///
+  /// @param[in] prob_analyzer  Instantiated probability analyzer.
+  explicit SensitivityAnalyzerBase(ProbabilityAnalyzerBase* prob_analyzer)
+      : SensitivityAnalysis(prob_analyzer), prob_analyzer_(prob_analyzer) {}
+
+ protected:
+  virtual ~SensitivityAnalyzerBase() = default;
+
+  /// @returns A pointer to the helper probability analyzer.
+  ProbabilityAnalyzerBase* prob_analyzer() { return prob_analyzer_; }
+
+ private:
+  double p_total() noexcept override { return prob_analyzer_->p_total(); }
+  const std::vector<const mef::BasicEvent*>& basic_events() noexcept override {
+    return prob_analyzer_->graph()->basic_events();
+  }
+
+  /// Calculator of the total probability.
+  ProbabilityAnalyzerBase* prob_analyzer_;
+};
+
+/// Analyzer of sensitivity
+/// with the help from probability analyzers.
+///
+/// The partial derivatives with respect to variables
+/// are the Birnbaum marginal importance factors.
+///
+/// @tparam Calculator  Quantitative calculator of probability values.
+template <class Calculator>
+class SensitivityAnalyzer : public SensitivityAnalyzerBase {
+ public:
+  /// @copydoc SensitivityAnalyzerBase::SensitivityAnalyzerBase
+  explicit SensitivityAnalyzer(ProbabilityAnalyzer<Calculator>* prob_analyzer)
+      : SensitivityAnalyzerBase(prob_analyzer) {}
+
+ private:
+  Pdag::IndexMap<double> CalculateGradient() noexcept override;
+};
+
+template <class Calculator>
+Pdag::IndexMap<double>
+SensitivityAnalyzer<Calculator>::CalculateGradient() noexcept {
+  auto* calculator =
+      static_cast<ProbabilityAnalyzer<Calculator>*>(prob_analyzer());
+  return calculator->CalculateMif(calculator->p_vars());
+}
+
+/// Specialization of sensitivity analyzer with Binary Decision Diagrams.
+/// The gradient is calculated with a single backward (adjoint) pass
+/// over the BDD after the forward probability calculation.
+template <>
+class SensitivityAnalyzer<Bdd> : public SensitivityAnalyzerBase {
+ public:
+  /// @copydoc SensitivityAnalyzerBase::SensitivityAnalyzerBase
+  explicit SensitivityAnalyzer(ProbabilityAnalyzer<Bdd>* prob_analyzer)
+      : SensitivityAnalyzerBase(prob_analyzer),
+        bdd_graph_(prob_analyzer->bdd_graph()) {}
+
+ private:
+  Pdag::IndexMap<double> CalculateGradient() noexcept override;
+
+  /// Collects vertices of the BDD including module graphs.
+  ///
+  /// @param[in] vertex  The root vertex of a function graph.
+  /// @param[in] mark  A flag to mark traversed vertices.
+  /// @param[in,out] vertices  The vertices in depth-first post-order.
+  ///
+  /// @post The importance factor fields of the vertices are reset to 0
+  ///       to accumulate adjoint values.
+  void CollectVertices(const Bdd::VertexPtr& vertex, bool mark,
+                       std::vector<Ite*>* vertices) noexcept;
+
+  Bdd* bdd_graph_;  ///< Binary decision diagram for the analyzer.
+};
+
+/// Specialization of sensitivity analyzer with direct Monte Carlo simulation.
+/// The gradient is estimated on the same simulated scenarios
+/// as marginal importance factors.
+template <>
+class SensitivityAnalyzer<MonteCarlo> : public SensitivityAnalyzerBase {
+ public:
+  /// @copydoc SensitivityAnalyzerBase::SensitivityAnalyzerBase
+  explicit SensitivityAnalyzer(ProbabilityAnalyzer<MonteCarlo>* prob_analyzer)
+      : SensitivityAnalyzerBase(prob_analyzer),
+        simulator_(prob_analyzer->simulator()) {}
+
+ private:
+  Pdag::IndexMap<double> CalculateGradient() noexcept override;
+
+  MonteCarlo* simulator_;  ///< The simulator of the analysis graph.
+};
+
+}  // namespace scram::core
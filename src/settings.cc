@@ -21,6 +21,7 @@
 #include "settings.h"
 
 #include <string>
+#include <utility>
 
 #include <boost/range/algorithm.hpp>
 
@@ -32,8 +33,15 @@ Settings& Settings::algorithm(Algorithm value) noexcept {
   algorithm_ = value;
   switch (algorithm_) {
     case Algorithm::kBdd:
+    case Algorithm::kAuto:
       approximation(Approximation::kNone);
       break;
+    case Algorithm::kMonteCarlo:
+      approximation(Approximation::kNone);
+      if (prime_implicants_)
+        prime_implicants(false);
+      probability_analysis_ = true;
+      break;
     default:
       if (approximation_ == Approximation::kNone)
         approximation(Approximation::kRareEvent);
@@ -58,6 +66,9 @@ Settings& Settings::approximation(Approximation value) {
   if (value != Approximation::kNone && prime_implicants_)
     SCRAM_THROW(SettingsError(
         "Prime implicants require no quantitative approximation."));
+  if (value != Approximation::kNone && algorithm_ == Algorithm::kMonteCarlo)
+    SCRAM_THROW(SettingsError(
+        "The Monte Carlo simulation requires no quantitative approximation."));
   approximation_ = value;
   return *this;
 }
@@ -74,7 +85,7 @@ Settings& Settings::approximation(std::string_view value) {
 }
 
 Settings& Settings::prime_implicants(bool flag) {
-  if (flag && algorithm_ != Algorithm::kBdd)
+  if (flag && algorithm_ != Algorithm::kBdd && algorithm_ != Algorithm::kAuto)
     SCRAM_THROW(
         SettingsError("Prime implicants can only be calculated with BDD"));
 
@@ -104,6 +115,35 @@ Settings& Settings::cut_off(double prob) {
   return *this;
 }
 
+Settings& Settings::reorder_threshold(int size) {
+  if (size < 0)
+    SCRAM_THROW(SettingsError(
+        "The BDD size to trigger reordering cannot be negative."))
+        << errinfo_value(std::to_string(size));
+
+  reorder_threshold_ = size;
+  return *this;
+}
+
+Settings& Settings::ccf_expansion_limit(int limit) {
+  if (limit < 0)
+    SCRAM_THROW(SettingsError("The CCF expansion limit cannot be negative."))
+        << errinfo_value(std::to_string(limit));
+
+  ccf_expansion_limit_ = limit;
+  return *this;
+}
+
+Settings& Settings::preprocessing_budget(double time) {
+  if (time < 0)
+    SCRAM_THROW(
+        SettingsError("The preprocessing time budget cannot be negative."))
+        << errinfo_value(std::to_string(time));
+
+  preprocessing_budget_ = time;
+  return *this;
+}
+
 Settings& Settings::num_trials(int n) {
   if (n < 1)
     SCRAM_THROW(SettingsError("The number of trials cannot be less than 1."))
@@ -172,4 +212,36 @@ Settings& Settings::safety_integrity_levels(bool flag) {
   return *this;
 }
 
+Settings& Settings::sweep(Sweep sweep) {
+  if (sweep.num_points < 1)
+    SCRAM_THROW(
+        SettingsError("The number of sweep points cannot be less than 1."))
+        << errinfo_value(std::to_string(sweep.num_points));
+  if (boost::find_if(sweeps_, [&sweep](const Sweep& axis) {
+        return axis.parameter == sweep.parameter;
+      }) != sweeps_.end()) {
+    SCRAM_THROW(SettingsError("The parameter is already swept."))
+        << errinfo_value(sweep.parameter);
+  }
+  if (sweep.parameter == kMissionTime && (sweep.start < 0 || sweep.stop < 0))
+    SCRAM_THROW(SettingsError("The mission time cannot be negative."))
+        << errinfo_value(sweep.parameter);
+
+  sweeps_.push_back(std::move(sweep));
+  probability_analysis_ = true;
+  return *this;
+}
+
+Settings& Settings::target(std::string id) {
+  if (id.empty())
+    SCRAM_THROW(SettingsError("The analysis target id cannot be empty."));
+  if (boost::find(targets_, id) != targets_.end()) {
+    SCRAM_THROW(SettingsError("Duplicate analysis target."))
+        << errinfo_value(id);
+  }
+
+  targets_.push_back(std::move(id));
+  return *this;
+}
+
 }  // namespace scram::core
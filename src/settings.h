@@ -22,15 +22,28 @@
 
 #include <cstdint>
 
+#include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace scram::core {
 
-/// Qualitative analysis algorithms.
-enum class Algorithm : std::uint8_t { kBdd = 0, kZbdd, kMocus };
+/// Analysis algorithms.
+/// The direct Monte Carlo simulation is a purely quantitative algorithm.
+/// The automatic selection picks a qualitative algorithm per analysis target
+/// from the structure of its preprocessed PDAG.
+enum class Algorithm : std::uint8_t {
+  kBdd = 0,
+  kZbdd,
+  kMocus,
+  kMonteCarlo,
+  kAuto
+};
 
 /// String representations for algorithms.
-const char* const kAlgorithmToString[] = {"bdd", "zbdd", "mocus"};
+const char* const kAlgorithmToString[] = {"bdd", "zbdd", "mocus",
+                                          "monte-carlo", "auto"};
 
 /// Quantitative analysis approximations.
 enum class Approximation : std::uint8_t { kNone = 0, kRareEvent, kMcub };
@@ -48,6 +61,17 @@ const char* const kApproximationToString[] = {"none", "rare-event", "mcub"};
 /// @warning The order of building the settings matters.
 class Settings {
  public:
+  /// The name of the system mission time as a sweep parameter.
+  static constexpr const char* kMissionTime = "mission-time";
+
+  /// Linear range of values for a parametric sweep.
+  struct Sweep {
+    std::string parameter;  ///< The parameter id or the mission time.
+    double start;  ///< The first value of the range.
+    double stop;  ///< The last value of the range.
+    int num_points;  ///< The number of values in the range.
+  };
+
   /// @returns The Qualitative analysis algorithm.
   Algorithm algorithm() const { return algorithm_; }
 
@@ -58,6 +82,10 @@ class Settings {
   /// MOCUS and ZBDD based analyses run
   /// with the Rare-Event approximation by default.
   /// Whereas, BDD based analyses run with exact quantitative analysis.
+  /// The automatic selection leaves the approximation
+  /// to the selected algorithm unless it is requested explicitly.
+  /// The direct Monte Carlo simulation implies probability analysis
+  /// without products and approximations.
   ///
   /// @param[in] value  The algorithm kind.
   ///
@@ -84,6 +112,8 @@ class Settings {
   ///
   /// @throws SettingsError  The approximation is not recognized
   ///                          or inappropriate for analysis.
+  /// @throws SettingsError  The approximation is requested
+  ///                          for the direct Monte Carlo simulation.
   /// @{
   Settings& approximation(Approximation value);
   Settings& approximation(std::string_view value);
@@ -95,6 +125,7 @@ class Settings {
 
   /// Sets a flag to calculate prime implicants instead of minimal cut sets.
   /// Prime implicants can only be calculated with BDD-based algorithms.
+  /// The automatic selection always picks BDD for prime implicants.
   ///
   /// The request for prime implicants cancels
   /// the request for inapplicable quantitative analysis approximations.
@@ -131,6 +162,35 @@ class Settings {
   /// @throws SettingsError  The probability is not in the [0, 1] range.
   Settings& cut_off(double prob);
 
+  /// @returns The number of BDD vertices to trigger variable reordering.
+  ///          0 if the reordering is disabled.
+  int reorder_threshold() const { return reorder_threshold_; }
+
+  /// Sets the initial number of BDD vertices
+  /// that triggers dynamic variable reordering.
+  /// The threshold grows with the BDD after each reordering.
+  ///
+  /// @param[in] size  The number of vertices or 0 to disable the reordering.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is negative.
+  Settings& reorder_threshold(int size);
+
+  /// @returns The time budget in seconds for each optional preprocessing pass.
+  ///          0 if the time is unlimited.
+  double preprocessing_budget() const { return preprocessing_budget_; }
+
+  /// Sets the time budget for each optional preprocessing pass.
+  /// The pass is skipped once its total run time exceeds the budget.
+  ///
+  /// @param[in] time  The time in seconds or 0 for unlimited time.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The time value is negative.
+  Settings& preprocessing_budget(double time);
+
   /// @returns The number of trials for Monte-Carlo simulations.
   int num_trials() const { return num_trials_; }
 
@@ -211,7 +271,7 @@ class Settings {
   bool probability_analysis() const { return probability_analysis_; }
 
   /// Sets the flag for probability analysis.
-  /// If another analysis requires probability analysis,
+  /// If another analysis or the algorithm requires probability analysis,
   /// it won't be possible to turn off probability analysis
   /// before the parent analysis.
   ///
@@ -220,7 +280,8 @@ class Settings {
   /// @returns Reference to this object.
   Settings& probability_analysis(bool flag) {
     if (!importance_analysis_ && !uncertainty_analysis_ &&
-        !safety_integrity_levels_) {
+        !sensitivity_analysis_ && !safety_integrity_levels_ &&
+        sweeps_.empty() && algorithm_ != Algorithm::kMonteCarlo) {
       probability_analysis_ = flag;
     }
     return *this;
@@ -257,6 +318,24 @@ class Settings {
     return *this;
   }
 
+  /// @returns true if sensitivity analysis is requested.
+  bool sensitivity_analysis() const { return sensitivity_analysis_; }
+
+  /// Sets the flag for sensitivity analysis to model parameters.
+  /// Sensitivity analysis is performed
+  /// together with probability analysis.
+  /// Appropriate flags are turned on.
+  ///
+  /// @param[in] flag  True or false for turning on or off the analysis.
+  ///
+  /// @returns Reference to this object.
+  Settings& sensitivity_analysis(bool flag) {
+    sensitivity_analysis_ = flag;
+    if (sensitivity_analysis_)
+      probability_analysis_ = true;
+    return *this;
+  }
+
   /// @returns true if uncertainty analysis is requested.
   bool uncertainty_analysis() const { return uncertainty_analysis_; }
 
@@ -274,6 +353,69 @@ class Settings {
     return *this;
   }
 
+  /// @returns The grid axes of the parametric sweep.
+  const std::vector<Sweep>& sweeps() const { return sweeps_; }
+
+  /// Adds an axis to the grid of the parametric sweep.
+  /// The total probability is requantified
+  /// at every point of the Cartesian product of axis ranges,
+  /// so the probability analysis is turned on implicitly.
+  ///
+  /// @param[in] sweep  The linear range of values for a parameter.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number of points is less than 1.
+  /// @throws SettingsError  The parameter is already swept.
+  /// @throws SettingsError  The mission time range is negative.
+  Settings& sweep(Sweep sweep);
+
+  /// @returns The ids of gates, initiating events, or sequences
+  ///          to restrict the analysis.
+  ///          Empty if all top events and initiating events are analyzed.
+  const std::vector<std::string>& targets() const { return targets_; }
+
+  /// Adds an analysis target.
+  /// Only the elements reachable from the targets are defined upon loading,
+  /// and only the targets are analyzed.
+  ///
+  /// @param[in] id  The id of a gate, initiating event, or sequence.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The id is empty or already a target.
+  Settings& target(std::string id);
+
+  /// @returns The directory of BDD/ZBDD snapshots for warm restarts.
+  ///          Empty if the diagrams are not cached.
+  const std::string& diagram_cache() const { return diagram_cache_; }
+
+  /// Sets the directory to store and look up snapshots of decision diagrams
+  /// keyed by the preprocessed PDAG of analysis targets.
+  ///
+  /// @param[in] directory  The cache directory or empty to disable caching.
+  ///
+  /// @returns Reference to this object.
+  Settings& diagram_cache(std::string directory) {
+    diagram_cache_ = std::move(directory);
+    return *this;
+  }
+
+  /// @returns The file of BDD variable orders from previous runs.
+  ///          Empty if the orders are not persisted.
+  const std::string& variable_order() const { return variable_order_; }
+
+  /// Sets the file to seed the BDD variable ordering
+  /// and to save the final orders of analysis targets.
+  ///
+  /// @param[in] file  The order file or empty to disable the persistence.
+  ///
+  /// @returns Reference to this object.
+  Settings& variable_order(std::string file) {
+    variable_order_ = std::move(file);
+    return *this;
+  }
+
   /// @returns true if CCF groups must be incorporated into analysis.
   bool ccf_analysis() const { return ccf_analysis_; }
 
@@ -287,6 +429,24 @@ class Settings {
     return *this;
   }
 
+  /// @returns The maximum number of CCF events per level of a CCF group
+  ///          to generate for member combinations.
+  int ccf_expansion_limit() const { return ccf_expansion_limit_; }
+
+  /// Sets the maximum number of CCF events
+  /// for member combinations per level of a CCF group.
+  /// The levels with more combinations are factored into K/N gates
+  /// over per-member shares of the level.
+  ///
+  /// @param[in] limit  The number of events
+  ///                   or 0 to factor all levels with more combinations
+  ///                   than members.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is negative.
+  Settings& ccf_expansion_limit(int limit);
+
 #ifndef NDEBUG
   bool preprocessor = false;  ///< Stop analysis after preprocessor.
   bool print = false;  ///< Print analysis results in a terminal friendly way.
@@ -297,6 +457,7 @@ class Settings {
   bool safety_integrity_levels_ = false;  ///< Calculation of the SIL metrics.
   bool importance_analysis_ = false;  ///< A flag for importance analysis.
   bool uncertainty_analysis_ = false;  ///< A flag for uncertainty analysis.
+  bool sensitivity_analysis_ = false;  ///< A flag for sensitivity analysis.
   bool ccf_analysis_ = false;  ///< A flag for common-cause analysis.
   bool prime_implicants_ = false;  ///< Calculation of prime implicants.
   /// Qualitative analysis algorithm.
@@ -311,6 +472,13 @@ class Settings {
   double mission_time_ = 8760;  ///< System mission time.
   double time_step_ = 0;  ///< The time step for probability analyses.
   double cut_off_ = 1e-8;  ///< The cut-off probability for products.
+  int reorder_threshold_ = 0;  ///< The BDD size to trigger reordering.
+  int ccf_expansion_limit_ = 100;  ///< The CCF combination events per level.
+  double preprocessing_budget_ = 0;  ///< The time budget for passes.
+  std::vector<Sweep> sweeps_;  ///< The grid axes of the parametric sweep.
+  std::vector<std::string> targets_;  ///< The ids of the analysis targets.
+  std::string diagram_cache_;  ///< The directory of diagram snapshots.
+  std::string variable_order_;  ///< The file of persistent variable orders.
 };
 
 }  // namespace scram::core
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the persistent BDD variable orders.
+
+#include "variable_order.h"
+
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include <boost/exception/errinfo_at_line.hpp>
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/exception/errinfo_file_open_mode.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/range/algorithm.hpp>
+
+#include "error.h"
+#include "event.h"
+
+namespace scram::core {
+
+namespace {
+
+const char kTargetPrefix[] = "target: ";  ///< The header of target sections.
+
+}  // namespace
+
+VariableOrder::VariableOrder(std::string file) : file_(std::move(file)) {
+  boost::system::error_code error;
+  if (!boost::filesystem::exists(file_, error))
+    return;
+  std::ifstream in(file_);
+  if (!in) {
+    SCRAM_THROW(IOError("Cannot read the variable order file."))
+        << boost::errinfo_file_name(file_) << boost::errinfo_file_open_mode("r");
+  }
+  std::vector<std::string>* order = nullptr;
+  int line_number = 0;
+  for (std::string line; std::getline(in, line);) {
+    ++line_number;
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    if (line.empty())
+      continue;
+    if (line.compare(0, sizeof(kTargetPrefix) - 1, kTargetPrefix) == 0) {
+      order = &orders_[line.substr(sizeof(kTargetPrefix) - 1)];
+      order->clear();
+    } else if (order) {
+      order->push_back(std::move(line));
+    } else {
+      SCRAM_THROW(IOError("The variable order is not in a target section."))
+          << boost::errinfo_file_name(file_)
+          << boost::errinfo_at_line(line_number);
+    }
+  }
+  if (in.bad()) {
+    SCRAM_THROW(IOError("Cannot read the variable order file."))
+        << boost::errinfo_file_name(file_);
+  }
+}
+
+int VariableOrder::Seed(const std::string& target, Pdag* graph) const
+    noexcept {
+  auto it = orders_.find(target);
+  if (it == orders_.end() || graph->IsTrivial())
+    return 0;
+  std::unordered_map<std::string_view, int> ranks;
+  for (int i = 0; i < it->second.size(); ++i)
+    ranks.emplace(it->second[i], i);
+
+  std::vector<std::pair<int, Variable*>> seeded;  // With the saved ranks.
+  std::vector<int> positions;  // The heuristic orders of seeded variables.
+  std::unordered_set<int> visited;
+  auto gather = [&](auto& self, Gate* gate) -> void {
+    if (!visited.insert(gate->index()).second)
+      return;
+    for (const Gate::Arg<Variable>& arg : gate->args<Variable>()) {
+      Variable* var = arg.second.get();
+      if (!visited.insert(var->index()).second)
+        continue;
+      auto it_rank = ranks.find(graph->basic_events()[var->index()]->id());
+      if (it_rank == ranks.end())
+        continue;
+      seeded.emplace_back(it_rank->second, var);
+      positions.push_back(var->order());
+    }
+    for (const Gate::Arg<Gate>& arg : gate->args<Gate>())
+      self(self, arg.second.get());
+  };
+  gather(gather, graph->root().get());
+
+  boost::sort(positions);
+  boost::sort(seeded, [](const auto& lhs, const auto& rhs) {
+    return lhs.first < rhs.first;
+  });
+  for (int i = 0; i < seeded.size(); ++i)
+    seeded[i].second->order(positions[i]);
+  return seeded.size();
+}
+
+void VariableOrder::Record(const std::string& target, const Bdd& bdd,
+                           const Pdag& graph) noexcept {
+  int end_index = Pdag::kVariableStartIndex + graph.basic_events().size();
+  std::vector<std::pair<int, const std::string*>> variables;
+  for (const auto& [index, order] : bdd.index_to_order()) {
+    if (index >= Pdag::kVariableStartIndex && index < end_index)
+      variables.emplace_back(order, &graph.basic_events()[index]->id());
+  }
+  if (variables.empty())
+    return;  // Constant or trivial graphs have nothing to order.
+  boost::sort(variables);
+  std::vector<std::string>& order = orders_[target];
+  order.clear();
+  for (const auto& variable : variables)
+    order.push_back(*variable.second);
+}
+
+void VariableOrder::Save() const {
+  // The orders replace the old file only after a successful write.
+  std::string temp_file = file_ + ".tmp";
+  {
+    std::ofstream out(temp_file);
+    for (const auto& [target, order] : orders_) {
+      out << kTargetPrefix << target << "\n";
+      for (const std::string& id : order)
+        out << id << "\n";
+    }
+    if (!out) {
+      SCRAM_THROW(IOError("Cannot write the variable order file."))
+          << boost::errinfo_file_name(file_)
+          << boost::errinfo_file_open_mode("w");
+    }
+  }
+  boost::system::error_code error;
+  boost::filesystem::rename(temp_file, file_, error);
+  if (error) {
+    SCRAM_THROW(IOError("Cannot replace the variable order file."))
+        << boost::errinfo_file_name(file_);
+  }
+}
+
+}  // namespace scram::core
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Persistent BDD variable orders of analysis targets.
+///
+/// The orders are stored by basic event ids
+/// to survive model revisions that change PDAG indices.
+/// The file is plain text with a section per analysis target:
+///
+///     target: <gate id>
+///     <basic event id>
+///     ...
+///
+/// The basic events of a section are listed in the ascending BDD order.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "bdd.h"
+#include "pdag.h"
+
+namespace scram::core {
+
+/// Variable orders of analysis targets saved from previous runs.
+class VariableOrder {
+ public:
+  /// Loads the variable orders from a file.
+  ///
+  /// @param[in] file  The file with the orders.
+  ///                  A missing file has no orders.
+  ///
+  /// @throws IOError  The file is not readable or malformed.
+  explicit VariableOrder(std::string file);
+
+  /// Seeds the PDAG with the saved order of the target.
+  /// The variables with the saved order take the positions
+  /// the heuristic has assigned to them as a group
+  /// but follow the saved relative order.
+  /// The new variables keep their positions from the heuristic.
+  ///
+  /// @param[in] target  The id of the analysis target.
+  /// @param[in,out] graph  The PDAG with the heuristic order.
+  ///
+  /// @returns The number of seeded variables.
+  ///
+  /// @pre The PDAG has variable ordering.
+  int Seed(const std::string& target, Pdag* graph) const noexcept;
+
+  /// Records the variable order of the BDD for the target.
+  ///
+  /// @param[in] target  The id of the analysis target.
+  /// @param[in] bdd  The constructed BDD of the target.
+  /// @param[in] graph  The PDAG of the BDD with the basic events.
+  void Record(const std::string& target, const Bdd& bdd,
+              const Pdag& graph) noexcept;
+
+  /// Writes the orders of all the targets into the file.
+  ///
+  /// @throws IOError  The file is not writable.
+  void Save() const;
+
+ private:
+  std::string file_;  ///< The file with the orders.
+  /// The basic event ids in the ascending order by targets.
+  std::map<std::string, std::vector<std::string>> orders_;
+};
+
+}  // namespace scram::core
@@ -24,6 +24,30 @@
 
 namespace scram::xml {
 
+namespace {
+
+/// Detects XInclude directives left unresolved in the tree,
+/// e.g., due to inclusion cycles.
+///
+/// @param[in] node  The root node of the tree to search.
+///
+/// @returns true if the tree contains an XInclude element.
+bool HasXInclude(const xmlNode* node) noexcept {
+  for (; node; node = node->next) {
+    if (node->type != XML_ELEMENT_NODE)
+      continue;
+    if (node->ns && (xmlStrEqual(node->ns->href, XINCLUDE_NS) ||
+                     xmlStrEqual(node->ns->href, XINCLUDE_OLD_NS))) {
+      return true;
+    }
+    if (HasXInclude(node->children))
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
 Document::Document(const std::string& file_path, Validator* validator)
     : doc_(nullptr, &xmlFreeDoc) {
   xmlResetLastError();
@@ -45,8 +69,7 @@ Document::Document(const std::string& file_path, Validator* validator)
 }
 
 Validator::Validator(const std::string& rng_file)
-    : schema_(nullptr, &xmlRelaxNGFree),
-      valid_ctxt_(nullptr, &xmlRelaxNGFreeValidCtxt) {
+    : schema_(nullptr, &xmlRelaxNGFree) {
   xmlResetLastError();
   std::unique_ptr<xmlRelaxNGParserCtxt, decltype(&xmlRelaxNGFreeParserCtxt)>
       parser_ctxt(xmlRelaxNGNewParserCtxt(rng_file.c_str()),
@@ -57,10 +80,141 @@ Validator::Validator(const std::string& rng_file)
   schema_.reset(xmlRelaxNGParse(parser_ctxt.get()));
   if (!schema_)
     SCRAM_THROW(detail::GetError<ParseError>());
+}
 
-  valid_ctxt_.reset(xmlRelaxNGNewValidCtxt(schema_.get()));
-  if (!valid_ctxt_)
+void Validator::validate(const Document& doc) const {
+  xmlResetLastError();
+  std::unique_ptr<xmlRelaxNGValidCtxt, decltype(&xmlRelaxNGFreeValidCtxt)>
+      valid_ctxt(xmlRelaxNGNewValidCtxt(schema_.get()),
+                 &xmlRelaxNGFreeValidCtxt);
+  if (!valid_ctxt)
     SCRAM_THROW(detail::GetError<LogicError>());
+
+  int ret =
+      xmlRelaxNGValidateDoc(valid_ctxt.get(), const_cast<xmlDoc*>(doc.get()));
+  if (ret != 0) {
+    // Failed XInclude directives, e.g., cycles, are left in the document,
+    // so the schema reports them as unexpected elements.
+    if (HasXInclude(xmlDocGetRootElement(doc.get()))) {
+      XIncludeError err("Failed to resolve XInclude directives.");
+      if (doc.get()->URL) {
+        err << boost::errinfo_file_name(
+            reinterpret_cast<const char*>(doc.get()->URL));
+      }
+      SCRAM_THROW(err);
+    }
+    SCRAM_THROW(detail::GetError<ValidityError>());
+  }
+}
+
+Reader::Reader(const std::string& file_path, const Validator* validator)
+    : file_path_(file_path),
+      reader_(nullptr, &xmlFreeTextReader),
+      subtree_(nullptr, &xmlFreeDoc),
+      validate_(validator != nullptr) {
+  xmlResetLastError();
+  reader_.reset(xmlReaderForFile(file_path.c_str(), nullptr, kParserOptions));
+  if (!reader_) {
+    SCRAM_THROW(IOError("Failed to open the file for reading."))
+        << boost::errinfo_file_name(file_path) << boost::errinfo_errno(errno)
+        << boost::errinfo_file_open_mode("r");
+  }
+  if (validator &&
+      xmlTextReaderRelaxNGSetSchema(reader_.get(), validator->schema_.get())) {
+    SCRAM_THROW(detail::GetError<LogicError>());
+  }
+}
+
+bool Reader::ReadNode() {
+  xmlResetLastError();
+  int ret = xmlTextReaderRead(reader_.get());
+  if (ret < 0) {
+    xmlErrorPtr xml_error = xmlGetLastError();
+    if (!xml_error) {
+      SCRAM_THROW(ParseError("Failed to read the document."))
+          << boost::errinfo_file_name(file_path_);
+    }
+    if (xml_error->domain == xmlErrorDomain::XML_FROM_XINCLUDE)
+      SCRAM_THROW(detail::GetError<XIncludeError>(xml_error));
+    SCRAM_THROW(detail::GetError<ParseError>(xml_error));
+  }
+  if (validate_ && xmlTextReaderIsValid(reader_.get()) != 1) {
+    xmlErrorPtr xml_error = xmlGetLastError();
+    if (!xml_error) {
+      SCRAM_THROW(ValidityError("Document failed schema validation."))
+          << boost::errinfo_file_name(file_path_);
+    }
+    // The reader leaves failed XInclude directives in place,
+    // so the schema validation reports them as unexpected elements.
+    auto* node = static_cast<const xmlNode*>(xml_error->node);
+    if (!node)
+      node = xmlTextReaderCurrentNode(reader_.get());
+    if (node && node->type == XML_ELEMENT_NODE && HasXInclude(node)) {
+      SCRAM_THROW(XIncludeError("Failed to resolve XInclude directives."))
+          << boost::errinfo_file_name(file_path_)
+          << boost::errinfo_at_line(xml_error->line);
+    }
+    SCRAM_THROW(detail::GetError<ValidityError>(xml_error));
+  }
+  return ret == 1;
+}
+
+bool Reader::Read() {
+  subtree_.reset();
+  if (pending_end_) {
+    pending_end_ = false;
+    start_ = false;
+    return true;
+  }
+  while (ReadNode()) {
+    switch (xmlTextReaderNodeType(reader_.get())) {
+      case XML_READER_TYPE_ELEMENT:
+        start_ = true;
+        pending_end_ = xmlTextReaderIsEmptyElement(reader_.get()) == 1;
+        return true;
+      case XML_READER_TYPE_END_ELEMENT:
+        start_ = false;
+        return true;
+      default:
+        continue;
+    }
+  }
+  return false;
+}
+
+Element Reader::Expand() {
+  assert(start_ && "The reader is not at the start tag.");
+  xmlResetLastError();
+  xmlNode* node = xmlTextReaderExpand(reader_.get());
+  if (!node)
+    SCRAM_THROW(detail::GetError<ParseError>());
+  // The subtree is copied out of the reader
+  // because reading through it for validation releases the original.
+  subtree_.reset(xmlNewDoc(nullptr));
+  subtree_->URL = xmlStrdup(node->doc->URL);
+  xmlNode* copy = xmlDocCopyNode(node, subtree_.get(), 1);
+  if (!copy)
+    SCRAM_THROW(detail::GetError<LogicError>());
+  xmlDocSetRootElement(subtree_.get(), copy);
+  Skip();
+  return Element(reinterpret_cast<const xmlElement*>(copy));
+}
+
+void Reader::Skip() {
+  assert(start_ && "The reader is not at the start tag.");
+  start_ = false;
+  if (pending_end_) {
+    pending_end_ = false;
+    return;
+  }
+  int depth = xmlTextReaderDepth(reader_.get());
+  while (ReadNode()) {
+    if (xmlTextReaderNodeType(reader_.get()) == XML_READER_TYPE_END_ELEMENT &&
+        xmlTextReaderDepth(reader_.get()) == depth) {
+      return;
+    }
+  }
+  assert(false && "The reader has reached the end of the document.");
 }
 
 }  // namespace scram::xml
@@ -53,6 +53,7 @@
 #include <libxml/parser.h>
 #include <libxml/relaxng.h>
 #include <libxml/tree.h>
+#include <libxml/xmlreader.h>
 
 #include "error.h"
 
@@ -381,6 +382,14 @@ class Element {
            });
   }
 
+  /// @returns true if both adaptors refer to the same XML element.
+  /// @{
+  bool operator==(const Element& other) const {
+    return element_ == other.element_;
+  }
+  bool operator!=(const Element& other) const { return !(*this == other); }
+  /// @}
+
  private:
   /// Converts the data to its base.
   xmlNode* to_node() const {
@@ -395,7 +404,7 @@ const int kParserOptions = XML_PARSE_XINCLUDE | XML_PARSE_NOBASEFIX |
                            XML_PARSE_NONET | XML_PARSE_NOXINCNODE |
                            XML_PARSE_COMPACT | XML_PARSE_HUGE;
 
-class Validator;  // Forward declaration for validation upon DOM constructions.
+class Validator;  // Forward declaration for validation upon constructions.
 
 /// XML DOM tree document.
 class Document {
@@ -443,24 +452,104 @@ class Validator {
   explicit Validator(const std::string& rng_file);
 
   /// Validates XML DOM documents against the schema.
+  /// Each validation runs in its own context,
+  /// so documents can be validated concurrently against the same schema.
   ///
   /// @param[in] doc  The initialized XML DOM document.
   ///
   /// @throws ValidityError  The document failed schema validation.
-  void validate(const Document& doc) {
-    xmlResetLastError();
-    int ret = xmlRelaxNGValidateDoc(valid_ctxt_.get(),
-                                    const_cast<xmlDoc*>(doc.get()));
-    if (ret != 0)
-      SCRAM_THROW(detail::GetError<ValidityError>());
-  }
+  /// @throws XIncludeError  The document has unresolved XInclude directives.
+  /// @throws LogicError  The XML library functions have failed internally.
+  void validate(const Document& doc) const;
 
  private:
-  /// The schema used by the validation context.
+  friend class Reader;  // Streaming validation with the schema.
+
+  /// The schema shared by the validation contexts.
   std::unique_ptr<xmlRelaxNG, decltype(&xmlRelaxNGFree)> schema_;
-  /// The validation context.
-  std::unique_ptr<xmlRelaxNGValidCtxt, decltype(&xmlRelaxNGFreeValidCtxt)>
-      valid_ctxt_;
+};
+
+/// Forward-only streaming reader of XML documents.
+///
+/// Unlike the DOM Document,
+/// the reader keeps in memory only the element being processed.
+/// Elements are either entered by their start and end tags
+/// or materialized with their whole subtree one at a time.
+/// XInclude directives are processed in place.
+class Reader {
+ public:
+  /// Opens the document for reading.
+  ///
+  /// @param[in] file_path  The path to the document file.
+  /// @param[in] validator  Optional validator against the RNG schema.
+  ///
+  /// @throws IOError  The file is not available.
+  /// @throws LogicError  The XML library functions have failed internally.
+  explicit Reader(const std::string& file_path,
+                  const Validator* validator = nullptr);
+
+  /// Advances to the next element start or end tag.
+  ///
+  /// @returns false if the end of the document is reached.
+  ///
+  /// @throws ParseError  There are XML parsing failures.
+  /// @throws XIncludeError  XInclude resolution has failed.
+  /// @throws ValidityError  The XML file is not valid.
+  bool Read();
+
+  /// @returns true if the reader is at the element start tag.
+  bool start() const { return start_; }
+
+  /// @returns The current element.
+  ///
+  /// @pre The reader is at the element start or end tag.
+  ///
+  /// @warning Only the attributes of the element are available.
+  ///          Its children are not read yet or already released.
+  Element element() const {
+    return Element(reinterpret_cast<const xmlElement*>(
+        xmlTextReaderCurrentNode(reader_.get())));
+  }
+
+  /// Materializes the current element with its whole subtree
+  /// and moves the reader to the element end tag.
+  /// The subtree is validated before returning.
+  ///
+  /// @returns The element valid until the next call to Read or Expand.
+  ///
+  /// @throws ParseError  There are XML parsing failures.
+  /// @throws XIncludeError  XInclude resolution has failed.
+  /// @throws ValidityError  The XML file is not valid.
+  ///
+  /// @pre The reader is at the element start tag.
+  Element Expand();
+
+  /// Moves the reader to the end tag of the current element
+  /// without materializing its subtree.
+  ///
+  /// @throws ParseError  There are XML parsing failures.
+  /// @throws XIncludeError  XInclude resolution has failed.
+  /// @throws ValidityError  The XML file is not valid.
+  ///
+  /// @pre The reader is at the element start tag.
+  void Skip();
+
+ private:
+  /// Reads the next node of the document.
+  ///
+  /// @returns false if the end of the document is reached.
+  ///
+  /// @throws ParseError  There are XML parsing failures.
+  /// @throws XIncludeError  XInclude resolution has failed.
+  /// @throws ValidityError  The XML file is not valid.
+  bool ReadNode();
+
+  std::string file_path_;  ///< The document file for error reporting.
+  std::unique_ptr<xmlTextReader, decltype(&xmlFreeTextReader)> reader_;
+  std::unique_ptr<xmlDoc, decltype(&xmlFreeDoc)> subtree_;  ///< Expansion.
+  bool validate_;  ///< The reader validates the document.
+  bool start_ = false;  ///< The reader is at the element start tag.
+  bool pending_end_ = false;  ///< The start tag of an empty element.
 };
 
 }  // namespace scram::xml
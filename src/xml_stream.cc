@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2016-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the buffered output for XML streams.
+
+#include "xml_stream.h"
+
+namespace scram::xml::detail {
+
+FileStream::FileStream(std::FILE* file, bool async)
+    : file_(file),
+      buffer_(new char[kBufferSize]),
+      pos_(buffer_.get()),
+      end_(buffer_.get() + kBufferSize),
+      async_(async) {
+  if (async_) {
+    back_buffer_.reset(new char[kBufferSize]);
+    writer_ = std::thread(&FileStream::RunWriter, this);
+  }
+}
+
+FileStream::~FileStream() noexcept {
+  Flush();
+  if (async_) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      done_ = true;
+    }
+    cv_.notify_one();
+    writer_.join();
+  }
+}
+
+void FileStream::Flush() {
+  Drain();
+  if (async_) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    WaitWriter(&lock);
+  }
+}
+
+void FileStream::Drain() {
+  std::size_t size = pos_ - buffer_.get();
+  pos_ = buffer_.get();
+  if (!size)
+    return;
+  if (!async_) {
+    std::fwrite(buffer_.get(), 1, size, file_);
+    return;
+  }
+  {  // Swap the blocks once the writer is done with the previous one.
+    std::unique_lock<std::mutex> lock(mutex_);
+    WaitWriter(&lock);
+    buffer_.swap(back_buffer_);
+    pending_size_ = size;
+  }
+  cv_.notify_one();
+  pos_ = buffer_.get();
+  end_ = pos_ + kBufferSize;
+}
+
+void FileStream::Spill(const char* data, std::size_t size) {
+  Drain();
+  if (size < kBufferSize) {
+    std::memcpy(pos_, data, size);
+    pos_ += size;
+    return;
+  }
+  if (async_) {  // Keep the order of blocks.
+    std::unique_lock<std::mutex> lock(mutex_);
+    WaitWriter(&lock);
+  }
+  std::fwrite(data, 1, size, file_);
+}
+
+void FileStream::WaitWriter(std::unique_lock<std::mutex>* lock) {
+  cv_.wait(*lock, [this] { return pending_size_ == 0; });
+}
+
+void FileStream::RunWriter() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    cv_.wait(lock, [this] { return pending_size_ || done_; });
+    if (!pending_size_)
+      return;  // The stream is done, and all the blocks are written.
+    std::size_t size = pending_size_;
+    lock.unlock();
+    std::fwrite(back_buffer_.get(), 1, size, file_);
+    lock.lock();
+    pending_size_ = 0;
+    cv_.notify_one();
+  }
+}
+
+}  // namespace scram::xml::detail
@@ -22,10 +22,17 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 
 #include <algorithm>
+#include <charconv>
+#include <condition_variable>
 #include <exception>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
 
 #include <boost/exception/errinfo_errno.hpp>
 
@@ -99,48 +106,109 @@ class Indenter {
   char spaces[kMaxIndent + 1];  ///< The indentation and terminator.
 };
 
-/// Adaptor for stdio FILE stream with write generic interface.
+/// Buffered adaptor for stdio FILE stream with write generic interface.
+///
+/// The data is accumulated in a large user-space buffer
+/// and handed to the FILE stream in big blocks.
+/// Numbers are formatted with std::to_chars directly into the buffer.
+/// Optionally, the blocks are written on a background thread
+/// while the next block is being formed (double buffering).
 ///
 /// @note Write operations do not return any error code or throw exceptions.
 ///       If any IO errors happen,
-///       the FILE handler contains the error information.
+///       the FILE handler contains the error information
+///       after the stream is flushed.
 class FileStream {
  public:
+  static const std::size_t kBufferSize = 1 << 20;  ///< The block size.
+
   /// @param[in] file  The output file stream.
-  explicit FileStream(std::FILE* file) : file_(file) {}
+  /// @param[in] async  Write the blocks on a background thread.
+  explicit FileStream(std::FILE* file, bool async = false);
+
+  /// Flushes the remaining data and stops the background writer.
+  ~FileStream() noexcept;
+
+  FileStream(const FileStream&) = delete;
+  FileStream& operator=(const FileStream&) = delete;
 
   /// @returns The destination file stream.
+  ///
+  /// @pre The stream is flushed before inspecting the file.
   std::FILE* file() { return file_; }
 
-  /// Writes a value into file.
+  /// Hands all the buffered data to the destination file stream
+  /// and waits for the background writes to complete.
+  void Flush();
+
+  /// Writes a value into the buffer.
   /// @{
-  void write(const std::string& value) { write(value.c_str()); }
-  void write(const char* value) { std::fputs(value, file_); }
-  void write(const char value) { std::fputc(value, file_); }
-  void write(int value) {
-    if (value < 0) {
-      std::fputc('-', file_);
-      value = -value;
-    }
-    write(static_cast<std::size_t>(value));
+  void write(const std::string& value) { write(value.data(), value.size()); }
+  void write(const char* value) { write(value, std::strlen(value)); }
+  void write(const char* data, std::size_t size) {
+    if (size > static_cast<std::size_t>(end_ - pos_))
+      return Spill(data, size);
+    std::memcpy(pos_, data, size);
+    pos_ += size;
   }
-  void write(std::size_t value) {
-    char temp[20];
-    char* p = temp;
-    do {
-      *p++ = value % 10 + '0';
-      value /= 10;
-    } while (value > 0);
-
-    do {
-      std::fputc(*--p, file_);
-    } while (p != temp);
+  void write(const char value) {
+    if (pos_ == end_)
+      Drain();
+    *pos_++ = value;
+  }
+  void write(int value) { PutNumber(value); }
+  void write(std::size_t value) { PutNumber(value); }
+  void write(double value) {  // The same as printf("%g").
+    PutNumber(value, std::chars_format::general, 6);
   }
-  void write(double value) { std::fprintf(file_, "%g", value); }
   /// @}
 
  private:
+  /// The upper bound of the length of a formatted number.
+  static const int kMaxNumberChars = 32;
+
+  /// Formats a number directly into the buffer.
+  ///
+  /// @param[in] args  The value and its format for std::to_chars.
+  template <typename... Ts>
+  void PutNumber(Ts... args) {
+    if (end_ - pos_ < kMaxNumberChars)
+      Drain();
+    std::to_chars_result result = std::to_chars(pos_, end_, args...);
+    assert(result.ec == std::errc() && "Insufficient number buffer.");
+    pos_ = result.ptr;
+  }
+
+  /// Hands the filled part of the buffer to the destination
+  /// and starts a new block.
+  void Drain();
+
+  /// Writes the data that doesn't fit into the rest of the buffer.
+  void Spill(const char* data, std::size_t size);
+
+  /// Waits for the background writer to finish the pending block.
+  ///
+  /// @param[in] lock  The lock of the writer mutex.
+  void WaitWriter(std::unique_lock<std::mutex>* lock);
+
+  /// The main loop of the background writer thread.
+  void RunWriter();
+
   std::FILE* file_;  ///< The destination file.
+  std::unique_ptr<char[]> buffer_;  ///< The block being formed.
+  char* pos_;  ///< The end of the data in the buffer.
+  char* end_;  ///< The end of the buffer.
+
+  /// Background writer facilities.
+  /// @{
+  bool async_;  ///< The writer thread is running.
+  std::unique_ptr<char[]> back_buffer_;  ///< The block being written.
+  std::size_t pending_size_ = 0;  ///< The size of the data in the back buffer.
+  bool done_ = false;  ///< The signal to stop the writer.
+  std::mutex mutex_;  ///< The guard of the writer state.
+  std::condition_variable cv_;  ///< The writer state change notifications.
+  std::thread writer_;  ///< The background writer.
+  /// @}
 };
 
 /// Convenience wrapper to provide C++ stream-like interface.
@@ -213,7 +281,9 @@ class StreamElement {
     } else if (accept_elements_) {
       out_ << indenter_(kIndent_);
     closing_tag:
-      out_ << "</" << kName_ << ">\n";
+      out_ << "</";
+      out_.write(kName_, kNameSize_);
+      out_ << ">\n";
     } else {
       assert(accept_text_ && "The element is in unspecified state.");
       goto closing_tag;
@@ -241,9 +311,9 @@ class StreamElement {
     if (*name == '\0')
       throw StreamError("Attribute name can't be empty.");
 
-    out_ << " " << name << "=\"";
+    out_ << ' ' << name << "=\"";
     PutValue(std::forward<T>(value));
-    out_ << "\"";
+    out_ << '"';
     return *this;
   }
 
@@ -324,6 +394,7 @@ class StreamElement {
   StreamElement(const char* name, int indent, StreamElement* parent,
                 detail::Indenter* indenter, detail::FileStream* out)
       : kName_(name),
+        kNameSize_(std::strlen(name)),
         kIndent_(indent),
         accept_attributes_(true),
         accept_elements_(true),
@@ -332,7 +403,7 @@ class StreamElement {
         parent_(parent),
         indenter_(*indenter),
         out_(*out) {
-    if (*kName_ == '\0')
+    if (!kNameSize_)
       throw StreamError("The element name can't be empty.");
 
     if (parent_) {
@@ -341,7 +412,8 @@ class StreamElement {
       parent_->active_ = false;
     }
     assert(kIndent_ >= 0 && "Negative XML indentation.");
-    out_ << indenter_(kIndent_) << "<" << kName_;
+    out_ << indenter_(kIndent_) << '<';
+    out_.write(kName_, kNameSize_);
   }
 
   /// Puts the value as text escaping the required XML special characters.
@@ -350,46 +422,38 @@ class StreamElement {
   void PutValue(double value) { out_ << value; }
   void PutValue(std::size_t value) { out_ << value; }
   void PutValue(bool value) { out_ << (value ? "true" : "false"); }
-  void PutValue(const std::string& value) { PutValue(value.c_str()); }
-  void PutValue(const char* value) {
-    bool has_special_chars = [value]() mutable {  // 2x faster than strpbrk.
-      for (;; ++value) {
-        switch (*value) {
-          case '\0':
-            return false;
-          case '&':
-          case '<':
-          case '"':
-            return true;
-        }
-      }
-    }();
-
-    if (!has_special_chars) {  // The most common case.
-      out_ << value;
-    } else {
-      for (;; ++value) {
-        switch (*value) {
-          case '\0':
-            return;
-          case '&':
-            out_ << "&amp;";
-            break;
-          case '<':
-            out_ << "&lt;";
-            break;
-          case '"':
-            out_ << "&quot;";
-            break;
-          default:
-            out_ << *value;
-        }
+  void PutValue(const std::string& value) {
+    PutValue(std::string_view(value));
+  }
+  void PutValue(const char* value) { PutValue(std::string_view(value)); }
+  void PutValue(std::string_view value) {
+    const char* run = value.data();  // Copy runs between special chars.
+    const char* end = run + value.size();
+    for (const char* cur = run; cur != end; ++cur) {
+      const char* escape = nullptr;
+      switch (*cur) {
+        case '&':
+          escape = "&amp;";
+          break;
+        case '<':
+          escape = "&lt;";
+          break;
+        case '"':
+          escape = "&quot;";
+          break;
+        default:
+          continue;
       }
+      out_.write(run, cur - run);
+      out_ << escape;
+      run = cur + 1;
     }
+    out_.write(run, end - run);
   }
   /// @}
 
   const char* kName_;  ///< The name of the element.
+  const std::size_t kNameSize_;  ///< The length of the name for closing tags.
   const int kIndent_;  ///< Indentation for tags.
   bool accept_attributes_;  ///< Flag for preventing late attributes.
   bool accept_elements_;  ///< Flag for preventing late elements.
@@ -413,13 +477,15 @@ class Stream {
   ///
   /// @param[in] out  The stream destination.
   /// @param[in] indent  Option to indent output for readability.
+  /// @param[in] async  Option to write the output on a background thread
+  ///                   overlapping with the document generation.
   ///
   /// @note This output file has clean error state.
-  explicit Stream(std::FILE* out, bool indent = true)
+  explicit Stream(std::FILE* out, bool indent = true, bool async = false)
       : indenter_(indent),
         has_root_(false),
         uncaught_exceptions_(std::uncaught_exceptions()),
-        out_(out) {
+        out_(out, async) {
     assert(!std::ferror(out) && "Unclean error state in output destination.");
     out_ << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
   }
@@ -428,6 +494,7 @@ class Stream {
   ///
   /// @post The exception is thrown only if no other exception is on flight.
   ~Stream() noexcept(false) {
+    out_.Flush();
     int err = std::ferror(out_.file());
     if (err && (std::uncaught_exceptions() == uncaught_exceptions_))
       SCRAM_THROW(IOError("FILE error on write")) << boost::errinfo_errno(err);
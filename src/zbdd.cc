@@ -23,6 +23,7 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <numeric>
 
 #include <boost/range/algorithm.hpp>
 
@@ -356,9 +357,13 @@ Zbdd::VertexPtr Zbdd::ConvertGraph(
       return false;
     return SetNode::Ref(lhs).order() > SetNode::Ref(rhs).order();
   });
-  auto it = args.cbegin();
-  for (result = *it++; it != args.cend(); ++it) {
-    result = Apply(gate.type(), result, *it, kSettings_.limit_order());
+  if (gate.type() == kAtleast) {
+    result = ApplyAtleast(args, gate.min_number(), kSettings_.limit_order());
+  } else {
+    auto it = args.cbegin();
+    for (result = *it++; it != args.cend(); ++it) {
+      result = Apply(gate.type(), result, *it, kSettings_.limit_order());
+    }
   }
   ClearTables();
   assert(result);
@@ -543,6 +548,23 @@ Zbdd::VertexPtr Zbdd::Apply(Connective type, const VertexPtr& arg_one,
   return Apply<kOr>(arg_one, arg_two, limit_order);
 }
 
+Zbdd::VertexPtr Zbdd::ApplyAtleast(const std::vector<VertexPtr>& args,
+                                   int min_number, int limit_order) noexcept {
+  assert(min_number > 0 && min_number <= args.size());
+  // The K/N sets of the applied arguments by the remaining K.
+  std::vector<VertexPtr> row(min_number + 1, kEmpty_);
+  row.front() = kBase_;
+  int num_args = args.size();
+  for (int i = 0; i < num_args; ++i) {
+    int last = std::max(1, min_number - (num_args - i - 1));
+    for (int k = std::min(i + 1, min_number); k >= last; --k) {
+      row[k] = Apply<kOr>(Apply<kAnd>(args[i], row[k - 1], limit_order),
+                          row[k], limit_order);
+    }
+  }
+  return row.back();
+}
+
 Zbdd::VertexPtr Zbdd::EliminateComplements(
     const VertexPtr& vertex,
     std::unordered_map<int, VertexPtr>* wide_results) noexcept {
@@ -781,6 +803,47 @@ void Zbdd::ApplySubstitutions(
   root_ = Minimize(root_);
 }
 
+double Zbdd::CalculateProbabilitySum(const Pdag::IndexMap<double>& p_vars,
+                                     int max_order) const noexcept {
+  std::unordered_map<const SetNode*, SizeSums> sums;
+  SizeSums root_sums = SumProbabilities(root_, p_vars, max_order, &sums);
+  return std::accumulate(root_sums.begin(), root_sums.end(), 0.0);
+}
+
+Zbdd::SizeSums Zbdd::SumProbabilities(
+    const VertexPtr& vertex, const Pdag::IndexMap<double>& p_vars,
+    int max_order,
+    std::unordered_map<const SetNode*, SizeSums>* sums) const noexcept {
+  SizeSums result(max_order + 1);
+  if (vertex->terminal()) {
+    if (Terminal<SetNode>::Ref(vertex).value())
+      result.front() = 1;
+    return result;
+  }
+  const SetNode& node = SetNode::Ref(vertex);
+  if (auto it = sums->find(&node); it != sums->end())
+    return it->second;
+
+  result = SumProbabilities(node.low(), p_vars, max_order, sums);
+  SizeSums high = SumProbabilities(node.high(), p_vars, max_order, sums);
+  if (node.module()) {  // The products of the module extend the high sets.
+    const Zbdd& module = *modules_.find(node.index())->second;
+    SizeSums module_sums =
+        module.SumProbabilities(module.root_, p_vars, max_order, sums);
+    for (int i = 0; i <= max_order; ++i) {
+      for (int j = 0; i + j <= max_order; ++j)
+        result[i + j] += module_sums[i] * high[j];
+    }
+  } else {
+    int index = node.index();
+    double p = index < 0 ? 1 - p_vars[-index] : p_vars[index];
+    for (int i = 1; i <= max_order; ++i)
+      result[i] += p * high[i - 1];
+  }
+  sums->emplace(&node, result);
+  return result;
+}
+
 int Zbdd::CountSetNodes(const VertexPtr& vertex) noexcept {
   if (vertex->terminal())
     return 0;
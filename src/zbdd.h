@@ -128,6 +128,8 @@ using TripletTable = std::unordered_map<Triplet, Value, TripletHash>;
 
 /// Zero-Suppressed Binary Decision Diagrams for set manipulations.
 class Zbdd : private boost::noncopyable {
+  friend class DiagramCache;  // Restores the diagram from snapshots.
+
  public:
   using VertexPtr = IntrusivePtr<Vertex<SetNode>>;  ///< ZBDD vertex base.
   using TerminalPtr = IntrusivePtr<Terminal<SetNode>>;  ///< Terminal vertex.
@@ -364,6 +366,20 @@ class Zbdd : private boost::noncopyable {
   /// @returns true if the ZBDD represents a base/unity set.
   bool base() const { return root_ == kBase_; }
 
+  /// Calculates the sum of the probabilities of products
+  /// in a single pass over the ZBDD vertices
+  /// instead of the enumeration of products.
+  ///
+  /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
+  /// @param[in] max_order  The maximum size of products to account for
+  ///                       (i.e., the limit on the product order
+  ///                        or the largest product in the ZBDD).
+  ///
+  /// @returns The sum of the probabilities of products
+  ///          as if they were iterated with the products of modules.
+  double CalculateProbabilitySum(const Pdag::IndexMap<double>& p_vars,
+                                 int max_order) const noexcept;
+
  protected:
   /// The common constructor to initialize member variables.
   ///
@@ -457,6 +473,23 @@ class Zbdd : private boost::noncopyable {
   VertexPtr Apply(Connective type, const VertexPtr& arg_one,
                   const VertexPtr& arg_two, int limit_order) noexcept;
 
+  /// Applies the K/N (ATLEAST) logic to the argument sets
+  /// without the expansion of the gate into AND/OR gates.
+  ///
+  /// @param[in] args  The argument vertices in the order of application.
+  /// @param[in] min_number  The min number of arguments in products.
+  /// @param[in] limit_order  The limit on the order for the computations.
+  ///
+  /// @returns The resulting ZBDD vertex.
+  ///
+  /// @pre 0 < min_number <= args.size()
+  ///
+  /// @post The limit on the set order is guaranteed.
+  ///
+  /// @see Bdd::ApplyAtleast
+  VertexPtr ApplyAtleast(const std::vector<VertexPtr>& args, int min_number,
+                         int limit_order) noexcept;
+
   /// Applies Boolean operation to ZBDD graph non-terminal vertices.
   ///
   /// @tparam Type  The connective enum.
@@ -796,6 +829,23 @@ class Zbdd : private boost::noncopyable {
   /// @returns false if the passed node can never be Unity.
   bool MayBeUnity(const SetNode& node) noexcept;
 
+  /// The sums of the probabilities of products grouped by product size.
+  using SizeSums = std::vector<double>;
+
+  /// Calculates the sums of product probabilities by product size
+  /// for the sub-graph of the ZBDD vertex.
+  ///
+  /// @param[in] vertex  The root vertex of the sub-graph.
+  /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
+  /// @param[in] max_order  The maximum size of products.
+  /// @param[in,out] sums  The memoized results for non-terminal vertices.
+  ///
+  /// @returns The sums of probabilities for product sizes up to the maximum.
+  SizeSums SumProbabilities(
+      const VertexPtr& vertex, const Pdag::IndexMap<double>& p_vars,
+      int max_order,
+      std::unordered_map<const SetNode*, SizeSums>* sums) const noexcept;
+
   /// Counts the number of SetNodes
   /// excluding the nodes in the modules.
   ///
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bdd.h"
+
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "fault_tree_analysis.h"
+#include "initializer.h"
+#include "probability_analysis.h"
+#include "risk_analysis_tests.h"
+
+namespace scram::core::test {
+
+TEST_CASE("BddReorderingTest.SameResults", "[core::bdd_reordering]") {
+  auto input = GENERATE(values<std::vector<std::string>>(
+      {{"tests/input/fta/correct_tree_input_with_probs.xml"},
+       {"tests/input/core/a_or_not_b.xml"},
+       {"tests/input/core/mgl_ccf.xml"},
+       {"input/TwoTrain/two_train.xml"},
+       {"input/ThreeMotor/three_motor.xml"},
+       {"input/Theatre/theatre.xml"},
+       {"input/Baobab/baobab2.xml", "input/Baobab/baobab2-basic-events.xml"}}));
+  bool prime_implicants = GENERATE(false, true);
+  INFO("inputs: " +
+       Catch::StringMaker<std::vector<std::string>>::convert(input));
+  INFO("prime implicants: " << prime_implicants);
+
+  Settings settings;
+  settings.prime_implicants(prime_implicants)
+      .probability_analysis(true)
+      .ccf_analysis(true);
+  std::unique_ptr<mef::Model> model = mef::Initializer(input, settings).model();
+  for (const mef::Gate* top : model->fault_trees().begin()->top_events()) {
+    INFO("target: " << top->id());
+    FaultTreeAnalyzer<Bdd> fta(*top, settings);
+    fta.Analyze();
+    ProbabilityAnalyzer<Bdd> pa(&fta, &model->mission_time());
+    pa.Analyze();
+
+    Settings reordered_settings(settings);
+    reordered_settings.reorder_threshold(1);
+    FaultTreeAnalyzer<Bdd> reordered_fta(*top, reordered_settings);
+    reordered_fta.Analyze();
+    ProbabilityAnalyzer<Bdd> reordered_pa(&reordered_fta,
+                                          &model->mission_time());
+    reordered_pa.Analyze();
+
+    CHECK(RiskAnalysisTest::Convert(reordered_fta.products()) ==
+          RiskAnalysisTest::Convert(fta.products()));
+    CHECK(reordered_pa.p_total() == Approx(pa.p_total()));
+    const Bdd::Reordering& reordering = fta.algorithm()->reordering();
+    CHECK(reordering.count == 0);
+    const Bdd::Reordering& result = reordered_fta.algorithm()->reordering();
+    REQUIRE(result.count > 0);
+    CHECK(result.size_after <= result.size_before);
+    CHECK(result.time >= 0);
+  }
+}
+
+TEST_CASE("BddReorderingTest.ReducesSize", "[core::bdd_reordering]") {
+  std::vector<std::string> input = {"input/Baobab/baobab2.xml",
+                                    "input/Baobab/baobab2-basic-events.xml"};
+  Settings settings;
+  settings.reorder_threshold(1);
+  std::unique_ptr<mef::Model> model = mef::Initializer(input, settings).model();
+  const mef::Gate* top = model->fault_trees().begin()->top_events().front();
+  FaultTreeAnalyzer<Bdd> fta(*top, settings);
+  fta.Analyze();
+  const Bdd::Reordering& result = fta.algorithm()->reordering();
+  REQUIRE(result.count > 0);
+  CHECK(result.size_after < result.size_before);
+}
+
+}  // namespace scram::core::test
@@ -94,6 +94,39 @@ TEST_P(RiskAnalysisTest, Atleast) {
   EXPECT_EQ(mcs, products());
 }
 
+// Voting logic with a complement of K/N gate.
+// [@(3, [A, B, C, D]) OR (E AND NOT @(2, [A, B, F]))]
+TEST_P(RiskAnalysisTest, AtleastComplement) {
+  std::string tree_input = "tests/input/core/atleast_complement.xml";
+  settings.probability_analysis(true);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  if (settings.approximation() == Approximation::kRareEvent) {
+    EXPECT_DOUBLE_EQ(0.55, p_total());
+  } else {
+    EXPECT_DOUBLE_EQ(0.44856, p_total());
+  }
+
+  std::set<std::set<std::string>> vote = {{"A", "B", "C"},
+                                          {"A", "B", "D"},
+                                          {"A", "C", "D"},
+                                          {"B", "C", "D"}};
+  if (settings.prime_implicants()) {
+    std::set<std::set<std::string>> pi = vote;
+    pi.insert({{"not A", "not B", "E"},
+               {"not A", "not F", "E"},
+               {"not B", "not F", "E"},
+               {"C", "D", "E"},
+               {"C", "not F", "E"},
+               {"D", "not F", "E"}});
+    EXPECT_EQ(pi, products());
+  } else {
+    std::set<std::set<std::string>> mcs = vote;
+    mcs.insert({"E"});
+    EXPECT_EQ(mcs, products());
+  }
+}
+
 // Benchmark tests for NOT gate.
 // [A OR NOT A]
 // This produces UNITY top gate.
@@ -196,6 +229,38 @@ TEST_F(RiskAnalysisTest, MonteCarloAorNotB) {
   ASSERT_NO_THROW(analysis->Analyze());
 }
 
+// The simulation kernels of XOR, ATLEAST, and complements
+// against the exact probabilities of the BDD analysis.
+TEST_F(RiskAnalysisTest, MonteCarloKernels) {
+  std::string tree_input =
+      GENERATE(as<std::string>(), "tests/input/core/xor.xml",
+               "tests/input/core/atleast.xml",
+               "tests/input/core/atleast_complement.xml",
+               "tests/input/core/a_and_not_b.xml", "tests/input/core/nand.xml");
+  INFO("input: " + tree_input);
+  settings.probability_analysis(true);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  double p_exact = p_total();
+
+  settings.algorithm(Algorithm::kMonteCarlo).num_trials(1e5).seed(42);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_NEAR(p_exact, p_total(), 0.01);
+}
+
+// The sampling of events with vanishing probabilities.
+TEST_F(RiskAnalysisTest, MonteCarloTinyProbability) {
+  std::string tree_input = "tests/input/core/single_exponential.xml";
+  settings.algorithm(Algorithm::kMonteCarlo)
+      .mission_time(1e-300)
+      .num_trials(1e4)
+      .seed(42);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_EQ(0, p_total());
+}
+
 // Repeated negative gate expansion.
 TEST_P(RiskAnalysisTest, MultipleParentNegativeGate) {
   std::string tree_input = "tests/input/core/multiple_parent_negative_gate.xml";
@@ -525,6 +590,45 @@ TEST_P(RiskAnalysisTest, AlphaFactorCCF) {
   EXPECT_EQ(distr, ProductDistribution());
 }
 
+// CCF events are generated by the analysis
+// if the model is initialized without common cause analysis.
+TEST_P(RiskAnalysisTest, AlphaFactorCCFAfterInitialization) {
+  std::string tree_input = "tests/input/core/alpha_factor_ccf.xml";
+  settings.probability_analysis(true);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  for (const mef::CcfGroup& ccf_group : model->ccf_groups())
+    EXPECT_TRUE(ccf_group.ccf_events().empty());
+  settings.ccf_analysis(true);
+  analysis = std::make_unique<RiskAnalysis>(model.get(), settings);
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_EQ(34, products().size());
+  std::vector<int> distr = {2, 24, 8};
+  EXPECT_EQ(distr, ProductDistribution());
+}
+
+// The levels of a large CCF group are factored into K/N gates
+// instead of member combinations.
+TEST_P(RiskAnalysisTest, FactoredCCF) {
+  std::string tree_input = "tests/input/core/large_ccf.xml";
+  settings.ccf_analysis(true).probability_analysis(true);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  double p_expanded = p_total();
+  EXPECT_EQ(227, products().size());
+  std::vector<int> expanded_distr = {42, 165, 20};
+  EXPECT_EQ(expanded_distr, ProductDistribution());
+
+  settings.ccf_expansion_limit(0);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_NEAR(p_expanded, p_total(), 0.03 * p_expanded);
+  EXPECT_EQ(142, products().size());
+  std::vector<int> factored_distr = {7, 0, 120, 15};
+  EXPECT_EQ(factored_distr, ProductDistribution());
+  settings.importance_analysis(true);
+  CheckReport({tree_input});
+}
+
 TEST_P(RiskAnalysisTest, ZeroProbability) {
   std::string tree_input = "tests/input/core/zero_prob.xml";
   settings.probability_analysis(true).importance_analysis(true);
@@ -47,4 +47,26 @@ TEST_F(RiskAnalysisTest, GasLeak) {
   EXPECT_EQ(2, analysis->event_tree_results().size());
 }
 
+TEST_F(RiskAnalysisTest, GasLeakTargets) {
+  settings.probability_analysis(true).target("Gas-Leak-Detection");
+  ASSERT_NO_THROW(
+      ProcessInputFiles({"input/EventTrees/gas_leak/gas_leak_reactive.xml",
+                         "input/EventTrees/gas_leak/gas_leak.xml"}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_EQ(1, analysis->event_tree_results().size());
+  EXPECT_EQ(8, sequences().size());
+  EXPECT_EQ(8, analysis->results().size());
+}
+
+// Sequence targets are analyzed without reporting the partial event trees.
+TEST_F(RiskAnalysisTest, GasLeakSequenceTarget) {
+  settings.probability_analysis(true).target("S3");
+  ASSERT_NO_THROW(
+      ProcessInputFiles({"input/EventTrees/gas_leak/gas_leak_reactive.xml",
+                         "input/EventTrees/gas_leak/gas_leak.xml"}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_TRUE(analysis->event_tree_results().empty());
+  EXPECT_EQ(2, analysis->results().size());
+}
+
 }  // namespace scram::core::test
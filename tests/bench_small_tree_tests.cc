@@ -17,6 +17,8 @@
 
 #include "risk_analysis_tests.h"
 
+#include <cmath>
+
 namespace scram::core::test {
 
 // Benchmark Tests for Small Tree fault tree from XFTA.
@@ -41,4 +43,67 @@ TEST_P(RiskAnalysisTest, SmallTree) {
   }
 }
 
+// The sensitivity is checked against the analytical derivatives
+// of exponential failure probabilities.
+TEST_P(RiskAnalysisTest, SmallTreeSensitivity) {
+  std::string tree_input = "input/SmallTree/SmallTree.xml";
+  settings.sensitivity_analysis(true);
+  CheckReport({tree_input});
+  double t = 8760;
+  double q_one = std::exp(-2e-5 * t);
+  double q_two = std::exp(-1e-5 * t);
+  double p_product = (1 - q_one) * (1 - q_two);
+  double d_one = (1 - q_two) * t * q_one;  // Product derivative w.r.t. lambda1.
+  double d_two = (1 - q_one) * t * q_two;  // Product derivative w.r.t. lambda2.
+  double scale = 1;  // The derivative of the top w.r.t. the products.
+  if (settings.approximation() != Approximation::kRareEvent)
+    scale = 1 - p_product;
+  EXPECT_NEAR(scale * d_one, sensitivity("lambda1").derivative, 1e-2);
+  EXPECT_NEAR(scale * d_one, sensitivity("lambda3").derivative, 1e-2);
+  EXPECT_NEAR(scale * d_two, sensitivity("lambda4").derivative, 1e-2);
+  // The lambda4 parameter refers to lambda2.
+  EXPECT_NEAR(2 * scale * d_two, sensitivity("lambda2").derivative, 1e-2);
+  EXPECT_NEAR(1e-5 * 2 * scale * d_two / p_total(),
+              sensitivity("lambda2").elasticity, 1e-6);
+}
+
+// The sweep of lambda2 also changes lambda4 referring to it.
+TEST_P(RiskAnalysisTest, SmallTreeParametricSweep) {
+  std::string tree_input = "input/SmallTree/SmallTree.xml";
+  settings.sweep({"lambda2", 1e-5, 3e-5, 3})
+      .sweep({Settings::kMissionTime, 1000, 8760, 2});
+  CheckReport({tree_input});
+  const ParametricAnalysis& study = parametric();
+  ASSERT_EQ(6, study.p_total().size());
+  std::vector<double> values = study.values(3);  // The row-major order.
+  EXPECT_DOUBLE_EQ(2e-5, values[0]);
+  EXPECT_DOUBLE_EQ(8760, values[1]);
+  for (int i = 0; i < study.p_total().size(); ++i) {
+    std::vector<double> point = study.values(i);
+    double p_product = (1 - std::exp(-2e-5 * point[1])) *
+                       (1 - std::exp(-point[0] * point[1]));
+    double p_top = 2 * p_product;
+    if (settings.approximation() != Approximation::kRareEvent)
+      p_top -= p_product * p_product;
+    EXPECT_NEAR(p_top, study.p_total()[i], 1e-8);
+  }
+  // The model is restored after the study.
+  EXPECT_NEAR(0.02678, p_total(), 2e-4);
+  EXPECT_EQ(8760, model->mission_time().value());
+}
+
+// The swept values out of the parameter domain
+// are adjusted to probabilities before the requantification.
+TEST_F(RiskAnalysisTest, SmallTreeParametricSweepOutOfRange) {
+  std::string tree_input = "input/SmallTree/SmallTree.xml";
+  settings.sweep({"lambda2", -1e-3, 1e-5, 2});
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  const ParametricAnalysis& study = parametric();
+  ASSERT_EQ(2, study.p_total().size());
+  EXPECT_EQ(0, study.p_total()[0]);
+  CHECK(study.p_total()[1] > 0);
+  CHECK_FALSE(study.warnings().empty());
+}
+
 }  // namespace scram::core::test
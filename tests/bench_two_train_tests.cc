@@ -39,6 +39,17 @@ TEST_P(RiskAnalysisTest, TwoTrain) {
   EXPECT_EQ(mcs, products());
 }
 
+// Only the data reachable from the target gate are loaded and analyzed.
+TEST_P(RiskAnalysisTest, TwoTrainTarget) {
+  settings.probability_analysis(true).target("TrainOne");
+  ASSERT_NO_THROW(ProcessInputFiles({"input/TwoTrain/two_train.xml"}));
+  EXPECT_EQ(1, model->gates().size());
+  EXPECT_EQ(2, model->basic_events().size());
+  ASSERT_NO_THROW(analysis->Analyze());
+  std::set<std::set<std::string>> mcs = {{"ValveOne"}, {"PumpOne"}};
+  EXPECT_EQ(mcs, products());
+}
+
 TEST_P(RiskAnalysisTest, TwoTrainUnityEventTree) {
   std::string dir = "input/TwoTrain/";
   settings.probability_analysis(true);
@@ -91,4 +102,17 @@ TEST_P(RiskAnalysisTest, TwoTrainNonDeclarativeSubstitutions) {
   EXPECT_EQ(mcs, products());
 }
 
+TEST_F(RiskAnalysisTest, TwoTrainMonteCarlo) {
+  std::string tree_input = "input/TwoTrain/two_train.xml";
+  settings.algorithm(Algorithm::kMonteCarlo)
+      .importance_analysis(true)
+      .num_trials(1e5)
+      .seed(42);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_NEAR(0.7225, p_total(), 0.01);
+  EXPECT_NEAR(0.255, importance("ValveOne").mif, 0.01);
+  EXPECT_NEAR(0.425, importance("PumpOne").mif, 0.01);
+}
+
 }  // namespace scram::core::test
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2014-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "binary_report.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "env.h"
+#include "initializer.h"
+#include "reporter.h"
+#include "settings.h"
+#include "xml.h"
+
+namespace fs = boost::filesystem;
+
+namespace scram::binary::test {
+
+namespace {
+
+/// @returns A unique path for a temporary file.
+fs::path TempFile() {
+  return fs::temp_directory_path() /
+         ("scram_binary_test-" + fs::unique_path().string());
+}
+
+/// @returns The analysis results section of the XML report file.
+std::string ReadResults(const fs::path& xml_file) {
+  std::ifstream stream(xml_file.string());
+  std::string xml_report((std::istreambuf_iterator<char>(stream)),
+                         std::istreambuf_iterator<char>());
+  std::string::size_type first = xml_report.find("<results>");
+  std::string::size_type last = xml_report.rfind("</results>");
+  if (first == std::string::npos || last == std::string::npos)
+    return "";
+  return xml_report.substr(first, last - first);
+}
+
+}  // namespace
+
+TEST_CASE("BinaryReportTest.RoundTrip", "[binary_report]") {
+  static xml::Validator validator(env::report_schema());
+  auto input = GENERATE(values<std::vector<std::string>>(
+      {{"tests/input/fta/correct_tree_input_with_probs.xml"},
+       {"tests/input/core/a_or_not_b.xml"},
+       {"tests/input/core/mgl_ccf.xml"},
+       {"input/TwoTrain/two_train.xml"},
+       {"input/Baobab/baobab1.xml", "input/Baobab/baobab1-basic-events.xml"}}));
+  INFO("inputs: " +
+       Catch::StringMaker<std::vector<std::string>>::convert(input));
+
+  core::Settings settings;
+  settings.importance_analysis(true).uncertainty_analysis(true).ccf_analysis(
+      true);
+  std::unique_ptr<mef::Model> model = mef::Initializer(input, settings).model();
+  core::RiskAnalysis analysis(model.get(), settings);
+  analysis.Analyze();
+
+  fs::path binary_file = TempFile();
+  INFO("binary report: " + binary_file.string());
+  REQUIRE_NOTHROW(Write(analysis, binary_file.string()));
+  {
+    Report report(binary_file.string());
+    REQUIRE(report.num_results() == analysis.results().size());
+    for (int i = 0; i < report.num_results(); ++i) {
+      const core::RiskAnalysis::Result& result = analysis.results()[i];
+      const core::ProductContainer& products =
+          result.fault_tree_analysis->products();
+      auto offsets = report.column<std::uint64_t>(Column::kProductOffsets, i);
+      REQUIRE(offsets.size() == products.size() + 1);
+      CHECK(report.column<std::int32_t>(Column::kProductLiterals, i).size() ==
+            offsets.back());
+      CHECK(report.column<double>(Column::kProbabilities)[i] ==
+            Approx(result.probability_analysis->p_total()));
+      CHECK(report.column<double>(Column::kMif, i).size() ==
+            result.importance_analysis->importance().size());
+      CHECK(report.column<double>(Column::kQuantiles, i).size() ==
+            result.uncertainty_analysis->quantiles().size());
+      CHECK(report.strings(Column::kTargets)[i] ==
+            std::get<const mef::Gate*>(result.id.target)->id());
+    }
+    CHECK(report.column<double>(Column::kUncertaintyMeasures, 0).size() == 5);
+    CHECK_THROWS_AS(report.column<double>(Column::kProductOffsets, 0),
+                    IOError);
+    CHECK(report.column<double>(Column::kMif, report.num_results()).empty());
+
+    fs::path xml_file = TempFile();
+    fs::path reporter_file = TempFile();
+    INFO("XML report: " + xml_file.string());
+    REQUIRE_NOTHROW(ConvertToXml(report, xml_file.string()));
+    CHECK_NOTHROW(xml::Document(xml_file.string(), &validator));
+    REQUIRE_NOTHROW(Reporter().Report(analysis, reporter_file.string()));
+    std::string results = ReadResults(xml_file);
+    CHECK_FALSE(results.empty());
+    CHECK(results == ReadResults(reporter_file));
+    fs::remove(xml_file);
+    fs::remove(reporter_file);
+  }
+  fs::remove(binary_file);
+}
+
+TEST_CASE("BinaryReportTest.InvalidFile", "[binary_report]") {
+  CHECK_THROWS_AS(Report("nonexistent_file.srb"), IOError);
+  fs::path temp_file = TempFile();
+  INFO("temp file: " + temp_file.string());
+  std::ofstream(temp_file.string()) << "<?xml version=\"1.0\"?><report/>";
+  CHECK_THROWS_AS(Report(temp_file.string()), IOError);
+  fs::remove(temp_file);
+}
+
+TEST_CASE("BinaryReportTest.CorruptedColumns", "[binary_report]") {
+  core::Settings settings;
+  std::unique_ptr<mef::Model> model =
+      mef::Initializer({"tests/input/fta/correct_tree_input_with_probs.xml"},
+                       settings)
+          .model();
+  core::RiskAnalysis analysis(model.get(), settings);
+  analysis.Analyze();
+  fs::path binary_file = TempFile();
+  INFO("binary report: " + binary_file.string());
+  REQUIRE_NOTHROW(Write(analysis, binary_file.string()));
+  CHECK_NOTHROW(Report(binary_file.string()));
+
+  std::string data;
+  {
+    std::ifstream stream(binary_file.string(), std::ios::binary);
+    std::ostringstream buffer;
+    buffer << stream.rdbuf();
+    data = buffer.str();
+  }
+  std::uint64_t directory = 0;
+  std::uint64_t num_columns = 0;
+  // The directory offset and size follow the signature, version, and results.
+  std::memcpy(&directory, data.data() + 16, sizeof(directory));
+  std::memcpy(&num_columns, data.data() + 24, sizeof(num_columns));
+  REQUIRE(directory + num_columns * sizeof(ColumnEntry) <= data.size());
+  auto corrupt = [&](Column column, auto value) {
+    std::string corrupted = data;
+    for (std::uint64_t i = 0; i < num_columns; ++i) {
+      ColumnEntry entry;
+      std::memcpy(&entry, data.data() + directory + i * sizeof(entry),
+                  sizeof(entry));
+      if (entry.column != column || !entry.size)
+        continue;
+      std::memcpy(&corrupted[entry.offset], &value, sizeof(value));
+      std::ofstream(binary_file.string(), std::ios::binary) << corrupted;
+      return true;
+    }
+    return false;
+  };
+  REQUIRE(corrupt(Column::kProductLiterals, 1000));
+  CHECK_THROWS_AS(Report(binary_file.string()), IOError);
+  REQUIRE(corrupt(Column::kProductOffsets, std::uint64_t(1000)));
+  CHECK_THROWS_AS(Report(binary_file.string()), IOError);
+  REQUIRE(corrupt(Column::kEventCcfGroups, 5));
+  CHECK_THROWS_AS(Report(binary_file.string()), IOError);
+
+  // The string column size at the limit of the integer range.
+  std::string corrupted = data;
+  for (std::uint64_t i = 0; i < num_columns; ++i) {
+    char* entry_data = &corrupted[directory + i * sizeof(ColumnEntry)];
+    ColumnEntry entry;
+    std::memcpy(&entry, entry_data, sizeof(entry));
+    if (entry.column != Column::kEventNames)
+      continue;
+    entry.size = std::numeric_limits<std::uint64_t>::max();
+    std::memcpy(entry_data, &entry, sizeof(entry));
+  }
+  std::ofstream(binary_file.string(), std::ios::binary) << corrupted;
+  CHECK_THROWS_AS(Report(binary_file.string()), IOError);
+  fs::remove(binary_file);
+}
+
+}  // namespace scram::binary::test
@@ -17,6 +17,10 @@
 
 #include "ccf_group.h"
 
+#include <memory>
+#include <variant>
+#include <vector>
+
 #include <catch2/catch.hpp>
 
 #include "error.h"
@@ -46,4 +50,76 @@ TEST_CASE("CcfGroupTest.AddMemberAfterDistribution", "[mef::ccf_group]") {
   CHECK_THROWS_AS(ccf_group.AddMember(&member_three), LogicError);
 }
 
+TEST_CASE("CcfGroupTest.LazyEvents", "[mef::ccf_group]") {
+  AlphaFactorModel ccf_group("general");
+  BasicEvent member_one("one");
+  BasicEvent member_two("two");
+  BasicEvent member_three("three");
+  for (BasicEvent* member : {&member_one, &member_two, &member_three})
+    REQUIRE_NOTHROW(ccf_group.AddMember(member));
+  REQUIRE_NOTHROW(ccf_group.AddDistribution(&ConstantExpression::kOne));
+  for (int level = 1; level <= 3; ++level)
+    REQUIRE_NOTHROW(ccf_group.AddFactor(&ConstantExpression::kOne, level));
+  REQUIRE_NOTHROW(ccf_group.Validate());
+
+  ccf_group.ApplyModel();
+  CHECK(member_two.HasCcf());
+  CHECK(ccf_group.ccf_events().empty());
+
+  ccf_group.GenerateEvents(100);
+  CHECK(ccf_group.ccf_events().size() == 7);
+  const Gate& gate = member_two.ccf_gate();
+  CHECK(gate.formula().connective() == kOr);
+  CHECK(gate.formula().args().size() == 4);
+  CHECK(&member_one.ccf_gate().formula() != &gate.formula());
+  ccf_group.GenerateEvents(0);
+  CHECK(ccf_group.ccf_events().size() == 7);  // No regeneration.
+}
+
+TEST_CASE("CcfGroupTest.FactoredLevels", "[mef::ccf_group]") {
+  AlphaFactorModel ccf_group("general");
+  std::vector<std::unique_ptr<BasicEvent>> members;
+  for (const char* name : {"one", "two", "three", "four"}) {
+    members.push_back(std::make_unique<BasicEvent>(name));
+    REQUIRE_NOTHROW(ccf_group.AddMember(members.back().get()));
+  }
+  REQUIRE_NOTHROW(ccf_group.AddDistribution(&ConstantExpression::kOne));
+  for (int level = 1; level <= 4; ++level)
+    REQUIRE_NOTHROW(ccf_group.AddFactor(&ConstantExpression::kOne, level));
+  REQUIRE_NOTHROW(ccf_group.Validate());
+  ccf_group.ApplyModel();
+
+  // Only the 6 pairs are more than the members.
+  ccf_group.GenerateEvents(0);
+  CHECK(ccf_group.ccf_events().size() == 4 + 4 + 4 + 1);
+  int num_shares = 0;
+  for (const std::unique_ptr<CcfEvent>& event : ccf_group.ccf_events()) {
+    if (event->level() == event->members().size())
+      continue;
+    ++num_shares;
+    CHECK(event->level() == 2);
+    CHECK(event->members().size() == 1);
+  }
+  CHECK(num_shares == 4);
+
+  const Formula& formula = members.front()->ccf_gate().formula();
+  CHECK(formula.connective() == kOr);
+  CHECK(formula.args().size() == 1 + 1 + 3 + 1);
+  int num_factored = 0;
+  for (const Formula::Arg& arg : formula.args()) {
+    if (auto* const* gate = std::get_if<Gate*>(&arg.event)) {
+      ++num_factored;
+      const Formula& share = (*gate)->formula();
+      CHECK(share.connective() == kAnd);
+      REQUIRE(share.args().size() == 2);
+      const auto* level_gate = std::get_if<Gate*>(&share.args().back().event);
+      REQUIRE(level_gate);
+      CHECK((*level_gate)->formula().connective() == kAtleast);
+      CHECK((*level_gate)->formula().min_number() == 2);
+      CHECK((*level_gate)->formula().args().size() == 4);
+    }
+  }
+  CHECK(num_factored == 1);
+}
+
 }  // namespace scram::mef::test
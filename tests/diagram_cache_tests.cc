@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "diagram_cache.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "fault_tree_analysis.h"
+#include "initializer.h"
+#include "risk_analysis.h"
+#include "risk_analysis_tests.h"
+
+namespace fs = boost::filesystem;
+
+namespace scram::core::test {
+
+namespace {
+
+/// @returns A unique path for a temporary directory.
+fs::path TempDirectory() {
+  return fs::temp_directory_path() /
+         ("scram_diagram_test-" + fs::unique_path().string());
+}
+
+/// @returns The number of files in the directory.
+int CountFiles(const fs::path& directory) {
+  return std::distance(fs::directory_iterator(directory),
+                       fs::directory_iterator());
+}
+
+}  // namespace
+
+TEST_CASE("DiagramCacheTest.RoundTrip", "[core::diagram_cache]") {
+  auto input = GENERATE(values<std::vector<std::string>>(
+      {{"tests/input/fta/correct_tree_input_with_probs.xml"},
+       {"tests/input/core/a_or_not_b.xml"},
+       {"tests/input/core/mgl_ccf.xml"},
+       {"input/TwoTrain/two_train.xml"},
+       {"input/Theatre/theatre.xml"},
+       {"input/Baobab/baobab2.xml", "input/Baobab/baobab2-basic-events.xml"}}));
+  auto [algorithm, prime_implicants] =
+      GENERATE(std::pair(Algorithm::kBdd, false),
+               std::pair(Algorithm::kZbdd, false),
+               std::pair(Algorithm::kBdd, true));
+  INFO("inputs: " +
+       Catch::StringMaker<std::vector<std::string>>::convert(input));
+  INFO("algorithm: " << kAlgorithmToString[static_cast<int>(algorithm)]);
+  INFO("prime implicants: " << prime_implicants);
+
+  Settings settings;
+  settings.algorithm(algorithm)
+      .prime_implicants(prime_implicants)
+      .probability_analysis(true)
+      .ccf_analysis(true);
+  std::unique_ptr<mef::Model> model = mef::Initializer(input, settings).model();
+  RiskAnalysis analysis(model.get(), settings);
+  analysis.Analyze();
+
+  fs::path directory = TempDirectory();
+  settings.diagram_cache(directory.string());
+  RiskAnalysis stored_analysis(model.get(), settings);
+  stored_analysis.Analyze();
+  CHECK(CountFiles(directory) > 0);
+  RiskAnalysis loaded_analysis(model.get(), settings);
+  loaded_analysis.Analyze();
+  fs::remove_all(directory);
+
+  REQUIRE(stored_analysis.results().size() == analysis.results().size());
+  REQUIRE(loaded_analysis.results().size() == analysis.results().size());
+  for (int i = 0; i < analysis.results().size(); ++i) {
+    const auto& result = analysis.results()[i];
+    auto products =
+        RiskAnalysisTest::Convert(result.fault_tree_analysis->products());
+    for (const RiskAnalysis& cached : {std::cref(stored_analysis),
+                                       std::cref(loaded_analysis)}) {
+      const auto& cached_result = cached.results()[i];
+      CHECK(RiskAnalysisTest::Convert(
+                cached_result.fault_tree_analysis->products()) == products);
+      CHECK(cached_result.probability_analysis->p_total() ==
+            Approx(result.probability_analysis->p_total()));
+    }
+  }
+}
+
+TEST_CASE("DiagramCacheTest.LoadSnapshot", "[core::diagram_cache]") {
+  std::vector<std::string> input = {"input/TwoTrain/two_train.xml"};
+  fs::path directory = TempDirectory();
+  Settings settings;
+  settings.diagram_cache(directory.string());
+  std::unique_ptr<mef::Model> model = mef::Initializer(input, settings).model();
+  const mef::Gate& top =
+      *model->fault_trees().begin()->top_events().front();
+
+  SECTION("BDD") {
+    FaultTreeAnalyzer<Bdd> fta(top, settings);
+    fta.Analyze();
+    DiagramCache cache(directory.string(), *fta.graph(), settings);
+    std::unique_ptr<Bdd> bdd = cache.Load<Bdd>();
+    REQUIRE(bdd);
+    CHECK(bdd->coherent() == fta.algorithm()->coherent());
+    CHECK(bdd->modules().size() == fta.algorithm()->modules().size());
+    CHECK(bdd->index_to_order() == fta.algorithm()->index_to_order());
+    CHECK(bdd->products().size() == fta.algorithm()->products().size());
+    CHECK_FALSE(cache.Load<Zbdd>());
+
+    Settings limited(settings);
+    limited.limit_order(1);
+    DiagramCache stale_cache(directory.string(), *fta.graph(), limited);
+    CHECK(stale_cache.key() != cache.key());
+    CHECK_FALSE(stale_cache.Load<Bdd>());
+
+    fs::directory_iterator it(directory);
+    fs::resize_file(it->path(), fs::file_size(it->path()) / 2);
+    CHECK_FALSE(cache.Load<Bdd>());
+  }
+
+  SECTION("ZBDD") {
+    settings.algorithm(Algorithm::kZbdd);
+    FaultTreeAnalyzer<Zbdd> fta(top, settings);
+    fta.Analyze();
+    DiagramCache cache(directory.string(), *fta.graph(), settings);
+    std::unique_ptr<Zbdd> zbdd = cache.Load<Zbdd>();
+    REQUIRE(zbdd);
+    CHECK(zbdd->size() == fta.algorithm()->size());
+    CHECK_FALSE(cache.Load<Bdd>());
+  }
+  fs::remove_all(directory);
+}
+
+}  // namespace scram::core::test
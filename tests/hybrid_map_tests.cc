@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ext/hybrid_map.h"
+
+#include <cstdlib>
+
+#include <string>
+#include <type_traits>
+
+#include <catch2/catch.hpp>
+
+namespace {
+/// The absolute value projection of signed keys.
+struct AbsKey {
+  int operator()(int key) const { return std::abs(key); }
+};
+}  // namespace
+
+// Explicit instantiations with some common types.
+template class ext::hybrid_map<int, int>;
+template class ext::hybrid_map<int, std::string>;
+template class ext::hybrid_map<std::string, int>;
+template class ext::hybrid_map<int, int, 4, AbsKey>;
+
+namespace scram::test {
+
+using IntMap = ext::hybrid_map<int, int, 4>;
+
+static_assert(std::is_move_constructible_v<IntMap>);
+static_assert(std::is_copy_constructible_v<IntMap>);
+
+TEST_CASE("hybrid map index", "[hybrid_map]") {
+  IntMap m;
+  for (int i = 1; i <= 4; ++i)
+    CHECK(m.insert({i, -i}).second);
+  CHECK_FALSE(m.indexed());
+  CHECK_FALSE(m.insert({1, 0}).second);
+
+  CHECK(m.emplace_unique(5, -5)->first == 5);
+  CHECK(m.indexed());
+  CHECK(m.size() == 5);
+  for (int i = 1; i <= 5; ++i) {
+    REQUIRE(m.count(i));
+    CHECK(m.find(i)->second == -i);
+  }
+  CHECK_FALSE(m.count(6));
+  CHECK(m.find(0) == m.end());
+
+  SECTION("erase moves the last entry") {
+    CHECK(m.erase(2) == 1);
+    CHECK(m.erase(2) == 0);
+    CHECK(m.data()[1] == std::pair(5, -5));
+    CHECK(m.find(5) - m.begin() == 1);
+    CHECK(m.indexed());
+    CHECK(m.erase(m.find(1))->first == 4);
+    CHECK(m.find(4) - m.begin() == 0);
+    CHECK(m.erase(3) == 1);
+    CHECK(m.indexed());
+    CHECK(m.erase(4) == 1);
+    CHECK_FALSE(m.indexed());
+    CHECK(m.size() == 1);
+    CHECK(m.count(5));
+  }
+
+  SECTION("copy keeps the index") {
+    IntMap copy(m);
+    CHECK(copy.indexed());
+    CHECK(copy.find(3)->second == -3);
+  }
+
+  SECTION("clear drops the index") {
+    m.clear();
+    CHECK(m.empty());
+    CHECK_FALSE(m.indexed());
+    CHECK_FALSE(m.count(1));
+  }
+}
+
+TEST_CASE("hybrid map projection", "[hybrid_map]") {
+  ext::hybrid_map<int, int, 4, AbsKey> m;
+  for (int i = 1; i <= 8; ++i)
+    m.emplace_unique(i % 2 ? i : -i, i);
+  REQUIRE(m.indexed());
+  CHECK(m.count(-2));
+  CHECK_FALSE(m.count(2));
+  CHECK(m.count(3));
+  CHECK_FALSE(m.count(-3));
+
+  for (auto& entry : m)
+    entry.first = -entry.first;
+  CHECK(m.count(2));
+  CHECK_FALSE(m.count(-2));
+  CHECK(m.find(-3)->second == 3);
+  CHECK(m.erase(8) == 1);
+  CHECK_FALSE(m.count(-8));
+  CHECK(m.find(-7)->second == 7);
+}
+
+}  // namespace scram::test
@@ -75,6 +75,19 @@ TEST_CASE("InitializerTest.FailSchemaValidation", "[mef::initializer]") {
                   xml::ValidityError);
 }
 
+// Concurrently parsed files report the first error in the input order.
+TEST_CASE("InitializerTest.MultipleFileErrorOrder", "[mef::initializer]") {
+  std::string input_correct = "tests/input/fta/correct_tree_input.xml";
+  std::string malformed = "tests/input/xml_formatting_error.xml";
+  std::string invalid = "tests/input/schema_fail.xml";
+  CHECK_THROWS_AS(
+      Initializer({input_correct, malformed, invalid}, core::Settings()),
+      xml::ParseError);
+  CHECK_THROWS_AS(
+      Initializer({input_correct, invalid, malformed}, core::Settings()),
+      xml::ValidityError);
+}
+
 // Unsupported operations.
 TEST_CASE("InitializerTest.UnsupportedFeature", "[mef::initializer]") {
   std::string dir = "tests/input/";
@@ -447,4 +460,122 @@ TEST_CASE("InitializerTest.NonDeclarativeSubstitutionsWithAppproximations",
   CHECK_THROWS_AS(Initializer({input}, core::Settings()), ValidityError);
 }
 
+// The streaming reader initializes the same model as the DOM documents.
+TEST_CASE("InitializerTest.StreamInput", "[mef::initializer]") {
+  auto input = GENERATE(values<std::vector<std::string>>(
+      {{"tests/input/fta/labels_and_attributes.xml"},
+       {"tests/input/fta/component_definition.xml"},
+       {"tests/input/fta/mixed_definitions.xml"},
+       {"tests/input/fta/model_data_mixed_definitions.xml"},
+       {"tests/input/fta/unordered_structure.xml"},
+       {"tests/input/fta/correct_expressions.xml"},
+       {"tests/input/eta/link_instruction.xml"},
+       {"tests/input/eta/collect_formula.xml"},
+       {"tests/input/model/extern_function.xml"},
+       {"tests/input/model/valid_alignment.xml"},
+       {"tests/input/model/substitution.xml"},
+       {"tests/input/xinclude.xml"},
+       {"input/Baobab/baobab2.xml", "input/Baobab/baobab2-basic-events.xml"}}));
+  INFO("inputs: " +
+       Catch::StringMaker<std::vector<std::string>>::convert(input));
+
+  core::Settings settings;
+  settings.approximation(core::Approximation::kRareEvent);
+  std::unique_ptr<Model> model =
+      Initializer(input, settings, true, nullptr, false).model();
+  std::unique_ptr<Model> streamed_model =
+      Initializer(input, settings, true, nullptr, true).model();
+  CHECK(streamed_model->name() == model->name());
+  CHECK(streamed_model->label() == model->label());
+  CHECK(streamed_model->attributes().size() == model->attributes().size());
+  CHECK(streamed_model->fault_trees().size() == model->fault_trees().size());
+  CHECK(streamed_model->gates().size() == model->gates().size());
+  CHECK(streamed_model->basic_events().size() ==
+        model->basic_events().size());
+  CHECK(streamed_model->house_events().size() ==
+        model->house_events().size());
+  CHECK(streamed_model->parameters().size() == model->parameters().size());
+  CHECK(streamed_model->ccf_groups().size() == model->ccf_groups().size());
+  CHECK(streamed_model->event_trees().size() == model->event_trees().size());
+  CHECK(streamed_model->sequences().size() == model->sequences().size());
+  CHECK(streamed_model->alignments().size() == model->alignments().size());
+  CHECK(streamed_model->substitutions().size() ==
+        model->substitutions().size());
+  for (const FaultTree& fault_tree : model->fault_trees()) {
+    const FaultTree& streamed_fault_tree =
+        streamed_model->Get<FaultTree>(fault_tree.name());
+    CHECK(streamed_fault_tree.label() == fault_tree.label());
+    CHECK(streamed_fault_tree.components().size() ==
+          fault_tree.components().size());
+    CHECK(streamed_fault_tree.top_events().size() ==
+          fault_tree.top_events().size());
+  }
+}
+
+TEST_CASE("InitializerTest.UndefinedTarget", "[mef::initializer]") {
+  core::Settings settings;
+  settings.target("TopEvent");
+  CHECK_NOTHROW(Initializer({"input/TwoTrain/two_train.xml"}, settings));
+  settings.target("Undefined");
+  CHECK_THROWS_AS(Initializer({"input/TwoTrain/two_train.xml"}, settings),
+                  SettingsError);
+}
+
+// The streaming reader defines only the closure of the analysis targets.
+TEST_CASE("InitializerTest.StreamInputTargets", "[mef::initializer]") {
+  // The event tree target requires all the fault tree data.
+  auto [input, target, pruned] =
+      GENERATE(table<std::vector<std::string>, std::string, bool>(
+          {{{"input/Baobab/baobab1.xml",
+             "input/Baobab/baobab1-basic-events.xml"},
+            "g3", true},
+           {{"input/TwoTrain/two_train.xml"}, "TrainOne", true},
+           {{"input/EventTrees/gas_leak/gas_leak_reactive.xml",
+             "input/EventTrees/gas_leak/gas_leak.xml"},
+            "Gas-Leak-Detection", false}}));
+  INFO("inputs: " +
+       Catch::StringMaker<std::vector<std::string>>::convert(input));
+  INFO("target: " + target);
+
+  core::Settings settings;
+  std::unique_ptr<Model> full_model = Initializer(input, settings).model();
+  settings.target(target);
+  std::unique_ptr<Model> model =
+      Initializer(input, settings, false, nullptr, false).model();
+  std::unique_ptr<Model> streamed_model =
+      Initializer(input, settings, false, nullptr, true).model();
+  CHECK((model->gates().size() < full_model->gates().size()) == pruned);
+  CHECK(streamed_model->gates().size() == model->gates().size());
+  CHECK(streamed_model->basic_events().size() ==
+        model->basic_events().size());
+  CHECK(streamed_model->house_events().size() ==
+        model->house_events().size());
+  CHECK(streamed_model->parameters().size() == model->parameters().size());
+  CHECK(streamed_model->ccf_groups().size() == model->ccf_groups().size());
+  CHECK(streamed_model->event_trees().size() == model->event_trees().size());
+  for (const Gate& gate : model->gates())
+    CHECK(streamed_model->table<Gate>().count(gate.id()));
+}
+
+TEST_CASE("InitializerTest.StreamInputErrors", "[mef::initializer]") {
+  auto stream = [](const std::string& input, bool allow_extern = false) {
+    Initializer({input}, core::Settings(), allow_extern, nullptr, true);
+  };
+  // The streaming reports the first error in the document order.
+  CHECK_THROWS_AS(stream("tests/input/xml_formatting_error.xml"), xml::Error);
+  CHECK_THROWS_AS(stream("tests/input/schema_fail.xml"), xml::ValidityError);
+  CHECK_THROWS_AS(stream("tests/input/xinclude_cycle.xml"), xml::XIncludeError);
+  CHECK_THROWS_AS(stream("tests/input/fta/doubly_defined_gate.xml"),
+                  ValidityError);
+  CHECK_THROWS_AS(stream("tests/input/fta/doubly_defined_component.xml"),
+                  ValidityError);
+  CHECK_THROWS_AS(stream("tests/input/fta/undefined_gate.xml"),
+                  ValidityError);
+  CHECK_THROWS_AS(stream("tests/input/fta/cyclic_expression.xml"),
+                  ValidityError);
+  CHECK_THROWS_AS(stream("tests/input/model/extern_library.xml"),
+                  IllegalOperation);
+  CHECK_NOTHROW(stream("tests/input/model/extern_library.xml", true));
+}
+
 }  // namespace scram::mef::test
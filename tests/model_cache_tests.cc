@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2014-2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "model_cache.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include <fstream>
+#include <iterator>
+
+#include <boost/filesystem.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "initializer.h"
+#include "risk_analysis.h"
+#include "settings.h"
+
+namespace fs = boost::filesystem;
+
+namespace scram::mef::test {
+
+TEST_CASE("ModelCacheTest.RoundTrip", "[mef::model_cache]") {
+  auto input = GENERATE(values<std::vector<std::string>>(
+      {{"tests/input/fta/correct_tree_input_with_probs.xml"},
+       {"tests/input/fta/correct_expressions.xml"},
+       {"tests/input/fta/labels_and_attributes.xml"},
+       {"tests/input/core/beta_factor_ccf.xml"},
+       {"tests/input/core/mgl_ccf.xml"},
+       {"tests/input/core/alpha_factor_ccf.xml"},
+       {"tests/input/core/phi_factor_ccf.xml"},
+       {"input/TwoTrain/two_train.xml"},
+       {"input/Theatre/theatre.xml"},
+       {"input/Baobab/baobab2.xml", "input/Baobab/baobab2-basic-events.xml"}}));
+  INFO("inputs: " +
+       Catch::StringMaker<std::vector<std::string>>::convert(input));
+
+  core::Settings settings;
+  settings.probability_analysis(true);
+  std::unique_ptr<Model> model = Initializer(input, settings).model();
+  std::uint64_t key = ComputeCacheKey(input, settings);
+  fs::path temp_file =
+      fs::temp_directory_path() / ("scram_test-" + fs::unique_path().string());
+  INFO("temp file: " + temp_file.string());
+  REQUIRE(WriteCache(*model, temp_file.string(), key));
+
+  CHECK_FALSE(LoadCache(temp_file.string(), key + 1, settings));
+  std::unique_ptr<Model> cached_model =
+      LoadCache(temp_file.string(), key, settings);
+  fs::remove(temp_file);
+  REQUIRE(cached_model);
+  CHECK(cached_model->name() == model->name());
+  CHECK(cached_model->gates().size() == model->gates().size());
+  CHECK(cached_model->basic_events().size() == model->basic_events().size());
+  CHECK(cached_model->parameters().size() == model->parameters().size());
+  CHECK(cached_model->ccf_groups().size() == model->ccf_groups().size());
+
+  core::RiskAnalysis analysis(model.get(), settings);
+  core::RiskAnalysis cached_analysis(cached_model.get(), settings);
+  analysis.Analyze();
+  cached_analysis.Analyze();
+  REQUIRE(cached_analysis.results().size() == analysis.results().size());
+  for (int i = 0; i < analysis.results().size(); ++i) {
+    const auto& result = analysis.results()[i];
+    const auto& cached_result = cached_analysis.results()[i];
+    CHECK(cached_result.fault_tree_analysis->products().size() ==
+          result.fault_tree_analysis->products().size());
+    CHECK(cached_result.probability_analysis->p_total() ==
+          Approx(result.probability_analysis->p_total()));
+  }
+}
+
+TEST_CASE("ModelCacheTest.KeyDependsOnSettings", "[mef::model_cache]") {
+  std::vector<std::string> input = {"input/TwoTrain/two_train.xml"};
+  core::Settings settings;
+  std::uint64_t key = ComputeCacheKey(input, settings);
+  CHECK(ComputeCacheKey(input, settings) == key);
+  settings.probability_analysis(true);
+  CHECK(ComputeCacheKey(input, settings) != key);
+  CHECK_THROWS_AS(ComputeCacheKey({"nonexistent_file.xml"}, settings),
+                  IOError);
+}
+
+TEST_CASE("ModelCacheTest.CorruptedBoolean", "[mef::model_cache]") {
+  std::vector<std::string> input = {"tests/input/fta/correct_expressions.xml"};
+  core::Settings settings;
+  std::unique_ptr<Model> model = Initializer(input, settings).model();
+  fs::path temp_file =
+      fs::temp_directory_path() / ("scram_test-" + fs::unique_path().string());
+  INFO("temp file: " + temp_file.string());
+  REQUIRE(WriteCache(*model, temp_file.string(), 0));
+  std::string data;
+  {
+    std::ifstream in(temp_file.string(), std::ios::binary);
+    data.assign(std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>());
+  }
+  // The house event record continues with its base path, role, label,
+  // the number of attributes, and the usage and state flags.
+  std::string name = "BooleanConstant";
+  std::size_t pos = data.find(name);
+  REQUIRE(pos != std::string::npos);
+  pos += name.size();
+  auto skip_string = [&data, &pos] {
+    std::uint32_t size = 0;
+    REQUIRE(pos + sizeof(size) <= data.size());
+    std::memcpy(&size, data.data() + pos, sizeof(size));
+    pos += sizeof(size) + size;
+  };
+  skip_string();
+  pos += 1;
+  skip_string();
+  pos += sizeof(std::uint32_t);
+  REQUIRE(pos + 1 < data.size());
+  REQUIRE(data[pos + 1] == 1);  // The constant state of the house event.
+  data[pos + 1] = 2;
+  std::ofstream(temp_file.string(), std::ios::binary) << data;
+  CHECK_FALSE(LoadCache(temp_file.string(), 0, settings));
+  fs::remove(temp_file);
+}
+
+TEST_CASE("ModelCacheTest.UnsupportedModel", "[mef::model_cache]") {
+  std::vector<std::string> input = {"input/EventTrees/bcd.xml"};
+  std::unique_ptr<Model> model =
+      Initializer(input, core::Settings{}).model();
+  fs::path temp_file =
+      fs::temp_directory_path() / ("scram_test-" + fs::unique_path().string());
+  CHECK_FALSE(WriteCache(*model, temp_file.string(), 0));
+  CHECK_FALSE(fs::exists(temp_file));
+  CHECK_FALSE(LoadCache(temp_file.string(), 0, core::Settings{}));
+}
+
+}  // namespace scram::mef::test
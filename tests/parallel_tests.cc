@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "parallel.h"
+
+#include <atomic>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace scram::core::test {
+
+TEST_CASE("ParallelTest.ForAllTasks", "[parallel]") {
+  CHECK_FALSE(IsParallelWorker());
+  std::vector<int> counts(100);
+  ParallelFor(counts.size(), [&counts](int i) { ++counts[i]; });
+  CHECK(counts == std::vector<int>(100, 1));
+  CHECK_FALSE(IsParallelWorker());
+  ParallelFor(0, [](int) { FAIL("No tasks to run."); });
+}
+
+TEST_CASE("ParallelTest.NestedTasksRunSerially", "[parallel]") {
+  std::atomic<int> num_outer_workers = 0;
+  std::atomic<int> num_inner_workers = 0;
+  std::atomic<int> num_outer_threads = 0;
+  std::vector<int> counts(16 * 16);
+  CHECK(NumParallelThreads(1) == 1);
+  ParallelFor(16, [&](int i) {
+    num_outer_workers += IsParallelWorker();
+    num_outer_threads += NumParallelThreads(16) == 1;
+    ParallelFor(16, [&, i](int j) {
+      num_inner_workers += IsParallelWorker();
+      ++counts[i * 16 + j];
+    });
+  });
+  CHECK(num_outer_workers == 16);
+  CHECK(num_outer_threads == 16);  // The nested tasks get no threads.
+  CHECK(num_inner_workers == 16 * 16);
+  CHECK(counts == std::vector<int>(16 * 16, 1));
+}
+
+}  // namespace scram::core::test
@@ -103,6 +103,88 @@ TEST_CASE("PdagTest.Cardinality", "[mef::pdag]") {
   }
 }
 
+TEST_CASE("PdagTest.ShareEqualGates", "[mef::pdag]") {
+  mef::BasicEvent one("one"), two("two"), three("three");
+  mef::Gate g_and("g_and"), g_and_copy("g_and_copy"), g_or("g_or");
+  mef::Gate g_vote("g_vote"), g_vote_copy("g_vote_copy");
+  mef::Gate left("left"), right("right"), root("root");
+  auto make_formula = [](mef::Connective connective,
+                         mef::Formula::ArgSet args) {
+    return std::make_unique<mef::Formula>(connective, std::move(args));
+  };
+  g_and.formula(make_formula(mef::kAnd, {&one, &two}));
+  g_and_copy.formula(make_formula(mef::kAnd, {&two, &one}));
+  g_or.formula(make_formula(mef::kOr, {&one, &two}));
+  mef::Formula::ArgSet vote_args = {&one, &two, &three};
+  g_vote.formula(std::make_unique<mef::Formula>(mef::kAtleast, vote_args, 2));
+  g_vote_copy.formula(
+      std::make_unique<mef::Formula>(mef::kAtleast, vote_args, 2));
+
+  SECTION("Equal gates in different formulas") {
+    left.formula(make_formula(mef::kOr, {&g_and, &g_vote}));
+    right.formula(make_formula(mef::kOr, {&g_and_copy, &g_vote_copy, &g_or}));
+    root.formula(make_formula(mef::kAnd, {&left, &right}));
+    Pdag pdag(root);
+    CHECK_FALSE(pdag.HasNullGates());
+    const auto& root_args = pdag.root()->args<Gate>();
+    REQUIRE(root_args.size() == 2);
+    const Gate& pdag_left = *root_args.begin()->second;
+    const Gate& pdag_right = *std::next(root_args.begin())->second;
+    CHECK(pdag_left.args<Gate>().size() == 2);
+    CHECK(pdag_right.args<Gate>().size() == 3);
+    for (const Gate::ConstArg<Gate>& arg : pdag_left.args<Gate>()) {
+      CHECK(pdag_right.args().count(arg.first));
+      CHECK(arg.second.parents().size() == 2);
+    }
+  }
+
+  SECTION("Equal gates in the same formula") {
+    root.formula(make_formula(mef::kOr, {&g_and, &g_and_copy, &g_or}));
+    Pdag pdag(root);
+    CHECK(pdag.HasNullGates());  // The pass-through for the repeated gate.
+    pdag.RemoveNullGates();
+    CHECK(pdag.root()->type() == kOr);
+    CHECK(pdag.root()->args<Gate>().size() == 2);
+    CHECK(pdag.root()->args<Variable>().empty());
+  }
+}
+
+TEST_CASE("PdagTest.DirtyGates", "[mef::pdag]") {
+  Pdag graph;
+  auto var_one = std::make_shared<Variable>(&graph);
+  auto var_two = std::make_shared<Variable>(&graph);
+  auto root = std::make_shared<Gate>(kOr, &graph);
+  auto child = std::make_shared<Gate>(kAnd, &graph);
+  child->AddArg(var_one);
+  child->AddArg(var_two);
+  root->AddArg(child);
+  root->AddArg(var_one);
+  CHECK(graph.PopDirtyGates().empty());  // No tracking by default.
+  CHECK_FALSE(root->dirty());
+
+  graph.TrackDirtyGates(true);
+  root->EraseArg(child->index());
+  CHECK(root->dirty());
+  CHECK(child->dirty());  // The parent is lost.
+  std::vector<GateWeakPtr> dirty = graph.PopDirtyGates();
+  REQUIRE(dirty.size() == 2);
+  CHECK(dirty.front().lock() == root);
+  CHECK(dirty.back().lock() == child);
+  CHECK_FALSE(root->dirty());
+  CHECK_FALSE(child->dirty());
+  CHECK(graph.PopDirtyGates().empty());
+
+  root->AddArg(var_two);
+  root->AddArg(var_two);  // Duplicates are registered once.
+  child.reset();
+  CHECK(graph.PopDirtyGates().size() == 1);
+
+  graph.TrackDirtyGates(false);
+  root->NegateArgs();
+  CHECK_FALSE(root->dirty());
+  CHECK(graph.PopDirtyGates().empty());
+}
+
 static_assert(kNumConnectives == 8, "New gate types are not considered!");
 
 class GateTest {
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "preprocessor.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "event.h"
+#include "fault_tree_analysis.h"
+#include "initializer.h"
+#include "mocus.h"
+#include "risk_analysis_tests.h"
+
+namespace scram::core::test {
+
+namespace {
+
+/// The passes that only optimize the graph.
+const std::set<std::string> kOptionalPasses = {
+    "multiple-definitions", "common-args-merging", "distributivity",
+    "boolean-optimization", "common-node-decomposition"};
+
+}  // namespace
+
+TEST_CASE("PreprocessorTest.PassProfiles", "[core::preprocessor]") {
+  std::vector<std::string> input = {"input/Baobab/baobab2.xml",
+                                    "input/Baobab/baobab2-basic-events.xml"};
+  Settings settings;
+  std::unique_ptr<mef::Model> model = mef::Initializer(input, settings).model();
+  const mef::Gate& top = *model->fault_trees().begin()->top_events().front();
+
+  FaultTreeAnalyzer<Zbdd> fta(top, settings);
+  fta.Analyze();
+  const std::vector<PassProfile>& profiles = fta.preprocessing();
+  REQUIRE_FALSE(profiles.empty());
+  std::set<std::string> names;
+  for (const PassProfile& profile : profiles) {
+    INFO("pass: " << profile.name);
+    CHECK(names.insert(profile.name).second);
+    CHECK(profile.runs + profile.skips > 0);
+    CHECK(profile.time >= 0);
+    if (!kOptionalPasses.count(profile.name))
+      CHECK(profile.skips == 0);
+  }
+  CHECK(names.count("module-detection"));
+  CHECK(names.count("boolean-optimization"));
+
+  settings.preprocessing_budget(1e-9);
+  FaultTreeAnalyzer<Zbdd> budget_fta(top, settings);
+  budget_fta.Analyze();
+  for (const PassProfile& profile : budget_fta.preprocessing()) {
+    INFO("pass: " << profile.name);
+    if (kOptionalPasses.count(profile.name))
+      CHECK(profile.runs <= 1);
+  }
+  CHECK(RiskAnalysisTest::Convert(budget_fta.products()) ==
+        RiskAnalysisTest::Convert(fta.products()));
+}
+
+TEST_CASE("PreprocessorTest.ParallelModules", "[core::preprocessor]") {
+  const int kNumModules = 3;
+  const int kModuleSize = 70;  // Large enough for a separate partition.
+  std::vector<std::unique_ptr<mef::BasicEvent>> events;
+  std::vector<std::unique_ptr<mef::Gate>> gates;
+  mef::Formula::ArgSet top_args;
+  for (int i = 0; i < kNumModules; ++i) {
+    mef::Formula::ArgSet module_args;
+    for (int j = 0; j < kModuleSize; ++j) {
+      mef::Formula::ArgSet voters;  // The K/N gates need new gates.
+      for (int k = 0; k < 3; ++k) {
+        events.push_back(std::make_unique<mef::BasicEvent>(
+            "e" + std::to_string(events.size())));
+        voters.Add(events.back().get());
+      }
+      gates.push_back(
+          std::make_unique<mef::Gate>("g" + std::to_string(gates.size())));
+      gates.back()->formula(
+          std::make_unique<mef::Formula>(mef::kAtleast, std::move(voters), 2));
+      module_args.Add(gates.back().get());
+    }
+    gates.push_back(
+        std::make_unique<mef::Gate>("m" + std::to_string(gates.size())));
+    gates.back()->formula(
+        std::make_unique<mef::Formula>(mef::kOr, std::move(module_args)));
+    top_args.Add(gates.back().get());
+  }
+  mef::Gate top("top");
+  top.formula(std::make_unique<mef::Formula>(mef::kOr, std::move(top_args)));
+
+  FaultTreeAnalyzer<Bdd> fta(top, Settings());
+  fta.Analyze();
+  auto products = RiskAnalysisTest::Convert(fta.products());
+  CHECK(products.size() == kNumModules * kModuleSize * 3);
+  for (const std::set<std::string>& product : products)
+    CHECK(product.size() == 2);
+}
+
+TEST_CASE("PreprocessorTest.ParallelModulesWithComplements",
+          "[core::preprocessor]") {
+  const int kNumModules = 3;
+  const int kModuleSize = 70;  // Large enough for a separate partition.
+  std::vector<std::unique_ptr<mef::BasicEvent>> events;
+  std::vector<std::unique_ptr<mef::Gate>> gates;
+  auto add_event = [&events](const std::string& name) {
+    events.push_back(std::make_unique<mef::BasicEvent>(name));
+    return events.back().get();
+  };
+  auto add_gate = [&gates](mef::Connective connective,
+                           mef::Formula::ArgSet args) {
+    gates.push_back(
+        std::make_unique<mef::Gate>("g" + std::to_string(gates.size())));
+    gates.back()->formula(
+        std::make_unique<mef::Formula>(connective, std::move(args)));
+    return gates.back().get();
+  };
+  mef::Formula::ArgSet top_args;
+  for (int i = 0; i < kNumModules; ++i) {
+    // The common event is redundant in the OR gates under the module.
+    mef::BasicEvent* common = add_event("s" + std::to_string(i));
+    mef::Formula::ArgSet module_args;
+    module_args.Add(common);
+    for (int j = 0; j < kModuleSize; ++j) {
+      std::string suffix = std::to_string(i) + "_" + std::to_string(j);
+      mef::Formula::ArgSet or_args;
+      or_args.Add(common);
+      or_args.Add(add_event("a" + suffix));
+      mef::Formula::ArgSet nand_args;  // Complements for Phase IV.
+      nand_args.Add(add_event("y" + suffix));
+      nand_args.Add(add_event("z" + suffix));
+      mef::Formula::ArgSet and_args;
+      and_args.Add(add_event("x" + suffix));
+      and_args.Add(add_gate(mef::kOr, std::move(or_args)));
+      and_args.Add(add_gate(mef::kNand, std::move(nand_args)));
+      module_args.Add(add_gate(mef::kAnd, std::move(and_args)));
+    }
+    top_args.Add(add_gate(mef::kOr, std::move(module_args)));
+  }
+  mef::Gate top("top");
+  top.formula(std::make_unique<mef::Formula>(mef::kOr, std::move(top_args)));
+
+  FaultTreeAnalyzer<Bdd> bdd(top, Settings());
+  bdd.Analyze();
+  auto products = RiskAnalysisTest::Convert(bdd.products());
+  CHECK(products.size() == kNumModules * (kModuleSize + 1));
+  for (const std::set<std::string>& product : products) {
+    CHECK(product.size() == (product.begin()->front() == 's' ? 1 : 2));
+    CHECK(product.begin()->front() != 'y');  // The complements are True.
+  }
+
+  FaultTreeAnalyzer<Zbdd> zbdd(top, Settings());
+  zbdd.Analyze();
+  CHECK(RiskAnalysisTest::Convert(zbdd.products()) == products);
+
+  FaultTreeAnalyzer<Mocus> mocus(top, Settings());
+  mocus.Analyze();
+  CHECK(RiskAnalysisTest::Convert(mocus.products()) == products);
+}
+
+}  // namespace scram::core::test
@@ -68,6 +68,7 @@ TEST_CASE("ProjectTest.FullSettings", "[config]") {
   CHECK(settings.probability_analysis());
   CHECK(settings.importance_analysis());
   CHECK(settings.uncertainty_analysis());
+  CHECK(settings.sensitivity_analysis());
   CHECK(settings.ccf_analysis());
   CHECK(settings.safety_integrity_levels());
   CHECK(settings.approximation() == core::Approximation::kRareEvent);
@@ -79,6 +80,11 @@ TEST_CASE("ProjectTest.FullSettings", "[config]") {
   CHECK(settings.num_quantiles() == 13);
   CHECK(settings.num_bins() == 31);
   CHECK(settings.seed() == 97531);
+  REQUIRE(settings.sweeps().size() == 1);
+  CHECK(settings.sweeps().front().parameter == core::Settings::kMissionTime);
+  CHECK(settings.sweeps().front().stop == 48);
+  CHECK(settings.sweeps().front().num_points == 5);
+  CHECK(settings.targets() == std::vector<std::string>{"TopEvent"});
 }
 
 TEST_CASE("ProjectTest.PrimeImplicantsSettings", "[config]") {
@@ -17,9 +17,12 @@
 
 #include "risk_analysis_tests.h"
 
+#include <cmath>
+
 #include <utility>
 
 #include <boost/filesystem.hpp>
+#include <boost/range/distance.hpp>
 
 #include "env.h"
 #include "error.h"
@@ -72,10 +75,8 @@ void RiskAnalysisTest::CheckReport(const std::vector<std::string>& tree_input) {
 const std::set<std::set<std::string>>& RiskAnalysisTest::products() {
   assert(analysis->results().size() == 1);
   if (result_.products.empty()) {
-    for (const Product& product :
-         analysis->results().front().fault_tree_analysis->products()) {
-      result_.products.emplace(Convert(product));
-    }
+    result_.products =
+        Convert(analysis->results().front().fault_tree_analysis->products());
   }
   return result_.products;
 }
@@ -118,6 +119,14 @@ std::map<std::string, double> RiskAnalysisTest::sequences() {
   return results;
 }
 
+std::set<std::set<std::string>> RiskAnalysisTest::Convert(
+    const ProductContainer& products) {
+  std::set<std::set<std::string>> string_sets;
+  for (const Product& product : products)
+    string_sets.emplace(Convert(product));
+  return string_sets;
+}
+
 std::set<std::string> RiskAnalysisTest::Convert(const Product& product) {
   std::set<std::string> string_set;
   for (const Literal& literal : product) {
@@ -343,6 +352,58 @@ TEST_F(RiskAnalysisTest, McubNonCoherent) {
   CHECK(p_total() == Approx(0.10));
 }
 
+// The automatic selection of algorithms per analysis target.
+TEST_F(RiskAnalysisTest, AutoAlgorithm) {
+  settings.algorithm("auto").probability_analysis(true);
+  auto selection = [this] {
+    REQUIRE(analysis->results().size() == 1);
+    REQUIRE(analysis->results().front().algorithm_selection);
+    return *analysis->results().front().algorithm_selection;
+  };
+
+  SECTION("Non-coherent logic") {
+    REQUIRE_NOTHROW(ProcessInputFiles({"tests/input/core/a_and_not_b.xml"}));
+    REQUIRE_NOTHROW(analysis->Analyze());
+    CHECK(selection().algorithm == Algorithm::kBdd);
+    CHECK_FALSE(selection().metrics.coherent);
+    CHECK(selection().metrics.num_noncoherent_gates > 0);
+    CHECK(selection().trial_vertices > 0);
+    CHECK(p_total() == Approx(0.08));
+  }
+
+  SECTION("Wide non-coherent logic") {
+    REQUIRE_NOTHROW(
+        ProcessInputFiles({"tests/input/core/wide_noncoherent_module.xml"}));
+    REQUIRE_NOTHROW(analysis->Analyze());
+    CHECK(selection().algorithm == Algorithm::kZbdd);
+    CHECK(selection().approximation == Approximation::kRareEvent);
+    CHECK_FALSE(selection().metrics.coherent);
+    CHECK(products().size() == 210);
+    CHECK(p_total() == Approx(0.021));
+  }
+
+  SECTION("Narrow coherent logic") {
+    REQUIRE_NOTHROW(ProcessInputFiles({"input/TwoTrain/two_train.xml"}));
+    REQUIRE_NOTHROW(analysis->Analyze());
+    CHECK(selection().algorithm == Algorithm::kBdd);
+    CHECK(selection().approximation == Approximation::kNone);
+    CHECK(selection().metrics.coherent);
+    CHECK(selection().trial_vertices > 0);
+    CHECK(p_total() == Approx(0.7225));
+    CHECK(products().size() == 4);
+  }
+
+  SECTION("Wide coherent logic") {
+    REQUIRE_NOTHROW(ProcessInputFiles({"tests/input/core/wide_module.xml"}));
+    REQUIRE_NOTHROW(analysis->Analyze());
+    CHECK(selection().algorithm == Algorithm::kZbdd);
+    CHECK(selection().approximation == Approximation::kRareEvent);
+    CHECK(selection().metrics.max_module_shared_variables > 100);
+    CHECK(products().size() == 210);
+    CHECK(p_total() == Approx(0.021));
+  }
+}
+
 // Test Monte Carlo Analysis
 /// @todo Expand this test.
 TEST_P(RiskAnalysisTest, AnalyzeMC) {
@@ -593,12 +654,163 @@ TEST_F(RiskAnalysisTest, ReportAlignment) {
   CheckReport({tree_input});
 }
 
+// The phases with the same house events in the target cone
+// share the qualitative analysis.
+TEST_F(RiskAnalysisTest, AlignmentSharedAnalysis) {
+  std::string tree_input = "input/TwoTrain/two_train_alignment.xml";
+  settings.probability_analysis(true).target("TrainOne");
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  const std::vector<RiskAnalysis::Result>& results = analysis->results();
+  REQUIRE(results.size() == 3);  // Normal, PumpOne, PumpTwo phases.
+  for (const RiskAnalysis::Result& result : results)
+    REQUIRE(result.fault_tree_analysis);
+  CHECK(results[0].fault_tree_analysis == results[2].fault_tree_analysis);
+  CHECK(results[0].fault_tree_analysis != results[1].fault_tree_analysis);
+  CHECK(results[0].fault_tree_analysis->products().size() == 2);
+  CHECK(results[1].fault_tree_analysis->products().size() == 1);
+  REQUIRE(results[2].probability_analysis);
+  CHECK(results[2].probability_analysis->p_total() ==
+        Approx(results[0].probability_analysis->p_total()));
+}
+
+// The shared products are requantified with the phase mission time.
+TEST_F(RiskAnalysisTest, AlignmentSharedAnalysisMissionTime) {
+  std::string tree_input = "tests/input/core/alignment_mission_time.xml";
+  settings.probability_analysis(true).importance_analysis(true).time_step(1000);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  const std::vector<RiskAnalysis::Result>& results = analysis->results();
+  REQUIRE(results.size() == 2);  // Startup and Shutdown phases.
+  REQUIRE(results[0].fault_tree_analysis);
+  CHECK(results[0].fault_tree_analysis == results[1].fault_tree_analysis);
+  REQUIRE(results[0].probability_analysis);
+  REQUIRE(results[1].probability_analysis);
+  // The phase mission times are 1752 and 7008 hours.
+  CHECK(results[0].probability_analysis->p_total() ==
+        Approx(1 - std::exp(-2e-5 * 1752)));
+  CHECK(results[1].probability_analysis->p_total() ==
+        Approx(1 - std::exp(-2e-5 * 7008)));
+  // The reused analysis is requantified with the settings of the phase.
+  for (int i : {0, 1}) {
+    double mission_time = i ? 7008 : 1752;
+    CHECK(results[i].probability_analysis->settings().mission_time() ==
+          Approx(mission_time));
+    REQUIRE(results[i].importance_analysis);
+    CHECK(results[i].importance_analysis->settings().mission_time() ==
+          Approx(mission_time));
+    const auto& p_time = results[i].probability_analysis->p_time();
+    REQUIRE_FALSE(p_time.empty());
+    CHECK(p_time.back().second == Approx(mission_time));
+    CHECK(p_time.back().first == Approx(1 - std::exp(-2e-5 * mission_time)));
+  }
+}
+
 TEST_F(RiskAnalysisTest, ReportAlignmentEventTree) {
   std::string dir = "input/EventTrees/";
   settings.probability_analysis(true);
   CheckReport({dir + "attack_alignment.xml", dir + "attack.xml"});
 }
 
+// Reporting of a limited number of products.
+TEST_F(RiskAnalysisTest, ReportLimitedProducts) {
+  static xml::Validator validator(env::report_schema());
+  std::vector<std::string> input_files = {
+      "input/Baobab/baobab1.xml", "input/Baobab/baobab1-basic-events.xml"};
+  settings.probability_analysis(true);
+  REQUIRE_NOTHROW(ProcessInputFiles(input_files));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  CHECK_THROWS_AS(Reporter().limit_order(-1), SettingsError);
+  CHECK_THROWS_AS(Reporter().limit_products(-1), SettingsError);
+
+  auto [limit_order, limit_products, num_reported] =
+      GENERATE(table<int, int, int>(
+          {{0, 0, 46188}, {0, 100, 100}, {5, 0, 472}, {5, 10, 10}}));
+  INFO("limit order: " << limit_order);
+  INFO("limit products: " << limit_products);
+  fs::path unique_name = "scram_report_test-" + fs::unique_path().string();
+  fs::path temp_file = fs::temp_directory_path() / unique_name;
+  INFO("output: " + temp_file.string());
+  REQUIRE_NOTHROW(Reporter()
+                      .limit_order(limit_order)
+                      .limit_products(limit_products)
+                      .Report(*analysis, temp_file.string()));
+  xml::Document document(temp_file.string(), &validator);
+  fs::remove(temp_file);
+  xml::Element sum_of_products =
+      *document.root().child("results")->child("sum-of-products");
+  CHECK(sum_of_products.attribute<int>("products") == 46188);
+  CHECK(boost::distance(sum_of_products.children("product")) == num_reported);
+  for (const xml::Element& product : sum_of_products.children("product")) {
+    if (limit_order)
+      CHECK(product.attribute<int>("order") <= limit_order);
+  }
+}
+
+// Reporting of the BDD variable reordering in the performance section.
+TEST_F(RiskAnalysisTest, ReportBddReordering) {
+  static xml::Validator validator(env::report_schema());
+  settings.algorithm("bdd").reorder_threshold(1);
+  REQUIRE_NOTHROW(ProcessInputFiles({"input/ThreeMotor/three_motor.xml"}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  const auto& reordering =
+      analysis->results().front().fault_tree_analysis->reordering();
+  REQUIRE(reordering);
+  REQUIRE(reordering->count > 0);
+
+  fs::path unique_name = "scram_report_test-" + fs::unique_path().string();
+  fs::path temp_file = fs::temp_directory_path() / unique_name;
+  INFO("output: " + temp_file.string());
+  REQUIRE_NOTHROW(Reporter().Report(*analysis, temp_file.string()));
+  xml::Document document(temp_file.string(), &validator);
+  fs::remove(temp_file);
+  xml::Element element = *document.root()
+                              .child("information")
+                              ->child("performance")
+                              ->child("calculation-time")
+                              ->child("bdd-reordering");
+  CHECK(element.attribute<int>("count") == reordering->count);
+  CHECK(element.attribute<int>("size-before") == reordering->size_before);
+  CHECK(element.attribute<int>("size-after") == reordering->size_after);
+  CHECK(element.attribute<double>("time") >= 0);
+
+  settings.algorithm("zbdd");
+  REQUIRE_NOTHROW(ProcessInputFiles({"input/ThreeMotor/three_motor.xml"}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  CHECK_FALSE(analysis->results().front().fault_tree_analysis->reordering());
+}
+
+// The sum of product probabilities without enumeration of products.
+TEST_P(RiskAnalysisTest, ProductProbabilitySum) {
+  const std::vector<std::string> baobab = {
+      "input/Baobab/baobab1.xml", "input/Baobab/baobab1-basic-events.xml"};
+  auto [input_files, limit_order] =
+      GENERATE_COPY(table<std::vector<std::string>, int>(
+          {{{"tests/input/fta/correct_tree_input_with_probs.xml"}, 20},
+           {{"tests/input/core/a_or_not_b.xml"}, 20},
+           {{"tests/input/core/mgl_ccf.xml"}, 20},
+           {{"input/ThreeMotor/three_motor.xml"}, 20},
+           {baobab, 20},
+           {baobab, 4}}));
+  INFO("input: " + input_files.front());
+  INFO("limit order: " << limit_order);
+  settings.limit_order(limit_order).ccf_analysis(true);
+  REQUIRE_NOTHROW(ProcessInputFiles(input_files));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  for (const RiskAnalysis::Result& result : analysis->results()) {
+    const ProductContainer& products = result.fault_tree_analysis->products();
+    Pdag::IndexMap<double> p_vars = products.ExtractProbabilities();
+    double sum = 0;
+    double cached_sum = 0;
+    for (const Product& product : products) {
+      sum += product.p();
+      cached_sum += product.p(p_vars);
+    }
+    CHECK(cached_sum == Approx(sum));
+    CHECK(products.CalculateProbabilitySum(p_vars) == Approx(sum));
+  }
+}
+
 // NAND and NOR as a child cases.
 TEST_P(RiskAnalysisTest, ChildNandNorGates) {
   std::string tree_input = "tests/input/fta/children_nand_nor.xml";
@@ -30,8 +30,9 @@
 #define TEST_F(Fixture, Name) \
   TEST_CASE_METHOD(Fixture, #Fixture "." #Name, "[risk]")
 /// Parametrized tests by the by analysis algorithms.
-#define TEST_P(Fixture, Name) \
-  TEST_CASE_METHOD(Fixture, #Fixture "." #Name, "[risk][bdd][pi][mocus][zbdd]")
+#define TEST_P(Fixture, Name)                \
+  TEST_CASE_METHOD(Fixture, #Fixture "." #Name, \
+                   "[risk][bdd][pi][mocus][zbdd][auto]")
 #define ASSERT_NO_THROW REQUIRE_NOTHROW
 #define EXPECT_NEAR(expected, value, delta) \
   CHECK((value) == Approx(expected).margin(delta))
@@ -58,6 +59,15 @@ class RiskAnalysisTest {
 
   RiskAnalysisTest();
 
+  /// Converts products into readable and testable sets of strings.
+  /// Complements are communicated with "not" prefix.
+  ///
+  /// @param[in] products  The products of a fault tree analysis.
+  ///
+  /// @returns The products as sets of literal strings.
+  static std::set<std::set<std::string>> Convert(
+      const ProductContainer& products);
+
  protected:
   // Parsing multiple input files.
   void ProcessInputFiles(const std::vector<std::string>& input_files,
@@ -120,6 +130,27 @@ class RiskAnalysisTest {
 #undef IMP_EQ
   }
 
+  /// @returns The sensitivity of the total probability to a parameter.
+  const SensitivityRecord& sensitivity(const std::string& id) {
+    assert(analysis->results().size() == 1);
+    assert(analysis->results().front().sensitivity_analysis);
+    const auto& sensitivity =
+        analysis->results().front().sensitivity_analysis->sensitivity();
+    auto it =
+        boost::find_if(sensitivity, [&id](const SensitivityRecord& record) {
+          return record.parameter.id() == id;
+        });
+    assert(it != sensitivity.end());
+    return *it;
+  }
+
+  /// @returns The parametric study of the only analysis target.
+  const ParametricAnalysis& parametric() {
+    assert(analysis->results().size() == 1);
+    assert(analysis->results().front().parametric_analysis);
+    return *analysis->results().front().parametric_analysis;
+  }
+
   // Uncertainty analysis.
   double mean() {
     assert(analysis->results().size() == 1);
@@ -145,7 +176,7 @@ class RiskAnalysisTest {
   /// Converts a set of pointers to events with complement flags
   /// into readable and testable strings.
   /// Complements are communicated with "not" prefix.
-  std::set<std::string> Convert(const Product& product);
+  static std::set<std::string> Convert(const Product& product);
 
   /// @todo Provide parametrized tests.
   /// @{
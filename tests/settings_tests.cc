@@ -34,6 +34,12 @@ TEST_CASE("SettingsTest IncorrectSetup", "[settings]") {
   // Incorrect cut-off probability.
   CHECK_THROWS_AS(s.cut_off(-1), SettingsError);
   CHECK_THROWS_AS(s.cut_off(10), SettingsError);
+  // Incorrect BDD size to trigger reordering.
+  CHECK_THROWS_AS(s.reorder_threshold(-1), SettingsError);
+  // Incorrect number of CCF combination events per level.
+  CHECK_THROWS_AS(s.ccf_expansion_limit(-1), SettingsError);
+  // Incorrect time budget for preprocessing passes.
+  CHECK_THROWS_AS(s.preprocessing_budget(-1), SettingsError);
   // Incorrect number of trials.
   CHECK_THROWS_AS(s.num_trials(-10), SettingsError);
   CHECK_THROWS_AS(s.num_trials(0), SettingsError);
@@ -63,6 +69,9 @@ TEST_CASE("SettingsTest CorrectSetup", "[settings]") {
   CHECK_NOTHROW(s.algorithm("mocus"));
   CHECK_NOTHROW(s.algorithm("bdd"));
   CHECK_NOTHROW(s.algorithm("zbdd"));
+  CHECK_NOTHROW(s.algorithm("monte-carlo"));
+  CHECK_NOTHROW(s.algorithm("auto"));
+  CHECK_NOTHROW(s.algorithm("bdd"));
 
   // Correct approximation argument.
   CHECK_NOTHROW(s.approximation("rare-event"));
@@ -78,6 +87,18 @@ TEST_CASE("SettingsTest CorrectSetup", "[settings]") {
   CHECK_NOTHROW(s.cut_off(0));
   CHECK_NOTHROW(s.cut_off(0.5));
 
+  // Correct BDD size to trigger reordering.
+  CHECK_NOTHROW(s.reorder_threshold(0));
+  CHECK_NOTHROW(s.reorder_threshold(1000));
+
+  // Correct number of CCF combination events per level.
+  CHECK_NOTHROW(s.ccf_expansion_limit(0));
+  CHECK_NOTHROW(s.ccf_expansion_limit(100));
+
+  // Correct time budget for preprocessing passes.
+  CHECK_NOTHROW(s.preprocessing_budget(0));
+  CHECK_NOTHROW(s.preprocessing_budget(0.5));
+
   // Correct number of trials.
   CHECK_NOTHROW(s.num_trials(1));
   CHECK_NOTHROW(s.num_trials(1e6));
@@ -120,6 +141,43 @@ TEST_CASE("SettingsTest SetupForPrimeImplicants", "[settings]") {
   CHECK_NOTHROW(s.approximation("none"));
   CHECK_THROWS_AS(s.approximation("rare-event"), SettingsError);
   CHECK_THROWS_AS(s.approximation("mcub"), SettingsError);
+  // The automatic selection leaves prime implicants to BDD.
+  REQUIRE_NOTHROW(s.algorithm("auto"));
+  CHECK(s.prime_implicants());
+}
+
+TEST_CASE("SettingsTest SetupForMonteCarlo", "[settings]") {
+  Settings s;
+  REQUIRE_NOTHROW(s.algorithm("monte-carlo"));
+  CHECK(s.probability_analysis());
+  CHECK(s.approximation() == Approximation::kNone);
+  CHECK_THROWS_AS(s.approximation("rare-event"), SettingsError);
+  CHECK_THROWS_AS(s.approximation("mcub"), SettingsError);
+  CHECK_THROWS_AS(s.prime_implicants(true), SettingsError);
+}
+
+TEST_CASE("SettingsTest SetupForSweep", "[settings]") {
+  Settings s;
+  CHECK_THROWS_AS(s.sweep({"lambda", 0, 1, 0}), SettingsError);
+  CHECK_THROWS_AS(s.sweep({Settings::kMissionTime, -1, 10, 2}), SettingsError);
+  CHECK(s.sweeps().empty());
+  REQUIRE_NOTHROW(s.sweep({"lambda", 0, 1, 10}));
+  CHECK(s.probability_analysis());
+  CHECK_THROWS_AS(s.sweep({"lambda", 1, 2, 10}), SettingsError);
+  REQUIRE_NOTHROW(s.sweep({Settings::kMissionTime, 0, 1000, 5}));
+  CHECK(s.sweeps().size() == 2);
+  s.probability_analysis(false);
+  CHECK(s.probability_analysis());
+}
+
+TEST_CASE("SettingsTest SetupForTargets", "[settings]") {
+  Settings s;
+  CHECK(s.targets().empty());
+  CHECK_THROWS_AS(s.target(""), SettingsError);
+  REQUIRE_NOTHROW(s.target("TopEvent"));
+  REQUIRE_NOTHROW(s.target("IE"));
+  CHECK_THROWS_AS(s.target("TopEvent"), SettingsError);
+  CHECK(s.targets() == std::vector<std::string>{"TopEvent", "IE"});
 }
 
 }  // namespace scram::core::test
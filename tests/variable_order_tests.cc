@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "variable_order.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/range/algorithm.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "error.h"
+#include "event.h"
+#include "fault_tree_analysis.h"
+#include "initializer.h"
+
+namespace fs = boost::filesystem;
+
+namespace scram::core::test {
+
+namespace {
+
+/// @returns The basic event ids in the ascending order of the BDD variables.
+std::vector<std::string> GetOrder(const FaultTreeAnalyzer<Bdd>& fta) {
+  std::vector<std::pair<int, std::string>> variables;
+  for (const auto& [index, order] : fta.algorithm()->index_to_order())
+    variables.emplace_back(order, fta.graph()->basic_events()[index]->id());
+  boost::sort(variables);
+  std::vector<std::string> ids;
+  for (const auto& variable : variables)
+    ids.push_back(variable.second);
+  return ids;
+}
+
+}  // namespace
+
+TEST_CASE("VariableOrderTest.SeedAndSave", "[core::variable_order]") {
+  std::vector<std::string> input = {"input/ThreeMotor/three_motor.xml"};
+  fs::path file = fs::temp_directory_path() /
+                  ("scram_order_test-" + fs::unique_path().string());
+  Settings settings;
+  settings.variable_order(file.string());
+  std::unique_ptr<mef::Model> model = mef::Initializer(input, settings).model();
+  const mef::Gate& top = *model->fault_trees().begin()->top_events().front();
+
+  FaultTreeAnalyzer<Bdd> fta(top, settings);
+  fta.Analyze();
+  std::vector<std::string> order = GetOrder(fta);
+  REQUIRE(order.size() > 2);
+  REQUIRE(fs::exists(file));
+
+  // The saved order is reproduced.
+  FaultTreeAnalyzer<Bdd> saved_fta(top, settings);
+  saved_fta.Analyze();
+  CHECK(GetOrder(saved_fta) == order);
+
+  // The seeded order is followed, and other targets are preserved.
+  std::vector<std::string> reversed(order.rbegin(), order.rend() - 1);
+  {
+    std::ofstream out(file.string());
+    out << "target: " << top.id() << "\n";
+    for (const std::string& id : reversed)
+      out << id << "\n";
+    out << "target: OtherTarget\nOtherEvent\n";
+  }
+  FaultTreeAnalyzer<Bdd> seeded_fta(top, settings);
+  seeded_fta.Analyze();
+  std::vector<std::string> seeded_order = GetOrder(seeded_fta);
+  REQUIRE(seeded_order.size() == order.size());
+  seeded_order.erase(boost::find(seeded_order, order.front()));
+  CHECK(seeded_order == reversed);
+  CHECK(seeded_fta.products().size() == fta.products().size());
+  {
+    std::ifstream in(file.string());
+    std::string content((std::istreambuf_iterator<char>(in)),
+                        std::istreambuf_iterator<char>());
+    CHECK(content.find("target: OtherTarget\nOtherEvent\n") !=
+          std::string::npos);
+  }
+
+  {
+    std::ofstream out(file.string());
+    out << "EventWithoutTarget\n";
+  }
+  CHECK_THROWS_AS(VariableOrder(file.string()), IOError);
+  fs::remove(file);
+}
+
+}  // namespace scram::core::test
@@ -17,6 +17,8 @@
 
 #include "xml_stream.h"
 
+#include <cstdio>
+
 #include <fstream>
 #include <memory>
 #include <sstream>
@@ -106,6 +108,8 @@ TEST_CASE("XmlStreamTest.Element", "[xml_stream]") {
 }
 
 TEST_CASE("XmlStreamTest.Full", "[xml_stream]") {
+  bool async = GENERATE(false, true);
+  INFO("async: " << async);
   fs::path unique_name = "scram_xml_test-" + fs::unique_path().string();
   fs::path temp_file = fs::temp_directory_path() / unique_name;
   INFO("XML temp file: " + temp_file.string());
@@ -129,7 +133,7 @@ TEST_CASE("XmlStreamTest.Full", "[xml_stream]") {
   {
     std::unique_ptr<std::FILE, decltype(&std::fclose)> fp(
         std::fopen(temp_file.string().c_str(), "w"), &std::fclose);
-    Stream xml_stream(fp.get());
+    Stream xml_stream(fp.get(), /*indent=*/true, async);
     StreamElement root = xml_stream.root("root");
     root.SetAttribute("name", "master")
         .SetAttribute("age", 42)
@@ -156,4 +160,44 @@ TEST_CASE("XmlStreamTest.Full", "[xml_stream]") {
   fs::remove(temp_file);
 }
 
+TEST_CASE("XmlStreamTest.LargeOutput", "[xml_stream]") {
+  bool async = GENERATE(false, true);
+  INFO("async: " << async);
+  fs::path unique_name = "scram_xml_test-" + fs::unique_path().string();
+  fs::path temp_file = fs::temp_directory_path() / unique_name;
+  INFO("XML temp file: " + temp_file.string());
+  std::string long_text(3 * detail::FileStream::kBufferSize / 2, 'x');
+  long_text[42] = '&';
+  const int kNumElements = 100000;  // Over multiple buffer blocks.
+  std::string expected = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+  expected += "<root>\n";
+  char number[32];
+  for (int i = 0; i < kNumElements; ++i) {
+    std::snprintf(number, sizeof(number), "%g", i * 0.001 - 7);
+    expected += "<e index=\"" + std::to_string(i) + "\" size=\"" +
+                std::to_string(std::size_t(i) * 1000) + "\" value=\"" +
+                number + "\"/>\n";
+  }
+  expected += "<text>" + long_text.substr(0, 42) + "&amp;" +
+              long_text.substr(43) + "</text>\n";
+  expected += "</root>\n";
+  {
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> fp(
+        std::fopen(temp_file.string().c_str(), "w"), &std::fclose);
+    Stream xml_stream(fp.get(), /*indent=*/false, async);
+    StreamElement root = xml_stream.root("root");
+    for (int i = 0; i < kNumElements; ++i) {
+      root.AddChild("e")
+          .SetAttribute("index", i)
+          .SetAttribute("size", std::size_t(i) * 1000)
+          .SetAttribute("value", i * 0.001 - 7);
+    }
+    root.AddChild("text").AddText(long_text);
+  }
+  std::stringstream str_stream;
+  str_stream << std::fstream(temp_file.string()).rdbuf();
+  CHECK(str_stream.str() == expected);
+  fs::remove(temp_file);
+}
+
 }  // namespace scram::xml::test